@@ -0,0 +1,141 @@
+#
+# CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+# Author: Jakub Parez <parez.jakub@gmail.com>
+#
+# Generates perfect hash dispatch table of SCPI commands (comm_hash.h) from scpi_commands[] in comm.c.
+#
+#   python3 scpi_hash.py [comm.c] [comm_hash.h]
+#
+# key of command is normalized header - first PREFIX chars of every mnemonic, upper case, ':' between,
+# '?' for query. both short and long form of header give the same key, so firmware hashes received header
+# and verifies the only candidate by full matcher. patterns with optional parts [] or numeric suffix #
+# are left to linear search.
+#
+
+import os
+import re
+import sys
+
+ROOT = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "src", "firmware-stm32", "__app"))
+SRC = os.path.join(ROOT, "src", "comm.c")
+DST = os.path.join(ROOT, "inc", "comm_hash.h")
+
+FNV_OFFSET = 2166136261
+FNV_PRIME = 16777619
+SEED_MAX = 100000
+
+
+def read_patterns(path):
+    text = open(path).read()
+    table = text[text.index("scpi_commands[]"):]
+    table = table[:table.index("SCPI_CMD_LIST_END")]
+    patterns = []
+    for line in table.splitlines():
+        line = line.strip()
+        if line.startswith("//"):
+            continue
+        m = re.search(r'\.pattern\s*=\s*"([^"]+)"', line)
+        if m:
+            patterns.append(m.group(1))
+    return patterns
+
+
+def short_len(mnemonic):
+    return sum(1 for c in mnemonic if c.isupper() or c.isdigit() or c == '*')
+
+
+def normalize(header, prefix):
+    key = ""
+    seg = 0
+    for c in header.lstrip(':'):
+        if c == ':':
+            key += c
+            seg = 0
+        elif c == '?':
+            key += c
+        elif seg < prefix:
+            key += c.upper()
+            seg += 1
+    return key
+
+
+def fnv(key, seed):
+    h = (FNV_OFFSET ^ seed) & 0xFFFFFFFF
+    for c in key.encode():
+        h ^= c
+        h = (h * FNV_PRIME) & 0xFFFFFFFF
+    return h
+
+
+def main():
+    src = sys.argv[1] if len(sys.argv) > 1 else SRC
+    dst = sys.argv[2] if len(sys.argv) > 2 else DST
+
+    patterns = read_patterns(src)
+    hashed = [(i, p) for i, p in enumerate(patterns) if '[' not in p and '#' not in p]
+
+    # longest prefix all valid header forms share
+    prefix = min([short_len(m) for _, p in hashed for m in p.rstrip('?').split(':')
+                  if m.lstrip('*') and short_len(m) != len(m)] or [4])
+
+    keys = {}
+    for i, p in hashed:
+        k = normalize(p, prefix)
+        if k in keys:
+            sys.exit("scpi_hash: '%s' and '%s' have same key '%s'" % (patterns[keys[k]], p, k))
+        keys[k] = i
+
+    bits = max(1, (2 * len(keys) - 1).bit_length())
+    for seed in range(SEED_MAX):
+        slots = {}
+        for k, i in keys.items():
+            s = fnv(k, seed) >> (32 - bits)
+            if s in slots:
+                break
+            slots[s] = i
+        else:
+            break
+    else:
+        sys.exit("scpi_hash: no perfect hash found")
+
+    table = [0] * (1 << bits)
+    for s, i in slots.items():
+        table[s] = i + 1
+
+    rows = []
+    for n in range(0, len(table), 16):
+        rows.append("    " + ", ".join("%2d" % v for v in table[n:n + 16]) + ",")
+
+    out = """/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+/* generated by scripts/scpi_hash.py from scpi_commands[] in comm.c - do not edit */
+
+#ifndef INC_COMM_HASH_H_
+#define INC_COMM_HASH_H_
+
+#include <stdint.h>
+
+#define COMM_HASH_CMDS      %d          // entries of scpi_commands[], table is not used if they differ
+#define COMM_HASH_PREFIX    %d           // chars of every mnemonic in key
+#define COMM_HASH_SEED      %du
+#define COMM_HASH_BITS      %d
+
+/* top COMM_HASH_BITS of FNV-1a of key -> index of command + 1, 0 = none */
+static const uint8_t comm_hash_table[1 << COMM_HASH_BITS] =
+{
+%s
+};
+
+#endif /* INC_COMM_HASH_H_ */
+""" % (len(patterns), prefix, seed, bits, "\n".join(rows))
+
+    open(dst, "w").write(out)
+    print("scpi_hash: %d commands, %d hashed, prefix %d, seed %d, %d slots -> %s" %
+          (len(patterns), len(keys), prefix, seed, len(table), dst))
+
+
+if __name__ == "__main__":
+    main()
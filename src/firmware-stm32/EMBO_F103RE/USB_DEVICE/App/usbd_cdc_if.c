@@ -95,7 +95,8 @@ uint8_t UserRxBufferFS[APP_RX_DATA_SIZE];
 uint8_t UserTxBufferFS[APP_TX_DATA_SIZE];
 
 /* USER CODE BEGIN PRIVATE_VARIABLES */
-
+static uint8_t* volatile rx_held;       // unparsed rest of OUT packet, endpoint NAKs until comm task takes it
+static volatile uint32_t rx_held_len;
 /* USER CODE END PRIVATE_VARIABLES */
 
 /**
@@ -133,6 +134,9 @@ uint8_t CDC_Busy()
     USBD_CDC_HandleTypeDef *hcdc = (USBD_CDC_HandleTypeDef*)hUsbDeviceFS.pClassData;
     return hcdc->TxState != 0 ? 1 : 0;
 }
+
+static void CDC_RxArm(void);
+static uint32_t CDC_RxParse(uint8_t* Buf, uint32_t Len, uint8_t* msg);
 /* USER CODE END PRIVATE_FUNCTIONS_DECLARATION */
 
 /**
@@ -268,7 +272,6 @@ static int8_t CDC_Receive_FS(uint8_t* Buf, uint32_t *Len)
   int8_t ret = 0;
   int8_t exit = 0;
 
-  uint32_t len = *Len;
   if (hUsbDeviceFS.dev_state != USBD_STATE_CONFIGURED)
   {
      ret = USBD_FAIL;
@@ -281,42 +284,24 @@ static int8_t CDC_Receive_FS(uint8_t* Buf, uint32_t *Len)
      goto quit;
   }
 
-  uint8_t result = USBD_OK;
-  do
-  {
-      result = USBD_CDC_SetRxBuffer(&hUsbDeviceFS, &Buf[0]);
-  }
-  while(result != USBD_OK);
+  uint8_t msg = EM_FALSE;
+  uint32_t used = CDC_RxParse(Buf, *Len, &msg);
 
-  do
+  if (used < *Len) // previous message not processed yet, keep rest and do not re-arm
   {
-     result = USBD_CDC_ReceivePacket(&hUsbDeviceFS);
+      rx_held = Buf + used;
+      rx_held_len = *Len - used;
   }
-  while(result != USBD_OK);
+  else
+      CDC_RxArm();
 
-  if (comm.uart.available == EM_FALSE && comm.usb.available == EM_FALSE)
+  if (msg == EM_TRUE)
   {
-      while (len--)
-      {
-         comm.usb.rx_buffer[comm.usb.rx_index++] = *Buf;
-
-         if (comm.usb.rx_index >= RX_BUFF_LAST)
-             comm.usb.rx_index = 0;
-
-         comm.uart.last = EM_FALSE;
-         comm.usb.last = EM_TRUE;
-
-         if (*Buf == '\n' && comm.usb.rx_index > 1 && comm.usb.rx_buffer[comm.usb.rx_index - 2] == '\r')
-         {
-             comm.usb.available = EM_TRUE;
-             exit = -1;
-
-             portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
-             ASSERT(xSemaphoreGiveFromISR(sem1_comm, &xHigherPriorityTaskWoken) == pdPASS);
-             portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
-         }
-         Buf++;
-      }
+      exit = -1;
+
+      portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+      ASSERT(xSemaphoreGiveFromISR(sem1_comm, &xHigherPriorityTaskWoken) == pdPASS);
+      portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
   }
 
   ret = USBD_OK;
@@ -355,6 +340,106 @@ uint8_t CDC_Transmit_FS(uint8_t* Buf, uint16_t Len)
 
 /* USER CODE BEGIN PRIVATE_FUNCTIONS_IMPLEMENTATION */
 
+/* OUT endpoint ready for next packet */
+static void CDC_RxArm(void)
+{
+  uint8_t result = USBD_OK;
+  do
+  {
+      result = USBD_CDC_SetRxBuffer(&hUsbDeviceFS, UserRxBufferFS);
+  }
+  while(result != USBD_OK);
+
+  do
+  {
+     result = USBD_CDC_ReceivePacket(&hUsbDeviceFS);
+  }
+  while(result != USBD_OK);
+}
+
+/* copy bytes to comm.usb until message is complete, returns bytes used */
+static uint32_t CDC_RxParse(uint8_t* Buf, uint32_t Len, uint8_t* msg)
+{
+  uint32_t i = 0;
+  *msg = EM_FALSE;
+
+  if (comm.uart.available == EM_TRUE || comm.usb.available == EM_TRUE)
+      return 0;
+
+  while (i < Len)
+  {
+     comm.usb.rx_buffer[comm.usb.rx_index++] = Buf[i];
+
+     if (comm.usb.rx_index >= RX_BUFF_LAST)
+         comm.usb.rx_index = 0;
+
+     comm.uart.last = EM_FALSE;
+     comm.usb.last = EM_TRUE;
+
+     if (comm_eol_step(&comm.usb.eol, Buf[i++])) // \r\n, not inside of binary block
+     {
+         comm.usb.available = EM_TRUE;
+         *msg = EM_TRUE;
+         break;
+     }
+  }
+  return i;
+}
+
+/* comm task - message processed, parse held rest of packet */
+void CDC_RxResume_FS(void)
+{
+  if (rx_held_len == 0)
+      return;
+
+  uint8_t msg = EM_FALSE;
+
+  taskENTER_CRITICAL(); // USB IRQ is below max syscall priority
+  uint32_t used = CDC_RxParse(rx_held, rx_held_len, &msg);
+  rx_held += used;
+  rx_held_len -= used;
+
+  if (rx_held_len == 0)
+      CDC_RxArm();
+  taskEXIT_CRITICAL();
+
+  if (msg == EM_TRUE)
+      xSemaphoreGive(sem1_comm);
+}
+
+/* comm_fifo endpoint - one IN packet, copied to PMA before return */
+int CDC_TxPacket_FS(const uint8_t* Buf, uint16_t Len)
+{
+  return USBD_LL_Transmit(&hUsbDeviceFS, CDC_IN_EP, (uint8_t*)Buf, Len) == USBD_OK ? 0 : -1;
+}
+
+/* comm task - start sending of TX FIFO if idle */
+uint8_t CDC_TxKick_FS(void)
+{
+  if (hUsbDeviceFS.dev_state != USBD_STATE_CONFIGURED)
+      return USBD_FAIL;
+
+  taskENTER_CRITICAL();
+  uint8_t ok = comm_fifo_kick(&comm.usb_tx);
+  taskEXIT_CRITICAL();
+
+  return ok == EM_TRUE ? USBD_OK : USBD_FAIL;
+}
+
+/* USB ISR - IN transfer complete, send next packet of TX FIFO */
+void CDC_TxCplt_FS(uint8_t epnum)
+{
+  if ((epnum | 0x80) != CDC_IN_EP)
+      return;
+
+  if (comm_fifo_tx_done(&comm.usb_tx) == EM_TRUE)
+  {
+      portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+      xSemaphoreGiveFromISR(sem4_usb, &xHigherPriorityTaskWoken);
+      portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+  }
+}
+
 /* USER CODE END PRIVATE_FUNCTIONS_IMPLEMENTATION */
 
 /**
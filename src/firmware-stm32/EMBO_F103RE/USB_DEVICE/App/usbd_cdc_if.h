@@ -72,6 +72,10 @@
 #include "semphr.h"
 
 uint8_t CDC_Busy();
+void CDC_RxResume_FS(void);
+int CDC_TxPacket_FS(const uint8_t* Buf, uint16_t Len);
+uint8_t CDC_TxKick_FS(void);
+void CDC_TxCplt_FS(uint8_t epnum);
 /* USER CODE END EXPORTED_TYPES */
 
 /**
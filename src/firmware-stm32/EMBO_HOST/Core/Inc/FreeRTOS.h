@@ -0,0 +1,77 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef INC_FREERTOS_H
+#define INC_FREERTOS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Host replacement of FreeRTOS API used by the application (rtos_posix.c).
+ * Every task is a pthread, blocking calls and delays use wall clock time, so
+ * task priorities are not enforced - same as FreeRTOS POSIX port on SMP host.
+ */
+
+#define tskKERNEL_VERSION_NUMBER    "V10.4.3-posix"
+
+typedef long                BaseType_t;
+typedef unsigned long       UBaseType_t;
+typedef uint32_t            TickType_t;
+typedef uint32_t            StackType_t;
+
+#define portBASE_TYPE       long
+#define portMAX_DELAY       ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS  ((TickType_t)1)
+#define configTICK_RATE_HZ  ((TickType_t)1000)
+
+#define pdFALSE             ((BaseType_t)0)
+#define pdTRUE              ((BaseType_t)1)
+#define pdPASS              (pdTRUE)
+#define pdFAIL              (pdFALSE)
+#define pdMS_TO_TICKS(x)    ((TickType_t)(x))
+
+/* ISR is already running in its own thread, woken task does not need to be switched to */
+#define portEND_SWITCHING_ISR(x)    (void)(x)
+#define portYIELD_FROM_ISR(x)       (void)(x)
+
+#define traceISR_ENTER()
+#define traceISR_EXIT()
+
+typedef void (*TaskFunction_t)(void*);
+
+typedef struct
+{
+    pthread_t thread;
+    TaskFunction_t func;
+    void* param;
+    const char* name;
+    UBaseType_t prio;
+    StackType_t* stack;
+    uint32_t stack_depth;
+} StaticTask_t;
+
+typedef struct
+{
+    pthread_mutex_t mtx;
+    pthread_cond_t cond;
+    UBaseType_t count;
+    UBaseType_t max;
+} StaticSemaphore_t;
+
+/* port handlers called from irq.c */
+void xPortSysTickHandler(void);
+void vPortSVCHandler(void);
+void xPortPendSVHandler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_FREERTOS_H */
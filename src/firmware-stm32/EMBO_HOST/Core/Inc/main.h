@@ -0,0 +1,23 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef __MAIN_H
+#define __MAIN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* host equivalent of CubeMX main.h - register model and LL drivers */
+#include "stm32_host.h"
+#include "stm32_host_ll.h"
+
+void Error_Handler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MAIN_H */
@@ -0,0 +1,29 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef INC_PTY_H_
+#define INC_PTY_H_
+
+#include <stdint.h>
+
+/* master side of pseudo-terminal, slave side is opened by EMBO like real tty */
+
+typedef struct
+{
+    int master;
+    int slave;              // kept open, so master does not get EIO while EMBO is not connected
+    char path[64];
+    char link[256];
+    uint64_t tx_bytes;
+    uint64_t rx_bytes;
+    uint64_t tx_dropped;
+} pty_t;
+
+int pty_open(pty_t* self, const char* symlink_path);
+void pty_close(pty_t* self);
+int pty_read(pty_t* self, uint8_t* data, int len);       // non-blocking, 0 if nothing received
+void pty_write(pty_t* self, const uint8_t* data, int len);
+
+#endif /* INC_PTY_H_ */
@@ -0,0 +1,35 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef INC_SIM_H_
+#define INC_SIM_H_
+
+#include "pty.h"
+
+#include <stdint.h>
+
+/* Real-time peripheral simulator - one thread advances DAQ timer, ADC sequencer,
+ * DMA channels, EXTI lines, counter timer, SysTick and USART, and runs interrupt
+ * handlers of the application the same way NVIC would.
+ */
+
+typedef struct
+{
+    const char* adc_file;   // rows of CH1..CH4 voltages, one row per DAQ timer event, looped
+    const char* la_file;    // rows of CH1..CH4 bit mask, one row per DAQ timer event, looped
+    double sig_freq;        // base frequency of synthetic signals (Hz)
+    double noise;           // synthetic noise (V rms)
+    double cntr_freq;       // counter input if PWM1 is not running (Hz), 0 = no signal
+    uint32_t baud;          // emulated UART speed, 0 = unlimited
+    uint32_t seed;
+    int stats;              // print simulator stats every second to stderr
+    double cntr_duty;       // counter input duty cycle if PWM1 is not running (%)
+    double cntr_jitter;     // counter input edge jitter (s rms)
+} sim_cfg_t;
+
+int sim_init(const sim_cfg_t* cfg, pty_t* pty);
+int sim_start(void);
+
+#endif /* INC_SIM_H_ */
@@ -0,0 +1,240 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef STM32_HOST_H
+#define STM32_HOST_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Register model of F103C8 peripherals used by the application. Registers which
+ * the application touches directly keep their real names, the rest is decoded
+ * state written by LL functions (stm32_host_ll.h) and advanced by simulator (sim.c).
+ * Peripheral addresses are passed to DMA as uint32_t, so the binary must be linked
+ * without PIE to keep all globals below 4 GB.
+ */
+
+#define __IO    volatile
+#define __I     volatile const
+
+/* interrupt numbers same as F103 */
+typedef enum
+{
+    SysTick_IRQn        = -1,
+    EXTI0_IRQn          = 6,
+    EXTI1_IRQn          = 7,
+    EXTI2_IRQn          = 8,
+    EXTI3_IRQn          = 9,
+    EXTI4_IRQn          = 10,
+    DMA1_Channel1_IRQn  = 11,   // channels 1 - 7 follow
+    DMA1_Channel2_IRQn  = 12,
+    ADC1_2_IRQn         = 18,
+    TIM1_UP_IRQn        = 25,
+    USART1_IRQn         = 37,
+} IRQn_Type;
+
+#define SIM_IRQ_CNT     64
+
+typedef enum { RESET = 0, SET = !RESET } FlagStatus, ITStatus;
+typedef enum { DISABLE = 0, ENABLE = !DISABLE } FunctionalState;
+typedef enum { SUCCESS = 0, ERROR = !SUCCESS } ErrorStatus;
+
+/* ADC ---------------------------------------------------------------------------------------------------- */
+
+typedef struct
+{
+    __IO uint32_t SR;           // status - AWD, EOS
+    __IO uint32_t CR2;          // control - TSVREFE
+    __IO uint32_t HTR;          // watchdog high threshold
+    __IO uint32_t LTR;          // watchdog low threshold
+    __IO uint32_t DR;           // regular data
+    __IO uint32_t enabled;
+    __IO uint32_t awd_ch;       // watchdog monitored channel (LL_ADC_AWD_CHANNEL_x_REG), 0 = disabled
+    __IO uint32_t seq_len;      // sequencer ranks
+    __IO uint32_t seq[16];      // channel of each rank
+    __IO uint32_t smpl[18];     // sampling time of each channel
+    __IO uint32_t res;          // resolution
+    __IO uint32_t dma;          // DMA transfer mode
+    __IO uint32_t trig_src;     // regular trigger source
+    __IO uint32_t ext_trig;     // conversions started by external trigger
+} ADC_TypeDef;
+
+#define ADC_SR_AWD              (1UL << 0)
+#define ADC_SR_EOS              (1UL << 1)
+#define ADC_CR2_TSVREFE         (1UL << 23)
+
+/* DMA ---------------------------------------------------------------------------------------------------- */
+
+typedef struct
+{
+    __IO uint32_t CCR;          // config - EN, DIR, CIRC, PSIZE, MSIZE
+    __IO uint32_t CNDTR;        // remaining transfers
+    __IO uint32_t CPAR;         // peripheral address
+    __IO uint32_t CMAR;         // memory address
+    __IO uint32_t len;          // programmed length, reloaded in circular mode
+} DMA_Channel_TypeDef;
+
+typedef struct
+{
+    DMA_Channel_TypeDef CH[8];  // indexed by LL_DMA_CHANNEL_x (1 - 7)
+    __IO uint32_t ISR;          // TC flags, 4 bits per channel
+} DMA_TypeDef;
+
+#define DMA_CCR_EN              (1UL << 0)
+#define DMA_CCR_TCIE            (1UL << 1)
+#define DMA_CCR_DIR             (1UL << 4)
+#define DMA_CCR_CIRC            (1UL << 5)
+#define DMA_CCR_PSIZE_Pos       8
+#define DMA_CCR_PSIZE           (3UL << DMA_CCR_PSIZE_Pos)
+#define DMA_CCR_MSIZE_Pos       10
+#define DMA_CCR_MSIZE           (3UL << DMA_CCR_MSIZE_Pos)
+#define DMA_ISR_TCIF(ch)        (1UL << (4 * ((ch) - 1) + 1))
+
+/* TIM ---------------------------------------------------------------------------------------------------- */
+
+typedef struct
+{
+    __IO uint32_t CR1;          // CEN
+    __IO uint32_t DIER;         // UIE, CCxDE
+    __IO uint32_t SR;           // UIF
+    __IO uint32_t CCER;         // CCxE
+    __IO uint32_t CNT;
+    __IO uint32_t PSC;
+    __IO uint32_t ARR;
+    __IO uint32_t CCR1;
+    __IO uint32_t CCR2;
+    __IO uint32_t CCR3;
+    __IO uint32_t CCR4;
+    __IO uint32_t ICPSC[4];     // input capture prescaler of each channel
+    __IO uint32_t ICPOL[4];     // input capture polarity of each channel
+} TIM_TypeDef;
+
+#define TIM_CR1_CEN             (1UL << 0)
+#define TIM_DIER_UIE            (1UL << 0)
+#define TIM_DIER_CC1DE          (1UL << 9)
+#define TIM_DIER_CC2DE          (1UL << 10)
+#define TIM_SR_UIF              (1UL << 0)
+
+/* GPIO, EXTI --------------------------------------------------------------------------------------------- */
+
+typedef struct
+{
+    __IO uint32_t IDR;
+    __IO uint32_t ODR;
+    __IO uint32_t BSRR;
+    __IO uint32_t BRR;
+} GPIO_TypeDef;
+
+typedef struct
+{
+    __IO uint32_t IMR;
+    __IO uint32_t RTSR;
+    __IO uint32_t FTSR;
+    __IO uint32_t PR;
+} EXTI_TypeDef;
+
+/* USART, IWDG, SysTick ----------------------------------------------------------------------------------- */
+
+typedef struct
+{
+    __IO uint32_t SR;           // RXNE, TXE
+    __IO uint32_t DR;
+    __IO uint32_t BRR;          // stored only, pseudo-terminal has no baud rate
+    __IO uint32_t CR1;          // RXNEIE, UE
+} USART_TypeDef;
+
+#define USART_SR_RXNE           (1UL << 5)
+#define USART_SR_TXE            (1UL << 7)
+#define USART_CR1_RXNEIE        (1UL << 5)
+#define USART_CR1_UE            (1UL << 13)
+
+typedef struct
+{
+    __IO uint32_t KR;
+} IWDG_TypeDef;
+
+typedef struct
+{
+    __IO uint32_t CTRL;
+    __IO uint32_t LOAD;
+    __IO uint32_t VAL;
+} SysTick_Type;
+
+#define SysTick_CTRL_ENABLE_Msk     (1UL << 0)
+#define SysTick_CTRL_TICKINT_Msk    (1UL << 1)
+
+/* NVIC --------------------------------------------------------------------------------------------------- */
+
+typedef struct
+{
+    __IO uint8_t en[SIM_IRQ_CNT];
+    __IO uint8_t pend[SIM_IRQ_CNT];
+    __IO uint8_t prio[SIM_IRQ_CNT];
+    __IO uint32_t grouping;
+} NVIC_Type;
+
+/* instances - defined in sim.c */
+
+extern ADC_TypeDef      sim_adc1;
+extern DMA_TypeDef      sim_dma1;
+extern TIM_TypeDef      sim_tim1, sim_tim2, sim_tim3, sim_tim4;
+extern GPIO_TypeDef     sim_gpioa, sim_gpiob, sim_gpioc;
+extern EXTI_TypeDef     sim_exti;
+extern USART_TypeDef    sim_usart1;
+extern IWDG_TypeDef     sim_iwdg;
+extern SysTick_Type     sim_systick;
+extern NVIC_Type        sim_nvic;
+
+#define ADC1            (&sim_adc1)
+#define DMA1            (&sim_dma1)
+#define TIM1            (&sim_tim1)
+#define TIM2            (&sim_tim2)
+#define TIM3            (&sim_tim3)
+#define TIM4            (&sim_tim4)
+#define GPIOA           (&sim_gpioa)
+#define GPIOB           (&sim_gpiob)
+#define GPIOC           (&sim_gpioc)
+#define EXTI            (&sim_exti)
+#define USART1          (&sim_usart1)
+#define IWDG            (&sim_iwdg)
+#define SysTick         (&sim_systick)
+#define NVIC            (&sim_nvic)
+
+extern uint32_t SystemCoreClock;
+
+/* core - interrupts are serialized by one lock, masking them blocks the simulator */
+
+void sim_irq_lock(void);
+void sim_irq_unlock(void);
+
+#define __disable_irq()     sim_irq_lock()
+#define __enable_irq()      sim_irq_unlock()
+
+/* USART transmit goes directly to pseudo-terminal */
+
+uint32_t sim_uart_txe(USART_TypeDef* uart);
+void sim_uart_tx(USART_TypeDef* uart, uint8_t val);
+
+/* vector table */
+
+void SysTick_Handler(void);
+void EXTI0_IRQHandler(void);
+void EXTI1_IRQHandler(void);
+void EXTI2_IRQHandler(void);
+void EXTI3_IRQHandler(void);
+void EXTI4_IRQHandler(void);
+void DMA1_Channel2_IRQHandler(void);
+void ADC1_2_IRQHandler(void);
+void TIM1_UP_IRQHandler(void);
+void USART1_IRQHandler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STM32_HOST_H */
@@ -0,0 +1,424 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef STM32_HOST_LL_H
+#define STM32_HOST_LL_H
+
+#include "stm32_host.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Subset of STM32F1 LL drivers and CMSIS core used by the application,
+ * implemented over register model of stm32_host.h. Names and signatures are
+ * the same as F1 LL, constants are simplified to plain indexes where the
+ * application does not combine them.
+ */
+
+/* CMSIS - NVIC, SysTick ---------------------------------------------------------------------------------- */
+
+#define NVIC_PRIORITYGROUP_4    0x00000003U
+
+static inline void NVIC_SetPriorityGrouping(uint32_t group)     { NVIC->grouping = group; }
+static inline uint32_t NVIC_GetPriorityGrouping(void)           { return NVIC->grouping; }
+
+static inline uint32_t NVIC_EncodePriority(uint32_t group, uint32_t preempt, uint32_t sub)
+{
+    (void)group; (void)sub;
+    return preempt;
+}
+
+static inline void NVIC_SetPriority(IRQn_Type irq, uint32_t prio)
+{
+    if (irq >= 0)
+        NVIC->prio[irq] = (uint8_t)prio;
+}
+
+static inline void NVIC_EnableIRQ(IRQn_Type irq)
+{
+    if (irq >= 0)
+        NVIC->en[irq] = 1;
+}
+
+static inline void NVIC_DisableIRQ(IRQn_Type irq)
+{
+    if (irq >= 0)
+        NVIC->en[irq] = 0;
+}
+
+static inline void NVIC_ClearPendingIRQ(IRQn_Type irq)
+{
+    if (irq >= 0)
+        NVIC->pend[irq] = 0;
+}
+
+static inline void NVIC_SetPendingIRQ(IRQn_Type irq)
+{
+    if (irq >= 0)
+        NVIC->pend[irq] = 1;
+}
+
+static inline void LL_Init1msTick(uint32_t hclk)
+{
+    SysTick->LOAD = (hclk / 1000) - 1;
+    SysTick->VAL = 0;
+    SysTick->CTRL |= SysTick_CTRL_ENABLE_Msk;
+}
+
+static inline void LL_SYSTICK_EnableIT(void)                    { SysTick->CTRL |= SysTick_CTRL_TICKINT_Msk; }
+static inline void LL_SYSTICK_DisableIT(void)                   { SysTick->CTRL &= ~SysTick_CTRL_TICKINT_Msk; }
+
+/* ADC ---------------------------------------------------------------------------------------------------- */
+
+#define LL_ADC_CHANNEL_0                    0
+#define LL_ADC_CHANNEL_1                    1
+#define LL_ADC_CHANNEL_2                    2
+#define LL_ADC_CHANNEL_3                    3
+#define LL_ADC_CHANNEL_4                    4
+#define LL_ADC_CHANNEL_5                    5
+#define LL_ADC_CHANNEL_6                    6
+#define LL_ADC_CHANNEL_7                    7
+#define LL_ADC_CHANNEL_8                    8
+#define LL_ADC_CHANNEL_9                    9
+#define LL_ADC_CHANNEL_VREFINT              17
+
+#define LL_ADC_REG_RANK_1                   1
+#define LL_ADC_REG_RANK_2                   2
+#define LL_ADC_REG_RANK_3                   3
+#define LL_ADC_REG_RANK_4                   4
+#define LL_ADC_REG_RANK_5                   5
+#define LL_ADC_REG_RANK_6                   6
+
+#define LL_ADC_REG_SEQ_SCAN_DISABLE         1
+#define LL_ADC_REG_SEQ_SCAN_ENABLE_2RANKS   2
+#define LL_ADC_REG_SEQ_SCAN_ENABLE_3RANKS   3
+#define LL_ADC_REG_SEQ_SCAN_ENABLE_4RANKS   4
+#define LL_ADC_REG_SEQ_SCAN_ENABLE_5RANKS   5
+#define LL_ADC_REG_SEQ_SCAN_ENABLE_6RANKS   6
+
+#define LL_ADC_SAMPLINGTIME_1CYCLE_5        0
+#define LL_ADC_SAMPLINGTIME_7CYCLES_5       1
+#define LL_ADC_SAMPLINGTIME_13CYCLES_5      2
+#define LL_ADC_SAMPLINGTIME_28CYCLES_5      3
+#define LL_ADC_SAMPLINGTIME_41CYCLES_5      4
+#define LL_ADC_SAMPLINGTIME_55CYCLES_5      5
+#define LL_ADC_SAMPLINGTIME_71CYCLES_5      6
+#define LL_ADC_SAMPLINGTIME_239CYCLES_5     7
+
+#define LL_ADC_RESOLUTION_12B               0
+#define LL_ADC_RESOLUTION_8B                2
+
+#define LL_ADC_AWD_DISABLE                  0
+#define LL_ADC_AWD_CHANNEL_1_REG            (0x100 | LL_ADC_CHANNEL_1)
+#define LL_ADC_AWD_CHANNEL_2_REG            (0x100 | LL_ADC_CHANNEL_2)
+#define LL_ADC_AWD_CHANNEL_3_REG            (0x100 | LL_ADC_CHANNEL_3)
+#define LL_ADC_AWD_CHANNEL_4_REG            (0x100 | LL_ADC_CHANNEL_4)
+#define LL_ADC_AWD_THRESHOLD_HIGH           0
+#define LL_ADC_AWD_THRESHOLD_LOW            1
+
+#define LL_ADC_REG_DMA_TRANSFER_NONE        0
+#define LL_ADC_REG_DMA_TRANSFER_UNLIMITED   1
+#define LL_ADC_REG_TRIG_SOFTWARE            0
+#define LL_ADC_REG_TRIG_EXT_TIM3_TRGO       1
+#define LL_ADC_REG_TRIG_EXT_RISING          1
+#define LL_ADC_DMA_REG_REGULAR_DATA         0
+#define LL_ADC_DELAY_ENABLE_CALIB_ADC_CYCLES 2
+
+/* thresholds are compared with 12-bit aligned data, same as F3 */
+#define __LL_ADC_ANALOGWD_SET_THRESHOLD_RESOLUTION(res, val) \
+    ((uint32_t)(val) << ((res) == LL_ADC_RESOLUTION_8B ? 4 : 0))
+
+static inline void LL_ADC_Enable(ADC_TypeDef* adc)              { adc->enabled = 1; }
+static inline void LL_ADC_Disable(ADC_TypeDef* adc)             { adc->enabled = 0; }
+static inline void LL_ADC_StartCalibration(ADC_TypeDef* adc)    { (void)adc; }
+static inline uint32_t LL_ADC_IsCalibrationOnGoing(ADC_TypeDef* adc) { (void)adc; return 0; }
+static inline void LL_ADC_SetResolution(ADC_TypeDef* adc, uint32_t res) { adc->res = res; }
+
+static inline void LL_ADC_SetChannelSamplingTime(ADC_TypeDef* adc, uint32_t ch, uint32_t smpl)
+{
+    adc->smpl[ch] = smpl;
+}
+
+static inline void LL_ADC_REG_SetSequencerLength(ADC_TypeDef* adc, uint32_t len)   { adc->seq_len = len; }
+
+static inline void LL_ADC_REG_SetSequencerRanks(ADC_TypeDef* adc, uint32_t rank, uint32_t ch)
+{
+    adc->seq[rank - 1] = ch;
+}
+
+static inline void LL_ADC_REG_SetDMATransfer(ADC_TypeDef* adc, uint32_t mode)      { adc->dma = mode; }
+static inline uint32_t LL_ADC_REG_GetDMATransfer(ADC_TypeDef* adc)                 { return adc->dma; }
+static inline void LL_ADC_REG_SetTriggerSource(ADC_TypeDef* adc, uint32_t src)     { adc->trig_src = src; }
+
+static inline void LL_ADC_REG_StartConversionExtTrig(ADC_TypeDef* adc, uint32_t edge)
+{
+    (void)edge;
+    adc->ext_trig = 1;
+}
+
+static inline void LL_ADC_REG_StopConversionExtTrig(ADC_TypeDef* adc)              { adc->ext_trig = 0; }
+static inline uint16_t LL_ADC_REG_ReadConversionData12(ADC_TypeDef* adc)           { return (uint16_t)adc->DR; }
+
+static inline void LL_ADC_SetAnalogWDMonitChannels(ADC_TypeDef* adc, uint32_t awd_ch)
+{
+    adc->awd_ch = awd_ch;
+}
+
+static inline void LL_ADC_SetAnalogWDThresholds(ADC_TypeDef* adc, uint32_t which, uint32_t val)
+{
+    if (which == LL_ADC_AWD_THRESHOLD_HIGH)
+        adc->HTR = val;
+    else
+        adc->LTR = val;
+}
+
+static inline uint32_t LL_ADC_IsActiveFlag_AWD1(ADC_TypeDef* adc)   { return (adc->SR & ADC_SR_AWD) ? 1 : 0; }
+static inline void LL_ADC_ClearFlag_AWD1(ADC_TypeDef* adc)          { adc->SR &= ~ADC_SR_AWD; }
+static inline uint32_t LL_ADC_IsActiveFlag_EOS(ADC_TypeDef* adc)    { return (adc->SR & ADC_SR_EOS) ? 1 : 0; }
+static inline void LL_ADC_ClearFlag_EOS(ADC_TypeDef* adc)           { adc->SR &= ~ADC_SR_EOS; }
+
+static inline uint32_t LL_ADC_DMA_GetRegAddr(ADC_TypeDef* adc, uint32_t reg)
+{
+    (void)reg;
+    return (uint32_t)(uintptr_t)&adc->DR;
+}
+
+/* DMA ---------------------------------------------------------------------------------------------------- */
+
+#define LL_DMA_CHANNEL_1                    1
+#define LL_DMA_CHANNEL_2                    2
+#define LL_DMA_CHANNEL_3                    3
+#define LL_DMA_CHANNEL_4                    4
+#define LL_DMA_CHANNEL_5                    5
+#define LL_DMA_CHANNEL_6                    6
+#define LL_DMA_CHANNEL_7                    7
+
+#define LL_DMA_DIRECTION_PERIPH_TO_MEMORY   0
+#define LL_DMA_DIRECTION_MEMORY_TO_PERIPH   DMA_CCR_DIR
+#define LL_DMA_MODE_NORMAL                  0
+#define LL_DMA_MODE_CIRCULAR                DMA_CCR_CIRC
+#define LL_DMA_PDATAALIGN_BYTE              (0UL << DMA_CCR_PSIZE_Pos)
+#define LL_DMA_PDATAALIGN_HALFWORD          (1UL << DMA_CCR_PSIZE_Pos)
+#define LL_DMA_PDATAALIGN_WORD              (2UL << DMA_CCR_PSIZE_Pos)
+#define LL_DMA_MDATAALIGN_BYTE              (0UL << DMA_CCR_MSIZE_Pos)
+#define LL_DMA_MDATAALIGN_HALFWORD          (1UL << DMA_CCR_MSIZE_Pos)
+#define LL_DMA_MDATAALIGN_WORD              (2UL << DMA_CCR_MSIZE_Pos)
+
+static inline void LL_DMA_EnableChannel(DMA_TypeDef* dma, uint32_t ch)     { dma->CH[ch].CCR |= DMA_CCR_EN; }
+static inline void LL_DMA_DisableChannel(DMA_TypeDef* dma, uint32_t ch)    { dma->CH[ch].CCR &= ~DMA_CCR_EN; }
+static inline uint32_t LL_DMA_IsEnabledChannel(DMA_TypeDef* dma, uint32_t ch) { return (dma->CH[ch].CCR & DMA_CCR_EN) != 0; }
+
+static inline void LL_DMA_SetMode(DMA_TypeDef* dma, uint32_t ch, uint32_t mode)
+{
+    dma->CH[ch].CCR = (dma->CH[ch].CCR & ~DMA_CCR_CIRC) | mode;
+}
+
+static inline void LL_DMA_ConfigAddresses(DMA_TypeDef* dma, uint32_t ch, uint32_t src, uint32_t dst, uint32_t dir)
+{
+    dma->CH[ch].CCR = (dma->CH[ch].CCR & ~DMA_CCR_DIR) | dir;
+
+    if (dir == LL_DMA_DIRECTION_MEMORY_TO_PERIPH)
+    {
+        dma->CH[ch].CMAR = src;
+        dma->CH[ch].CPAR = dst;
+    }
+    else
+    {
+        dma->CH[ch].CPAR = src;
+        dma->CH[ch].CMAR = dst;
+    }
+}
+
+static inline void LL_DMA_SetPeriphSize(DMA_TypeDef* dma, uint32_t ch, uint32_t sz)
+{
+    dma->CH[ch].CCR = (dma->CH[ch].CCR & ~DMA_CCR_PSIZE) | sz;
+}
+
+static inline void LL_DMA_SetMemorySize(DMA_TypeDef* dma, uint32_t ch, uint32_t sz)
+{
+    dma->CH[ch].CCR = (dma->CH[ch].CCR & ~DMA_CCR_MSIZE) | sz;
+}
+
+static inline void LL_DMA_SetDataLength(DMA_TypeDef* dma, uint32_t ch, uint32_t len)
+{
+    dma->CH[ch].len = len;
+    dma->CH[ch].CNDTR = len;
+}
+
+static inline uint32_t LL_DMA_GetDataLength(DMA_TypeDef* dma, uint32_t ch)  { return dma->CH[ch].CNDTR; }
+
+static inline void LL_DMA_EnableIT_TC(DMA_TypeDef* dma, uint32_t ch)       { dma->CH[ch].CCR |= DMA_CCR_TCIE; }
+static inline void LL_DMA_DisableIT_TC(DMA_TypeDef* dma, uint32_t ch)      { dma->CH[ch].CCR &= ~DMA_CCR_TCIE; }
+static inline void LL_DMA_EnableIT_HT(DMA_TypeDef* dma, uint32_t ch)       { (void)dma; (void)ch; }
+static inline void LL_DMA_EnableIT_TE(DMA_TypeDef* dma, uint32_t ch)       { (void)dma; (void)ch; }
+
+static inline uint32_t LL_DMA_IsActiveFlag_TC2(DMA_TypeDef* dma)           { return (dma->ISR & DMA_ISR_TCIF(2)) ? 1 : 0; }
+static inline void LL_DMA_ClearFlag_TC2(DMA_TypeDef* dma)                  { dma->ISR &= ~DMA_ISR_TCIF(2); }
+
+/* TIM ---------------------------------------------------------------------------------------------------- */
+
+#define LL_TIM_CHANNEL_CH1                  (1UL << 0)
+#define LL_TIM_CHANNEL_CH2                  (1UL << 4)
+#define LL_TIM_CHANNEL_CH3                  (1UL << 8)
+#define LL_TIM_CHANNEL_CH4                  (1UL << 12)
+
+#define LL_TIM_ICPSC_DIV1                   0
+#define LL_TIM_ICPSC_DIV2                   1
+#define LL_TIM_ICPSC_DIV4                   2
+#define LL_TIM_ICPSC_DIV8                   3
+
+static inline void LL_TIM_EnableCounter(TIM_TypeDef* tim)       { tim->CR1 |= TIM_CR1_CEN; }
+static inline void LL_TIM_DisableCounter(TIM_TypeDef* tim)      { tim->CR1 &= ~TIM_CR1_CEN; }
+static inline void LL_TIM_SetPrescaler(TIM_TypeDef* tim, uint32_t psc)     { tim->PSC = psc; }
+static inline void LL_TIM_SetAutoReload(TIM_TypeDef* tim, uint32_t arr)    { tim->ARR = arr; }
+static inline void LL_TIM_SetCounter(TIM_TypeDef* tim, uint32_t cnt)       { tim->CNT = cnt; }
+static inline uint32_t LL_TIM_GetCounter(TIM_TypeDef* tim)                 { return tim->CNT; }
+
+static inline void LL_TIM_CC_EnableChannel(TIM_TypeDef* tim, uint32_t ch)  { tim->CCER |= ch; }
+static inline void LL_TIM_CC_DisableChannel(TIM_TypeDef* tim, uint32_t ch) { tim->CCER &= ~ch; }
+
+#define LL_TIM_IC_POLARITY_RISING           0
+#define LL_TIM_IC_POLARITY_FALLING          1
+
+#define SIM_TIM_CH_IDX(ch)  ((ch) == LL_TIM_CHANNEL_CH1 ? 0 : ((ch) == LL_TIM_CHANNEL_CH2 ? 1 : ((ch) == LL_TIM_CHANNEL_CH3 ? 2 : 3)))
+
+static inline void LL_TIM_IC_SetPrescaler(TIM_TypeDef* tim, uint32_t ch, uint32_t psc)  { tim->ICPSC[SIM_TIM_CH_IDX(ch)] = psc; }
+static inline void LL_TIM_IC_SetPolarity(TIM_TypeDef* tim, uint32_t ch, uint32_t pol)   { tim->ICPOL[SIM_TIM_CH_IDX(ch)] = pol; }
+static inline void LL_TIM_GenerateEvent_UPDATE(TIM_TypeDef* tim)           { tim->CNT = 0; tim->SR |= TIM_SR_UIF; }
+
+static inline void LL_TIM_OC_SetCompareCH1(TIM_TypeDef* tim, uint32_t val)  { tim->CCR1 = val; }
+static inline void LL_TIM_OC_SetCompareCH2(TIM_TypeDef* tim, uint32_t val)  { tim->CCR2 = val; }
+static inline void LL_TIM_OC_SetCompareCH3(TIM_TypeDef* tim, uint32_t val)  { tim->CCR3 = val; }
+static inline void LL_TIM_OC_SetCompareCH4(TIM_TypeDef* tim, uint32_t val)  { tim->CCR4 = val; }
+
+static inline void LL_TIM_EnableDMAReq_CC1(TIM_TypeDef* tim)    { tim->DIER |= TIM_DIER_CC1DE; }
+static inline void LL_TIM_DisableDMAReq_CC1(TIM_TypeDef* tim)   { tim->DIER &= ~TIM_DIER_CC1DE; }
+static inline void LL_TIM_EnableDMAReq_CC2(TIM_TypeDef* tim)    { tim->DIER |= TIM_DIER_CC2DE; }
+static inline void LL_TIM_DisableDMAReq_CC2(TIM_TypeDef* tim)   { tim->DIER &= ~TIM_DIER_CC2DE; }
+static inline void LL_TIM_EnableIT_UPDATE(TIM_TypeDef* tim)     { tim->DIER |= TIM_DIER_UIE; }
+static inline void LL_TIM_DisableIT_UPDATE(TIM_TypeDef* tim)    { tim->DIER &= ~TIM_DIER_UIE; }
+static inline uint32_t LL_TIM_IsActiveFlag_UPDATE(TIM_TypeDef* tim)  { return (tim->SR & TIM_SR_UIF) ? 1 : 0; }
+static inline void LL_TIM_ClearFlag_UPDATE(TIM_TypeDef* tim)    { tim->SR &= ~TIM_SR_UIF; }
+
+/* GPIO, EXTI --------------------------------------------------------------------------------------------- */
+
+#define LL_GPIO_PIN_0                       (1UL << 0)
+#define LL_GPIO_PIN_1                       (1UL << 1)
+#define LL_GPIO_PIN_2                       (1UL << 2)
+#define LL_GPIO_PIN_3                       (1UL << 3)
+#define LL_GPIO_PIN_4                       (1UL << 4)
+#define LL_GPIO_PIN_5                       (1UL << 5)
+#define LL_GPIO_PIN_6                       (1UL << 6)
+#define LL_GPIO_PIN_7                       (1UL << 7)
+#define LL_GPIO_PIN_8                       (1UL << 8)
+
+#define LL_GPIO_MODE_ANALOG                 0
+#define LL_GPIO_MODE_FLOATING               1
+#define LL_GPIO_MODE_INPUT                  2
+#define LL_GPIO_MODE_OUTPUT                 3
+#define LL_GPIO_SPEED_FREQ_HIGH             3
+
+#define LL_GPIO_AF_EXTI_PORTA               0
+#define LL_GPIO_AF_EXTI_LINE0               0
+#define LL_GPIO_AF_EXTI_LINE1               1
+#define LL_GPIO_AF_EXTI_LINE2               2
+#define LL_GPIO_AF_EXTI_LINE3               3
+#define LL_GPIO_AF_EXTI_LINE4               4
+
+#define LL_EXTI_LINE_0                      (1UL << 0)
+#define LL_EXTI_LINE_1                      (1UL << 1)
+#define LL_EXTI_LINE_2                      (1UL << 2)
+#define LL_EXTI_LINE_3                      (1UL << 3)
+#define LL_EXTI_LINE_4                      (1UL << 4)
+
+#define LL_EXTI_MODE_IT                     0
+#define LL_EXTI_TRIGGER_RISING              1
+#define LL_EXTI_TRIGGER_FALLING             2
+#define LL_EXTI_TRIGGER_RISING_FALLING      3
+
+typedef struct
+{
+    uint32_t Pin;
+    uint32_t Mode;
+    uint32_t Speed;
+    uint32_t OutputType;
+    uint32_t Pull;
+} LL_GPIO_InitTypeDef;
+
+typedef struct
+{
+    uint32_t Line_0_31;
+    FunctionalState LineCommand;
+    uint8_t Mode;
+    uint8_t Trigger;
+} LL_EXTI_InitTypeDef;
+
+static inline ErrorStatus LL_GPIO_Init(GPIO_TypeDef* gpio, LL_GPIO_InitTypeDef* init)
+{
+    (void)gpio; (void)init;
+    return SUCCESS;
+}
+
+/* all EXTI lines are mapped to port A */
+static inline void LL_GPIO_AF_SetEXTISource(uint32_t port, uint32_t line)  { (void)port; (void)line; }
+
+static inline void LL_EXTI_EnableIT_0_31(uint32_t lines)        { EXTI->IMR |= lines; }
+static inline void LL_EXTI_DisableIT_0_31(uint32_t lines)       { EXTI->IMR &= ~lines; }
+static inline uint32_t LL_EXTI_IsActiveFlag_0_31(uint32_t lines){ return ((EXTI->PR & lines) == lines) ? 1 : 0; }
+static inline void LL_EXTI_ClearFlag_0_31(uint32_t lines)       { EXTI->PR &= ~lines; }
+
+static inline ErrorStatus LL_EXTI_Init(LL_EXTI_InitTypeDef* init)
+{
+    if (init->LineCommand != ENABLE)
+    {
+        EXTI->IMR &= ~init->Line_0_31;
+        return SUCCESS;
+    }
+
+    EXTI->IMR |= init->Line_0_31;
+
+    if (init->Trigger & LL_EXTI_TRIGGER_RISING)
+        EXTI->RTSR |= init->Line_0_31;
+    else
+        EXTI->RTSR &= ~init->Line_0_31;
+
+    if (init->Trigger & LL_EXTI_TRIGGER_FALLING)
+        EXTI->FTSR |= init->Line_0_31;
+    else
+        EXTI->FTSR &= ~init->Line_0_31;
+
+    return SUCCESS;
+}
+
+/* USART -------------------------------------------------------------------------------------------------- */
+
+static inline void LL_USART_EnableIT_RXNE(USART_TypeDef* uart)              { uart->CR1 |= USART_CR1_RXNEIE; }
+static inline uint32_t LL_USART_IsActiveFlag_RXNE(USART_TypeDef* uart)      { return (uart->SR & USART_SR_RXNE) ? 1 : 0; }
+static inline void LL_USART_ClearFlag_RXNE(USART_TypeDef* uart)             { uart->SR &= ~USART_SR_RXNE; }
+static inline uint32_t LL_USART_IsActiveFlag_TXE(USART_TypeDef* uart)       { return sim_uart_txe(uart); }
+static inline void LL_USART_TransmitData8(USART_TypeDef* uart, uint8_t val) { sim_uart_tx(uart, val); }
+static inline uint32_t LL_USART_IsActiveFlag_TC(USART_TypeDef* uart)        { (void)uart; return 1; } // tx is synchronous
+static inline void LL_USART_Enable(USART_TypeDef* uart)                     { uart->CR1 |= USART_CR1_UE; }
+static inline void LL_USART_Disable(USART_TypeDef* uart)                    { uart->CR1 &= ~USART_CR1_UE; }
+
+static inline void LL_USART_SetBaudRate(USART_TypeDef* uart, uint32_t clk, uint32_t baud)
+{
+    uart->BRR = (clk + (baud / 2)) / baud;
+}
+
+static inline uint8_t LL_USART_ReceiveData8(USART_TypeDef* uart)
+{
+    uart->SR &= ~USART_SR_RXNE;
+    return (uint8_t)uart->DR;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STM32_HOST_LL_H */
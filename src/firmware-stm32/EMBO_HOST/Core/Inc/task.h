@@ -0,0 +1,40 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef INC_TASK_H
+#define INC_TASK_H
+
+#include "FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define taskSCHEDULER_SUSPENDED     ((BaseType_t)0)
+#define taskSCHEDULER_NOT_STARTED   ((BaseType_t)1)
+#define taskSCHEDULER_RUNNING       ((BaseType_t)2)
+
+typedef StaticTask_t* TaskHandle_t;
+
+void sim_irq_lock(void);
+void sim_irq_unlock(void);
+
+#define taskENTER_CRITICAL()        sim_irq_lock()      // simulated IRQs are held off
+#define taskEXIT_CRITICAL()         sim_irq_unlock()
+
+TaskHandle_t xTaskCreateStatic(TaskFunction_t func, const char* const name, const uint32_t stack_depth,
+                               void* const param, UBaseType_t prio, StackType_t* const stack, StaticTask_t* const buff);
+void vTaskStartScheduler(void);
+void vTaskEndScheduler(void);
+void vTaskDelay(const TickType_t ticks);
+BaseType_t xTaskGetSchedulerState(void);
+TickType_t xTaskGetTickCount(void);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_TASK_H */
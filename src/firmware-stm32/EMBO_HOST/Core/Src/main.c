@@ -0,0 +1,687 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "cfg.h"
+#include "main.h"
+#include "app.h"
+#include "sim.h"
+#include "pty.h"
+#include "comm.h"
+#include "comm_fifo.h"
+#include "daq_trig.h"
+#include "trig_qual.h"
+#include "dds.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <getopt.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+
+static pty_t s_pty;
+
+static void MX_DMA_Init(void);
+static void MX_ADC1_Init(void);
+static void MX_TIM_Init(void);
+
+static int bench_scpi(long rounds);
+static int bench_trig(long rounds);
+static int bench_dds(long rounds);
+static int bench_post(long rounds);
+static int bench_usb(long rounds);
+
+static void on_signal(int sig)
+{
+    (void)sig;
+    vTaskEndScheduler();
+}
+
+static void on_exit_cleanup(void)
+{
+    pty_close(&s_pty);
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "EMBO firmware running on host against simulated peripherals, UART on pseudo-terminal.\n\n"
+            "  --link PATH      create symlink PATH to pty (e.g. /tmp/ttyEMBO)\n"
+            "  --adc FILE       replay ADC inputs, row of CH1..CH4 volts per DAQ timer event\n"
+            "  --la FILE        replay LA inputs, row of CH1..CH4 bit mask per DAQ timer event\n"
+            "  --freq HZ        base frequency of synthetic signals (default 1000)\n"
+            "  --noise V        synthetic noise rms (default 0.005)\n"
+            "  --cntr HZ        counter input if PWM1 is off, 0 = no signal (default 10000)\n"
+            "  --duty PCT       counter input duty cycle if PWM1 is off (default 50)\n"
+            "  --jitter S       counter input edge jitter rms (default 0)\n"
+            "  --baud N         emulate UART speed, bytes/s = baud / 10 (default unlimited)\n"
+            "  --seed N         noise random seed (default 1)\n"
+            "  --stats          print simulator stats every second to stderr\n"
+            "  --bench N        time SCPI header lookup (linear vs dispatch table), trigger qualifier and DDS N rounds,\n"
+            "                   check DDS against reference, posttrigger counting against fake DMA\n"
+            "                   and USB TX FIFO framing against fake endpoint, exit\n"
+            "  --help           this help\n", name);
+}
+
+int main(int argc, char* argv[])
+{
+    static const struct option opts[] =
+    {
+        { "link",       required_argument, NULL, 'l' },
+        { "adc",        required_argument, NULL, 'a' },
+        { "la",         required_argument, NULL, 'g' },
+        { "freq",       required_argument, NULL, 'f' },
+        { "noise",      required_argument, NULL, 'n' },
+        { "cntr",       required_argument, NULL, 'c' },
+        { "duty",       required_argument, NULL, 'd' },
+        { "jitter",     required_argument, NULL, 'j' },
+        { "baud",       required_argument, NULL, 'b' },
+        { "seed",       required_argument, NULL, 's' },
+        { "stats",      no_argument,       NULL, 'S' },
+        { "bench",      required_argument, NULL, 'B' },
+        { "help",       no_argument,       NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+
+    sim_cfg_t cfg = { NULL, NULL, 1000, 0.005, 10000, 0, 1, 0, 50, 0 };
+    const char* link_path = NULL;
+    int opt;
+
+    while ((opt = getopt_long(argc, argv, "h", opts, NULL)) != -1)
+    {
+        switch (opt)
+        {
+        case 'l': link_path = optarg; break;
+        case 'a': cfg.adc_file = optarg; break;
+        case 'g': cfg.la_file = optarg; break;
+        case 'f': cfg.sig_freq = atof(optarg); break;
+        case 'n': cfg.noise = atof(optarg); break;
+        case 'c': cfg.cntr_freq = atof(optarg); break;
+        case 'd': cfg.cntr_duty = atof(optarg); break;
+        case 'j': cfg.cntr_jitter = atof(optarg); break;
+        case 'b': cfg.baud = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 's': cfg.seed = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 'S': cfg.stats = 1; break;
+        case 'B': return bench_scpi(strtol(optarg, NULL, 10)) || bench_trig(strtol(optarg, NULL, 10)) ||
+                         bench_dds(strtol(optarg, NULL, 10)) || bench_post(strtol(optarg, NULL, 10)) ||
+                         bench_usb(strtol(optarg, NULL, 10));
+        default:  usage(argv[0]); return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    if (pty_open(&s_pty, link_path) != 0 || sim_init(&cfg, &s_pty) != 0)
+        return 1;
+
+    atexit(on_exit_cleanup);
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    printf("%s\n", s_pty.path);
+    fflush(stdout);
+
+    /* same order as CubeMX generated main of F103C8 */
+    MX_DMA_Init();
+    MX_ADC1_Init();
+    MX_TIM_Init();
+
+    if (sim_start() != 0)
+    {
+        fprintf(stderr, "simulator start failed\n");
+        return 1;
+    }
+
+    app_main();
+
+    return 0;
+}
+
+/* parser micro-benchmark - what findCommandHeader does per command of line */
+static int64_t bench_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int bench_scpi(long rounds)
+{
+    static const char* headers[] =
+    {
+        "*IDN?", ":SYS:MODE?", ":SYS:LIM?", ":SYS:INFO?", ":VM:READ?", ":SCOP:READ?", ":SCOP:SET?",
+        ":LA:READ?", ":LA:SET?", ":CNTR:READ?", ":SGEN:SET?", ":PWM:SET?", ":SYSTEM:UPTIME?", ":SCOPE:FORCETRIG",
+    };
+    int n = sizeof(headers) / sizeof(headers[0]);
+    int lens[sizeof(headers) / sizeof(headers[0])];
+    volatile int32_t sink = 0;
+
+    for (int h = 0; h < n; h++)
+        lens[h] = strlen(headers[h]);
+
+    int64_t t0 = bench_ns();
+
+    for (long r = 0; r < rounds; r++)
+    {
+        for (int h = 0; h < n; h++)
+        {
+            for (int32_t i = 0; scpi_commands[i].pattern != NULL; i++)
+            {
+                if (SCPI_Match(scpi_commands[i].pattern, headers[h], lens[h]))
+                {
+                    sink += i;
+                    break;
+                }
+            }
+        }
+    }
+
+    int64_t t1 = bench_ns();
+
+    for (long r = 0; r < rounds; r++)
+    {
+        for (int h = 0; h < n; h++)
+        {
+            int32_t i = comm_cmd_index(headers[h], lens[h]);
+
+            if (i < 0 || !SCPI_Match(scpi_commands[i].pattern, headers[h], lens[h]))
+            {
+                fprintf(stderr, "bench: %s not in dispatch table, run scripts/scpi_hash.py\n", headers[h]);
+                return 1;
+            }
+            sink += i;
+        }
+    }
+
+    int64_t t2 = bench_ns();
+    double cnt = (double)rounds * n;
+
+    printf("SCPI header lookup, %d headers x %ld rounds\n", n, rounds);
+    printf("  linear:   %8.1f ns\n", (t1 - t0) / cnt);
+    printf("  dispatch: %8.1f ns\n", (t2 - t1) / cnt);
+    return 0;
+}
+
+static int bench_trig(long rounds)
+{
+    /* noisy 12-bit sine, 100 samples per period, trigger level in the middle */
+    static const int widths[] = { 0, 16, 64, EM_TRIG_WIDTH_MAX };
+    static uint16_t buff[1000];
+    int len = sizeof(buff) / sizeof(buff[0]);
+    volatile int sink = 0;
+    trig_qual_t q;
+
+    srand(1);
+    for (int i = 0; i < len; i++)
+        buff[i] = (uint16_t)(2048 + 1500 * sin(2 * M_PI * i / 100.0) + (rand() % 241) - 120);
+
+    printf("Trigger qualifier, run over window per AWD hit x %ld rounds\n", rounds);
+
+    for (size_t w = 0; w < sizeof(widths) / sizeof(widths[0]); w++)
+    {
+        int cnt = widths[w] + EM_TRIG_QUAL_LOOK + 1;
+        trig_qual_init(&q, 2048, 0, widths[w], 1, 4095);
+
+        int64_t t0 = bench_ns();
+
+        for (long r = 0; r < rounds; r++)
+        {
+            trig_qual_reset(&q, TQ_ARMED);
+            sink += trig_qual_run(&q, buff, 0, (int)(r % len), cnt, 1, len);
+        }
+
+        printf("  width %3d: %8.1f ns\n", widths[w], (double)(bench_ns() - t0) / rounds);
+    }
+
+    /* edges of stream after half period warm-up - without hysteresis noise around level makes many */
+    long errs = 0;
+    int edges_hyst = 0;
+
+    for (int hyst = 0; hyst <= 200; hyst += 200)
+    {
+        int edges = 0;
+        trig_qual_init(&q, 2048, hyst, 0, 1, 4095);
+
+        for (int i = 0; i < len * 10 + 50; i++)
+            if (trig_qual_step(&q, buff[i % len]) && i >= 50)
+                edges++;
+
+        printf("  hysteresis %3d: %5.2f edges per period\n", hyst, edges / 100.0);
+        edges_hyst = edges;
+    }
+
+    if (edges_hyst != 100)
+        errs++;
+
+    /* low pulse before rising edge - narrower than width rejected, width and wider accepted */
+    for (int k = 1; k <= 2 * widths[1]; k++)
+    {
+        int edges = 0;
+        trig_qual_init(&q, 2048, 0, widths[1], 1, 4095);
+
+        for (int i = 0; i < 10; i++)
+            edges += trig_qual_step(&q, 4000);
+        for (int i = 0; i < k; i++)
+            edges += trig_qual_step(&q, 100);
+        for (int i = 0; i < 10; i++)
+            edges += trig_qual_step(&q, 4000);
+
+        if (edges != (k >= widths[1]))
+            errs++;
+    }
+
+    /* holdoff 250 ticks of 1 sample, edges every 100 - every third taken, tick wraps meanwhile */
+    {
+        int taken = 0;
+        uint32_t tick = 0xFFFFFFFFu - 5000, last = tick - 250;
+        trig_qual_init(&q, 2048, 200, 0, 1, 4095);
+
+        for (int i = 0; i < len * 10 + 50; i++, tick++)
+        {
+            if (trig_qual_step(&q, buff[i % len]) && i >= 50 && trig_qual_holdoff(tick, last, 250))
+            {
+                last = tick;
+                taken++;
+            }
+        }
+
+        printf("  holdoff 250: %d of 100 edges taken\n", taken);
+
+        if (taken != 34)
+            errs++;
+    }
+
+    printf("  hysteresis, width and holdoff errors: %ld\n", errs);
+
+    if (errs > 0)
+    {
+        fprintf(stderr, "bench: trigger qualifier failed\n");
+        return 1;
+    }
+    return 0;
+}
+
+/* DDS sine and triangle vs double reference, settings changed mid stream must keep phase */
+static int bench_dds(long rounds)
+{
+    static const double freqs[] = { 1, 1000.001, 12345.678, 20000 };
+    const double fs = 200000;
+    const int len = 500, max = 4095;
+    static uint32_t buff[500];
+    double err_max = 0, f_err_max = 0;
+    dds_t dds;
+
+    dds_init(&dds);
+
+    for (int wave = DDS_SINE; wave <= DDS_TRIANGLE; wave++)
+    {
+        uint64_t ph = 0; // reference phase, 2^32 = 1 period
+
+        dds_set(&dds, wave, dds_step(freqs[0], fs), max, 0, max);
+        dds_reset(&dds);
+
+        for (size_t f = 0; f < sizeof(freqs) / sizeof(freqs[0]); f++)
+        {
+            uint32_t step = dds_step(freqs[f], fs);
+            f_err_max = fmax(f_err_max, fabs(dds_freq(step, fs) - freqs[f]));
+
+            if (f > 0)
+                dds_set(&dds, wave, step, max, 0, max); // taken at next fill
+
+            for (int blk = 0; blk < 8; blk++)
+            {
+                dds_fill(&dds, buff, len);
+
+                for (int i = 0; i < len; i++, ph += step)
+                {
+                    double x = (double)(ph & 0xFFFFFFFFu) / 4294967296.0;
+                    double ref = (wave == DDS_SINE ? (sin(2 * M_PI * x) + 1) / 2 : 1 - fabs(2 * x - 1)) * max;
+                    err_max = fmax(err_max, fabs(buff[i] - ref));
+                }
+            }
+        }
+    }
+
+    printf("DDS fs %.0f Hz, %d samples per half buffer x %ld rounds\n", fs, len, rounds);
+    printf("  resolution: %.3f uHz, max freq error %.3f uHz\n", fs / 4294967296.0 * 1e6, f_err_max * 1e6);
+    printf("  max error vs reference: %.3f LSB\n", err_max);
+
+    for (int wave = DDS_SINE; wave <= DDS_NOISE; wave++)
+    {
+        dds_set(&dds, wave, dds_step(12345.678, fs), max, 0, max);
+        dds_reset(&dds);
+
+        int64_t t0 = bench_ns();
+
+        for (long r = 0; r < rounds / len + 1; r++)
+            dds_fill(&dds, buff, len);
+
+        printf("  wave %d: %6.2f ns per sample\n", wave, (double)(bench_ns() - t0) / ((rounds / len + 1) * len));
+    }
+
+    if (err_max > 1.0 || f_err_max > fs / 4294967296.0)
+    {
+        fprintf(stderr, "bench: DDS out of tolerance\n");
+        return 1;
+    }
+    return 0;
+}
+
+/* posttrigger positions and counting against fake circular DMA, t3 may oversleep by one tick */
+static int bench_post(long rounds)
+{
+    static const int pretrigs[] = { 0, 1, 50, 99, 100 };
+    static const double f_events[] = { 10, 1000, 100000, 1000000 };
+    const int mem = 1000;
+    long errs = 0, sleeps = 0, polls = 0;
+
+    /* window of mem samples around trigger, all positions inside buffer, also for trigger at len-1 */
+    for (int chans = 1; chans <= 4; chans++)
+    {
+        for (int la = 0; la <= (chans == 1); la++)
+        {
+            int len = (mem + EM_MEM_RESERVE) * chans;
+            int span = la ? mem - 1 : (mem + 1) * chans - 1;
+
+            for (size_t p = 0; p < sizeof(pretrigs) / sizeof(pretrigs[0]); p++)
+            {
+                for (int from = 0; from < len; from++)
+                {
+                    for (int order = 0; order < (la ? 1 : chans); order++)
+                    {
+                        int trig, frst, last, post;
+                        daq_trig_post_pos(from, order, la ? 1 : chans, len, mem, pretrigs[p], la, &trig, &frst, &last, &post);
+
+                        int post_want = (int)((double)mem * (100 - pretrigs[p]) / 100.0) * (la ? 1 : chans);
+
+                        if (trig < 0 || trig >= len || frst < 0 || frst >= len || last < 0 || last >= len)
+                            errs++;
+                        else if (trig != (from + order) % len || post != post_want ||
+                                 (last - trig + len) % len != post || (last - frst + len) % len != span)
+                            errs++;
+                    }
+                }
+            }
+        }
+    }
+
+    /* DMA data length counts down and reloads, every check sees less than one wrap */
+    if (daq_trig_post_moved(5, 5, 100) != 0 || daq_trig_post_moved(5, 2, 100) != 3 ||
+        daq_trig_post_moved(1, 100, 100) != 1 || daq_trig_post_moved(3, 98, 100) != 5)
+        errs++;
+
+    /* sleep is never shorter than poll limit */
+    for (int left = 1; left <= 100000; left++)
+    {
+        int ms = daq_trig_post_ms(left, 1, 1000);
+        if ((ms > 0 && ms < EM_TRIG_POST_POLL_MS) || (ms == 0) != (left / 2 < EM_TRIG_POST_POLL_MS))
+            errs++;
+    }
+
+    /* whole count at DAQ rates, DMA of len samples, post up to len */
+    srand(1);
+    for (long r = 0; r < rounds / 100 + 1; r++)
+    {
+        int chans = 1 + rand() % 4;
+        int len = (mem + EM_MEM_RESERVE) * chans;
+        double f_event = f_events[r % (sizeof(f_events) / sizeof(f_events[0]))];
+        int post = (int)((double)mem * (100 - pretrigs[r % 5]) / 100.0) * chans;
+
+        double t = 0;                               // [s] since posttrigger start
+        int dma_start = len - rand() % len;         // DMA data length, len..1
+        int dma = dma_start, sum = 0;
+
+        while (1)
+        {
+            long done = (long)(t * f_event) * chans;            // samples written by DMA
+            int now = len - (int)((len - dma_start + done) % len);
+            sum += daq_trig_post_moved(dma, now, len);
+            dma = now;
+
+            if (sum != done) // DMA wrapped unseen
+            {
+                errs++;
+                break;
+            }
+
+            int left = post - sum;
+            if (left <= 0)
+                break;
+
+            int ms = daq_trig_post_ms(left, chans, f_event);
+            if (ms > 0)
+            {
+                t += (ms + 1) / 1000.0;                         // vTaskDelay ends up to one tick late
+                sleeps++;
+            }
+            else
+            {
+                t += 1.0 / f_event;
+                polls++;
+            }
+        }
+    }
+
+    printf("Posttrigger, mem %d, fake DMA, %ld counts\n", mem, rounds / 100 + 1);
+    printf("  %ld sleeps, %ld polls\n", sleeps, polls);
+    printf("  position and count errors: %ld\n", errs);
+
+    if (errs > 0)
+    {
+        fprintf(stderr, "bench: posttrigger counting failed\n");
+        return 1;
+    }
+    return 0;
+}
+
+/* fake IN endpoint - checks packet size, ZLP only after full packet, and stream content */
+static comm_fifo_t s_fifo;
+static uint32_t s_ep_pos;           // stream bytes received
+static int s_ep_last;               // last packet length, -1 = none
+static long s_ep_pkts, s_ep_zlps, s_ep_errs;
+
+static uint8_t usb_byte(uint32_t pos)
+{
+    return (uint8_t)(pos * 7 + (pos >> 8) + 3);
+}
+
+static int fake_ep(const uint8_t* data, uint16_t len)
+{
+    if (len > COMM_FIFO_PKT)
+        s_ep_errs++;
+
+    if (len == 0 && (s_ep_last != COMM_FIFO_PKT || comm_fifo_used(&s_fifo) != 0))
+        s_ep_errs++;
+
+    for (int i = 0; i < len; i++)
+    {
+        if (data[i] != usb_byte(s_ep_pos++))
+            s_ep_errs++;
+    }
+
+    s_ep_pkts += len > 0;
+    s_ep_zlps += len == 0;
+    s_ep_last = len;
+    return 0;
+}
+
+/* ISR side - IN transfer complete, transfer must not end on full packet */
+static void usb_done(void)
+{
+    comm_fifo_tx_done(&s_fifo);
+
+    if (!s_fifo.busy && s_ep_last == COMM_FIFO_PKT)
+        s_ep_errs++;
+}
+
+static void usb_drain(void)
+{
+    while (s_fifo.busy)
+        usb_done();
+}
+
+static uint32_t usb_write(uint32_t pos, int len)
+{
+    uint8_t buff[2048];
+
+    for (int i = 0; i < len; i++)
+        buff[i] = usb_byte(pos + i);
+
+    return comm_fifo_write(&s_fifo, (const char*)buff, len);
+}
+
+static void usb_reset(uint32_t idx)
+{
+    comm_fifo_init(&s_fifo, fake_ep);
+    s_fifo.head = s_fifo.tail = s_fifo.mark = idx; // free running indexes start anywhere
+    s_ep_pos = 0;
+    s_ep_last = -1;
+}
+
+/* USB TX FIFO framing: 64 B packets, ZLP on transfer of exact multiple of 64, wrap of buffer and of
+ * 32-bit indexes with random writes and completions, drop of unsent message */
+static int bench_usb(long rounds)
+{
+    uint32_t pos = 0;
+    long errs = 0;
+
+    /* transfers of n bytes into idle FIFO, ZLP iff n % 64 == 0 */
+    for (int n = 1; n <= COMM_FIFO_LEN; n++)
+    {
+        usb_reset(0);
+        s_ep_zlps = 0;
+
+        usb_write(0, n);
+        comm_fifo_kick(&s_fifo);
+        usb_drain();
+
+        if (s_ep_pos != (uint32_t)n || s_ep_zlps != (n % COMM_FIFO_PKT == 0))
+            errs++;
+    }
+
+    /* random writes and completions, indexes cross 2^32 */
+    usb_reset(0xFFFFFFFFu - 10 * COMM_FIFO_LEN);
+    s_ep_pkts = s_ep_zlps = 0;
+    srand(1);
+
+    int64_t t0 = bench_ns();
+
+    for (long r = 0; r < rounds; r++)
+    {
+        int len = 1 + rand() % (2 * COMM_FIFO_LEN);
+        int sent = 0;
+
+        while (sent < len)
+        {
+            sent += usb_write(pos + sent, len - sent);
+            comm_fifo_kick(&s_fifo);
+
+            for (int done = rand() % 12; done > 0 || (sent < len && comm_fifo_free(&s_fifo) == 0); done--)
+                usb_done();
+        }
+        pos += len;
+    }
+    usb_drain();
+
+    int64_t t1 = bench_ns();
+
+    if (s_ep_pos != pos || comm_fifo_used(&s_fifo) != 0)
+        errs++;
+
+    uint32_t rnd_bytes = pos;
+    long rnd_pkts = s_ep_pkts, rnd_zlps = s_ep_zlps;
+
+    /* drop: whole message while unsent, never after first packet of it left */
+    usb_reset(0);
+    pos = 0;
+
+    comm_fifo_mark(&s_fifo);
+    pos += usb_write(pos, 200);
+    comm_fifo_kick(&s_fifo); // first packet in flight
+    comm_fifo_mark(&s_fifo);
+    usb_write(pos, 100);
+
+    if (!comm_fifo_drop(&s_fifo) || comm_fifo_used(&s_fifo) != 200 - COMM_FIFO_PKT)
+        errs++;
+
+    comm_fifo_mark(&s_fifo);
+    usb_write(pos, 100);
+    usb_done(); // second packet leaves, of previous message
+
+    if (!comm_fifo_drop(&s_fifo)) // nothing of this one sent yet
+        errs++;
+
+    comm_fifo_mark(&s_fifo);
+    pos += usb_write(pos, 150);
+    usb_done();
+    usb_done(); // third packet is previous message tail + start of this one
+
+    if (comm_fifo_drop(&s_fifo) || s_fifo.drops != 2)
+        errs++;
+
+    usb_drain();
+
+    if (s_ep_pos != pos)
+        errs++;
+
+    errs += s_ep_errs;
+
+    printf("USB TX FIFO %d B, %d B packets, fake endpoint, %ld random messages\n", COMM_FIFO_LEN, COMM_FIFO_PKT, rounds);
+    printf("  %u B in %ld packets + %ld ZLP, %.2f ns per byte\n", (unsigned)rnd_bytes, rnd_pkts, rnd_zlps,
+           (double)(t1 - t0) / (rnd_bytes > 0 ? rnd_bytes : 1));
+    printf("  framing, wrap and drop errors: %ld\n", errs);
+
+    if (errs > 0)
+    {
+        fprintf(stderr, "bench: USB TX FIFO framing failed\n");
+        return 1;
+    }
+    return 0;
+}
+
+void Error_Handler(void)
+{
+    fprintf(stderr, "Error_Handler\n");
+    abort();
+}
+
+static void MX_DMA_Init(void)
+{
+    LL_DMA_SetMode(EM_DMA_ADC1, EM_DMA_CH_ADC1, LL_DMA_MODE_CIRCULAR);
+    LL_DMA_SetMode(EM_DMA_LA, EM_DMA_CH_LA, LL_DMA_MODE_CIRCULAR);
+    LL_DMA_SetMode(EM_DMA_CNTR, EM_DMA_CH_CNTR, LL_DMA_MODE_NORMAL);
+    LL_DMA_SetMode(EM_DMA_CNTR2, EM_DMA_CH_CNTR2, LL_DMA_MODE_NORMAL);
+}
+
+static void MX_ADC1_Init(void)
+{
+    LL_ADC_REG_SetTriggerSource(EM_ADC1, LL_ADC_REG_TRIG_EXT_TIM3_TRGO);
+    LL_ADC_REG_SetSequencerLength(EM_ADC1, LL_ADC_REG_SEQ_SCAN_ENABLE_3RANKS);
+    LL_ADC_REG_SetDMATransfer(EM_ADC1, LL_ADC_REG_DMA_TRANSFER_UNLIMITED);
+    LL_ADC_SetResolution(EM_ADC1, LL_ADC_RESOLUTION_12B);
+}
+
+static void MX_TIM_Init(void)
+{
+    /* TIM1 - counter */
+    LL_TIM_SetPrescaler(EM_TIM_CNTR, 0);
+    LL_TIM_SetAutoReload(EM_TIM_CNTR, EM_TIM_CNTR_MAX);
+    LL_TIM_IC_SetPrescaler(EM_TIM_CNTR, EM_TIM_CNTR_CH, LL_TIM_ICPSC_DIV1);
+    LL_TIM_IC_SetPrescaler(EM_TIM_CNTR, EM_TIM_CNTR_CH2, LL_TIM_ICPSC_DIV1);
+
+    /* TIM2, TIM4 - PWM */
+    LL_TIM_SetPrescaler(EM_TIM_PWM1, 1000);
+    LL_TIM_SetAutoReload(EM_TIM_PWM1, 72);
+    LL_TIM_SetPrescaler(EM_TIM_PWM2, 1000);
+    LL_TIM_SetAutoReload(EM_TIM_PWM2, 72);
+
+    /* TIM3 - DAQ */
+    LL_TIM_SetPrescaler(EM_TIM_DAQ, 0);
+    LL_TIM_SetAutoReload(EM_TIM_DAQ, 1000);
+}
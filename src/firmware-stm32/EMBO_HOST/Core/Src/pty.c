@@ -0,0 +1,136 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#define _GNU_SOURCE
+
+#include "pty.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+
+#define PTY_TX_TIMEOUT_MS   100     // nobody reads - data are lost, same as UART without receiver
+
+int pty_open(pty_t* self, const char* symlink_path)
+{
+    memset(self, 0, sizeof(pty_t));
+    self->slave = -1;
+
+    self->master = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+
+    if (self->master < 0 || grantpt(self->master) != 0 || unlockpt(self->master) != 0)
+    {
+        perror("posix_openpt");
+        return -1;
+    }
+
+    const char* name = ptsname(self->master);
+
+    if (name == NULL)
+    {
+        perror("ptsname");
+        return -1;
+    }
+
+    snprintf(self->path, sizeof(self->path), "%s", name);
+    self->slave = open(name, O_RDWR | O_NOCTTY);
+
+    /* raw mode, no echo and no line discipline, binary blocks must pass untouched */
+
+    struct termios tio;
+
+    if (self->slave < 0 || tcgetattr(self->slave, &tio) != 0)
+    {
+        perror("open slave");
+        return -1;
+    }
+
+    cfmakeraw(&tio);
+
+    if (tcsetattr(self->slave, TCSANOW, &tio) != 0)
+    {
+        perror("tcsetattr");
+        return -1;
+    }
+
+    if (symlink_path != NULL && symlink_path[0] != '\0')
+    {
+        unlink(symlink_path);
+
+        if (symlink(name, symlink_path) != 0)
+        {
+            perror(symlink_path);
+            return -1;
+        }
+
+        snprintf(self->link, sizeof(self->link), "%s", symlink_path);
+    }
+
+    return 0;
+}
+
+void pty_close(pty_t* self)
+{
+    if (self->link[0] != '\0')
+        unlink(self->link);
+    if (self->slave >= 0)
+        close(self->slave);
+    if (self->master >= 0)
+        close(self->master);
+
+    self->link[0] = '\0';
+    self->slave = -1;
+    self->master = -1;
+}
+
+int pty_read(pty_t* self, uint8_t* data, int len)
+{
+    int ret = read(self->master, data, len);
+
+    if (ret <= 0)
+        return 0;
+
+    self->rx_bytes += ret;
+    return ret;
+}
+
+void pty_write(pty_t* self, const uint8_t* data, int len)
+{
+    int sent = 0;
+
+    while (sent < len)
+    {
+        int ret = write(self->master, data + sent, len - sent);
+
+        if (ret > 0)
+        {
+            sent += ret;
+            self->tx_bytes += ret;
+        }
+        else if (ret < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else if (ret < 0 && errno == EAGAIN)
+        {
+            struct pollfd pfd = { self->master, POLLOUT, 0 };
+
+            if (poll(&pfd, 1, PTY_TX_TIMEOUT_MS) <= 0)
+                break;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    self->tx_dropped += len - sent;
+}
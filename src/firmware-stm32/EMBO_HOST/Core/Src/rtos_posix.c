@@ -0,0 +1,238 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#define _GNU_SOURCE
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+static pthread_mutex_t s_start_mtx = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_start_cond = PTHREAD_COND_INITIALIZER;
+static volatile int s_started = 0;
+static volatile sig_atomic_t s_end = 0;
+static volatile TickType_t s_ticks = 0;
+static __thread StaticTask_t* s_current = NULL;
+
+
+static void* task_thread(void* p)
+{
+    StaticTask_t* task = (StaticTask_t*)p;
+    s_current = task;
+
+    /* block until scheduler starts, same as tasks created before vTaskStartScheduler */
+    pthread_mutex_lock(&s_start_mtx);
+    while (!s_started)
+        pthread_cond_wait(&s_start_cond, &s_start_mtx);
+    pthread_mutex_unlock(&s_start_mtx);
+
+    task->func(task->param);
+
+    fprintf(stderr, "task %s returned\n", task->name);
+    abort(); // FreeRTOS task must never return
+    return NULL;
+}
+
+TaskHandle_t xTaskCreateStatic(TaskFunction_t func, const char* const name, const uint32_t stack_depth,
+                               void* const param, UBaseType_t prio, StackType_t* const stack, StaticTask_t* const buff)
+{
+    if (func == NULL || buff == NULL)
+        return NULL;
+
+    buff->func = func;
+    buff->param = param;
+    buff->name = name;
+    buff->prio = prio;
+    buff->stack = stack;
+    buff->stack_depth = stack_depth;
+
+    if (pthread_create(&buff->thread, NULL, task_thread, buff) != 0)
+        return NULL;
+
+    char thread_name[16];
+    snprintf(thread_name, sizeof(thread_name), "%s", name);
+    pthread_setname_np(buff->thread, thread_name); // visible in perf and gdb
+
+    return buff;
+}
+
+void vTaskStartScheduler(void)
+{
+    pthread_mutex_lock(&s_start_mtx);
+    s_started = 1;
+    pthread_cond_broadcast(&s_start_cond);
+    pthread_mutex_unlock(&s_start_mtx);
+
+    struct timespec ts = { 0, 10000000 };
+
+    while (!s_end)
+        nanosleep(&ts, NULL);
+
+    exit(EXIT_SUCCESS); // regular exit, so profiler data are written
+}
+
+void vTaskEndScheduler(void)
+{
+    s_end = 1; // async-signal-safe
+}
+
+void vTaskDelay(const TickType_t ticks)
+{
+    struct timespec ts;
+    ts.tv_sec = ticks / 1000;
+    ts.tv_nsec = (long)(ticks % 1000) * 1000000L;
+
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR);
+}
+
+BaseType_t xTaskGetSchedulerState(void)
+{
+    return s_started ? taskSCHEDULER_RUNNING : taskSCHEDULER_NOT_STARTED;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return s_ticks;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task)
+{
+    if (task == NULL)
+        task = s_current;
+
+    return task != NULL ? task->stack_depth : 0; // host stack is not measured
+}
+
+void xPortSysTickHandler(void)
+{
+    s_ticks++;
+}
+
+void vPortSVCHandler(void)
+{
+}
+
+void xPortPendSVHandler(void)
+{
+}
+
+/************************************************************************************************************************/
+
+static SemaphoreHandle_t sem_create(StaticSemaphore_t* buff, UBaseType_t count, UBaseType_t max)
+{
+    if (buff == NULL)
+        return NULL;
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+
+    pthread_mutex_init(&buff->mtx, NULL);
+    pthread_cond_init(&buff->cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    buff->count = count;
+    buff->max = max;
+
+    return buff;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t* buff)
+{
+    return sem_create(buff, 0, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t* buff)
+{
+    return sem_create(buff, 1, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCountingStatic(UBaseType_t max, UBaseType_t count, StaticSemaphore_t* buff)
+{
+    return sem_create(buff, count, max);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    struct timespec deadline;
+    int ret = 0;
+
+    if (ticks != portMAX_DELAY)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += ticks / 1000;
+        deadline.tv_nsec += (long)(ticks % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L)
+        {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+    }
+
+    pthread_mutex_lock(&sem->mtx);
+
+    while (sem->count == 0 && ret == 0)
+    {
+        if (ticks == portMAX_DELAY)
+            pthread_cond_wait(&sem->cond, &sem->mtx);
+        else if (ticks == 0)
+            ret = ETIMEDOUT;
+        else
+            ret = pthread_cond_timedwait(&sem->cond, &sem->mtx, &deadline);
+    }
+
+    BaseType_t taken = pdFALSE;
+    if (sem->count > 0)
+    {
+        sem->count--;
+        taken = pdTRUE;
+    }
+
+    pthread_mutex_unlock(&sem->mtx);
+    return taken;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    BaseType_t ret = pdFAIL;
+
+    pthread_mutex_lock(&sem->mtx);
+    if (sem->count < sem->max)
+    {
+        sem->count++;
+        ret = pdPASS;
+        pthread_cond_signal(&sem->cond);
+    }
+    pthread_mutex_unlock(&sem->mtx);
+
+    return ret;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t* woken)
+{
+    BaseType_t ret = xSemaphoreGive(sem);
+
+    if (woken != NULL)
+        *woken = ret;
+
+    return ret;
+}
+
+UBaseType_t uxQueueMessagesWaitingFromISR(SemaphoreHandle_t sem)
+{
+    pthread_mutex_lock(&sem->mtx);
+    UBaseType_t count = sem->count;
+    pthread_mutex_unlock(&sem->mtx);
+
+    return count;
+}
@@ -0,0 +1,726 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#define _GNU_SOURCE
+
+#include "cfg.h"
+#include "sim.h"
+#include "main.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+
+#define SIM_STEP_NS         50000       // simulator period
+#define SIM_LAG_MAX_S       0.02        // longer lag of DAQ timer is dropped (host overloaded)
+#define SIM_CNTR_EVT_MAX    200000      // max counter events per step
+#define SIM_TX_BUFF_SZ      4096        // flushed to pty on new line or when full
+#define SIM_RX_BUFF_SZ      1024
+#define SIM_VREFINT         1.2         // internal reference voltage (V)
+#define SIM_NS              1000000000LL
+
+/* register model instances ------------------------------------------------------------------------------- */
+
+ADC_TypeDef     sim_adc1;
+DMA_TypeDef     sim_dma1;
+TIM_TypeDef     sim_tim1, sim_tim2, sim_tim3, sim_tim4;
+GPIO_TypeDef    sim_gpioa, sim_gpiob, sim_gpioc;
+EXTI_TypeDef    sim_exti;
+USART_TypeDef   sim_usart1 = { .SR = USART_SR_TXE };
+IWDG_TypeDef    sim_iwdg;
+SysTick_Type    sim_systick;
+NVIC_Type       sim_nvic;
+
+uint32_t SystemCoreClock = EM_FREQ_HCLK;
+
+typedef void (*sim_irq_handler_t)(void);
+
+static sim_irq_handler_t const s_vectors[SIM_IRQ_CNT] =
+{
+    [EXTI0_IRQn]    = EXTI0_IRQHandler,
+    [EXTI1_IRQn]    = EXTI1_IRQHandler,
+    [EXTI2_IRQn]    = EXTI2_IRQHandler,
+    [EXTI3_IRQn]    = EXTI3_IRQHandler,
+    [EXTI4_IRQn]    = EXTI4_IRQHandler,
+    [DMA1_Channel2_IRQn] = DMA1_Channel2_IRQHandler,
+    [ADC1_2_IRQn]   = ADC1_2_IRQHandler,
+    [TIM1_UP_IRQn]  = TIM1_UP_IRQHandler,
+    [USART1_IRQn]   = USART1_IRQHandler,
+};
+
+/* simulator state ---------------------------------------------------------------------------------------- */
+
+static pthread_mutex_t s_irq_mtx = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+static pthread_mutex_t s_tx_mtx = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t s_thread;
+
+static sim_cfg_t s_cfg;
+static pty_t* s_pty;
+static int64_t s_start;
+static uint32_t s_rng;
+
+static float* s_adc_rows = NULL;    // 4 values per row
+static int s_adc_rows_cnt = 0;
+static uint8_t* s_la_rows = NULL;
+static int s_la_rows_cnt = 0;
+
+static struct
+{
+    int run;
+    int64_t t0;
+    uint64_t events;
+    uint32_t psc;
+    uint32_t arr;
+} s_daq;
+
+static struct
+{
+    int run;
+    int64_t t0;
+    uint32_t psc;                   // restarted on change, ticks are counted in its units
+    double next_ovf;                // in timer ticks from t0
+    double next_cap;                // CH1 edge (after IC prescaler), with jitter
+    double cap_ideal;
+    double next_fall;               // falling edge for CH2 falling polarity, with jitter
+    double fall_ideal;
+} s_cntr;
+
+static struct
+{
+    uint8_t tx[SIM_TX_BUFF_SZ];
+    int tx_len;
+    int64_t tx_ready;               // time when TX register is empty again
+    uint8_t rx[SIM_RX_BUFF_SZ];
+    int rx_len;
+    int rx_pos;
+    int64_t rx_next;
+    int64_t byte_ns;                // 0 = unlimited
+} s_uart;
+
+static int64_t s_tick_next;
+
+static struct
+{
+    uint64_t daq_events;
+    uint64_t conversions;
+    uint64_t irqs;
+    uint64_t lost;                  // DAQ timer events dropped because of lag
+    int64_t last;
+    uint64_t tx_last;
+    uint64_t rx_last;
+} s_stats;
+
+/************************************************************************************************************************/
+
+static int64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * SIM_NS + ts.tv_nsec;
+}
+
+static double rand_gauss(void)
+{
+    /* xorshift32 + Box-Muller */
+    double u[2];
+    for (int i = 0; i < 2; i++)
+    {
+        s_rng ^= s_rng << 13;
+        s_rng ^= s_rng >> 17;
+        s_rng ^= s_rng << 5;
+        u[i] = (s_rng + 1.0) / 4294967297.0;
+    }
+    return sqrt(-2.0 * log(u[0])) * cos(2.0 * M_PI * u[1]);
+}
+
+void sim_irq_lock(void)
+{
+    pthread_mutex_lock(&s_irq_mtx);
+}
+
+void sim_irq_unlock(void)
+{
+    pthread_mutex_unlock(&s_irq_mtx);
+}
+
+static void irq_dispatch(int irq)
+{
+    if (sim_nvic.en[irq] && sim_nvic.pend[irq] && s_vectors[irq] != NULL)
+    {
+        sim_nvic.pend[irq] = 0;
+        s_stats.irqs++;
+
+        sim_irq_lock();
+        s_vectors[irq]();
+        sim_irq_unlock();
+    }
+}
+
+static void irq_raise(int irq)
+{
+    sim_nvic.pend[irq] = 1;
+    irq_dispatch(irq);
+}
+
+/* DMA ---------------------------------------------------------------------------------------------------- */
+
+static uint32_t mem_read(uint32_t addr, uint32_t sz)
+{
+    if (sz == 1)
+        return *(volatile uint8_t*)(uintptr_t)addr;
+    if (sz == 2)
+        return *(volatile uint16_t*)(uintptr_t)addr;
+    return *(volatile uint32_t*)(uintptr_t)addr;
+}
+
+static void mem_write(uint32_t addr, uint32_t sz, uint32_t val)
+{
+    if (sz == 1)
+        *(volatile uint8_t*)(uintptr_t)addr = (uint8_t)val;
+    else if (sz == 2)
+        *(volatile uint16_t*)(uintptr_t)addr = (uint16_t)val;
+    else
+        *(volatile uint32_t*)(uintptr_t)addr = val;
+}
+
+/* one transfer requested by peripheral - memory increment, fixed peripheral address */
+static void dma_request(DMA_TypeDef* dma, uint32_t ch)
+{
+    DMA_Channel_TypeDef* c = &dma->CH[ch];
+
+    if ((c->CCR & DMA_CCR_EN) == 0 || c->CNDTR == 0)
+        return;
+
+    uint32_t p_sz = 1 << ((c->CCR & DMA_CCR_PSIZE) >> DMA_CCR_PSIZE_Pos);
+    uint32_t m_sz = 1 << ((c->CCR & DMA_CCR_MSIZE) >> DMA_CCR_MSIZE_Pos);
+    uint32_t m_addr = c->CMAR + (c->len - c->CNDTR) * m_sz;
+
+    if (c->CCR & DMA_CCR_DIR)
+        mem_write(c->CPAR, p_sz, mem_read(m_addr, m_sz));
+    else
+        mem_write(m_addr, m_sz, mem_read(c->CPAR, p_sz));
+
+    if (--c->CNDTR == 0)
+    {
+        if (c->CCR & DMA_CCR_CIRC)
+            c->CNDTR = c->len;
+
+        dma->ISR |= DMA_ISR_TCIF(ch);
+
+        if ((c->CCR & DMA_CCR_TCIE) && dma == DMA1)
+            irq_raise(DMA1_Channel1_IRQn + ch - 1);
+    }
+}
+
+/* inputs ------------------------------------------------------------------------------------------------- */
+
+static double adc_input(uint32_t ch, uint64_t event, double t)
+{
+    if (ch == LL_ADC_CHANNEL_VREFINT)
+        return (sim_adc1.CR2 & ADC_CR2_TSVREFE) ? SIM_VREFINT : 0;
+
+    if (ch < 1 || ch > 4)
+        return 0;
+
+    if (s_adc_rows_cnt > 0)
+        return s_adc_rows[(event % s_adc_rows_cnt) * 4 + (ch - 1)];
+
+    double f = s_cfg.sig_freq;
+    double v;
+
+    if (ch == 1)        // sine
+        v = 1.65 + 1.0 * sin(2.0 * M_PI * f * t);
+    else if (ch == 2)   // square, half frequency
+        v = fmod(t * f / 2.0, 1.0) < 0.5 ? 2.8 : 0.5;
+    else if (ch == 3)   // triangle, double frequency
+        v = 0.3 + 2.7 * fabs(2.0 * fmod(t * f * 2.0, 1.0) - 1.0);
+    else                // slow sine
+        v = 1.65 + 0.8 * sin(2.0 * M_PI * f / 10.0 * t);
+
+    if (s_cfg.noise > 0)
+        v += s_cfg.noise * rand_gauss();
+
+    return v;
+}
+
+/* bit mask of LA channels */
+static uint32_t la_input(uint64_t event, double t)
+{
+    if (s_la_rows_cnt > 0)
+        return s_la_rows[event % s_la_rows_cnt];
+
+    return (uint32_t)(t * s_cfg.sig_freq * 2.0) & 0x0F; // binary counter, CH1 at base frequency
+}
+
+/* ADC, GPIO, EXTI ---------------------------------------------------------------------------------------- */
+
+static void adc_convert(ADC_TypeDef* adc, uint64_t event, double t)
+{
+    double full = adc->res == LL_ADC_RESOLUTION_8B ? 255.0 : 4095.0;
+    double tconv = adc->res == LL_ADC_RESOLUTION_8B ? EM_ADC_TCONV8 : EM_ADC_TCONV12;
+
+    for (uint32_t r = 0; r < adc->seq_len && r < 16; r++)
+    {
+        uint32_t ch = adc->seq[r];
+        double v = adc_input(ch, event, t);
+        double code = round(v / (EM_VREF / 1000.0) * full);
+
+        if (code < 0)
+            code = 0;
+        if (code > full)
+            code = full;
+
+        adc->DR = (uint32_t)code;
+        t += (EM_ADC_SMPLT_N[adc->smpl[ch] % EM_ADC_SMPLT_CNT] + tconv) / EM_FREQ_ADCCLK;
+        s_stats.conversions++;
+
+        if (adc->dma != LL_ADC_REG_DMA_TRANSFER_NONE)
+            dma_request(EM_DMA_ADC1, EM_DMA_CH_ADC1);
+
+        /* analog watchdog on single regular channel, thresholds 12-bit aligned */
+        if (adc->awd_ch != LL_ADC_AWD_DISABLE && (adc->awd_ch & 0xFF) == ch)
+        {
+            uint32_t val = adc->res == LL_ADC_RESOLUTION_8B ? adc->DR << 4 : adc->DR;
+
+            if (val > adc->HTR || val < adc->LTR)
+            {
+                adc->SR |= ADC_SR_AWD;
+                irq_raise(EM_IRQN_ADC1);
+            }
+        }
+    }
+
+    adc->SR |= ADC_SR_EOS;
+}
+
+static void gpio_set_input(GPIO_TypeDef* gpio, uint32_t idr)
+{
+    uint32_t changed = gpio->IDR ^ idr;
+    gpio->IDR = idr;
+
+    for (int line = 0; line <= 4; line++)
+    {
+        uint32_t bit = 1UL << line;
+
+        if ((changed & bit) == 0 || (sim_exti.IMR & bit) == 0)
+            continue;
+
+        if (((idr & bit) && (sim_exti.RTSR & bit)) || (!(idr & bit) && (sim_exti.FTSR & bit)))
+        {
+            sim_exti.PR |= bit;
+            irq_raise(EXTI0_IRQn + line);
+        }
+    }
+}
+
+/* DAQ timer - triggers ADC sequence and LA DMA (CC1) */
+static void daq_event(uint64_t event, double t)
+{
+    s_stats.daq_events++;
+
+    if (sim_adc1.enabled && sim_adc1.ext_trig)
+        adc_convert(&sim_adc1, event, t);
+
+    if (EM_TIM_DAQ->DIER & TIM_DIER_CC1DE)
+    {
+        gpio_set_input(EM_GPIO_LA_PORT, la_input(event, t) << EM_GPIO_LA_CH1_NUM);
+        dma_request(EM_DMA_LA, EM_DMA_CH_LA);
+    }
+}
+
+static void daq_step(int64_t now)
+{
+    TIM_TypeDef* tim = EM_TIM_DAQ;
+
+    if ((tim->CR1 & TIM_CR1_CEN) == 0)
+    {
+        s_daq.run = 0;
+        return;
+    }
+
+    if (!s_daq.run || tim->PSC != s_daq.psc || tim->ARR != s_daq.arr)
+    {
+        s_daq.run = 1;
+        s_daq.t0 = now;
+        s_daq.events = 0;
+        s_daq.psc = tim->PSC;
+        s_daq.arr = tim->ARR;
+    }
+
+    double fs = (double)EM_TIM_DAQ_FREQ / (((double)s_daq.psc + 1.0) * ((double)s_daq.arr + 1.0));
+    double t0 = (double)(s_daq.t0 - s_start) / SIM_NS;
+    uint64_t due = (uint64_t)((double)(now - s_daq.t0) / SIM_NS * fs);
+    uint64_t lag_max = (uint64_t)(fs * SIM_LAG_MAX_S) + 1;
+
+    if (due - s_daq.events > lag_max)
+    {
+        s_stats.lost += due - s_daq.events - lag_max;
+        s_daq.events = due - lag_max;
+    }
+
+    while (s_daq.events < due && (tim->CR1 & TIM_CR1_CEN))
+    {
+        s_daq.events++;
+        daq_event(s_daq.events, t0 + (double)s_daq.events / fs);
+    }
+}
+
+static double cntr_jitter(double rms)
+{
+    return rms > 0 ? rms * rand_gauss() : 0;
+}
+
+/* counter - TIM1 free running, CH1 direct capture to DMA, CH2 indirect capture moves overflow count (CCR3),
+ * or captures falling edge to CCR2 if its polarity is falling (duty) */
+static void cntr_step(int64_t now)
+{
+    TIM_TypeDef* tim = EM_TIM_CNTR;
+
+    if ((tim->CR1 & TIM_CR1_CEN) == 0)
+    {
+        s_cntr.run = 0;
+        return;
+    }
+
+    double period = (double)tim->ARR + 1.0;
+    double f_tim = (double)EM_TIM_CNTR_FREQ / ((double)tim->PSC + 1.0);
+    double f_in = s_cfg.cntr_freq;
+    double duty = s_cfg.cntr_duty / 100.0;
+
+    if ((EM_TIM_PWM1->CR1 & TIM_CR1_CEN) && (EM_TIM_PWM1->CCER & EM_TIM_PWM1_CH)) // PWM looped back to input
+    {
+        f_in = (double)EM_TIM_PWM1_FREQ / (((double)EM_TIM_PWM1->PSC + 1.0) * ((double)EM_TIM_PWM1->ARR + 1.0));
+        duty = (double)EM_TIM_PWM1->CCR1 / ((double)EM_TIM_PWM1->ARR + 1.0); // PWM1 is CH1
+    }
+
+    double in_ticks = f_in > 0 ? f_tim / f_in : 0;
+    double cap_ticks = in_ticks * (double)(1 << (tim->ICPSC[0] & 3));
+    double jitter = s_cfg.cntr_jitter * f_tim;
+    double ticks = (double)(now - s_cntr.t0) / SIM_NS * f_tim;
+    int falling = tim->ICPOL[1] == LL_TIM_IC_POLARITY_FALLING;
+
+    if (!s_cntr.run || tim->PSC != s_cntr.psc)
+    {
+        s_cntr.run = 1;
+        s_cntr.t0 = now;
+        s_cntr.psc = tim->PSC;
+        s_cntr.next_ovf = period - tim->CNT;
+        s_cntr.cap_ideal = cap_ticks;
+        s_cntr.next_cap = cap_ticks + cntr_jitter(jitter);
+        s_cntr.fall_ideal = duty * in_ticks;
+        s_cntr.next_fall = s_cntr.fall_ideal + cntr_jitter(jitter);
+        ticks = 0;
+    }
+
+    int dma1 = (EM_DMA_CNTR->CH[EM_DMA_CH_CNTR].CCR & DMA_CCR_EN) && EM_DMA_CNTR->CH[EM_DMA_CH_CNTR].CNDTR > 0;
+    int dma2 = (EM_DMA_CNTR2->CH[EM_DMA_CH_CNTR2].CCR & DMA_CCR_EN) && EM_DMA_CNTR2->CH[EM_DMA_CH_CNTR2].CNDTR > 0;
+    int capturing = cap_ticks > 0 && (dma1 || (dma2 && !falling));
+    int capturing_f = in_ticks > 0 && dma2 && falling;
+
+    if (!capturing && cap_ticks > 0 && s_cntr.cap_ideal < ticks) // nobody listens, keep phase only
+    {
+        s_cntr.cap_ideal += ceil((ticks - s_cntr.cap_ideal) / cap_ticks) * cap_ticks;
+        s_cntr.next_cap = s_cntr.cap_ideal + cntr_jitter(jitter);
+    }
+    if (!capturing_f && in_ticks > 0 && s_cntr.fall_ideal < ticks)
+    {
+        s_cntr.fall_ideal += ceil((ticks - s_cntr.fall_ideal) / in_ticks) * in_ticks;
+        s_cntr.next_fall = s_cntr.fall_ideal + cntr_jitter(jitter);
+    }
+
+    for (int i = 0; i < SIM_CNTR_EVT_MAX; i++)
+    {
+        int cap = capturing && s_cntr.next_cap < s_cntr.next_ovf && (!capturing_f || s_cntr.next_cap < s_cntr.next_fall);
+        int fall = !cap && capturing_f && s_cntr.next_fall < s_cntr.next_ovf;
+        double evt = cap ? s_cntr.next_cap : (fall ? s_cntr.next_fall : s_cntr.next_ovf);
+
+        if (evt > ticks)
+            break;
+
+        if (cap)
+        {
+            if (tim->CCER & EM_TIM_CNTR_CH)
+            {
+                tim->EM_TIM_CNTR_CCR = (uint32_t)fmod(evt, period);
+
+                if (tim->DIER & TIM_DIER_CC1DE)
+                    dma_request(EM_DMA_CNTR, EM_DMA_CH_CNTR);
+            }
+            if (!falling && (tim->CCER & EM_TIM_CNTR_CH2) && (tim->DIER & TIM_DIER_CC2DE))
+                dma_request(EM_DMA_CNTR2, EM_DMA_CH_CNTR2);
+
+            s_cntr.cap_ideal += cap_ticks;
+            s_cntr.next_cap = s_cntr.cap_ideal + cntr_jitter(jitter);
+        }
+        else if (fall)
+        {
+            if (tim->CCER & EM_TIM_CNTR_CH2)
+            {
+                tim->EM_TIM_CNTR_CCR3 = (uint32_t)fmod(evt, period);
+
+                if (tim->DIER & TIM_DIER_CC2DE)
+                    dma_request(EM_DMA_CNTR2, EM_DMA_CH_CNTR2);
+            }
+
+            s_cntr.fall_ideal += in_ticks;
+            s_cntr.next_fall = s_cntr.fall_ideal + cntr_jitter(jitter);
+        }
+        else
+        {
+            tim->SR |= TIM_SR_UIF;
+            tim->CNT = 0;
+
+            if (tim->DIER & TIM_DIER_UIE)
+                irq_raise(EM_CNTR_IRQ);
+
+            s_cntr.next_ovf += period;
+        }
+    }
+
+    tim->CNT = (uint32_t)fmod(ticks, period);
+}
+
+/* SysTick, USART ----------------------------------------------------------------------------------------- */
+
+static void systick_step(int64_t now)
+{
+    const uint32_t en = SysTick_CTRL_ENABLE_Msk | SysTick_CTRL_TICKINT_Msk;
+
+    if (now - s_tick_next > SIM_NS / 10) // suspended or overloaded, do not catch up
+        s_tick_next = now;
+
+    while (now >= s_tick_next)
+    {
+        s_tick_next += SIM_NS / EM_SYSTICK_FREQ;
+
+        if ((sim_systick.CTRL & en) == en)
+        {
+            sim_irq_lock();
+            SysTick_Handler();
+            sim_irq_unlock();
+        }
+    }
+
+    /* counts down to next tick, firmware reads it for sub-ms timing */
+    uint64_t val = (uint64_t)(s_tick_next - now) * ((uint64_t)sim_systick.LOAD + 1) / (SIM_NS / EM_SYSTICK_FREQ);
+    sim_systick.VAL = (uint32_t)(val > sim_systick.LOAD ? sim_systick.LOAD : val);
+}
+
+static void uart_flush(void)
+{
+    if (s_uart.tx_len > 0)
+    {
+        pty_write(s_pty, s_uart.tx, s_uart.tx_len);
+        s_uart.tx_len = 0;
+    }
+}
+
+uint32_t sim_uart_txe(USART_TypeDef* uart)
+{
+    (void)uart;
+    return s_uart.byte_ns == 0 || now_ns() >= s_uart.tx_ready;
+}
+
+void sim_uart_tx(USART_TypeDef* uart, uint8_t val)
+{
+    (void)uart;
+
+    pthread_mutex_lock(&s_tx_mtx);
+
+    s_uart.tx[s_uart.tx_len++] = val;
+
+    if (val == '\n' || s_uart.tx_len == SIM_TX_BUFF_SZ)
+        uart_flush();
+
+    if (s_uart.byte_ns > 0)
+    {
+        int64_t now = now_ns();
+        s_uart.tx_ready = (s_uart.tx_ready > now ? s_uart.tx_ready : now) + s_uart.byte_ns;
+    }
+
+    pthread_mutex_unlock(&s_tx_mtx);
+}
+
+static void uart_step(int64_t now)
+{
+    if (pthread_mutex_trylock(&s_tx_mtx) == 0)
+    {
+        uart_flush();
+        pthread_mutex_unlock(&s_tx_mtx);
+    }
+
+    if ((sim_usart1.CR1 & USART_CR1_RXNEIE) == 0) // not initialized yet, keep data in pty
+        return;
+
+    if (s_uart.rx_pos >= s_uart.rx_len)
+    {
+        s_uart.rx_len = pty_read(s_pty, s_uart.rx, SIM_RX_BUFF_SZ);
+        s_uart.rx_pos = 0;
+    }
+
+    if (s_uart.rx_next < now - SIM_NS / 100)
+        s_uart.rx_next = now;
+
+    while (s_uart.rx_pos < s_uart.rx_len && (s_uart.byte_ns == 0 || s_uart.rx_next <= now))
+    {
+        sim_usart1.DR = s_uart.rx[s_uart.rx_pos++];
+        sim_usart1.SR |= USART_SR_RXNE; // overrun if previous byte was not read, same as hw
+        s_uart.rx_next += s_uart.byte_ns;
+
+        irq_raise(EM_IRQN_UART);
+    }
+}
+
+/* main loop ---------------------------------------------------------------------------------------------- */
+
+static void stats_step(int64_t now)
+{
+    if (!s_cfg.stats || now - s_stats.last < SIM_NS)
+        return;
+
+    double dt = (double)(now - s_stats.last) / SIM_NS;
+
+    fprintf(stderr, "daq %.0f/s  conv %.0f/s  irq %.0f/s  lost %llu  tx %.1f kB/s  rx %.1f kB/s  dropped %llu\n",
+            s_stats.daq_events / dt, s_stats.conversions / dt, s_stats.irqs / dt, (unsigned long long)s_stats.lost,
+            (s_pty->tx_bytes - s_stats.tx_last) / dt / 1000.0, (s_pty->rx_bytes - s_stats.rx_last) / dt / 1000.0,
+            (unsigned long long)s_pty->tx_dropped);
+
+    s_stats.daq_events = 0;
+    s_stats.conversions = 0;
+    s_stats.irqs = 0;
+    s_stats.tx_last = s_pty->tx_bytes;
+    s_stats.rx_last = s_pty->rx_bytes;
+    s_stats.last = now;
+}
+
+static void* sim_thread(void* p)
+{
+    (void)p;
+
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    while (1)
+    {
+        int64_t now = now_ns();
+
+        systick_step(now);
+        daq_step(now);
+        cntr_step(now);
+        uart_step(now);
+
+        for (int irq = 0; irq < SIM_IRQ_CNT; irq++) // enabled later while pending
+            irq_dispatch(irq);
+
+        stats_step(now);
+
+        next.tv_nsec += SIM_STEP_NS;
+        if (next.tv_nsec >= SIM_NS)
+        {
+            next.tv_sec++;
+            next.tv_nsec -= SIM_NS;
+        }
+        if ((int64_t)next.tv_sec * SIM_NS + next.tv_nsec < now) // overloaded, do not catch up
+        {
+            next.tv_sec = now / SIM_NS;
+            next.tv_nsec = now % SIM_NS;
+        }
+
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+    }
+
+    return NULL;
+}
+
+/************************************************************************************************************************/
+
+static int load_rows(const char* path, int cols, float** out_f, uint8_t** out_u)
+{
+    FILE* f = fopen(path, "r");
+    if (f == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+
+    char line[256];
+    int cnt = 0, cap = 0;
+
+    while (fgets(line, sizeof(line), f) != NULL)
+    {
+        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r')
+            continue;
+
+        if (cnt == cap)
+        {
+            cap = cap ? cap * 2 : 1024;
+            if (out_f) *out_f = realloc(*out_f, sizeof(float) * cols * cap);
+            if (out_u) *out_u = realloc(*out_u, cap);
+        }
+
+        char* s = line;
+        for (int i = 0; i < cols; i++)
+        {
+            char* end;
+
+            if (out_f)
+                (*out_f)[cnt * cols + i] = strtof(s, &end);
+            else
+                (*out_u)[cnt] = (uint8_t)(strtoul(s, &end, 0) & 0x0F);
+
+            s = end;
+            while (*s == ',' || *s == ';' || *s == ' ' || *s == '\t')
+                s++;
+        }
+        cnt++;
+    }
+
+    fclose(f);
+
+    if (cnt == 0)
+        fprintf(stderr, "%s: no data\n", path);
+
+    return cnt > 0 ? cnt : -1;
+}
+
+int sim_init(const sim_cfg_t* cfg, pty_t* pty)
+{
+    /* DMA addresses are 32-bit, same as on MCU */
+    if ((uintptr_t)&sim_adc1 > 0xFFFFFFFFULL || (uintptr_t)&s_uart > 0xFFFFFFFFULL)
+    {
+        fprintf(stderr, "globals above 4 GB - link with -no-pie\n");
+        return -1;
+    }
+
+    s_cfg = *cfg;
+    s_pty = pty;
+    s_rng = cfg->seed ? cfg->seed : 1;
+    s_uart.byte_ns = cfg->baud > 0 ? SIM_NS * 10 / cfg->baud : 0; // 8N1
+
+    if (cfg->adc_file != NULL && (s_adc_rows_cnt = load_rows(cfg->adc_file, 4, &s_adc_rows, NULL)) < 0)
+        return -1;
+
+    if (cfg->la_file != NULL && (s_la_rows_cnt = load_rows(cfg->la_file, 1, NULL, &s_la_rows)) < 0)
+        return -1;
+
+    return 0;
+}
+
+int sim_start(void)
+{
+    s_start = now_ns();
+    s_tick_next = s_start;
+    s_stats.last = s_start;
+
+    if (pthread_create(&s_thread, NULL, sim_thread, NULL) != 0)
+        return -1;
+
+    pthread_setname_np(s_thread, "sim");
+    return 0;
+}
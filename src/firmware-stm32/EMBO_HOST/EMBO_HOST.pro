@@ -0,0 +1,91 @@
+# EMBO firmware built for Linux host against simulated F103C8 peripherals (firmware-in-the-loop)
+#
+# Application (__app) and SCPI library are compiled unchanged, only cfg_host.h is selected by EMBO_HOST.
+# LL drivers, CMSIS and FreeRTOS are replaced by Core/Inc headers: register model, LL subset over it
+# and FreeRTOS API over pthreads. UART is exposed as pseudo-terminal, path is printed to stdout,
+# so EMBO, embo.py or EMBO-virtual clients connect to it like to a real board.
+#
+#   qmake && make                     release build
+#   qmake CONFIG+=profile && make     gprof build (gmon.out is written on SIGINT/SIGTERM)
+#   perf record -g ./embo-host        threads are named by FreeRTOS tasks
+#   ./embo-host --bench 100000        SCPI header lookup (linear vs dispatch table), trigger qualifier,
+#                                     DDS synthesis checked against double reference (exit 1 on error)
+
+TEMPLATE = app
+TARGET = embo-host
+
+CONFIG += console
+CONFIG -= qt app_bundle
+
+DEFINES += EMBO_HOST
+
+# headers of __app define globals (app_data.h, app_sync.h) - same as GCC < 10 default
+QMAKE_CFLAGS += -std=gnu11 -fcommon -Wno-pointer-to-int-cast -Wno-int-to-pointer-cast
+
+# DMA addresses are uint32_t like on MCU, globals must stay below 4 GB
+QMAKE_LFLAGS += -no-pie
+
+profile {
+    QMAKE_CFLAGS += -pg -fno-omit-frame-pointer
+    QMAKE_LFLAGS += -pg
+}
+
+LIBS += -lpthread -lm
+
+# SCPI dispatch table is regenerated when command table changes (MCU builds use committed comm_hash.h)
+scpi_hash.target = $$PWD/../__app/inc/comm_hash.h
+scpi_hash.depends = $$PWD/../__app/src/comm.c
+scpi_hash.commands = -python3 $$PWD/../../../scripts/scpi_hash.py
+QMAKE_EXTRA_TARGETS += scpi_hash
+PRE_TARGETDEPS += $$scpi_hash.target
+
+INCLUDEPATH += \
+    Core/Inc \
+    ../__app/inc \
+    ../__app/inc/cfg \
+    ../__lib/scpi/inc
+
+SOURCES += \
+    Core/Src/main.c \
+    Core/Src/pty.c \
+    Core/Src/rtos_posix.c \
+    Core/Src/sim.c \
+    ../__app/src/app.c \
+    ../__app/src/cfg.c \
+    ../__app/src/cntr.c \
+    ../__app/src/cntr_irq.c \
+    ../__app/src/comm.c \
+    ../__app/src/comm_fifo.c \
+    ../__app/src/comm_irq.c \
+    ../__app/src/comm_proto.c \
+    ../__app/src/daq.c \
+    ../__app/src/daq_irq.c \
+    ../__app/src/daq_trig.c \
+    ../__app/src/dds.c \
+    ../__app/src/irq.c \
+    ../__app/src/led.c \
+    ../__app/src/periph.c \
+    ../__app/src/pwm.c \
+    ../__app/src/sgen.c \
+    ../__app/src/sgen_irq.c \
+    ../__app/src/trig_qual.c \
+    ../__app/src/utility.c \
+    ../__lib/scpi/src/error.c \
+    ../__lib/scpi/src/expression.c \
+    ../__lib/scpi/src/fifo.c \
+    ../__lib/scpi/src/ieee488.c \
+    ../__lib/scpi/src/lexer.c \
+    ../__lib/scpi/src/minimal.c \
+    ../__lib/scpi/src/parser.c \
+    ../__lib/scpi/src/units.c \
+    ../__lib/scpi/src/utils.c
+
+HEADERS += \
+    Core/Inc/FreeRTOS.h \
+    Core/Inc/main.h \
+    Core/Inc/pty.h \
+    Core/Inc/semphr.h \
+    Core/Inc/sim.h \
+    Core/Inc/stm32_host.h \
+    Core/Inc/stm32_host_ll.h \
+    Core/Inc/task.h
@@ -13,11 +13,15 @@
 StaticSemaphore_t buff_sem1_comm; // comm respond init
 StaticSemaphore_t buff_sem2_trig; // post trig count init
 StaticSemaphore_t buff_sem3_cntr; // counter enable
+StaticSemaphore_t buff_sem4_usb;  // USB TX FIFO space
+StaticSemaphore_t buff_sem5_cntr; // counter gate closed
 StaticSemaphore_t buff_mtx1;      // mutex for comm and trig
 
 SemaphoreHandle_t sem1_comm;
 SemaphoreHandle_t sem2_trig;
 SemaphoreHandle_t sem3_cntr;
+SemaphoreHandle_t sem4_usb;
+SemaphoreHandle_t sem5_cntr;
 SemaphoreHandle_t mtx1;
 
 #endif /* INC_APP_SYNC_H_ */
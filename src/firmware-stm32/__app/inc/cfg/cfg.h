@@ -159,6 +159,26 @@
 
 #endif
 
+#elif defined(EMBO_HOST)
+/*................................................... HOST ..................................................*/
+
+#define EM_HOST
+
+/*
+ * =========layout=========
+ *  DAQ CH1 ........... PA1
+ *  DAQ CH2 ........... PA2
+ *  DAQ CH3 ........... PA3
+ *  DAQ CH4 ........... PA4
+ *  PWM CH1 ........... PA15
+ *  PWM CH2 ........... PB6
+ *  CNTR .............. PA8
+ *  UART .............. pseudo-terminal
+ *  =======================
+*/
+
+#include "cfg_host.h"
+
 #endif
 
 #if !defined(EM_DAQ_4CH) && (defined(EM_ADC_MODE_ADC12) || defined(EM_ADC_MODE_ADC1234))
@@ -181,6 +201,7 @@
 #define EM_RESP_RDY_A          "\"ReadyA\""  // auto trigger data ready
 #define EM_RESP_RDY_D          "\"ReadyD\""  // disabled trigger data ready
 #define EM_RESP_RDY_F          "\"ReadyF\""  // forced trigger
+#define EM_RESP_RDY_C          "\"ReadyC\""  // counter gates closed, binary record follows
 
 // IWDG ------------------------------------------------------------
 #define EM_IWDG_RST_VAL        0xAAAA  // watchdog reset key value
@@ -189,12 +210,24 @@
 // DAQ -------------------------------------------------------------
 #define EM_AUTRIG_MIN_MS       500   // auto trigger ms delay
 #define EM_PRETRIG_MIN_MS      10    // pre trigger minimum ms
+#define EM_TRIG_POST_POLL_MS   2     // posttrigger rest shorter than this is polled, longer one slept
+#define EM_DAQ_SETTLE_US       500   // max wait for ADC and DMA to stop or start
+#define EM_TRIG_QUAL_LOOK      4     // AWD hit is valid if qualified edge is in this many last samples
+#define EM_TRIG_HYST_MAX       50    // max trigger hysteresis percent
+#define EM_TRIG_HOLDOFF_MAX    60000 // max trigger holdoff ms
+#define EM_TRIG_WIDTH_MAX      250   // max trigger min pulse width samples (ISR scans it)
 
 // Counter common --------------------------------------------------
 #define EM_CNTR_BUFF_SZ        200   // buffer size for high frequencies - fast mode
 #define EM_CNTR_BUFF_SZ2       30    // buffer size for slow frequencies - precise mode
-#define EM_CNTR_MEAS_MS        2000  // counter max measure time ms
-#define EM_CNTR_INT_DELAY      10    // counter internal read delay
+#define EM_CNTR_MEAS_MS        2000  // counter max measure time ms - gate without edge reports no signal after gate + this
+#define EM_CNTR_GATE_MS        100   // counter default gate time ms
+#define EM_CNTR_GATE_MIN_MS    10    // counter min gate time ms
+#define EM_CNTR_GATE_MAX_MS    10000 // counter max gate time ms - 32-bit timestamp wraps after 59 s at 72 MHz
+#define EM_CNTR_GATES          8     // gates closed by ISR, not yet taken by counter task, power of 2
+#define EM_CNTR_RES_LEN        16    // gate results not yet read by :CNTR:READ?, power of 2
+#define EM_CNTR_PUSH_LEN       4     // gate results per pushed record, more gates are pushed in more records
+#define EM_CNTR_RAW_MAX        (EM_CNTR_BUFF_SZ - 1) // max edges of raw timestamp capture - in counter DMA buffers
 
 // Voltmeter common ------------------------------------------------
 #define EM_VM_FS               100  // voltmeter fs (Hz)
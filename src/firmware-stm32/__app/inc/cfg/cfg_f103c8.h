@@ -64,9 +64,19 @@
 // UART -------------------------------------------------------------
 #define EM_UART                USART1               // UART periph
 #define EM_UART_RX_IRQHandler  USART1_IRQHandler    // UART IRQ handler
+#define EM_UART_CLK            72000000             // UART kernel clock - APB2
+#define EM_UART_BAUD_MAX       4500000              // max baud rate - EM_UART_CLK / 16
+#define EM_UART_SET_BAUD(x,b)  LL_USART_SetBaudRate(x, EM_UART_CLK, b);  // LL API differs by family
+#define EM_UART_RX_LEN         256                  // UART RX circular buffer [B], power of 2, fits pipelined commands
+#define EM_UART_DMA            DMA1                 // UART RX by DMA with idle line IRQ
+#define EM_UART_DMA_CH         LL_DMA_CHANNEL_5
+#define EM_UART_DMA_ADDR(x)    LL_USART_DMA_GetRegAddr(x)
+#define EM_UART_DMA_IRQh       DMA1_Channel5_IRQHandler  // UART RX DMA half/full buffer
+#define EM_UART_DMA_FLAG(a)    a##5                 // HT/TC flags of UART RX channel
 //#define EM_UART_CLEAR_FLAG(x)  LL_USART_ClearFlag_RTO(x);  // RTO flags needs clearing
 #define EM_UART_CLEAR_FLAG(x)  LL_USART_ClearFlag_RXNE(x);  // RXNE flags needs clearing
 #define EM_USB                                      // if emulated USB enabled
+#define EM_USB_FIFO            512                  // USB CDC TX FIFO [B], drained by USB ISR
 //#define EM_UART_POLLINIT                          // if defined poll for init
 
 // LED -------------------------------------------------------------
@@ -139,6 +149,7 @@
 #define EM_TIM_CNTR_CH2        LL_TIM_CHANNEL_CH2 // indirect input capture - channel
 #define EM_TIM_CNTR_CCR        CCR1   // direct input capture - ccr register
 #define EM_TIM_CNTR_CCR2       CCR3   // ovf store - ccr register
+#define EM_TIM_CNTR_CCR3       CCR2   // indirect input capture - ccr register (duty)
 #define EM_TIM_CNTR_CC(a)      a##CC1 // direct input capture - cc name
 #define EM_TIM_CNTR_CC2(a)     a##CC2 // indirect input capture - cc name
 #define EM_TIM_CNTR_OVF(a)     a##CH3 // ovf store
@@ -194,6 +205,8 @@
 #define EM_DMA_CH_LA           LL_DMA_CHANNEL_6
 #define EM_DMA_CH_CNTR         LL_DMA_CHANNEL_2
 #define EM_DMA_CH_CNTR2        LL_DMA_CHANNEL_3
+#define EM_DMA_CNTR_FLAG(a)    a##2                 // TC flag of counter channel
+#define EM_DMA_CNTR_IRQh       DMA1_Channel2_IRQHandler  // counter DMA buffer wraps
 //#define EM_DMA_CH_SGEN       LL_DMA_CHANNEL_2
 
 // IRQ map ---------------------------------------------------------
@@ -202,11 +215,13 @@
 //#define EM_IRQN_ADC3         ADC3_IRQn
 //#define EM_IRQN_ADC4         ADC4_IRQn
 #define EM_IRQN_UART           USART1_IRQn
+#define EM_IRQN_UART_DMA       DMA1_Channel5_IRQn
 #define EM_LA_IRQ_EXTI1        EXTI1_IRQn
 #define EM_LA_IRQ_EXTI2        EXTI2_IRQn
 #define EM_LA_IRQ_EXTI3        EXTI3_IRQn
 #define EM_LA_IRQ_EXTI4        EXTI4_IRQn
 #define EM_CNTR_IRQ            TIM1_UP_TIM16_IRQn
+#define EM_IRQN_CNTR_DMA       DMA1_Channel2_IRQn
 
 // IRQ helpers -----------------------------------------------------
 #define EM_IRQ_ADC1            EM_IRQN_ADC1
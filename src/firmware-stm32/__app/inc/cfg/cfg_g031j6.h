@@ -61,6 +61,16 @@
 // UART -------------------------------------------------------------
 #define EM_UART                USART1               // UART periph
 #define EM_UART_RX_IRQHandler  USART1_IRQHandler    // UART IRQ handler
+#define EM_UART_CLK            64000000             // UART kernel clock - PCLK1
+#define EM_UART_BAUD_MAX       4000000              // max baud rate - EM_UART_CLK / 16
+#define EM_UART_SET_BAUD(x,b)  LL_USART_SetBaudRate(x, EM_UART_CLK, LL_USART_PRESCALER_DIV1, LL_USART_OVERSAMPLING_16, b);  // LL API differs by family
+#define EM_UART_RX_LEN         128                  // UART RX circular buffer [B], power of 2, fits pipelined commands
+#define EM_UART_DMA            DMA1                 // UART RX by DMA with idle line IRQ
+#define EM_UART_DMA_CH         LL_DMA_CHANNEL_5
+#define EM_UART_DMA_REQ        LL_DMAMUX_REQ_USART1_RX
+#define EM_UART_DMA_ADDR(x)    LL_USART_DMA_GetRegAddr(x, LL_USART_DMA_REG_DATA_RECEIVE)
+//#define EM_UART_DMA_IRQh     DMA1_Ch4_5_DMAMUX1_OVR_IRQHandler  // taken by Cube, calls comm_uart_dma_irq()
+#define EM_UART_DMA_FLAG(a)    a##5                 // HT/TC flags of UART RX channel
 //#define EM_UART_CLEAR_FLAG(x)  LL_USART_ClearFlag_RTO(x);  // RTO flags needs clearing
 //#define EM_UART_CLEAR_FLAG(x)  LL_USART_ClearFlag_RXNE(x);  // RXNE flags needs clearing
 //#define EM_USB                                    // if emulated USB enabled
@@ -137,6 +147,7 @@
 #define EM_TIM_CNTR_CH2        LL_TIM_CHANNEL_CH2 // indirect input capture - channel
 #define EM_TIM_CNTR_CCR        CCR1   // direct input capture - ccr register
 #define EM_TIM_CNTR_CCR2       CCR3   // ovf store - ccr register
+#define EM_TIM_CNTR_CCR3       CCR2   // indirect input capture - ccr register (duty)
 #define EM_TIM_CNTR_CC(a)      a##CC1 // direct input capture - cc name
 #define EM_TIM_CNTR_CC2(a)     a##CC2 // indirect input capture - cc name
 #define EM_TIM_CNTR_OVF(a)     a##CH3 // ovf store
@@ -188,6 +199,8 @@
 #define EM_DMA_CH_LA           LL_DMA_CHANNEL_2
 #define EM_DMA_CH_CNTR         LL_DMA_CHANNEL_3
 #define EM_DMA_CH_CNTR2        LL_DMA_CHANNEL_4
+#define EM_DMA_CNTR_FLAG(a)    a##3                 // TC flag of counter channel
+//#define EM_DMA_CNTR_IRQh     DMA1_Channel2_3_IRQHandler  // taken by Cube, DMA wraps polled by TIM update IRQ
 //#define EM_DMA_CH_SGEN       LL_DMA_CHANNEL_2
 
 // IRQ map ---------------------------------------------------------
@@ -196,6 +209,7 @@
 //#define EM_IRQN_ADC3         ADC3_IRQn
 //#define EM_IRQN_ADC4         ADC4_IRQn
 #define EM_IRQN_UART           USART1_IRQn
+#define EM_IRQN_UART_DMA       DMA1_Ch4_5_DMAMUX1_OVR_IRQn
 #define EM_LA_IRQ_EXTI1        EXTI4_15_IRQn
 #define EM_LA_IRQ_EXTI2        EXTI4_15_IRQn
 //#define EM_LA_IRQ_EXTI3      EXTI2_3_IRQn
@@ -6,21 +6,118 @@
 #ifndef INC_CNTR_H_
 #define INC_CNTR_H_
 
+/* reciprocal counter - every input edge (after IC prescaler) is captured by DMA into circular buffer
+ * together with overflow count, so edge timestamp = ovf:ccr (32-bit, wraps after 59 s at 72 MHz):
+ *
+ *   edges are counted by DMA buffer wraps (DMA TC IRQ) + position,
+ *   gate is closed by TIM update IRQ at first overflow after gate time, on last captured edge,
+ *   f = edges * psc / (ts_last - ts_first) * f_tim, next gate starts at the same edge - no dead time.
+ *
+ * ISR only stores edges and ticks of closed gate, counter task computes frequency and running statistics
+ * (min, max, mean, std, Allan deviation of consecutive gates) and pushes new results to host as "ReadyC" record
+ * (same binary record as :CNTR:READ? returns, which reads what is not pushed yet)
+ *
+ * raw capture pauses gates and fills the same buffers once with consecutive edges for :CNTR:RAW?:
+ *   EDGES - ccr + ovf store of each edge, host extends it to 64-bit ticks (period, TIE)
+ *   DUTY  - ccr of rising (direct ch) and falling (indirect ch) edges, timer prescaled so period < 1/2 timer
+ *           period - 16-bit differences are unambiguous without ovf */
+
+#define CNTR_READ_HEAD_LEN  48  // uint32 seq, n, double min, max, mean, std, adev
+#define CNTR_RAW_HEAD_LEN   28  // uint32 mode, len1, len2, IC psc, f_tim, timer psc, uint16 raw_pre, raw_post
+
+enum cntr_raw_state
+{
+    CNTR_RAW_IDLE = 0,
+    CNTR_RAW_REQ  = 1,          // requested by comm
+    CNTR_RAW_BUSY = 2,          // capturing
+    CNTR_RAW_DONE = 3           // waiting for read, gates paused
+};
+
+enum cntr_raw_mode
+{
+    CNTR_RAW_EDGES = 0,
+    CNTR_RAW_DUTY  = 1
+};
+
+typedef struct
+{
+    uint32_t edges;             // input edges in gate
+    uint32_t ticks;             // timer ticks from first to last edge, 0 = no signal
+}cntr_gate_t;
+
+typedef struct
+{
+    uint32_t n;                 // valid gates
+    double min;
+    double max;
+    double mean;
+    double m2;                  // sum of squared deviations from mean (Welford)
+    double prev;                // previous gate, for Allan deviation
+    double a2;                  // sum of squared differences of consecutive gates
+    uint32_t na;                // count of differences
+}cntr_stat_t;
 
 typedef struct
 {
     uint16_t data_ccr[EM_CNTR_BUFF_SZ];
     uint16_t data_ovf[EM_CNTR_BUFF_SZ];
     uint8_t enabled;
-    double freq;
+    double freq;                // last gate [Hz], -1 = no signal
     uint16_t ovf;
+    uint16_t ovf_cnt;           // counter right after ovf store update - older captures may hold previous ovf
+    uint16_t ovf_pre;           // counter right before ovf store update
     uint8_t fast_mode;
     uint8_t fast_mode_now;
+    uint16_t gate_ms;           // gate time
+    volatile uint8_t restart;   // settings changed, start again
+
+    /* gate - ISR */
+    uint16_t len;               // DMA circular buffer len
+    uint32_t wraps;             // DMA buffer wraps
+    uint32_t gate_ovf;          // overflows to close gate
+    uint32_t tout_ovf;          // overflows without edge to report no signal
+    uint32_t elapsed;           // overflows since gate start
+    uint32_t start_edge;        // first edge of gate
+    uint32_t start_ts;          // its timestamp
+    uint8_t started;            // first edge is known
+
+    /* gates closed by ISR, taken by task */
+    cntr_gate_t gates[EM_CNTR_GATES];
+    volatile uint32_t gates_head;
+    volatile uint32_t gates_tail;
+
+    /* results - counter task, read by comm */
+    double res[EM_CNTR_RES_LEN];
+    volatile uint32_t res_head;
+    volatile uint32_t res_tail;
+    uint32_t seq;               // gates since enable
+    cntr_stat_t stat;
+    uint8_t push[CNTR_READ_HEAD_LEN + EM_CNTR_PUSH_LEN * sizeof(double)]; // pushed record, task stack is small
+
+    /* raw capture */
+    volatile enum cntr_raw_state raw_state;
+    enum cntr_raw_mode raw_mode;
+    uint16_t raw_n;             // requested edges
+    uint16_t raw_len1;          // captured edges - ccr
+    uint16_t raw_len2;          // captured edges - ovf store or falling ccr
+    uint32_t raw_div;           // timer prescaler used
+    uint8_t raw_psc;            // IC prescaler used
+    uint8_t raw_end;            // capture complete or timeout, set by ISR
+    uint16_t raw_pre;           // min counter before ovf store write
+    uint16_t raw_post;          // max counter after ovf store write
 }cntr_data_t;
 
 void cntr_init(cntr_data_t* self);
-void cntr_enable(cntr_data_t* self, uint8_t enable, uint8_t fast_mode);
+void cntr_enable(cntr_data_t* self, uint8_t enable, uint8_t fast_mode, uint16_t gate_ms);
 void cntr_start(cntr_data_t* self, uint8_t start);
 void cntr_meas(cntr_data_t* self);
+int cntr_read(cntr_data_t* self, uint8_t* buff, int len);
+uint8_t cntr_raw(cntr_data_t* self, uint16_t n, enum cntr_raw_mode mode);
+int cntr_raw_read(cntr_data_t* self, uint8_t* head);
+void cntr_raw_release(cntr_data_t* self);
+
+uint8_t cntr_dma_wrap(cntr_data_t* self);
+uint8_t cntr_gate_check(cntr_data_t* self, uint16_t cnt);
+uint8_t cntr_raw_check(cntr_data_t* self);
 
 #endif /* INC_CNTR_H_ */
@@ -7,15 +7,27 @@
 #define COMM_H
 
 #include "cfg.h"
+#include "comm_fifo.h"
 
 #include "scpi/scpi.h"
 
+#ifdef EM_RX_BUFF_LEN
+#define RX_BUFF_LEN    EM_RX_BUFF_LEN
+#else
 #define RX_BUFF_LEN    200
+#endif
 #define RX_BUFF_LAST   RX_BUFF_LEN - 1
 
 #define APP_RX_DATA_SIZE  RX_BUFF_LEN
 #define APP_TX_DATA_SIZE  1
 
+#define EM_UART_BAUD          115200    // default baud rate, after reset and when host is gone
+#define EM_UART_BAUD_MIN      9600      // min baud rate of :SYS:BAUD
+#define EM_UART_BAUD_ERR      20        // max baud rate error [per mille]
+#define EM_UART_BAUD_IDLE_MS  3000      // no message at changed baud rate this long -> default baud rate
+
+#define EM_USB_TX_TIMEOUT_MS  100       // USB TX FIFO stays full this long -> host does not read, drop unsent response
+
 void uart_put_text(const char* data);
 
 extern const scpi_command_t scpi_commands[];
@@ -30,19 +42,95 @@ scpi_result_t SCPI_Reset(scpi_t * context);
 scpi_result_t SCPI_Flush(scpi_t * context);
 
 
+/* line end (\r\n) detector - skips data of definite length arbitrary block #<n><len><data>,
+ * binary data may contain \r\n. called per byte by RX IRQs and comm task, so it is kept trivial */
+typedef struct
+{
+    char prev;              // previous byte
+    uint8_t hash;           // '#' received, count of length digits follows
+    uint8_t digits;         // length digits of block left
+    uint32_t len;           // block length being read
+    uint32_t skip;          // block data bytes left
+}comm_eol_t;
+
+static inline uint8_t comm_eol_step(comm_eol_t* self, char c)
+{
+    if (self->skip > 0) // block data
+    {
+        self->skip--;
+        self->prev = 0;
+        return EM_FALSE;
+    }
+
+    if (self->hash)
+    {
+        self->hash = EM_FALSE;
+        if (c > '0' && c <= '9')
+        {
+            self->digits = c - '0';
+            self->len = 0;
+        }
+    }
+    else if (self->digits > 0)
+    {
+        if (c >= '0' && c <= '9')
+        {
+            self->len = self->len * 10 + (c - '0');
+            if (--self->digits == 0)
+                self->skip = (self->len < RX_BUFF_LEN ? self->len : 0); // too long is dropped anyway, keep lines
+        }
+        else
+            self->digits = 0; // not a block
+    }
+    else if (c == '#')
+        self->hash = EM_TRUE;
+    else if (c == '\n' && self->prev == '\r')
+    {
+        self->prev = 0;
+        return EM_TRUE;
+    }
+
+    self->prev = c;
+    return EM_FALSE;
+}
+
 typedef struct
 {
     char rx_buffer[RX_BUFF_LEN];
 
     uint8_t last;
     uint8_t available;
-    uint8_t rx_index;
+    uint16_t rx_index;
+    comm_eol_t eol;         // USB, line end of rx_buffer
 }comm_ch_t;
 
+/* UART RX - DMA (or RXNE IRQ) writes circular buffer, IRQ counts complete lines for comm task */
+typedef struct
+{
+    char buff[EM_UART_RX_LEN];
+
+    volatile uint32_t head;     // received bytes, free running, IRQ
+    uint32_t tail;              // consumed bytes, free running, comm task
+    volatile uint32_t lines;    // complete lines received, IRQ
+    uint32_t lines_read;        // complete lines consumed, comm task
+    comm_eol_t eol;             // line end scan of IRQ
+    volatile uint8_t ovf;       // unread data overwritten, comm task flushes
+}comm_rx_t;
+
 typedef struct
 {
     comm_ch_t usb;
     comm_ch_t uart;
+    comm_rx_t uart_rx;
+#ifdef EM_USB_FIFO
+    comm_fifo_t usb_tx;         // drained by USB ISR
+    uint8_t usb_drop;           // current message dropped, its remaining writes are discarded
+    uint8_t usb_line;           // command line is answered, async message sent by handler is part of it
+#endif
+
+    uint32_t uart_baud;         // current baud rate
+    uint32_t uart_baud_next;    // set by :SYS:BAUD, applied after response is sent
+    uint32_t uart_rx_tick;      // uwTick of last message from UART
 }comm_data_t;
 
 
@@ -50,7 +138,14 @@ comm_data_t* comm_ptr;
 
 void comm_init(comm_data_t* self);
 uint8_t comm_main(comm_data_t* self);
+int32_t comm_cmd_index(const char* header, int len);
 int comm_respond(comm_data_t* self, const char* data, int len);
+uint8_t comm_baud_valid(uint32_t baud);
+void comm_baud_set(comm_data_t* self, uint32_t baud);
 void comm_daq_ready(comm_data_t* self, const char* rdy, uint32_t pos_frst);
+void comm_cntr_ready(comm_data_t* self, const char* rdy, const uint8_t* data, int len);
+#ifdef EM_UART_DMA
+void comm_uart_dma_irq(void);
+#endif
 
 #endif
@@ -0,0 +1,59 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef INC_COMM_FIFO_H_
+#define INC_COMM_FIFO_H_
+
+#include "cfg.h"
+
+#include <stdint.h>
+
+#ifdef EM_USB_FIFO
+#define COMM_FIFO_LEN   EM_USB_FIFO
+#else
+#define COMM_FIFO_LEN   512
+#endif
+
+#define COMM_FIFO_PKT   64      // full-speed bulk max packet size
+
+/* TX FIFO of USB CDC - comm task writes, USB ISR sends it packet by packet:
+ *
+ *   every packet is max COMM_FIFO_PKT bytes, next one is started from IN transfer complete,
+ *   when FIFO runs empty after full packet, ZLP is sent so host ends its read transfer.
+ *
+ * kick (task) and tx_done (ISR) must not preempt each other - call kick with USB IRQ masked.
+ * endpoint is abstract, so framing can run on host against fake endpoint.
+ *
+ * mark starts a message (response line, async message); drop removes it while none of its bytes left,
+ * so host gets whole lines only. */
+
+typedef int (*comm_fifo_ep_t)(const uint8_t* data, uint16_t len); // start IN transfer, 0 = ok
+
+typedef struct
+{
+    uint8_t buff[COMM_FIFO_LEN];    // power of 2
+    uint8_t pkt[COMM_FIFO_PKT];     // packet in flight, its FIFO space is free already
+
+    volatile uint32_t head;         // written bytes, only task
+    volatile uint32_t tail;         // sent bytes, only ISR (or task in kick)
+    uint32_t mark;                  // head at start of current message, only task
+    uint32_t drops;                 // messages dropped, host did not read
+    volatile uint16_t pkt_len;      // last started packet, 0 = ZLP
+    volatile uint8_t busy;          // packet in flight
+    volatile uint8_t waiting;       // writer waits for free space
+
+    comm_fifo_ep_t ep_tx;
+}comm_fifo_t;
+
+void comm_fifo_init(comm_fifo_t* self, comm_fifo_ep_t ep_tx);
+int comm_fifo_write(comm_fifo_t* self, const char* data, int len);
+uint32_t comm_fifo_used(comm_fifo_t* self);
+uint32_t comm_fifo_free(comm_fifo_t* self);
+uint8_t comm_fifo_kick(comm_fifo_t* self);
+uint8_t comm_fifo_tx_done(comm_fifo_t* self);
+void comm_fifo_mark(comm_fifo_t* self);
+uint8_t comm_fifo_drop(comm_fifo_t* self);
+
+#endif /* INC_COMM_FIFO_H_ */
@@ -0,0 +1,27 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+/* generated by scripts/scpi_hash.py from scpi_commands[] in comm.c - do not edit */
+
+#ifndef INC_COMM_HASH_H_
+#define INC_COMM_HASH_H_
+
+#include <stdint.h>
+
+#define COMM_HASH_CMDS      32          // entries of scpi_commands[], table is not used if they differ
+#define COMM_HASH_PREFIX    3           // chars of every mnemonic in key
+#define COMM_HASH_SEED      33473u
+#define COMM_HASH_BITS      6
+
+/* top COMM_HASH_BITS of FNV-1a of key -> index of command + 1, 0 = none */
+static const uint8_t comm_hash_table[1 << COMM_HASH_BITS] =
+{
+     8,  0,  0, 12, 32, 22, 23,  0,  0,  0, 25, 17,  0,  0,  1,  0,
+     0, 21,  9,  0, 13,  0, 10, 11,  0,  0,  0, 28, 20, 24,  0,  0,
+    14,  0,  3, 29,  7, 18,  0, 15,  0, 31,  0,  4, 19, 16,  0,  0,
+    26,  0,  5,  0,  2,  0,  0, 27,  0,  0, 30,  0,  0,  0,  0,  6,
+};
+
+#endif /* INC_COMM_HASH_H_ */
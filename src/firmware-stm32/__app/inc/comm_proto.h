@@ -15,6 +15,9 @@ scpi_result_t EM_SYS_ModeQ(scpi_t * context);
 scpi_result_t EM_SYS_LimitsQ(scpi_t * context);
 scpi_result_t EM_SYS_InfoQ(scpi_t * context);
 scpi_result_t EM_SYS_UptimeQ(scpi_t* context);
+scpi_result_t EM_SYS_Baud(scpi_t* context);
+scpi_result_t EM_SYS_BaudQ(scpi_t* context);
+scpi_result_t EM_SYS_RearmQ(scpi_t* context);
 
 scpi_result_t EM_VM_ReadQ(scpi_t * context);
 
@@ -31,9 +34,13 @@ scpi_result_t EM_LA_ForceTrig(scpi_t * context);
 scpi_result_t EM_CNTR_SetQ(scpi_t * context);
 scpi_result_t EM_CNTR_Set(scpi_t * context);
 scpi_result_t EM_CNTR_ReadQ(scpi_t * context);
+scpi_result_t EM_CNTR_Raw(scpi_t * context);
+scpi_result_t EM_CNTR_RawQ(scpi_t * context);
 
 scpi_result_t EM_SGEN_SetQ(scpi_t * context);
 scpi_result_t EM_SGEN_Set(scpi_t * context);
+scpi_result_t EM_SGEN_ArbQ(scpi_t * context);
+scpi_result_t EM_SGEN_Arb(scpi_t * context);
 
 scpi_result_t EM_PWM_SetQ(scpi_t * context);
 scpi_result_t EM_PWM_Set(scpi_t * context);
@@ -6,6 +6,8 @@
 #ifndef INC_DAQ_H_
 #define INC_DAQ_H_
 
+#include "trig_qual.h"
+
 
 enum daq_mode
 {
@@ -44,6 +46,9 @@ typedef struct
     int ch;                 // channel 1-4
     int val;                // raw ADC value
     int val_percent;        // percentage trig val
+    int hyst;               // hysteresis percentage 0-50
+    int holdoff;            // holdoff ms after valid trig
+    int width;              // min samples behind level before edge
 }trig_settings_t;
 
 typedef struct
@@ -82,10 +87,16 @@ typedef struct
     // awd limits
     uint32_t awd_hi;        // ADC AWD high limit raw value
     uint32_t awd_mid;       // ADC AWD trigger limit raw value
+    uint32_t awd_rearm;     // ADC AWD rearm limit raw value (trigger -/+ hysteresis)
     uint32_t awd_lo;        // ADC AWD low limit raw value
     uint8_t awd_rising;     // AWD limits state, either rising or falling - defined by user
     uint8_t awd_rising2;    // AWD limits state, either rising or falling - current value
 
+    // qualifier
+    trig_qual_t qual;       // hysteresis and pulse width qualifier of AWD hits
+    uint32_t holdoff_tick;  // systick timestamp of last valid trig
+    int qual_cntr;          // AWD hits rejected by qualifier or holdoff
+
     // misc
     uint32_t uwtick_first;  // systick timestamp when sampling start
     int pretrig_cntr;       // pre trig counter - ms
@@ -110,6 +121,8 @@ typedef struct
     uint8_t post_start;     // flag when set posttrigger counting starts
     int post_from;          // position from where start counting posttrigger
     int dma_pos_catched;    // catched actual DMA circular buffer position
+    int post_sum;           // posttrigger samples counted so far
+    int post_dma;           // DMA data length at last posttrigger check
 }daq_trig_data_t;
 
 typedef struct
@@ -154,6 +167,10 @@ typedef struct
     uint8_t interleaved;    // interleaved enabled
     uint8_t dualmode;       // dual mode enabled
 
+    uint32_t rearm_us;      // debug - last enable/disable settle time
+    uint32_t rearm_max_us;  // debug - max enable/disable settle time
+    uint32_t rearm_tout;    // debug - settle timeouts count
+
     daq_trig_data_t trig;       // trigger substruct
 }daq_data_t;
 
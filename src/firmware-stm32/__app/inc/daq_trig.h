@@ -14,8 +14,16 @@ int8_t daq_trig_trigger_scope(daq_data_t* self);
 int8_t daq_trig_trigger_la(daq_data_t* self);
 int8_t daq_trig_poststart(daq_data_t* self, int pos);
 void daq_trig_postcount(daq_data_t* self);
+int daq_trig_postwait(daq_data_t* self);
 void daq_trig_init(daq_data_t* self);
 void daq_trig_update(daq_data_t* self);
+int daq_trig_qual_set(daq_data_t* self, int hyst, int holdoff, int width);
 int daq_trig_set(daq_data_t* self, uint32_t ch, uint8_t level, enum trig_edge edge, enum trig_mode mode, int pretrigger);
 
+/* pure helpers of posttrigger counting, no periph access */
+void daq_trig_post_pos(int from, int order, int chans, int len, int mem, int pretrigger, uint8_t la,
+                       int* pos_trig, int* pos_frst, int* pos_last, int* post_size);
+int daq_trig_post_moved(int dma_prev, int dma_now, int len);
+int daq_trig_post_ms(int left, int per_event, double f_event);
+
 #endif /* INC_DAQ_TRIG_H_ */
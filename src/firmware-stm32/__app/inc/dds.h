@@ -0,0 +1,62 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef INC_DDS_H_
+#define INC_DDS_H_
+
+#include <stdint.h>
+
+#define DDS_LUT_BITS    8                       // quarter wave LUT entries = 2^bits (+1 for interpolation)
+#define DDS_LUT_LEN     (1 << DDS_LUT_BITS)
+
+/* direct digital synthesis - 32-bit phase accumulator, 2^32 = 1 period:
+ *
+ *   phase += step every sample, step = f / fs * 2^32  ->  resolution fs / 2^32 (< 1 mHz)
+ *   sine = quarter wave LUT, mirrored by 2 top bits of phase, linear interpolation by next 15 bits
+ *
+ * new settings are only pending until next fill, so when DMA half buffers are refilled from ISR,
+ * frequency / amplitude / wave change at buffer boundary with continuous phase - no glitch.
+ * no periph access, so it is built and checked against reference on host too. */
+
+enum dds_wave                   // same order as sgen_mode
+{
+    DDS_CONST    = 0,
+    DDS_SINE     = 1,
+    DDS_TRIANGLE = 2,
+    DDS_SAWTOOTH = 3,
+    DDS_SQUARE   = 4,
+    DDS_NOISE    = 5
+};
+
+typedef struct
+{
+    enum dds_wave wave;
+    uint32_t step;              // phase increment per sample
+    uint16_t ampl;              // peak to peak [LSB]
+    uint16_t offset;            // bottom of wave [LSB]
+    uint16_t max;               // DAC max value
+}dds_set_t;
+
+typedef struct
+{
+    dds_set_t now;              // used by fill (ISR)
+    volatile dds_set_t next;    // written by task
+    volatile uint8_t pending;   // next is complete, take it at next fill
+
+    uint32_t phase;             // accumulator
+    int rnd_w;                  // noise generator state
+    int rnd_z;
+}dds_t;
+
+void dds_init(dds_t* self);
+void dds_set(dds_t* self, enum dds_wave wave, uint32_t step, uint16_t ampl, uint16_t offset, uint16_t max);
+void dds_reset(dds_t* self);
+void dds_fill(dds_t* self, uint32_t* data, int len);
+
+uint32_t dds_step(double f, double fs);
+double dds_freq(uint32_t step, double fs);
+int32_t dds_sin(uint32_t phase);
+
+#endif /* INC_DDS_H_ */
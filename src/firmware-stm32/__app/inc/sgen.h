@@ -7,6 +7,7 @@
 #define INC_SGEN_H_
 
 #include "cfg.h"
+#include "dds.h"
 
 #ifdef EM_DAC
 
@@ -17,26 +18,41 @@ enum sgen_mode
     TRIANGLE = 2,
     SAWTOOTH = 3,
     SQUARE   = 4,
-    NOISE    = 5
+    NOISE    = 5,
+    ARB      = 6    // samples uploaded by :SGEN:ARB
 };
 
+/* waves are synthesized by DDS (dds.h), two ways:
+ *
+ *   table - one period of samples, DMA loops it, timer = f * samples      (f > EM_SGEN_DDS_MAX_F, const)
+ *   DDS   - fixed timer EM_SGEN_DDS_FS, DMA IRQ refills half buffer just played, fine freq resolution,
+ *           new settings while enabled go on without DMA restart
+ *
+ * ARB plays samples uploaded to data by chunks (sgen_arb_write) as table, f = repetition rate of them all */
+
 typedef struct
 {
     uint8_t enabled;
+    uint8_t dds_on;                 // running in DDS mode, buffer refilled from DMA IRQ
     enum sgen_mode mode;
-    int freq;
+    double freq;
+    double freq_real;
     float ampl;
     int tim_f;
     double tim_f_real;
     int samples;
     int offset;
+    int arb_len;                    // uploaded samples in data, 0 = data holds generated wave
+    dds_t dds;
     uint32_t data[EM_DAC_BUFF_LEN];
 }sgen_data_t;
 
 
 void sgen_init(sgen_data_t* self);
-void sgen_enable(sgen_data_t* self, enum sgen_mode mode, float A, float f, int offset);
+void sgen_enable(sgen_data_t* self, enum sgen_mode mode, float A, double f, int offset);
 void sgen_disable(sgen_data_t* self);
+void sgen_dds_refill(sgen_data_t* self, uint8_t second);
+int sgen_arb_write(sgen_data_t* self, int offset, const uint8_t* data, int count);
 
 #endif
 
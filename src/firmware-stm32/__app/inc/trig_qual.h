@@ -0,0 +1,81 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef INC_TRIG_QUAL_H_
+#define INC_TRIG_QUAL_H_
+
+#include <stdint.h>
+
+/* trigger qualifier - edge is valid only after signal went back behind rearm level (hysteresis)
+ * and stayed behind trigger level for at least width samples (min pulse width):
+ *
+ *   rising:   ---- level ----------/‾‾‾‾‾   edge valid if >= width samples <= level before it
+ *             ---- rearm = level - hyst     and since last edge signal was <= rearm
+ *
+ * integer only (raw ADC values), runs in AWD ISR over window just written by DMA. no periph access,
+ * so it is built and benchmarked on host too. */
+
+enum trig_qual_state
+{
+    TQ_REARM = 0,           // wait for signal behind rearm level
+    TQ_ARMED = 1            // count samples behind trigger level, edge may come
+};
+
+typedef struct
+{
+    // settings
+    uint16_t level;         // raw trigger level
+    uint16_t rearm;         // raw rearm level (level -/+ hysteresis)
+    uint16_t width;         // min samples behind level before edge, 0 = off
+    uint8_t rising;         // edge rising or falling
+
+    // state
+    enum trig_qual_state state;
+    uint16_t run;           // samples behind level in ARMED, saturated at width
+}trig_qual_t;
+
+void trig_qual_init(trig_qual_t* self, uint16_t level, uint16_t hyst, uint16_t width, uint8_t rising, uint16_t max);
+void trig_qual_reset(trig_qual_t* self, enum trig_qual_state state);
+int trig_qual_run(trig_qual_t* self, const void* data, uint8_t b8, int last, int cnt, int stride, int len);
+
+static inline uint8_t trig_qual_step(trig_qual_t* self, uint16_t x)
+{
+    uint8_t behind = (self->rising ? x <= self->level : x >= self->level);
+
+    if (self->state == TQ_REARM)
+    {
+        if (self->rising ? x <= self->rearm : x >= self->rearm)
+        {
+            self->state = TQ_ARMED;
+            self->run = 1;
+        }
+        return 0;
+    }
+
+    if (behind)
+    {
+        if (self->run < self->width || self->run == 0)
+            self->run++;
+        return 0;
+    }
+
+    uint8_t valid = (self->run >= self->width && self->run > 0); // crossing, not just level above
+
+    self->state = TQ_REARM; // valid or not, next edge needs rearm again
+    if (self->level == self->rearm)
+    {
+        self->state = TQ_ARMED; // no hysteresis
+        self->run = 0;
+    }
+    return valid;
+}
+
+/* holdoff since last valid trigger passed, tick counter may wrap */
+static inline uint8_t trig_qual_holdoff(uint32_t now, uint32_t last, uint32_t holdoff)
+{
+    return (uint32_t)(now - last) >= holdoff;
+}
+
+#endif /* INC_TRIG_QUAL_H_ */
@@ -17,6 +17,10 @@
 #include "task.h"
 #include "semphr.h"
 
+#ifdef EM_USB_FIFO
+#include "usbd_cdc_if.h"
+#endif
+
 #ifdef EM_SYSVIEW
 #include "SEGGER_SYSVIEW.h"
 #endif
@@ -77,14 +81,20 @@ void app_main(void)
     LL_SYSTICK_EnableIT();
 
     /* Semaphores */
-    sem1_comm = xSemaphoreCreateBinaryStatic(&buff_sem1_comm);
+    sem1_comm = xSemaphoreCreateCountingStatic(2, 0, &buff_sem1_comm); // one wake per channel, UART and USB
     sem2_trig = xSemaphoreCreateBinaryStatic(&buff_sem2_trig);
     sem3_cntr = xSemaphoreCreateBinaryStatic(&buff_sem3_cntr);
+    sem5_cntr = xSemaphoreCreateBinaryStatic(&buff_sem5_cntr);
+#ifdef EM_USB_FIFO
+    sem4_usb = xSemaphoreCreateBinaryStatic(&buff_sem4_usb);
+    ASSERT(sem4_usb != NULL);
+#endif
     mtx1 = xSemaphoreCreateMutexStatic(&buff_mtx1);
 
     ASSERT(sem1_comm != NULL);
     ASSERT(sem2_trig != NULL);
     ASSERT(sem3_cntr != NULL);
+    ASSERT(sem5_cntr != NULL);
     ASSERT(mtx1 != NULL);
 
     /* Tasks */
@@ -113,6 +123,13 @@ void t1_wd(void* p)
         iwdg_feed(); // feed watchdog
         led_blink_do(&led, daq.uwTick); // blink led optionaly
 
+        if (comm.uart_baud != EM_UART_BAUD && (int32_t)(daq.uwTick - comm.uart_rx_tick) > EM_UART_BAUD_IDLE_MS) // host gone or failed
+        {
+            ASSERT(xSemaphoreTake(mtx1, portMAX_DELAY) == pdPASS);
+            comm_baud_set(&comm, EM_UART_BAUD);
+            ASSERT(xSemaphoreGive(mtx1) == pdPASS);
+        }
+
         vTaskDelay(10);
 
 #ifdef EM_DEBUG
@@ -152,7 +169,15 @@ void t3_trig_post_count(void* p)
         ASSERT(xSemaphoreTake(sem2_trig, portMAX_DELAY) == pdPASS);
         ASSERT(xSemaphoreTake(mtx1, portMAX_DELAY) == pdPASS);
 
-        daq_trig_postcount(&daq); // count post-trigger and send Ready
+        daq_trig_postcount(&daq); // post-trigger positions
+
+        int wait_ms;
+        while ((wait_ms = daq_trig_postwait(&daq)) > 0) // count post-trigger and send Ready, comm runs meanwhile
+        {
+            ASSERT(xSemaphoreGive(mtx1) == pdPASS);
+            vTaskDelay(wait_ms);
+            ASSERT(xSemaphoreTake(mtx1, portMAX_DELAY) == pdPASS);
+        }
 
         ASSERT(xSemaphoreGive(mtx1) == pdPASS);
 
@@ -205,6 +230,10 @@ void t4_comm_and_init(void* p)
         comm.uart.available = EM_FALSE;
         comm.usb.available = EM_FALSE;
 
+#ifdef EM_USB_FIFO
+        CDC_RxResume_FS(); // USB packet held back while message was pending
+#endif
+
         ASSERT(xSemaphoreGive(mtx1) == pdPASS);
 
 #ifdef EM_DEBUG
@@ -224,8 +253,7 @@ void t5_cntr(void* p)
 
         while (cntr.enabled)
         {
-            cntr_meas(&cntr); // calc freq from counter measured data
-            vTaskDelay(50);
+            cntr_meas(&cntr); // runs until disabled or settings changed, gates closed by ISR
 
 #ifdef EM_DEBUG
         watermark_t5 = uxTaskGetStackHighWaterMark(NULL);
@@ -52,4 +52,13 @@ const uint32_t EM_ADC_SMPLT[EM_ADC_SMPLT_CNT] = { LL_ADC_SAMPLINGTIME_1CYCLE_5,
                                                   LL_ADC_SAMPLINGTIME_79CYCLES_5, LL_ADC_SAMPLINGTIME_160CYCLES_5};
 const float EM_ADC_SMPLT_N[EM_ADC_SMPLT_CNT]  = { 1.5, 3.5, 7.5, 12.5, 19.5, 39.5, 79.5, 160.5};
 
+#elif defined (EMBO_HOST)
+
+#include "stm32_host_ll.h"
+
+const uint32_t EM_ADC_SMPLT[EM_ADC_SMPLT_CNT] = { LL_ADC_SAMPLINGTIME_1CYCLE_5, LL_ADC_SAMPLINGTIME_7CYCLES_5, LL_ADC_SAMPLINGTIME_13CYCLES_5,
+                                                  LL_ADC_SAMPLINGTIME_28CYCLES_5, LL_ADC_SAMPLINGTIME_41CYCLES_5, LL_ADC_SAMPLINGTIME_55CYCLES_5,
+                                                  LL_ADC_SAMPLINGTIME_71CYCLES_5, LL_ADC_SAMPLINGTIME_239CYCLES_5};
+const float EM_ADC_SMPLT_N[EM_ADC_SMPLT_CNT]  = { 1.5, 7.5, 13.5, 28.5, 41.5, 55.5, 71.5, 239.5};
+
 #endif
@@ -7,15 +7,23 @@
 #include "cntr.h"
 
 #include "app_sync.h"
+#include "comm.h"
 #include "periph.h"
+#include "utility.h"
 #include "main.h"
 
 #include "FreeRTOS.h"
+#include "semphr.h"
 
 #include <string.h>
+#include <math.h>
 
 
 static void cntr_reset(cntr_data_t* self);
+static uint32_t cntr_ts(cntr_data_t* self, uint32_t idx, uint16_t cnt);
+static void cntr_gate_push(cntr_data_t* self, uint32_t edges, uint32_t ticks);
+static void cntr_res_push(cntr_data_t* self, double f);
+static void cntr_raw_capture(cntr_data_t* self);
 
 
 void cntr_init(cntr_data_t* self)
@@ -24,26 +32,58 @@ void cntr_init(cntr_data_t* self)
     self->enabled = EM_FALSE;
     self->fast_mode = EM_FALSE;
     self->fast_mode_now = 0;
+    self->gate_ms = EM_CNTR_GATE_MS;
+    self->restart = EM_FALSE;
+    self->raw_state = CNTR_RAW_IDLE;
 
     NVIC_SetPriority(EM_CNTR_IRQ, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), EM_IT_PRI_CNTR, 0));
+#ifdef EM_DMA_CNTR_IRQh
+    NVIC_SetPriority(EM_IRQN_CNTR_DMA, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), EM_IT_PRI_CNTR, 0));
+#endif
     //cntr_reset(self); REMOVED 29.5.21
 }
 
 static void cntr_reset(cntr_data_t* self)
 {
     self->ovf = 0;
+    self->ovf_cnt = 0;
     self->fast_mode_now = self->fast_mode == EM_TRUE;
+    self->len = self->fast_mode_now ? EM_CNTR_BUFF_SZ : EM_CNTR_BUFF_SZ2;
+
+    /* gate and no signal timeout in timer overflows, at least one */
+    uint64_t ovf_ticks = (uint64_t)EM_TIM_CNTR_MAX + 1;
+    self->gate_ovf = ((uint64_t)self->gate_ms * EM_TIM_CNTR_FREQ / 1000 + ovf_ticks - 1) / ovf_ticks;
+    if (self->gate_ovf == 0)
+        self->gate_ovf = 1;
+    self->tout_ovf = self->gate_ovf + ((uint64_t)EM_CNTR_MEAS_MS * EM_TIM_CNTR_FREQ / 1000) / ovf_ticks;
+
+    self->wraps = 0;
+    self->elapsed = 0;
+    self->start_edge = 0;
+    self->start_ts = 0;
+    self->started = EM_FALSE;
+    self->gates_head = 0;
+    self->gates_tail = 0;
 
     memset(self->data_ccr, 0, EM_CNTR_BUFF_SZ * sizeof(uint16_t));
     memset(self->data_ovf, 0, EM_CNTR_BUFF_SZ * sizeof(uint16_t));
 
+    /* circular - edges are counted by buffer wraps, no restart between gates */
+    LL_DMA_DisableChannel(EM_DMA_CNTR, EM_DMA_CH_CNTR);
+    LL_DMA_DisableChannel(EM_DMA_CNTR2, EM_DMA_CH_CNTR2);
+    LL_DMA_SetMode(EM_DMA_CNTR, EM_DMA_CH_CNTR, LL_DMA_MODE_CIRCULAR);
+    LL_DMA_SetMode(EM_DMA_CNTR2, EM_DMA_CH_CNTR2, LL_DMA_MODE_CIRCULAR);
+    EM_DMA_CNTR_FLAG(LL_DMA_ClearFlag_TC)(EM_DMA_CNTR);
+
     dma_set((uint32_t)&EM_TIM_CNTR->EM_TIM_CNTR_CCR, EM_DMA_CNTR, EM_DMA_CH_CNTR, (uint32_t)&self->data_ccr,
-            self->fast_mode_now ? EM_CNTR_BUFF_SZ : EM_CNTR_BUFF_SZ2,
-            LL_DMA_PDATAALIGN_HALFWORD, LL_DMA_MDATAALIGN_HALFWORD, LL_DMA_DIRECTION_PERIPH_TO_MEMORY);
+            self->len, LL_DMA_PDATAALIGN_HALFWORD, LL_DMA_MDATAALIGN_HALFWORD, LL_DMA_DIRECTION_PERIPH_TO_MEMORY);
 
     dma_set((uint32_t)&EM_TIM_CNTR->EM_TIM_CNTR_CCR2, EM_DMA_CNTR2, EM_DMA_CH_CNTR2, (uint32_t)&self->data_ovf,
-            self->fast_mode_now ? EM_CNTR_BUFF_SZ : EM_CNTR_BUFF_SZ2,
-            LL_DMA_PDATAALIGN_HALFWORD, LL_DMA_MDATAALIGN_HALFWORD, LL_DMA_DIRECTION_PERIPH_TO_MEMORY);
+            self->len, LL_DMA_PDATAALIGN_HALFWORD, LL_DMA_MDATAALIGN_HALFWORD, LL_DMA_DIRECTION_PERIPH_TO_MEMORY);
+
+#ifdef EM_DMA_CNTR_IRQh
+    LL_DMA_EnableIT_TC(EM_DMA_CNTR, EM_DMA_CH_CNTR);
+#endif
 
     LL_TIM_EnableIT_UPDATE(EM_TIM_CNTR);
     EM_TIM_CNTR_OVF(LL_TIM_OC_SetCompare)(EM_TIM_CNTR, 0);
@@ -53,11 +93,13 @@ static void cntr_reset(cntr_data_t* self)
     LL_TIM_IC_SetPrescaler(EM_TIM_CNTR, EM_TIM_CNTR_CH2, self->fast_mode_now ? LL_TIM_ICPSC_DIV8 : LL_TIM_ICPSC_DIV1);
 }
 
-void cntr_enable(cntr_data_t* self, uint8_t enable, uint8_t fast_mode)
+void cntr_enable(cntr_data_t* self, uint8_t enable, uint8_t fast_mode, uint16_t gate_ms)
 {
     uint8_t en = self->enabled;
     self->enabled = enable;
     self->fast_mode = fast_mode;
+    self->gate_ms = gate_ms;
+    self->raw_state = CNTR_RAW_IDLE; // pending or unread raw capture is dropped
 
     if (en == EM_FALSE && enable == EM_TRUE)
         self->freq = -1;
@@ -67,10 +109,16 @@ void cntr_enable(cntr_data_t* self, uint8_t enable, uint8_t fast_mode)
     else if (enable == EM_FALSE && en == EM_TRUE)
         xSemaphoreTake(sem3_cntr, 0);
 
+    if (en == EM_TRUE) // running meas takes new settings or ends
+    {
+        self->restart = EM_TRUE;
+        xSemaphoreGive(sem5_cntr);
+    }
+
     if (enable == EM_FALSE) // ADDED 29.5.21
     {
         LL_DMA_DisableChannel(EM_DMA_CNTR, EM_DMA_CH_CNTR);
-        LL_DMA_DisableChannel(EM_DMA_CNTR, EM_DMA_CH_CNTR2);
+        LL_DMA_DisableChannel(EM_DMA_CNTR2, EM_DMA_CH_CNTR2);
     }
 }
 
@@ -82,6 +130,9 @@ void cntr_start(cntr_data_t* self, uint8_t start)
 
         EM_TIM_CNTR_CC(LL_TIM_EnableDMAReq_)(EM_TIM_CNTR);
         EM_TIM_CNTR_CC2(LL_TIM_EnableDMAReq_)(EM_TIM_CNTR);
+#ifdef EM_DMA_CNTR_IRQh
+        NVIC_EnableIRQ(EM_IRQN_CNTR_DMA);
+#endif
         NVIC_EnableIRQ(EM_CNTR_IRQ);
         LL_TIM_CC_EnableChannel(EM_TIM_CNTR, EM_TIM_CNTR_CH);
         LL_TIM_CC_EnableChannel(EM_TIM_CNTR, EM_TIM_CNTR_CH2);
@@ -93,66 +144,426 @@ void cntr_start(cntr_data_t* self, uint8_t start)
         LL_TIM_CC_DisableChannel(EM_TIM_CNTR, EM_TIM_CNTR_CH);
         LL_TIM_CC_DisableChannel(EM_TIM_CNTR, EM_TIM_CNTR_CH2);
         NVIC_DisableIRQ(EM_CNTR_IRQ);
+#ifdef EM_DMA_CNTR_IRQh
+        NVIC_DisableIRQ(EM_IRQN_CNTR_DMA);
+        LL_DMA_DisableIT_TC(EM_DMA_CNTR, EM_DMA_CH_CNTR);
+#endif
         EM_TIM_CNTR_CC(LL_TIM_DisableDMAReq_)(EM_TIM_CNTR);
         EM_TIM_CNTR_CC2(LL_TIM_DisableDMAReq_)(EM_TIM_CNTR);
     }
 }
 
+/* counter task - waits for gates closed by ISR, no busy polling of DMA */
 void cntr_meas(cntr_data_t* self)
 {
-    int pre_timeout = 0;
-    int cntr_timeout = 0;
-    uint32_t sz = 0;
+    if (self->raw_state == CNTR_RAW_REQ)
+    {
+        cntr_raw_capture(self);
+        return;
+    }
+    if (self->raw_state == CNTR_RAW_DONE) // gates paused until raw capture is read
+    {
+        xSemaphoreTake(sem5_cntr, EM_CNTR_MEAS_MS);
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    self->restart = EM_FALSE;
+    self->res_head = 0;
+    self->res_tail = 0;
+    self->seq = 0;
+    memset(&self->stat, 0, sizeof(cntr_stat_t));
+    taskEXIT_CRITICAL();
 
+    xSemaphoreTake(sem5_cntr, 0);
     cntr_start(self, 1); // start
 
-    while (1) // wait DMA fill buffer or timeout
+    double psc = self->fast_mode_now ? EM_TIM_CNTR_PSC_FAST : 1;
+
+    while (self->enabled && !self->restart && self->raw_state == CNTR_RAW_IDLE)
     {
-        sz = LL_DMA_GetDataLength(EM_DMA_CNTR, EM_DMA_CH_CNTR);
+        xSemaphoreTake(sem5_cntr, EM_CNTR_MEAS_MS);
+
+        uint8_t closed = self->gates_tail != self->gates_head;
 
-        if (pre_timeout > 1000)
+        while (self->gates_tail != self->gates_head)
         {
-            vTaskDelay(EM_CNTR_INT_DELAY);
-            cntr_timeout += EM_CNTR_INT_DELAY;
+            cntr_gate_t* g = &self->gates[self->gates_tail % EM_CNTR_GATES];
+            double f = -1; // no signal
+
+            if (g->ticks > 0)
+                f = (double)g->edges * psc * (double)EM_TIM_CNTR_FREQ / (double)g->ticks;
+
+            self->gates_tail++;
+
+            taskENTER_CRITICAL();
+            cntr_res_push(self, f);
+            taskEXIT_CRITICAL();
         }
 
-        pre_timeout++;
+        if (closed) // push new gates to host, mutex keeps record out of other responses
+        {
+            ASSERT(xSemaphoreTake(mtx1, portMAX_DELAY) == pdPASS);
 
-        if (cntr_timeout > EM_CNTR_MEAS_MS || sz == 0)
-            break;
+            int len;
+            while ((len = cntr_read(self, self->push, sizeof(self->push))) > 0)
+                comm_cntr_ready(comm_ptr, EM_RESP_RDY_C, self->push, len);
+
+            ASSERT(xSemaphoreGive(mtx1) == pdPASS);
+        }
     }
 
     cntr_start(self, 0); // stop
+}
+
+/* binary result of new gates since last read:
+ *   uint32 seq, uint32 n, double min, max, mean, std, adev (fractional), then new gates as double [Hz], -1 = no signal
+ * returns length, 0 = nothing new */
+int cntr_read(cntr_data_t* self, uint8_t* buff, int len)
+{
+    const int head_len = CNTR_READ_HEAD_LEN;
+    uint32_t u32[2];
+    double d[5];
+    int ret = 0;
+
+    taskENTER_CRITICAL();
 
-    sz = (self->fast_mode_now ? EM_CNTR_BUFF_SZ : EM_CNTR_BUFF_SZ2) - sz; // get data size
+    uint32_t cnt = self->res_head - self->res_tail;
 
-    if (sz >= 2)
+    if (cnt > 0 && len >= head_len + (int)sizeof(double))
     {
-        uint16_t ovf = 0;
-        uint32_t ccr_sum = 0;
+        cntr_stat_t* s = &self->stat;
 
-        ovf = self->data_ovf[sz - 1] - self->data_ovf[0];
+        u32[0] = self->seq;
+        u32[1] = s->n;
+        d[0] = s->n > 0 ? s->min : -1;
+        d[1] = s->n > 0 ? s->max : -1;
+        d[2] = s->n > 0 ? s->mean : -1;
+        d[3] = s->n > 1 ? sqrt(s->m2 / (s->n - 1)) : 0;
+        d[4] = s->na > 0 && s->mean > 0 ? sqrt(s->a2 / (2.0 * s->na)) / s->mean : 0;
 
-        if (ovf > 0) // prepare overflow bit values
+        memcpy(buff, u32, sizeof(u32));
+        memcpy(buff + sizeof(u32), d, sizeof(d));
+        ret = head_len;
+
+        for (; cnt > 0 && ret + (int)sizeof(double) <= len; cnt--, ret += sizeof(double))
         {
-            ccr_sum += (EM_TIM_CNTR_MAX - self->data_ccr[0]) + self->data_ccr[sz - 1];
-            ovf -= 1;
+            memcpy(buff + ret, &self->res[self->res_tail % EM_CNTR_RES_LEN], sizeof(double));
+            self->res_tail++;
+        }
+    }
+
+    taskEXIT_CRITICAL();
+
+    return ret;
+}
+
+/* request raw capture of n edges, taken by counter task. duty mode needs known frequency to prescale timer */
+uint8_t cntr_raw(cntr_data_t* self, uint16_t n, enum cntr_raw_mode mode)
+{
+    uint32_t div = 1;
+
+    if (mode == CNTR_RAW_DUTY)
+    {
+        if (self->freq <= 0)
+            return EM_FALSE;
+
+        div = (uint32_t)((double)EM_TIM_CNTR_FREQ / self->freq / (((uint32_t)EM_TIM_CNTR_MAX + 1) / 2)) + 1;
+        if (div > (uint32_t)EM_TIM_CNTR_MAX + 1)
+            div = (uint32_t)EM_TIM_CNTR_MAX + 1;
+    }
+
+    taskENTER_CRITICAL();
+    self->raw_n = n;
+    self->raw_mode = mode;
+    self->raw_div = div;
+    self->raw_state = CNTR_RAW_REQ;
+    taskEXIT_CRITICAL();
+
+    xSemaphoreGive(sem5_cntr); // running gates end
+    return EM_TRUE;
+}
+
+/* header of finished raw capture, data follow in data_ccr (len1) and data_ovf (len2) until released.
+ * returns header length, 0 = not finished yet */
+int cntr_raw_read(cntr_data_t* self, uint8_t* head)
+{
+    if (self->raw_state != CNTR_RAW_DONE)
+        return 0;
+
+    uint32_t u32[6] = { self->raw_mode, self->raw_len1, self->raw_len2, self->raw_psc,
+                        EM_TIM_CNTR_FREQ, self->raw_div };
+    uint16_t u16[2] = { self->raw_pre, self->raw_post };
+
+    memcpy(head, u32, sizeof(u32));
+    memcpy(head + sizeof(u32), u16, sizeof(u16));
+
+    return CNTR_RAW_HEAD_LEN;
+}
+
+/* raw data were sent, gates continue */
+void cntr_raw_release(cntr_data_t* self)
+{
+    if (self->raw_state == CNTR_RAW_DONE)
+    {
+        self->raw_state = CNTR_RAW_IDLE;
+        xSemaphoreGive(sem5_cntr);
+    }
+}
+
+/* called from TIM update IRQ instead of gate check during raw capture, returns 1 once when finished */
+uint8_t cntr_raw_check(cntr_data_t* self)
+{
+    if (self->ovf > 0) // counter at ovf store write of previous IRQ - range for host timestamp correction
+    {
+        if (self->ovf_pre < self->raw_pre)
+            self->raw_pre = self->ovf_pre;
+        if (self->ovf_cnt > self->raw_post)
+            self->raw_post = self->ovf_cnt;
+    }
+
+    self->elapsed++;
+
+    if (self->raw_end)
+        return EM_FALSE;
+
+    if ((LL_DMA_GetDataLength(EM_DMA_CNTR, EM_DMA_CH_CNTR) == 0 &&
+         LL_DMA_GetDataLength(EM_DMA_CNTR2, EM_DMA_CH_CNTR2) == 0) || self->elapsed >= self->tout_ovf)
+    {
+        self->raw_end = EM_TRUE;
+        return EM_TRUE;
+    }
+    return EM_FALSE;
+}
+
+/* DMA TC flag - counter buffer wrapped, returns 1 if wrap was counted now */
+uint8_t cntr_dma_wrap(cntr_data_t* self)
+{
+    if (EM_DMA_CNTR_FLAG(LL_DMA_IsActiveFlag_TC)(EM_DMA_CNTR) == 1)
+    {
+        EM_DMA_CNTR_FLAG(LL_DMA_ClearFlag_TC)(EM_DMA_CNTR);
+        self->wraps++;
+        return EM_TRUE;
+    }
+    return EM_FALSE;
+}
+
+/* called from TIM update IRQ before ovf increment, cnt = counter at IRQ entry.
+ * closes gate on last captured edge when gate time elapsed, returns 1 if gate was pushed */
+uint8_t cntr_gate_check(cntr_data_t* self, uint16_t cnt)
+{
+    uint32_t len = self->len;
+
+    cntr_dma_wrap(self); // wrap not serviced yet (same priority) or polled if no DMA IRQ
+    uint32_t pos = (len - LL_DMA_GetDataLength(EM_DMA_CNTR, EM_DMA_CH_CNTR)) % len;
+    if (cntr_dma_wrap(self)) // wrapped meanwhile
+        pos = (len - LL_DMA_GetDataLength(EM_DMA_CNTR, EM_DMA_CH_CNTR)) % len;
+
+    /* ovf channel may be one transfer behind, take only edges complete in both buffers */
+    uint32_t pos2 = (len - LL_DMA_GetDataLength(EM_DMA_CNTR2, EM_DMA_CH_CNTR2)) % len;
+    uint32_t lag = (pos - pos2 + len) % len;
+    if (lag > len / 2)
+        lag = 0;
+
+    uint32_t done = self->wraps * len + pos - lag; // edges captured since start
+    uint8_t edge = done != self->start_edge;
+
+    self->elapsed++;
+
+    if (!self->started)
+    {
+        if (edge) // first edge, gate opens here
+        {
+            self->start_edge = done;
+            self->start_ts = cntr_ts(self, (pos - lag - 1 + 2 * len) % len, cnt);
+            self->started = EM_TRUE;
+            self->elapsed = 0;
+        }
+        else if (self->elapsed >= self->tout_ovf)
+        {
+            self->elapsed = 0;
+            cntr_gate_push(self, 0, 0);
+            return EM_TRUE;
+        }
+    }
+    else if (self->elapsed >= self->gate_ovf)
+    {
+        if (edge) // close on last edge, next gate opens on the same edge - no dead time
+        {
+            uint32_t ts = cntr_ts(self, (pos - lag - 1 + 2 * len) % len, cnt);
+
+            cntr_gate_push(self, done - self->start_edge, ts - self->start_ts);
+
+            self->start_edge = done;
+            self->start_ts = ts;
+            self->elapsed = 0;
+            return EM_TRUE;
+        }
+        else if (self->elapsed >= self->tout_ovf)
+        {
+            self->started = EM_FALSE;
+            self->elapsed = 0;
+            cntr_gate_push(self, 0, 0);
+            return EM_TRUE;
+        }
+    }
+    return EM_FALSE;
+}
+
+/* 32-bit timestamp ovf:ccr of captured edge. ovf store is written by ISR after the overflow, so capture
+ * before the write holds previous ovf - it is recognized by ccr lower than counter at the write */
+static uint32_t cntr_ts(cntr_data_t* self, uint32_t idx, uint16_t cnt)
+{
+    uint16_t ccr = self->data_ccr[idx];
+    uint16_t ovf = self->data_ovf[idx];
+
+    if (ovf == (uint16_t)(self->ovf - 1) && ccr < self->ovf_cnt)
+        ovf++;
+    else if (ovf == self->ovf && ccr < cnt && ccr < self->ovf_cnt) // after overflow being serviced now
+        ovf++;
+
+    return ((uint32_t)ovf << 16) | ccr;
+}
+
+/* one shot capture of raw_n edges to data buffers, DMA normal mode, counter task waits until ISR sees both done */
+static void cntr_raw_capture(cntr_data_t* self)
+{
+    uint8_t duty = self->raw_mode == CNTR_RAW_DUTY;
+    uint16_t n = self->raw_n;
+    uint16_t len2 = duty ? n + 1 : n; // falling edge before first rising may be captured
+
+    cntr_start(self, 0);
+
+    self->raw_state = CNTR_RAW_BUSY;
+    self->raw_psc = (self->fast_mode == EM_TRUE && !duty) ? EM_TIM_CNTR_PSC_FAST : 1;
+    self->raw_pre = EM_TIM_CNTR_MAX;
+    self->raw_post = 0;
+    self->raw_end = EM_FALSE;
+    self->ovf = 0;
+    self->ovf_cnt = 0;
+    self->ovf_pre = 0;
+    self->elapsed = 0;
+
+    /* expected time of capture + no signal timeout, in (prescaled) overflows */
+    uint64_t ovf_ticks = ((uint64_t)EM_TIM_CNTR_MAX + 1) * self->raw_div;
+    double t = self->freq > 0 ? (double)len2 * self->raw_psc / self->freq : 0;
+    self->tout_ovf = (uint32_t)(t * EM_TIM_CNTR_FREQ / ovf_ticks) + 1 +
+                     ((uint64_t)EM_CNTR_MEAS_MS * EM_TIM_CNTR_FREQ / 1000) / ovf_ticks + 1;
+
+    LL_DMA_SetMode(EM_DMA_CNTR, EM_DMA_CH_CNTR, LL_DMA_MODE_NORMAL);
+    LL_DMA_SetMode(EM_DMA_CNTR2, EM_DMA_CH_CNTR2, LL_DMA_MODE_NORMAL);
+
+    dma_set((uint32_t)&EM_TIM_CNTR->EM_TIM_CNTR_CCR, EM_DMA_CNTR, EM_DMA_CH_CNTR, (uint32_t)&self->data_ccr,
+            n, LL_DMA_PDATAALIGN_HALFWORD, LL_DMA_MDATAALIGN_HALFWORD, LL_DMA_DIRECTION_PERIPH_TO_MEMORY);
+
+    if (duty) // falling edges from indirect channel own capture
+        dma_set((uint32_t)&EM_TIM_CNTR->EM_TIM_CNTR_CCR3, EM_DMA_CNTR2, EM_DMA_CH_CNTR2, (uint32_t)&self->data_ovf,
+                len2, LL_DMA_PDATAALIGN_HALFWORD, LL_DMA_MDATAALIGN_HALFWORD, LL_DMA_DIRECTION_PERIPH_TO_MEMORY);
+    else
+        dma_set((uint32_t)&EM_TIM_CNTR->EM_TIM_CNTR_CCR2, EM_DMA_CNTR2, EM_DMA_CH_CNTR2, (uint32_t)&self->data_ovf,
+                len2, LL_DMA_PDATAALIGN_HALFWORD, LL_DMA_MDATAALIGN_HALFWORD, LL_DMA_DIRECTION_PERIPH_TO_MEMORY);
+
+    LL_TIM_IC_SetPrescaler(EM_TIM_CNTR, EM_TIM_CNTR_CH, self->raw_psc > 1 ? LL_TIM_ICPSC_DIV8 : LL_TIM_ICPSC_DIV1);
+    LL_TIM_IC_SetPrescaler(EM_TIM_CNTR, EM_TIM_CNTR_CH2, self->raw_psc > 1 ? LL_TIM_ICPSC_DIV8 : LL_TIM_ICPSC_DIV1);
+    LL_TIM_IC_SetPolarity(EM_TIM_CNTR, EM_TIM_CNTR_CH2, duty ? LL_TIM_IC_POLARITY_FALLING : LL_TIM_IC_POLARITY_RISING);
+
+    EM_TIM_CNTR_OVF(LL_TIM_OC_SetCompare)(EM_TIM_CNTR, 0);
+    LL_TIM_SetPrescaler(EM_TIM_CNTR, self->raw_div - 1);
+    LL_TIM_GenerateEvent_UPDATE(EM_TIM_CNTR); // load prescaler
+    LL_TIM_ClearFlag_UPDATE(EM_TIM_CNTR);
+    LL_TIM_SetCounter(EM_TIM_CNTR, 0);
+    LL_TIM_EnableIT_UPDATE(EM_TIM_CNTR);
+    NVIC_EnableIRQ(EM_CNTR_IRQ);
+    LL_TIM_EnableCounter(EM_TIM_CNTR);
+
+    /* edges before first ovf store write would not be recognized by host as stale */
+    for (int i = 0; !duty && self->ovf == 0 && i < EM_CNTR_MEAS_MS && self->enabled && !self->restart; i++)
+        vTaskDelay(1);
+
+    EM_TIM_CNTR_CC(LL_TIM_EnableDMAReq_)(EM_TIM_CNTR);
+    EM_TIM_CNTR_CC2(LL_TIM_EnableDMAReq_)(EM_TIM_CNTR);
+    LL_TIM_CC_EnableChannel(EM_TIM_CNTR, EM_TIM_CNTR_CH);
+    LL_TIM_CC_EnableChannel(EM_TIM_CNTR, EM_TIM_CNTR_CH2);
+
+    while (self->raw_state == CNTR_RAW_BUSY && !self->raw_end && self->enabled && !self->restart)
+        xSemaphoreTake(sem5_cntr, EM_CNTR_MEAS_MS);
+
+    cntr_start(self, 0);
+
+    self->raw_len1 = n - LL_DMA_GetDataLength(EM_DMA_CNTR, EM_DMA_CH_CNTR);
+    self->raw_len2 = len2 - LL_DMA_GetDataLength(EM_DMA_CNTR2, EM_DMA_CH_CNTR2);
+    LL_DMA_DisableChannel(EM_DMA_CNTR, EM_DMA_CH_CNTR);
+    LL_DMA_DisableChannel(EM_DMA_CNTR2, EM_DMA_CH_CNTR2);
+
+    /* back to gate settings */
+    LL_TIM_DisableIT_UPDATE(EM_TIM_CNTR);
+    LL_TIM_SetPrescaler(EM_TIM_CNTR, 0);
+    LL_TIM_GenerateEvent_UPDATE(EM_TIM_CNTR);
+    LL_TIM_ClearFlag_UPDATE(EM_TIM_CNTR);
+    NVIC_ClearPendingIRQ(EM_CNTR_IRQ);
+    LL_TIM_IC_SetPolarity(EM_TIM_CNTR, EM_TIM_CNTR_CH2, LL_TIM_IC_POLARITY_RISING);
+
+    taskENTER_CRITICAL();
+    if (self->raw_state == CNTR_RAW_BUSY) // not dropped or requested again meanwhile
+        self->raw_state = CNTR_RAW_DONE;
+    taskEXIT_CRITICAL();
+}
+
+static void cntr_gate_push(cntr_data_t* self, uint32_t edges, uint32_t ticks)
+{
+    if (self->gates_head - self->gates_tail >= EM_CNTR_GATES) // task is late, drop
+        return;
+
+    cntr_gate_t* g = &self->gates[self->gates_head % EM_CNTR_GATES];
+    g->edges = edges;
+    g->ticks = ticks;
+    self->gates_head++;
+}
+
+/* running statistics - Welford mean and variance, Allan variance of consecutive gates */
+static void cntr_res_push(cntr_data_t* self, double f)
+{
+    cntr_stat_t* s = &self->stat;
+
+    self->freq = f;
+    self->seq++;
+
+    if (f > 0)
+    {
+        s->n++;
+
+        if (s->n == 1)
+        {
+            s->min = f;
+            s->max = f;
         }
         else
         {
-            if (self->data_ccr[sz - 1] > self->data_ccr[0])
-                ccr_sum += self->data_ccr[sz - 1] - self->data_ccr[0];
-            else
-                return;
+            if (f < s->min)
+                s->min = f;
+            if (f > s->max)
+                s->max = f;
         }
 
-        /* finally calc freq */
-        double total = (ovf * EM_TIM_CNTR_MAX) + ccr_sum;
-        total /= (double)(sz - 1);
-        self->freq = ((double)EM_TIM_CNTR_FREQ / total) * (double)(self->fast_mode_now ? 8 : 1);
+        double delta = f - s->mean;
+        s->mean += delta / s->n;
+        s->m2 += delta * (f - s->mean);
+
+        if (s->prev > 0)
+        {
+            s->a2 += (f - s->prev) * (f - s->prev);
+            s->na++;
+        }
+        s->prev = f;
     }
     else
     {
-        self->freq = -1; // timeout
+        s->prev = 0; // gap, next gate is not consecutive
     }
+
+    if (self->res_head - self->res_tail >= EM_CNTR_RES_LEN) // not read, oldest is lost
+        self->res_tail++;
+
+    self->res[self->res_head % EM_CNTR_RES_LEN] = f;
+    self->res_head++;
 }
@@ -6,22 +6,54 @@
 #include "cfg.h"
 
 #include "app_data.h"
+#include "app_sync.h"
 #include "main.h"
 
 #include "FreeRTOS.h"
 #include "semphr.h"
 
-/* counter overflow bit - software extended counter resolution */
+/* counter overflow bit - software extended counter resolution, gate or raw capture is closed here */
 void EM_TIM_CNTR_UP_IRQh(void)
 {
     traceISR_ENTER();
 
+    uint8_t gate = EM_FALSE;
+
     if(LL_TIM_IsActiveFlag_UPDATE(EM_TIM_CNTR) == 1)
     {
+        if (cntr.raw_state == CNTR_RAW_BUSY)
+            gate = cntr_raw_check(&cntr);
+        else
+            gate = cntr_gate_check(&cntr, LL_TIM_GetCounter(EM_TIM_CNTR));
+
         cntr.ovf++;
+        cntr.ovf_pre = LL_TIM_GetCounter(EM_TIM_CNTR);
         EM_TIM_CNTR_OVF(LL_TIM_OC_SetCompare)(EM_TIM_CNTR, cntr.ovf);
+        cntr.ovf_cnt = LL_TIM_GetCounter(EM_TIM_CNTR);
     }
     LL_TIM_ClearFlag_UPDATE(EM_TIM_CNTR);
 
+    /* gate closed, wake counter task */
+    if (gate == EM_TRUE)
+    {
+        portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+        xSemaphoreGiveFromISR(sem5_cntr, &xHigherPriorityTaskWoken);
+        portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+    }
+    else
+        traceISR_EXIT();
+}
+
+#ifdef EM_DMA_CNTR_IRQh
+
+/* counter DMA circular buffer wrapped - edge count */
+void EM_DMA_CNTR_IRQh(void)
+{
+    traceISR_ENTER();
+
+    cntr_dma_wrap(&cntr);
+
     traceISR_EXIT();
 }
+
+#endif
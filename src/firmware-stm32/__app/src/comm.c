@@ -6,6 +6,7 @@
 #include "cfg.h"
 #include "comm.h"
 #include "comm_proto.h"
+#include "comm_hash.h"
 #include "utility.h"
 #include "build_defs.h"
 
@@ -15,6 +16,9 @@
 
 #include "main.h"
 
+#include "FreeRTOS.h"
+#include "task.h"
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -28,6 +32,16 @@
 // respond
 static void uart_put_str(const char* data, int len);
 static void uart_put_char(const char data);
+#ifdef EM_USB_FIFO
+static int usb_put_str(comm_data_t* self, const char* data, int len);
+#endif
+static void comm_msg_start(comm_data_t* self);
+
+
+// receive
+static int uart_rx_line(comm_data_t* self);
+static void uart_rx_flush(comm_data_t* self);
+static void comm_input(const char* line, int len);
 
 
 // scpi core
@@ -66,6 +80,9 @@ const scpi_command_t scpi_commands[] = {
     {.pattern = "SYStem:LIMits?", .callback = EM_SYS_LimitsQ,},
     {.pattern = "SYStem:INFO?", .callback = EM_SYS_InfoQ,},
     {.pattern = "SYStem:UPTime?", .callback = EM_SYS_UptimeQ,},
+    {.pattern = "SYStem:BAUD?", .callback = EM_SYS_BaudQ,},
+    {.pattern = "SYStem:BAUD", .callback = EM_SYS_Baud,},
+    {.pattern = "SYStem:REARm?", .callback = EM_SYS_RearmQ,},
 
     /* EMBO - Voltmeter */
     {.pattern = "VM:READ?", .callback = EM_VM_ReadQ,},
@@ -86,10 +103,14 @@ const scpi_command_t scpi_commands[] = {
     {.pattern = "CNTR:SET?", .callback = EM_CNTR_SetQ,},
     {.pattern = "CNTR:SET", .callback = EM_CNTR_Set,},
     {.pattern = "CNTR:READ?", .callback = EM_CNTR_ReadQ,},
+    {.pattern = "CNTR:RAW?", .callback = EM_CNTR_RawQ,},
+    {.pattern = "CNTR:RAW", .callback = EM_CNTR_Raw,},
 
     /* EMBO - Signal Generator */
     {.pattern = "SGEN:SET?", .callback = EM_SGEN_SetQ,},
     {.pattern = "SGEN:SET", .callback = EM_SGEN_Set,},
+    {.pattern = "SGEN:ARB?", .callback = EM_SGEN_ArbQ,},
+    {.pattern = "SGEN:ARB", .callback = EM_SGEN_Arb,},
 
     /* EMBO - PWM */
     {.pattern = "PWM:SET?", .callback = EM_PWM_SetQ,},
@@ -181,6 +202,38 @@ scpi_result_t SCPI_CoreIdnQ(scpi_t * context)
     return SCPI_RES_OK;
 }
 
+/************************* Dispatch *************************/
+
+/* same key as scripts/scpi_hash.py - first chars of every mnemonic, upper case */
+int32_t comm_cmd_index(const char* header, int len)
+{
+    uint32_t h = 2166136261u ^ COMM_HASH_SEED; // FNV-1a
+    int seg = 0;
+    int i = 0;
+
+    if (len > 0 && header[0] == ':')
+        i++;
+
+    for (; i < len; i++)
+    {
+        char c = header[i];
+
+        if (c == ':')
+            seg = 0;
+        else if (c == '?')
+            ;
+        else if (seg++ < COMM_HASH_PREFIX)
+            c = (c >= 'a' && c <= 'z') ? c - 32 : c;
+        else
+            continue;
+
+        h = (h ^ (uint8_t)c) * 16777619u;
+    }
+
+    uint8_t idx = comm_hash_table[h >> (32 - COMM_HASH_BITS)];
+    return (int32_t)idx - 1;
+}
+
 /************************* Write Respond *************************/
 
 void uart_put_text(const char* data)
@@ -201,6 +254,119 @@ static void uart_put_str(const char* data, int len)
         uart_put_char(data[i]);
 }
 
+#ifdef EM_USB_FIFO
+static int usb_put_str(comm_data_t* self, const char* data, int len)
+{
+    int sent = 0;
+
+    if (self->usb_drop) // rest of message which host did not read
+        return len;
+
+    while (1)
+    {
+        sent += comm_fifo_write(&self->usb_tx, data + sent, len - sent);
+
+        if (CDC_TxKick_FS() != USBD_OK) // host is gone
+            return sent;
+
+        if (sent >= len)
+            return len;
+
+        /* FIFO full - sleep until USB ISR drains half of it */
+        if (xSemaphoreTake(sem4_usb, pdMS_TO_TICKS(EM_USB_TX_TIMEOUT_MS)) != pdPASS)
+        {
+            /* host does not read - drop whole message if none of it was sent, truncated line would
+             * be parsed as valid by host. if part is out already, wait for host to read the rest */
+            taskENTER_CRITICAL();
+            uint8_t dropped = comm_fifo_drop(&self->usb_tx);
+            taskEXIT_CRITICAL();
+
+            if (dropped)
+            {
+                self->usb_drop = EM_TRUE;
+                return len;
+            }
+        }
+    }
+}
+#endif
+
+/* response line or async message starts - unit of USB TX drop */
+static void comm_msg_start(comm_data_t* self)
+{
+#ifdef EM_USB_FIFO
+    if (self->usb.last == EM_TRUE && self->usb_line == EM_FALSE)
+    {
+        comm_fifo_mark(&self->usb_tx);
+        self->usb_drop = EM_FALSE;
+    }
+#else
+    (void)self;
+#endif
+}
+
+/************************* Read Lines *************************/
+
+/* next complete line to uart.rx_buffer, returns length, 0 = line dropped, -1 = none */
+static int uart_rx_line(comm_data_t* self)
+{
+    comm_rx_t* rx = &self->uart_rx;
+
+    if (rx->lines_read == rx->lines)
+        return -1;
+
+    uint32_t len = 0;
+    comm_eol_t eol = { 0 }; // same scan as IRQ, line starts outside of block
+
+    while (rx->tail + len != rx->head)
+    {
+        if (comm_eol_step(&eol, rx->buff[(rx->tail + len++) & (EM_UART_RX_LEN - 1)]))
+            break;
+    }
+
+    uint32_t at = rx->tail & (EM_UART_RX_LEN - 1);
+    int ret = 0;
+
+    if (len <= RX_BUFF_LAST) // longer does not fit to SCPI input buffer
+    {
+        uint32_t first = EM_UART_RX_LEN - at;
+
+        if (first > len)
+            first = len;
+
+        memcpy(self->uart.rx_buffer, rx->buff + at, first);
+        memcpy(self->uart.rx_buffer + first, rx->buff, len - first);
+        ret = len;
+    }
+
+    rx->tail += len;
+    rx->lines_read++;
+    return ret;
+}
+
+/* drop all received data after overflow */
+static void uart_rx_flush(comm_data_t* self)
+{
+    comm_rx_t* rx = &self->uart_rx;
+
+    taskENTER_CRITICAL(); // UART IRQ is below max syscall priority
+    rx->tail = rx->head;
+    rx->lines_read = rx->lines;
+    memset(&rx->eol, 0, sizeof(comm_eol_t));
+    rx->ovf = EM_FALSE;
+    taskEXIT_CRITICAL();
+}
+
+/* line is complete by framing - what parser still waits for (block shorter than its header says) is parsed now,
+ * so error is reported and next line does not get appended to it */
+static void comm_input(const char* line, int len)
+{
+    SCPI_Input(&scpi_context, line, len);
+
+    if (scpi_context.buffer.position > 0)
+        SCPI_Input(&scpi_context, NULL, 0);
+}
+
 /************************* Write Async Msg *************************/
 
 void comm_daq_ready(comm_data_t* self, const char* rdy, uint32_t pos_frst)
@@ -208,6 +374,8 @@ void comm_daq_ready(comm_data_t* self, const char* rdy, uint32_t pos_frst)
     int i;
     char buff[25];
 
+    comm_msg_start(self);
+
     for (i = 0; i < 8; i++)
         buff[i] = rdy[i];
 
@@ -222,6 +390,28 @@ void comm_daq_ready(comm_data_t* self, const char* rdy, uint32_t pos_frst)
     comm_respond(self, buff, suffix + 2);
 }
 
+/* "ReadyC",#<n><len><record>\r\n - binary block as SCPI arbitrary block */
+void comm_cntr_ready(comm_data_t* self, const char* rdy, const uint8_t* data, int len)
+{
+    int i;
+    char buff[20];
+
+    comm_msg_start(self);
+
+    for (i = 0; i < 8; i++)
+        buff[i] = rdy[i];
+
+    buff[i] = ',';
+    buff[i + 1] = '#';
+
+    int n = itoa_fast(buff + i + 3, len, 10);
+    buff[i + 2] = '0' + n;
+
+    comm_respond(self, buff, i + 3 + n);
+    comm_respond(self, (const char*)data, len);
+    comm_respond(self, "\r\n", 2);
+}
+
 /************************* Main Comm *************************/
 
 void comm_init(comm_data_t* self)
@@ -229,9 +419,19 @@ void comm_init(comm_data_t* self)
     self->uart.last = 0;
     self->uart.available = 0;
     self->uart.rx_index = 0;
+    memset(&self->uart_rx, 0, sizeof(comm_rx_t));
     self->usb.last = 0;
     self->usb.available = 0;
     self->usb.rx_index = 0;
+    memset(&self->usb.eol, 0, sizeof(comm_eol_t));
+    self->uart_baud = EM_UART_BAUD;
+    self->uart_baud_next = 0;
+    self->uart_rx_tick = 0;
+#ifdef EM_USB_FIFO
+    comm_fifo_init(&self->usb_tx, CDC_TxPacket_FS);
+    self->usb_drop = EM_FALSE;
+    self->usb_line = EM_FALSE;
+#endif
     comm_ptr = self;
 
     SCPI_Init(&scpi_context,
@@ -243,41 +443,105 @@ void comm_init(comm_data_t* self)
               scpi_error_queue_data, SCPI_ERROR_QUEUE_SIZE,
               self);
 
+    /* generated table is stale if commands were added without running scpi_hash.py */
+    if (sizeof(scpi_commands) / sizeof(scpi_command_t) - 1 == COMM_HASH_CMDS)
+        scpi_context.cmd_index = comm_cmd_index;
+
 
 #ifdef EM_UART_POLLINIT
     while((!(LL_USART_IsActiveFlag_TEACK(EM_UART))) || (!(LL_USART_IsActiveFlag_REACK(EM_UART))))
         __asm("nop");
 #endif
 
+#ifdef EM_UART_DMA
+    /* RX to circular buffer, IRQ when line goes idle and at half/full buffer */
+    LL_DMA_DisableChannel(EM_UART_DMA, EM_UART_DMA_CH);
+#ifdef EM_UART_DMA_REQ
+    LL_DMA_SetPeriphRequest(EM_UART_DMA, EM_UART_DMA_CH, EM_UART_DMA_REQ);
+#endif
+    LL_DMA_ConfigTransfer(EM_UART_DMA, EM_UART_DMA_CH, LL_DMA_DIRECTION_PERIPH_TO_MEMORY | LL_DMA_PRIORITY_LOW |
+                          LL_DMA_MODE_CIRCULAR | LL_DMA_PERIPH_NOINCREMENT | LL_DMA_MEMORY_INCREMENT |
+                          LL_DMA_PDATAALIGN_BYTE | LL_DMA_MDATAALIGN_BYTE);
+    LL_DMA_ConfigAddresses(EM_UART_DMA, EM_UART_DMA_CH, EM_UART_DMA_ADDR(EM_UART), (uint32_t)self->uart_rx.buff,
+                           LL_DMA_DIRECTION_PERIPH_TO_MEMORY);
+    LL_DMA_SetDataLength(EM_UART_DMA, EM_UART_DMA_CH, EM_UART_RX_LEN);
+    EM_UART_DMA_FLAG(LL_DMA_ClearFlag_HT)(EM_UART_DMA);
+    EM_UART_DMA_FLAG(LL_DMA_ClearFlag_TC)(EM_UART_DMA);
+    LL_DMA_EnableIT_HT(EM_UART_DMA, EM_UART_DMA_CH);
+    LL_DMA_EnableIT_TC(EM_UART_DMA, EM_UART_DMA_CH);
+    LL_DMA_EnableChannel(EM_UART_DMA, EM_UART_DMA_CH);
+
+    LL_USART_EnableDMAReq_RX(EM_UART);
+    LL_USART_ClearFlag_IDLE(EM_UART);
+    LL_USART_EnableIT_IDLE(EM_UART);
+#else
     LL_USART_EnableIT_RXNE(EM_UART);
+#endif
 
     //uart_put_text(WELCOME_STR);
 
     NVIC_SetPriority(EM_IRQN_UART, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), EM_IT_PRI_UART, 0));
     NVIC_EnableIRQ(EM_IRQN_UART);
+#ifdef EM_UART_DMA
+    NVIC_SetPriority(EM_IRQN_UART_DMA, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), EM_IT_PRI_UART, 0)); // same as UART, scans never nest
+    NVIC_EnableIRQ(EM_IRQN_UART_DMA);
+#endif
 }
 
 uint8_t comm_main(comm_data_t* self)
 {
-    if (self->uart.available == EM_TRUE)
+    uint8_t ret = EM_FALSE;
+    int len;
+
+    if (self->uart_rx.ovf == EM_TRUE)
+    {
+        uart_rx_flush(self);
+
+        self->uart.last = EM_TRUE;
+        self->usb.last = EM_FALSE;
+        SCPI_Error(&scpi_context, SCPI_ERROR_INPUT_BUFFER_OVERRUN);
+        ret = EM_TRUE;
+    }
+
+    /* all pipelined lines in order */
+    while ((len = uart_rx_line(self)) >= 0)
     {
-        SCPI_Input(&scpi_context, self->uart.rx_buffer, self->uart.rx_index);
+        self->uart.last = EM_TRUE;
+        self->usb.last = EM_FALSE;
+        self->uart.available = EM_TRUE;
+
+        if (len > 0)
+            comm_input(self->uart.rx_buffer, len);
 
-        memset(self->uart.rx_buffer, '\0', RX_BUFF_LEN * sizeof(char));
-        self->uart.rx_index = 0;
-        return EM_TRUE;
+        self->uart.available = EM_FALSE;
+
+        if (self->uart_baud_next != 0) // response is sent at old baud rate, now switch
+        {
+            comm_baud_set(self, self->uart_baud_next);
+            self->uart_baud_next = 0;
+        }
+        ret = EM_TRUE;
     }
 #ifdef EM_USB
-    else if (self->usb.available == EM_TRUE)
+    if (self->usb.available == EM_TRUE)
     {
-        SCPI_Input(&scpi_context, self->usb.rx_buffer, self->usb.rx_index);
+        self->uart.last = EM_FALSE;
+        self->usb.last = EM_TRUE;
+
+        comm_msg_start(self);
+#ifdef EM_USB_FIFO
+        self->usb_line = EM_TRUE;
+        comm_input(self->usb.rx_buffer, self->usb.rx_index);
+        self->usb_line = EM_FALSE;
+#else
+        comm_input(self->usb.rx_buffer, self->usb.rx_index);
+#endif
 
-        memset(self->usb.rx_buffer, '\0', RX_BUFF_LEN * sizeof(char));
         self->usb.rx_index = 0;
-        return EM_TRUE;
+        ret = EM_TRUE;
     }
 #endif
-    return EM_FALSE;
+    return ret;
 }
 
 int comm_respond(comm_data_t* self, const char* data, int len)
@@ -290,6 +554,9 @@ int comm_respond(comm_data_t* self, const char* data, int len)
 #ifdef EM_USB
     else if (self->usb.last == EM_TRUE)
     {
+#ifdef EM_USB_FIFO
+        return usb_put_str(self, data, len);
+#else
         int cntr = 1000000;
         uint8_t ret = USBD_BUSY;
 
@@ -303,7 +570,38 @@ int comm_respond(comm_data_t* self, const char* data, int len)
             __asm("nop");
 
         return len;
+#endif
     }
 #endif
     return 0;
 }
+
+/************************* Baud Rate *************************/
+
+uint8_t comm_baud_valid(uint32_t baud)
+{
+    if (baud < EM_UART_BAUD_MIN || baud > EM_UART_BAUD_MAX)
+        return EM_FALSE;
+
+    uint32_t div = (EM_UART_CLK + (baud / 2)) / baud; // oversampling 16, BRR = USARTDIV
+    uint32_t real = EM_UART_CLK / div;
+    uint32_t diff = real > baud ? real - baud : baud - real;
+
+    return ((uint64_t)diff * 1000 / baud) <= EM_UART_BAUD_ERR ? EM_TRUE : EM_FALSE;
+}
+
+void comm_baud_set(comm_data_t* self, uint32_t baud)
+{
+    while(!LL_USART_IsActiveFlag_TC(EM_UART)); // last stop bit out
+
+    LL_USART_Disable(EM_UART); // BRR is write protected when enabled (F3, G0, L4)
+    EM_UART_SET_BAUD(EM_UART, baud);
+    LL_USART_Enable(EM_UART);
+
+#ifdef EM_UART_POLLINIT
+    while((!(LL_USART_IsActiveFlag_TEACK(EM_UART))) || (!(LL_USART_IsActiveFlag_REACK(EM_UART))))
+        __asm("nop");
+#endif
+
+    self->uart_baud = baud;
+}
@@ -0,0 +1,144 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "cfg.h"
+#include "comm_fifo.h"
+
+#include <string.h>
+
+
+#if (COMM_FIFO_LEN & (COMM_FIFO_LEN - 1)) != 0
+#error "COMM_FIFO_LEN must be power of 2"
+#endif
+
+
+static uint8_t comm_fifo_next(comm_fifo_t* self);
+
+
+void comm_fifo_init(comm_fifo_t* self, comm_fifo_ep_t ep_tx)
+{
+    self->head = 0;
+    self->tail = 0;
+    self->mark = 0;
+    self->drops = 0;
+    self->pkt_len = 0;
+    self->busy = EM_FALSE;
+    self->waiting = EM_FALSE;
+    self->ep_tx = ep_tx;
+}
+
+uint32_t comm_fifo_used(comm_fifo_t* self)
+{
+    return self->head - self->tail; // free running indexes
+}
+
+uint32_t comm_fifo_free(comm_fifo_t* self)
+{
+    return COMM_FIFO_LEN - comm_fifo_used(self);
+}
+
+int comm_fifo_write(comm_fifo_t* self, const char* data, int len)
+{
+    uint32_t free = comm_fifo_free(self);
+
+    if (len > (int)free)
+    {
+        len = free;
+        self->waiting = EM_TRUE; // before head moves, ISR wakes writer from now
+    }
+
+    uint32_t at = self->head & (COMM_FIFO_LEN - 1);
+    uint32_t first = COMM_FIFO_LEN - at;
+
+    if (first > (uint32_t)len)
+        first = len;
+
+    memcpy(self->buff + at, data, first);
+    memcpy(self->buff, data + first, len - first);
+
+    self->head += len;
+    return len;
+}
+
+uint8_t comm_fifo_kick(comm_fifo_t* self)
+{
+    if (self->busy)
+        return EM_TRUE; // ISR continues itself
+
+    self->pkt_len = 0; // previous transfer is over, no ZLP owed
+    return comm_fifo_next(self);
+}
+
+uint8_t comm_fifo_tx_done(comm_fifo_t* self)
+{
+    if (!self->busy)
+        return EM_FALSE;
+
+    comm_fifo_next(self);
+
+    if (self->waiting && (comm_fifo_free(self) >= COMM_FIFO_LEN / 2 || !self->busy))
+    {
+        self->waiting = EM_FALSE;
+        return EM_TRUE;
+    }
+    return EM_FALSE;
+}
+
+void comm_fifo_mark(comm_fifo_t* self)
+{
+    self->mark = self->head;
+}
+
+/* unsent part of current message removed - call with USB IRQ masked, 0 = some of it was sent already */
+uint8_t comm_fifo_drop(comm_fifo_t* self)
+{
+    if ((int32_t)(self->tail - self->mark) > 0)
+        return EM_FALSE;
+
+    self->head = self->mark;
+    self->waiting = EM_FALSE;
+    self->drops++;
+    return EM_TRUE;
+}
+
+static uint8_t comm_fifo_next(comm_fifo_t* self)
+{
+    uint32_t used = comm_fifo_used(self);
+
+    if (used == 0)
+    {
+        /* transfer ended with full packet - host would wait for more */
+        if (self->busy && self->pkt_len == COMM_FIFO_PKT)
+        {
+            self->pkt_len = 0;
+            if (self->ep_tx(self->pkt, 0) == 0)
+                return EM_TRUE;
+        }
+        self->busy = EM_FALSE;
+        return EM_TRUE;
+    }
+
+    uint16_t len = (used > COMM_FIFO_PKT ? COMM_FIFO_PKT : used);
+    uint32_t at = self->tail & (COMM_FIFO_LEN - 1);
+    uint32_t first = COMM_FIFO_LEN - at;
+
+    if (first > len)
+        first = len;
+
+    memcpy(self->pkt, self->buff + at, first);
+    memcpy(self->pkt + first, self->buff, len - first);
+
+    self->tail += len;
+    self->pkt_len = len;
+    self->busy = EM_TRUE;
+
+    if (self->ep_tx(self->pkt, len) != 0)
+    {
+        self->tail = self->head; // endpoint gone (host disconnected) - drop all
+        self->busy = EM_FALSE;
+        return EM_FALSE;
+    }
+    return EM_TRUE;
+}
@@ -13,124 +13,113 @@
 #include "FreeRTOS.h"
 #include "semphr.h"
 
-/* UART IRQ handler */
+static uint8_t comm_rx_scan(comm_rx_t* self, uint32_t head);
+static void comm_rx_wake(uint8_t msg);
+#ifdef EM_UART_DMA
+static uint8_t comm_rx_dma(comm_rx_t* self);
+#endif
+
+
+/* UART IRQ handler - idle line (DMA) or byte (RXNE) */
 void EM_UART_RX_IRQHandler(void)
 {
     traceISR_ENTER();
-    int8_t exit = 0;
+    uint8_t msg = EM_FALSE;
 
+#ifdef EM_UART_DMA
+    if (LL_USART_IsActiveFlag_IDLE(EM_UART) == 1)
+    {
+        LL_USART_ClearFlag_IDLE(EM_UART);
+        msg = comm_rx_dma(&comm.uart_rx);
+    }
+#else
     if (LL_USART_IsActiveFlag_RXNE(EM_UART) == 1)
     {
-        char rx = LL_USART_ReceiveData8(EM_UART);
+        comm.uart_rx.buff[comm.uart_rx.head & (EM_UART_RX_LEN - 1)] = LL_USART_ReceiveData8(EM_UART);
 
-        if (comm.uart.available == EM_FALSE && comm.usb.available == EM_FALSE)
-        {
-            comm.uart.rx_buffer[comm.uart.rx_index++] = rx;
+#ifdef EM_UART_CLEAR_FLAG
+        EM_UART_CLEAR_FLAG(EM_UART);
+#endif
 
-            if (comm.uart.rx_index >= RX_BUFF_LAST)
-                comm.uart.rx_index = 0;
+        msg = comm_rx_scan(&comm.uart_rx, comm.uart_rx.head + 1);
+    }
+#endif
 
-            comm.uart.last = EM_TRUE;
-            comm.usb.last = EM_FALSE;
+    comm_rx_wake(msg);
+}
 
-#ifdef EM_UART_CLEAR_FLAG
-            EM_UART_CLEAR_FLAG(EM_UART);
-#endif
+#ifdef EM_UART_DMA
 
-            /* new message detected */
-            if (rx == '\n' && comm.uart.rx_index > 1 && comm.uart.rx_buffer[comm.uart.rx_index - 2] == '\r')
-            {
-                comm.uart.available = EM_TRUE;
-                exit = -1;
+/* UART RX DMA half or full buffer - scan at least twice per wrap, so no whole wrap passes unseen between IDLE events */
+void comm_uart_dma_irq(void)
+{
+    traceISR_ENTER();
+    uint8_t msg = EM_FALSE;
 
-                portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
-                ASSERT(xSemaphoreGiveFromISR(sem1_comm, &xHigherPriorityTaskWoken) == pdPASS);
-                portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
-            }
-        }
-        //else
-        //    ASSERT(0);
+    if (EM_UART_DMA_FLAG(LL_DMA_IsActiveFlag_HT)(EM_UART_DMA) == 1 ||
+        EM_UART_DMA_FLAG(LL_DMA_IsActiveFlag_TC)(EM_UART_DMA) == 1)
+    {
+        EM_UART_DMA_FLAG(LL_DMA_ClearFlag_HT)(EM_UART_DMA);
+        EM_UART_DMA_FLAG(LL_DMA_ClearFlag_TC)(EM_UART_DMA);
+        msg = comm_rx_dma(&comm.uart_rx);
     }
 
-    if (exit == 0)
-        traceISR_EXIT();
+    comm_rx_wake(msg);
 }
 
-/*
-static int8_t CDC_Receive_FS(uint8_t* Buf, uint32_t *Len)
+#ifdef EM_UART_DMA_IRQh
+void EM_UART_DMA_IRQh(void)
 {
-  */
-  /* USER CODE BEGIN 6 */
-  /*
-  traceISR_ENTER();
-  int8_t ret = 0;
-  int8_t exit = 0;
-
-  uint32_t len = *Len;
-  if (hUsbDeviceFS.dev_state != USBD_STATE_CONFIGURED)
-  {
-     ret = USBD_FAIL;
-     goto quit;
-  }
-
-  if (((Buf == NULL) || (Len == NULL)) || (*Len <= 0))
-  {
-     ret = USBD_FAIL;
-     goto quit;
-  }
-
-  uint8_t result = USBD_OK;
-  do
-  {
-      result = USBD_CDC_SetRxBuffer(&hUsbDeviceFS, &Buf[0]);
-  }
-  while(result != USBD_OK);
-
-  do
-  {
-     result = USBD_CDC_ReceivePacket(&hUsbDeviceFS);
-  }
-  while(result != USBD_OK);
-
-  if (comm.uart.available == EM_FALSE && comm.usb.available == EM_FALSE)
-  {
-      while (len--)
-      {
-         comm.usb.rx_buffer[comm.usb.rx_index++] = *Buf;
-
-         if (comm.usb.rx_index >= RX_BUFF_LAST)
-             comm.usb.rx_index = 0;
-
-         comm.uart.last = EM_FALSE;
-         comm.usb.last = EM_TRUE;
-
-         if (*Buf == '\n' && comm.usb.rx_index > 1 && comm.usb.rx_buffer[comm.usb.rx_index - 2] == '\r')
-         {
-             comm.usb.available = EM_TRUE;
-             exit = -1;
-
-             portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
-             ASSERT(xSemaphoreGiveFromISR(sem1_comm, &xHigherPriorityTaskWoken) == pdPASS);
-             portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
-         }
-         Buf++;
-      }
-  }
-
-  ret = USBD_OK;
-  if (exit == 0)
-      traceISR_EXIT();
-
-  quit:
-  return ret;
-  */
-  /* USER CODE END 6 */
-  /*
+    comm_uart_dma_irq();
 }
+#endif
 
-uint8_t CDC_Busy()
+/* scan bytes written by DMA since last scan, less than one wrap */
+static uint8_t comm_rx_dma(comm_rx_t* self)
 {
-    USBD_CDC_HandleTypeDef *hcdc = (USBD_CDC_HandleTypeDef*)hUsbDeviceFS.pClassData;
-    return hcdc->TxState != 0 ? 1 : 0;
+    uint32_t pos = EM_UART_RX_LEN - LL_DMA_GetDataLength(EM_UART_DMA, EM_UART_DMA_CH);
+    return comm_rx_scan(self, self->head + ((pos - self->head) & (EM_UART_RX_LEN - 1)));
+}
+
+#endif
+
+/* new message(s) detected - wake comm task, ends ISR */
+static void comm_rx_wake(uint8_t msg)
+{
+    if (msg == EM_TRUE)
+    {
+        comm.uart_rx_tick = daq.uwTick;
+
+        /* at most one UART wake is pending, the other token is kept for USB whose give must pass */
+        portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+        if (uxQueueMessagesWaitingFromISR(sem1_comm) == 0)
+            xSemaphoreGiveFromISR(sem1_comm, &xHigherPriorityTaskWoken);
+        portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
+    }
+    else
+        traceISR_EXIT();
+}
+
+/* count complete lines in received bytes up to head */
+static uint8_t comm_rx_scan(comm_rx_t* self, uint32_t head)
+{
+    uint8_t msg = EM_FALSE;
+
+    while (self->head != head)
+    {
+        char rx = self->buff[self->head++ & (EM_UART_RX_LEN - 1)];
+
+        if (comm_eol_step(&self->eol, rx))
+        {
+            self->lines++;
+            msg = EM_TRUE;
+        }
+    }
+
+    if (self->head - self->tail > EM_UART_RX_LEN) // DMA wrapped over unread data
+    {
+        self->ovf = EM_TRUE;
+        msg = EM_TRUE;
+    }
+    return msg;
 }
-*/
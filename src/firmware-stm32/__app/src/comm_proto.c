@@ -47,7 +47,7 @@ scpi_result_t EM_Reset(scpi_t* context)
     {
         daq_settings_init(&daq, EM_TRUE, EM_TRUE);
 
-        cntr_enable(&cntr, EM_FALSE, EM_FALSE);
+        cntr_enable(&cntr, EM_FALSE, EM_FALSE, EM_CNTR_GATE_MS);
         pwm_disable(&pwm);
 #ifdef EM_DAC
         sgen_disable(&sgen);
@@ -192,6 +192,46 @@ scpi_result_t EM_SYS_UptimeQ(scpi_t* context)
     return SCPI_RES_OK;
 }
 
+scpi_result_t EM_SYS_Baud(scpi_t* context)
+{
+    uint32_t baud;
+
+    if (!SCPI_ParamUInt32(context, &baud, TRUE))
+        return SCPI_RES_ERR;
+
+    if (comm.uart.last != EM_TRUE) // USB - no baud rate
+    {
+        SCPI_ResultUInt32(context, 0);
+        return SCPI_RES_OK;
+    }
+
+    if (comm_baud_valid(baud) != EM_TRUE)
+    {
+        SCPI_ErrorPush(context, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE);
+        return SCPI_RES_ERR;
+    }
+
+    comm.uart_baud_next = baud; // applied by comm_main after response
+    SCPI_ResultUInt32(context, baud);
+    return SCPI_RES_OK;
+}
+
+scpi_result_t EM_SYS_BaudQ(scpi_t* context)
+{
+    SCPI_ResultUInt32(context, comm.uart.last == EM_TRUE ? comm.uart_baud : 0);
+    return SCPI_RES_OK;
+}
+
+scpi_result_t EM_SYS_RearmQ(scpi_t* context)
+{
+    char buff[40];
+    int len = sprintf(buff, "%lu,%lu,%lu", (unsigned long)daq.rearm_us, (unsigned long)daq.rearm_max_us,
+                      (unsigned long)daq.rearm_tout);
+
+    SCPI_ResultCharacters(context, buff, len);
+    return SCPI_RES_OK;
+}
+
 /************************* [VM Actions] *************************/
 
 scpi_result_t EM_VM_ReadQ(scpi_t* context)
@@ -444,6 +484,21 @@ scpi_result_t EM_SCOPE_Set(scpi_t* context)
             return SCPI_RES_ERR;
         }
 
+        /* optional trigger qualifier - hysteresis %, holdoff ms, min pulse width samples */
+        uint32_t p10 = daq.trig.set.hyst;
+        uint32_t p11 = daq.trig.set.holdoff;
+        uint32_t p12 = daq.trig.set.width;
+
+        SCPI_ParamUInt32(context, &p10, FALSE);
+        SCPI_ParamUInt32(context, &p11, FALSE);
+        SCPI_ParamUInt32(context, &p12, FALSE);
+
+        if (p10 > EM_TRIG_HYST_MAX || p11 > EM_TRIG_HOLDOFF_MAX || p12 > EM_TRIG_WIDTH_MAX)
+        {
+            SCPI_ErrorPush(context, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE);
+            return SCPI_RES_ERR;
+        }
+
         if (p5 < 1 || p5 > 4 ||
             p4l != 4 || p7l != 1 || p8l != 1 ||
             (p4[0] != '1' && p4[0] != '0') || (p4[1] != '1' && p4[1] != '0') ||
@@ -476,6 +531,7 @@ scpi_result_t EM_SCOPE_Set(scpi_t* context)
         daq.dis_hold = EM_TRUE;
 
         daq_mem_set(&daq, 3); // safety guard
+        daq_trig_qual_set(&daq, (int)p10, (int)p11, (int)p12);
         int ret2 = daq_bit_set(&daq, (int)p1);
 #ifdef EM_DAQ_4CH
         int ret4 = daq_ch_set(&daq, ch1_en, ch2_en, ch3_en, ch4_en, (int)p3);
@@ -531,7 +587,7 @@ scpi_result_t EM_SCOPE_SetQ(scpi_t* context)
 {
     if (daq.mode == SCOPE)
     {
-        char buff[100];
+        char buff[120];
         char chans_en[5];
         char edge_s[2];
         char mode_s[2];
@@ -558,8 +614,9 @@ scpi_result_t EM_SCOPE_SetQ(scpi_t* context)
         sprint_fast(T_s, "%s", (1 / (double)EM_FREQ_ADCCLK) * daq.smpl_time * 1000000000.0, 2);
 
 
-        int len = sprintf(buff, "%d,%d,%d,%s,%d,%d,%s,%s,%d,%s,%s,%s", daq.set.bits, daq.set.mem, daq.set.fs, chans_en,
-                          daq.trig.set.ch, daq.trig.set.val_percent, edge_s, mode_s, daq.trig.set.pretrigger, maxZ_s, T_s, freq_real_s);
+        int len = sprintf(buff, "%d,%d,%d,%s,%d,%d,%s,%s,%d,%s,%s,%s,%d,%d,%d", daq.set.bits, daq.set.mem, daq.set.fs, chans_en,
+                          daq.trig.set.ch, daq.trig.set.val_percent, edge_s, mode_s, daq.trig.set.pretrigger, maxZ_s, T_s, freq_real_s,
+                          daq.trig.set.hyst, daq.trig.set.holdoff, daq.trig.set.width);
 
         SCPI_ResultCharacters(context, buff, len);
         return SCPI_RES_OK;
@@ -797,12 +854,10 @@ scpi_result_t EM_LA_ForceTrig(scpi_t* context)
 
 scpi_result_t EM_CNTR_SetQ(scpi_t* context)
 {
-    char buff[3];
-    buff[0] = cntr.enabled ? '1' : '0';
-    buff[1] = ',';
-    buff[2] = cntr.fast_mode ? '1' : '0';
+    char buff[20];
+    int len = sprintf(buff, "%d,%d,%d", cntr.enabled ? 1 : 0, cntr.fast_mode ? 1 : 0, (int)cntr.gate_ms);
 
-    SCPI_ResultCharacters(context, buff, 3);
+    SCPI_ResultCharacters(context, buff, len);
     return SCPI_RES_OK;
 }
 
@@ -816,13 +871,18 @@ scpi_result_t EM_CNTR_Set(scpi_t* context)
         return SCPI_RES_ERR;
     }
 
-    if (p1 < 0 || p1 > 1 || p2 < 0 || p2 > 1)
+    /* optional gate time ms */
+    uint32_t p3 = cntr.gate_ms;
+
+    SCPI_ParamUInt32(context, &p3, FALSE);
+
+    if (p1 < 0 || p1 > 1 || p2 < 0 || p2 > 1 || p3 < EM_CNTR_GATE_MIN_MS || p3 > EM_CNTR_GATE_MAX_MS)
     {
         SCPI_ErrorPush(context, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE);
         return SCPI_RES_ERR;
     }
 
-    cntr_enable(&cntr, p1, p2);
+    cntr_enable(&cntr, p1, p2, p3);
 
     SCPI_ResultText(context, SCPI_OK);
     return SCPI_RES_OK;
@@ -837,42 +897,74 @@ scpi_result_t EM_CNTR_ReadQ(scpi_t* context)
         return SCPI_RES_ERR;
     }
 
-    double f = cntr.freq;
+    /* stats and gates closed and not pushed yet, formatted by host */
+    uint8_t buff[CNTR_READ_HEAD_LEN + EM_CNTR_RES_LEN * sizeof(double)];
+    int len = cntr_read(&cntr, buff, sizeof(buff));
 
-    if (f > -1)
+    if (len == 0) // no gate closed yet
     {
-        char f_s[20];
-        char T_s[20];
+        SCPI_ResultText(context, "Empty");
+        return SCPI_RES_OK;
+    }
 
-        double T = 1.0 / f;
+    SCPI_ResultArbitraryBlock(context, buff, len);
+    return SCPI_RES_OK;
+}
 
-        if (f < 1000)
-            sprint_fast(f_s, "%s Hz", f, 3);
-        else if (f < 1000000)
-            sprint_fast(f_s, "%s kHz", f / 1000.0, 3);
-        else //if (f < 1000000000)
-            sprint_fast(f_s, "%s MHz", f / 1000000.0, 3);
+scpi_result_t EM_CNTR_Raw(scpi_t* context)
+{
+    uint32_t p1, p2;
 
-        if (T >= 1)
-            sprint_fast(T_s, "%s s", T, 3);
-        else if (T >= 0.001)
-            sprint_fast(T_s, "%s ms", T * 1000.0, 3);
-        else if (T >= 0.000001)
-            sprint_fast(T_s, "%s us", T * 1000000.0, 3);
-        else //if (T >= 0.000000001)
-            sprint_fast(T_s, "%s ns", T * 1000000000.0, 3);
+    if (!SCPI_ParamUInt32(context, &p1, TRUE) ||
+        !SCPI_ParamUInt32(context, &p2, TRUE))
+    {
+        return SCPI_RES_ERR;
+    }
 
-        char buff[100];
-        int len = sprintf(buff, "%s,%s", f_s, T_s);
+    if (!cntr.enabled)
+    {
+        SCPI_ErrorPush(context, SCPI_ERROR_CNTR_NOT_ENABLED);
+        return SCPI_RES_ERR;
+    }
 
-        SCPI_ResultCharacters(context, buff, len);
-        return SCPI_RES_OK;
+    if (p1 < 2 || p1 > EM_CNTR_RAW_MAX || p2 > CNTR_RAW_DUTY)
+    {
+        SCPI_ErrorPush(context, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE);
+        return SCPI_RES_ERR;
     }
-    else // if (f == -1)
+
+    if (!cntr_raw(&cntr, p1, p2)) // duty needs frequency
     {
-        SCPI_ErrorPush(context, SCPI_ERROR_TIME_OUT);
+        SCPI_ErrorPush(context, SCPI_ERROR_FUNCTION_NOT_AVAILABLE);
         return SCPI_RES_ERR;
     }
+
+    SCPI_ResultText(context, SCPI_OK);
+    return SCPI_RES_OK;
+}
+
+scpi_result_t EM_CNTR_RawQ(scpi_t* context)
+{
+    if (!cntr.enabled)
+    {
+        SCPI_ErrorPush(context, SCPI_ERROR_CNTR_NOT_ENABLED);
+        return SCPI_RES_ERR;
+    }
+
+    /* header + 16-bit captures, extended to timestamps by host */
+    uint8_t head[CNTR_RAW_HEAD_LEN];
+    int len = cntr_raw_read(&cntr, head);
+
+    if (len == 0) // not finished or not requested
+    {
+        SCPI_ResultText(context, "Empty");
+        return SCPI_RES_OK;
+    }
+
+    SCPI_ResultArbitraryBlocks(context, len, cntr.raw_len1 * sizeof(uint16_t), cntr.raw_len2 * sizeof(uint16_t), 0,
+                               head, cntr.data_ccr, cntr.data_ovf, NULL);
+    cntr_raw_release(&cntr);
+    return SCPI_RES_OK;
 }
 
 /************************* [SGEN Actions] *************************/
@@ -880,12 +972,14 @@ scpi_result_t EM_CNTR_ReadQ(scpi_t* context)
 scpi_result_t EM_SGEN_SetQ(scpi_t* context)
 {
 #ifdef EM_DAC
-    char buff[60];
+    char buff[70];
+    char freq_s[20];
     char freq_real_s[20];
 
-    sprint_fast(freq_real_s, "%s", sgen.tim_f_real / (double)sgen.samples, 3);
+    sprint_fast(freq_s, "%s", sgen.freq, 3);
+    sprint_fast(freq_real_s, "%s", sgen.freq_real, 3);
 
-    int len = sprintf(buff, "%d,%d,%d,%d,%d,%s,%d", sgen.freq, (int)(sgen.ampl * 10.0), sgen.offset,
+    int len = sprintf(buff, "%s,%d,%d,%d,%d,%s,%d", freq_s, (int)(sgen.ampl * 10.0), sgen.offset,
                       sgen.mode, sgen.enabled, freq_real_s, sgen.samples);
 
     SCPI_ResultCharacters(context, buff, len);
@@ -899,9 +993,10 @@ scpi_result_t EM_SGEN_SetQ(scpi_t* context)
 scpi_result_t EM_SGEN_Set(scpi_t* context)
 {
 #ifdef EM_DAC
-    uint32_t param1, param2, param3, param4, param5;
+    double param1;
+    uint32_t param2, param3, param4, param5;
 
-    if (!SCPI_ParamUInt32(context, &param1, TRUE) ||
+    if (!SCPI_ParamDouble(context, &param1, TRUE) ||
         !SCPI_ParamUInt32(context, &param2, TRUE) ||
         !SCPI_ParamUInt32(context, &param3, TRUE) ||
         !SCPI_ParamUInt32(context, &param4, TRUE) ||
@@ -914,22 +1009,35 @@ scpi_result_t EM_SGEN_Set(scpi_t* context)
     if (param1 < 0 || param1 > EM_SGEN_MAX_F || // freq
         param2 < 0 || param2 > 1000 ||          // ampl
         param3 < 0 || param3 > 100 ||           // offset
-        param4 < 0 || param4 > 5 ||             // mode
+        param4 < 0 || param4 > 6 ||             // mode
         param5 < 0 || param5 > 1)               // enable
     {
         SCPI_ErrorPush(context, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE);
         return SCPI_RES_ERR;
     }
 
-    sgen_disable(&sgen);
+    if (param5 == EM_TRUE && param4 != CONST && param1 <= 0)
+    {
+        SCPI_ErrorPush(context, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE); // wave needs a frequency
+        return SCPI_RES_ERR;
+    }
+
+    if (param4 == ARB && param5 == EM_TRUE && (sgen.arb_len == 0 || param1 * sgen.arb_len < 1 ||
+                                               param1 * sgen.arb_len > EM_DAC_TIM_MAX_F))
+    {
+        SCPI_ErrorPush(context, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE); // nothing uploaded, timer below 1 Hz or too fast for its length
+        return SCPI_RES_ERR;
+    }
 
     if (param5 == EM_TRUE)
-        sgen_enable(&sgen, param4, (float)param2 / 10.0, param1, param3);
+        sgen_enable(&sgen, param4, (float)param2 / 10.0, param1, param3); // DDS running - no restart
+    else
+        sgen_disable(&sgen);
 
     char buff[45];
     char freq_real_s[20];
 
-    sprint_fast(freq_real_s, "%s", sgen.tim_f_real / (double)sgen.samples, 3);
+    sprint_fast(freq_real_s, "%s", sgen.freq_real, 3);
 
     int len = sprintf(buff, "\"OK\",%s,%d", freq_real_s, sgen.samples);
 
@@ -941,6 +1049,60 @@ scpi_result_t EM_SGEN_Set(scpi_t* context)
 #endif
 }
 
+scpi_result_t EM_SGEN_ArbQ(scpi_t* context)
+{
+#ifdef EM_DAC
+    char buff[30];
+
+    int len = sprintf(buff, "%d,%d,%d", sgen.arb_len, EM_DAC_BUFF_LEN, EM_SGEN_ARB_CHUNK);
+
+    SCPI_ResultCharacters(context, buff, len);
+    return SCPI_RES_OK;
+#else
+    SCPI_ErrorPush(context, SCPI_ERROR_DAC_NA);
+    return SCPI_RES_ERR;
+#endif
+}
+
+scpi_result_t EM_SGEN_Arb(scpi_t* context)
+{
+#ifdef EM_DAC
+    uint32_t param1;
+    const char* block;
+    size_t block_len;
+
+    if (!SCPI_ParamUInt32(context, &param1, TRUE) ||
+        !SCPI_ParamArbitraryBlock(context, &block, &block_len, TRUE))
+    {
+        SCPI_ErrorPush(context, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE);
+        return SCPI_RES_ERR;
+    }
+
+    if (block_len % 2 != 0 || block_len / 2 > EM_SGEN_ARB_CHUNK)  // 16-bit samples
+    {
+        SCPI_ErrorPush(context, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE);
+        return SCPI_RES_ERR;
+    }
+
+    int arb_len = sgen_arb_write(&sgen, param1, (const uint8_t*)block, block_len / 2);
+
+    if (arb_len < 0) // offset out of uploaded samples or memory
+    {
+        SCPI_ErrorPush(context, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE);
+        return SCPI_RES_ERR;
+    }
+
+    char buff[20];
+    int len = sprintf(buff, "\"OK\",%d", arb_len);
+
+    SCPI_ResultCharacters(context, buff, len);
+    return SCPI_RES_OK;
+#else
+    SCPI_ErrorPush(context, SCPI_ERROR_DAC_NA);
+    return SCPI_RES_ERR;
+#endif
+}
+
 /************************* [PWM Actions] *************************/
 
 scpi_result_t EM_PWM_SetQ(scpi_t* context)
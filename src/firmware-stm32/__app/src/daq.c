@@ -18,6 +18,8 @@
 
 
 static void daq_enable_adc(daq_data_t* self, ADC_TypeDef* adc, uint8_t enable, uint32_t dma_ch);
+static uint8_t daq_enable_settled(daq_data_t* self, uint8_t enable, uint32_t elapsed_us);
+static uint32_t daq_us(daq_data_t* self);
 static void daq_malloc(daq_data_t* self, daq_buff_t* buff, int mem, int reserve, int chans, uint32_t src, uint32_t dma_ch,
                        DMA_TypeDef* dma, enum daq_bits bits);
 static void daq_clear_buff(daq_buff_t* buff);
@@ -46,6 +48,9 @@ void daq_init(daq_data_t* self)
     self->smpl_time = 0;
     self->interleaved = EM_FALSE;
     self->dualmode = EM_FALSE;
+    self->rearm_us = 0;
+    self->rearm_max_us = 0;
+    self->rearm_tout = 0;
     self->uwTick = 0;
     self->uwTick_start = 0;
     self->vm_seq = -1;
@@ -104,6 +109,9 @@ void daq_settings_save(daq_settings_t* src1, trig_settings_t* src2, daq_settings
     dst2->edge = src2->edge;
     dst2->mode = src2->mode;
     dst2->pretrigger = src2->pretrigger;
+    dst2->hyst = src2->hyst;
+    dst2->holdoff = src2->holdoff;
+    dst2->width = src2->width;
 }
 
 void daq_settings_init(daq_data_t* self, uint8_t scope, uint8_t la)
@@ -125,6 +133,9 @@ void daq_settings_init(daq_data_t* self, uint8_t scope, uint8_t la)
         self->trig.save_s.edge = RISING;
         self->trig.save_s.mode = AUTO;
         self->trig.save_s.pretrigger = 50;
+        self->trig.save_s.hyst = 0;
+        self->trig.save_s.holdoff = 0;
+        self->trig.save_s.width = 0;
     }
 
     if (la == EM_TRUE)
@@ -144,6 +155,9 @@ void daq_settings_init(daq_data_t* self, uint8_t scope, uint8_t la)
         self->trig.save_l.edge = RISING;
         self->trig.save_l.mode = AUTO;
         self->trig.save_l.pretrigger = 50;
+        self->trig.save_l.hyst = 0;
+        self->trig.save_l.holdoff = 0;
+        self->trig.save_l.width = 0;
     }
 }
 
@@ -669,6 +683,9 @@ void daq_enable(daq_data_t* self, uint8_t enable)
         //for (int i = 0; i < 1000; i++) __asm("nop");
     }
 
+    self->trig.post_start = EM_FALSE; // posttrigger counted by t3 is void now
+    self->trig.is_post = EM_FALSE;
+
     if (self->enabled == EM_TRUE && self->dis_hold == EM_TRUE)
         return;
 
@@ -715,8 +732,25 @@ void daq_enable(daq_data_t* self, uint8_t enable)
         }
     }
 
-    for (int i = 0; i < 10000; i++)  // let DMA and ADC finish their jobs
-        __asm("nop");
+    uint32_t t0 = daq_us(self); // let DMA and ADC finish their jobs
+
+    while (1)
+    {
+        uint32_t elapsed = daq_us(self) - t0;
+
+        if (daq_enable_settled(self, enable, elapsed) == EM_TRUE)
+            break;
+
+        if (elapsed > EM_DAQ_SETTLE_US)
+        {
+            self->rearm_tout++;
+            break;
+        }
+    }
+
+    self->rearm_us = daq_us(self) - t0;
+    if (self->rearm_us > self->rearm_max_us)
+        self->rearm_max_us = self->rearm_us;
 
     if (enable == EM_TRUE) // start the timer
     {
@@ -748,6 +782,61 @@ static void daq_enable_adc(daq_data_t* self, ADC_TypeDef* adc, uint8_t enable, u
     }
 }
 
+static uint8_t daq_enable_settled(daq_data_t* self, uint8_t enable, uint32_t elapsed_us)
+{
+    if (self->mode == LA) // GPIO to memory, nothing in flight
+        return (enable == EM_FALSE || LL_DMA_IsEnabledChannel(EM_DMA_LA, EM_DMA_CH_LA));
+
+    if (enable == EM_TRUE)
+    {
+#if !defined(LL_ADC_SPEC_START) && defined(EM_ADC_MODE_ADC1)
+        return (LL_DMA_IsEnabledChannel(EM_DMA_ADC1, EM_DMA_CH_ADC1) && LL_ADC_REG_IsConversionOngoing(EM_ADC1)); // ADSTART armed
+#else
+        return LL_DMA_IsEnabledChannel(EM_DMA_ADC1, EM_DMA_CH_ADC1);
+#endif
+    }
+
+#ifdef LL_ADC_SPEC_START
+    /* no stop flag - wait for scan in flight, then DMA must be at scan boundary */
+    double scan_s = self->buff1.chans * EM_ADC_1CH_SMPL_TM(self->smpl_time, (self->set.bits == B12 ? EM_ADC_TCONV12 : EM_ADC_TCONV8));
+    if (elapsed_us < (uint32_t)(scan_s * 1000000.0) + 1)
+        return EM_FALSE;
+
+    int left = LL_DMA_GetDataLength(EM_DMA_ADC1, EM_DMA_CH_ADC1);
+
+    if (self->buff1.chans <= 0 || left > self->buff1.len) // DMA not set to this buffer yet
+        return EM_TRUE;
+
+    return ((self->buff1.len - left) % self->buff1.chans == 0);
+#else
+    /* ADSTP is cleared by hardware when regular conversions are stopped */
+    uint8_t stopping = LL_ADC_REG_IsStopConversionOngoing(EM_ADC1);
+#if defined(EM_ADC_MODE_ADC12) || defined(EM_ADC_MODE_ADC1234)
+    stopping |= LL_ADC_REG_IsStopConversionOngoing(EM_ADC2);
+#endif
+#if defined(EM_ADC_MODE_ADC1234)
+    stopping |= LL_ADC_REG_IsStopConversionOngoing(EM_ADC3);
+    stopping |= LL_ADC_REG_IsStopConversionOngoing(EM_ADC4);
+#endif
+    return (stopping == 0);
+#endif
+}
+
+static uint32_t daq_us(daq_data_t* self)
+{
+    volatile uint32_t* tick = &self->uwTick;
+    uint32_t ms, val;
+
+    do // SysTick counts down within 1 ms
+    {
+        ms = *tick;
+        val = SysTick->VAL;
+    }
+    while (ms != *tick);
+
+    return (ms * 1000) + (((SysTick->LOAD - val) * 1000) / (SysTick->LOAD + 1));
+}
+
 void daq_mode_set(daq_data_t* self, enum daq_mode mode)
 {
     if (self->mode == SCOPE)
@@ -806,6 +895,7 @@ void daq_mode_set(daq_data_t* self, enum daq_mode mode)
 #endif
         daq_fs_set(self, self->save_s.fs);
         daq_mem_set(self, self->save_s.mem);
+        daq_trig_qual_set(self, self->trig.save_s.hyst, self->trig.save_s.holdoff, self->trig.save_s.width);
         daq_trig_set(self, self->trig.save_s.ch, self->trig.save_s.val_percent, self->trig.save_s.edge,
                      self->trig.save_s.mode, self->trig.save_s.pretrigger);
     }
@@ -22,6 +22,8 @@
 #include <math.h>
 
 
+static void daq_trig_awd_set(daq_data_t* self, uint8_t rising);
+
 void daq_trig_init(daq_data_t* self)
 {
     self->trig.ignore = EM_FALSE;
@@ -60,6 +62,10 @@ void daq_trig_init(daq_data_t* self)
     self->trig.awd_lo = 0;
     self->trig.awd_rising = 0;
     self->trig.awd_rising2 = 0;
+    self->trig.awd_rearm = 0;
+    self->trig.holdoff_tick = 0;
+    self->trig.qual_cntr = 0;
+    trig_qual_init(&self->trig.qual, 0, 0, 0, 1, 0);
 }
 
 void daq_trig_check(daq_data_t* self)
@@ -88,7 +94,9 @@ void daq_trig_check(daq_data_t* self)
             {
                 ASSERT(self->trig.awd_trig != 0);
 
-                self->trig.awd_rising2 = self->trig.awd_rising;
+                /* with hysteresis signal has to get behind rearm level first */
+                self->trig.ignore = (self->trig.awd_rearm != self->trig.awd_mid);
+                daq_trig_awd_set(self, self->trig.ignore ? !self->trig.awd_rising : self->trig.awd_rising);
 
                 NVIC_ClearPendingIRQ(self->trig.adcirq_trig);
                 NVIC_EnableIRQ(self->trig.adcirq_trig);
@@ -187,85 +195,35 @@ int8_t daq_trig_trigger_scope(daq_data_t* self)
         if (self->trig.dma_pos_catched < 0)
             self->trig.dma_pos_catched += self->trig.buff_trig->len;
 
-        int prev1_last_idx = self->trig.dma_pos_catched - self->trig.buff_trig->chans;
-        if (prev1_last_idx < 0)
-            prev1_last_idx += self->trig.buff_trig->len;
-
-        int prev2_last_idx = prev1_last_idx - self->trig.buff_trig->chans;
-        if (prev2_last_idx < 0)
-            prev2_last_idx += self->trig.buff_trig->len;
-
-        int prev3_last_idx = prev2_last_idx - self->trig.buff_trig->chans;
-        if (prev3_last_idx < 0)
-            prev3_last_idx += self->trig.buff_trig->len;
-
-        int prev4_last_idx = prev3_last_idx - self->trig.buff_trig->chans;
-        if (prev4_last_idx < 0)
-            prev4_last_idx += self->trig.buff_trig->len;
-
-        uint16_t prev1_last_val = 0;
-        uint16_t prev2_last_val = 0;
-        uint16_t prev3_last_val = 0;
-        uint16_t prev4_last_val = 0;
-
-        if (self->set.bits == B8)
-        {
-            prev1_last_val = (uint16_t)(((uint8_t*)(self->trig.buff_trig->data))[prev1_last_idx]);
-            prev2_last_val = (uint16_t)(((uint8_t*)(self->trig.buff_trig->data))[prev2_last_idx]);
-            prev3_last_val = (uint16_t)(((uint8_t*)(self->trig.buff_trig->data))[prev3_last_idx]);
-            prev4_last_val = (uint16_t)(((uint8_t*)(self->trig.buff_trig->data))[prev4_last_idx]);
-        }
-        else //(self->set.bits == B12)
-        {
-            prev1_last_val = (*((uint16_t*)(((uint8_t*)self->trig.buff_trig->data)+(prev1_last_idx * 2))));
-            prev2_last_val = (*((uint16_t*)(((uint8_t*)self->trig.buff_trig->data)+(prev2_last_idx * 2))));
-            prev3_last_val = (*((uint16_t*)(((uint8_t*)self->trig.buff_trig->data)+(prev3_last_idx * 2))));
-            prev4_last_val = (*((uint16_t*)(((uint8_t*)self->trig.buff_trig->data)+(prev4_last_idx * 2))));
-        }
-
         self->trig.all_cntr++;
-        uint8_t switch_awd = 0;
-        if (self->trig.ignore == EM_TRUE)
+
+        if (self->trig.ignore == EM_TRUE) // signal got behind rearm level, wait for edge
         {
             self->trig.ignore = EM_FALSE;
-            switch_awd = 1;
+            daq_trig_awd_set(self, self->trig.awd_rising);
         }
         else
         {
-            // trigger condition
-            if ((self->trig.set.edge == RISING && (prev1_last_val <= self->trig.set.val ||
-                                                   prev2_last_val <= self->trig.set.val ||
-                                                   prev3_last_val <= self->trig.set.val ||
-                                                   prev4_last_val <= self->trig.set.val)) ||
-                (self->trig.set.edge == FALLING && (prev1_last_val >= self->trig.set.val ||
-                                                    prev2_last_val >= self->trig.set.val ||
-                                                    prev3_last_val >= self->trig.set.val ||
-                                                    prev4_last_val >= self->trig.set.val)))
+            /* edge must be in last EM_TRIG_QUAL_LOOK samples, width is counted before it */
+            int cnt = self->trig.qual.width + EM_TRIG_QUAL_LOOK + 1;
+            if (cnt > self->trig.buff_trig->len / ch_cnt)
+                cnt = self->trig.buff_trig->len / ch_cnt;
+
+            trig_qual_reset(&self->trig.qual, TQ_ARMED); // rearm was guarded by AWD
+            int age = trig_qual_run(&self->trig.qual, self->trig.buff_trig->data, self->set.bits == B8,
+                                    self->trig.dma_pos_catched, cnt, ch_cnt, self->trig.buff_trig->len);
+
+            if (age >= 0 && age < EM_TRIG_QUAL_LOOK &&
+                trig_qual_holdoff(self->uwTick, self->trig.holdoff_tick, self->trig.set.holdoff))
             {
+                self->trig.holdoff_tick = self->uwTick;
                 return daq_trig_poststart(self, self->trig.dma_pos_catched); // VALID TRIG
             }
-            else // false trig, switch edges and wait for another window
+            else // false trig, wait for signal behind rearm level
             {
+                self->trig.qual_cntr++;
                 self->trig.ignore = EM_TRUE;
-                switch_awd = 1;
-            }
-        }
-
-        if (switch_awd) // flip awd limits
-        {
-            if (self->trig.awd_rising2 == 1)
-            {
-                LL_ADC_SetAnalogWDThresholds(self->trig.adc_trig, EM_ADC_AWD LL_ADC_AWD_THRESHOLD_HIGH, self->trig.awd_hi);
-                LL_ADC_SetAnalogWDThresholds(self->trig.adc_trig, EM_ADC_AWD LL_ADC_AWD_THRESHOLD_LOW, self->trig.awd_mid);
-
-                self->trig.awd_rising2 = 0;
-            }
-            else // (self->trig.awd_rising2 == 0)
-            {
-                LL_ADC_SetAnalogWDThresholds(self->trig.adc_trig, EM_ADC_AWD LL_ADC_AWD_THRESHOLD_HIGH, self->trig.awd_mid);
-                LL_ADC_SetAnalogWDThresholds(self->trig.adc_trig, EM_ADC_AWD LL_ADC_AWD_THRESHOLD_LOW, self->trig.awd_lo);
-
-                self->trig.awd_rising2 = 1;
+                daq_trig_awd_set(self, !self->trig.awd_rising);
             }
         }
 
@@ -289,10 +247,8 @@ int8_t daq_trig_trigger_la(daq_data_t* self)
 
     if (self->trig.ready == EM_TRUE || self->trig.post_start == EM_TRUE) // invalid trig
     {
+        NVIC_DisableIRQ(self->trig.exti_trig); // no more edges until rearmed by daq_enable and pre-trigger
         NVIC_ClearPendingIRQ(self->trig.exti_trig);
-
-        for (int i = 0; i < 10000; i++)
-            __asm("nop");
     }
     else
     {
@@ -317,93 +273,160 @@ int8_t daq_trig_poststart(daq_data_t* self, int pos)
     return -1;
 }
 
-void daq_trig_postcount(daq_data_t* self) // TODO slow start ??!! 600 samples (800 ksps)
+void daq_trig_postcount(daq_data_t* self)
 {
-
-    int last_idx = self->trig.post_from;
-
     ASSERT(self->trig.buff_trig != NULL);
 
+    if (self->trig.post_start == EM_FALSE) // DAQ reenabled before t3 got here
+        return;
+
     self->trig.is_post = EM_TRUE;
     self->trig.cntr++;
 
     if (self->mode == SCOPE)
     {
-        self->trig.pos_trig = last_idx + self->trig.order;
-        if (self->trig.pos_trig >= self->trig.buff_trig->len)
-            self->trig.pos_trig -= self->trig.buff_trig->len;
+        daq_trig_post_pos(self->trig.post_from, self->trig.order, self->trig.buff_trig->chans, self->trig.buff_trig->len,
+                          self->set.mem, self->trig.set.pretrigger, EM_FALSE, &self->trig.pos_trig, &self->trig.pos_frst,
+                          &self->trig.pos_last, &self->trig.posttrig_size);
+    }
+    else // mode == LA
+    {
+        daq_trig_post_pos(self->trig.post_from, 0, 1, self->trig.buff_trig->len, self->set.mem, self->trig.set.pretrigger,
+                          EM_TRUE, &self->trig.pos_trig, &self->trig.pos_frst, &self->trig.pos_last, &self->trig.posttrig_size);
+    }
 
-        int post = (int)((double)self->set.mem * ((double)(100 - self->trig.set.pretrigger) / 100.0));
-        self->trig.posttrig_size = post * self->trig.buff_trig->chans;
+    self->trig.post_dma = self->trig.buff_trig->len - self->trig.post_from;
+    self->trig.post_sum = 0;
+}
 
-        self->trig.pos_last = self->trig.pos_trig + self->trig.posttrig_size;
-        if (self->trig.pos_last >= self->trig.buff_trig->len)
-            self->trig.pos_last -= self->trig.buff_trig->len;
+int daq_trig_postwait(daq_data_t* self)
+{
+    /* settings changed or DAQ stopped meanwhile - posttrigger is void */
+    if (self->trig.is_post == EM_FALSE)
+        return 0;
 
-        self->trig.pos_frst = self->trig.pos_trig - ((self->set.mem - post + 1) * self->trig.buff_trig->chans) + 1;
+    int len = self->trig.buff_trig->len;
+    int per_event = (self->mode == SCOPE ? self->trig.buff_trig->chans : 1);
+    double f_event = (double)EM_TIM_DAQ_FREQ / (((double)EM_TIM_DAQ->PSC + 1.0) * ((double)EM_TIM_DAQ->ARR + 1.0));
 
-        if (self->trig.pos_frst < 0)
-            self->trig.pos_frst += self->trig.buff_trig->len;
-    }
-    else // mode == LA
+    while(1)
     {
-        self->trig.pos_trig = last_idx;
-        self->trig.posttrig_size = (int)((double)self->set.mem * ((double)(100 - self->trig.set.pretrigger) / 100.0));
+        int dma = LL_DMA_GetDataLength(self->trig.dma_trig, self->trig.dma_ch_trig);
+
+        self->trig.post_sum += daq_trig_post_moved(self->trig.post_dma, dma, len);
+        self->trig.post_dma = dma;
+
+        int left = self->trig.posttrig_size - self->trig.post_sum;
 
-        self->trig.pos_last = self->trig.pos_trig + self->trig.posttrig_size;
-        if (self->trig.pos_last >= self->trig.buff_trig->len)
-            self->trig.pos_last -= self->trig.buff_trig->len;
+        if (left <= 0)
+            break;
+
+        int ms = daq_trig_post_ms(left, per_event, f_event);
 
-        self->trig.pos_frst = self->trig.pos_trig - (self->set.mem - self->trig.posttrig_size) + 1; // +1 ??
-        if (self->trig.pos_frst < 0)
-            self->trig.pos_frst += self->trig.buff_trig->len;
+        if (ms > 0)
+            return ms; // caller sleeps without mtx1, then calls again
     }
 
-    //int pos_last_len = self->trig.buff_trig->len - self->trig.pos_last;  // DMA len of last valid point to compare
-    int target_prev = self->trig.buff_trig->len - self->trig.post_from;
-    int target_sum = 0;
+    LL_TIM_DisableCounter(EM_TIM_DAQ);
 
-    while(1)
-    {
-        iwdg_feed(); // 1
+    self->trig.ready = EM_TRUE; // before daq_enable clears post_start, so no new trig sneaks in
+    daq_enable(self, EM_FALSE);
 
-        // 15 instructions worst case
-        // Cortex M3 - 1.25 IPC per core -> 72/(15/1.25) = 6 MHz max
-        int target = LL_DMA_GetDataLength(self->trig.dma_trig, self->trig.dma_ch_trig); // 6
+    self->trig.pos_diff = self->trig.pos_last - self->trig.pos_trig;
+    if (self->trig.pos_diff < 0)
+        self->trig.pos_diff += self->trig.buff_trig->len;
 
-        int target_diff = target_prev - target;
-        if (target_diff >= 0)
-            target_sum += target_diff;
-        else
-            target_sum += target_diff + self->trig.buff_trig->len;
+    if (self->trig.forced == EM_TRUE)
+        comm_daq_ready(comm_ptr, EM_RESP_RDY_F, self->trig.pos_frst);   // data ready - trig forced
+    else if (self->trig.set.mode == SINGLE)
+        comm_daq_ready(comm_ptr, EM_RESP_RDY_S, self->trig.pos_frst);   // data ready - trig single
+    else
+        comm_daq_ready(comm_ptr, EM_RESP_RDY_N, self->trig.pos_frst);   // data ready - trig normal
+
+    self->trig.post_start = EM_FALSE;
+    return 0;
+}
 
-        target_prev = target;
+void daq_trig_post_pos(int from, int order, int chans, int len, int mem, int pretrigger, uint8_t la,
+                       int* pos_trig, int* pos_frst, int* pos_last, int* post_size)
+{
+    int post = (int)((double)mem * ((double)(100 - pretrigger) / 100.0));
 
-        if (target_sum >= self->trig.posttrig_size) // pos_last_len == target
-        {
-            LL_TIM_DisableCounter(EM_TIM_DAQ);
+    *pos_trig = from + order;
+    if (*pos_trig >= len)
+        *pos_trig -= len;
 
-            daq_enable(self, EM_FALSE);
-            self->trig.ready = EM_TRUE;
-            self->trig.is_post = EM_FALSE;
+    *post_size = post * chans;
 
-            self->trig.pos_diff = self->trig.pos_last - self->trig.pos_trig;
-            if (self->trig.pos_diff < 0)
-                self->trig.pos_diff += self->trig.buff_trig->len;
+    *pos_last = *pos_trig + *post_size;
+    if (*pos_last >= len)
+        *pos_last -= len;
 
-            //self->trig.respond = EM_TRUE; // init async respond ReadyX
+    if (la)
+        *pos_frst = *pos_trig - (mem - post) + 1; // +1 ??
+    else
+        *pos_frst = *pos_trig - ((mem - post + 1) * chans) + 1;
 
-            if (self->trig.forced == EM_TRUE)
-                comm_daq_ready(comm_ptr, EM_RESP_RDY_F, self->trig.pos_frst);   // data ready - trig forced
-            else if (self->trig.set.mode == SINGLE)
-                comm_daq_ready(comm_ptr, EM_RESP_RDY_S, self->trig.pos_frst);   // data ready - trig single
-            else
-                comm_daq_ready(comm_ptr, EM_RESP_RDY_N, self->trig.pos_frst);   // data ready - trig normal
+    if (*pos_frst < 0)
+        *pos_frst += len;
+    else if (*pos_frst >= len) // LA without pretrigger, trigger at len-1
+        *pos_frst -= len;
+}
 
-            break;
-        }
+int daq_trig_post_moved(int dma_prev, int dma_now, int len)
+{
+    int moved = dma_prev - dma_now; // DMA data length counts down, reloads at 0
+
+    if (moved < 0)
+        moved += len;
+
+    return moved;
+}
+
+int daq_trig_post_ms(int left, int per_event, double f_event)
+{
+    /* sleep only half of remaining time - estimate is from timer, not from DMA,
+     * and DMA must not wrap unseen between two checks. last ms is polled */
+    double ms = ((double)left / (double)per_event) / f_event * 1000.0 / 2.0;
+
+    if (ms < EM_TRIG_POST_POLL_MS)
+        return 0;
+
+    return (int)ms;
+}
+
+int daq_trig_qual_set(daq_data_t* self, int hyst, int holdoff, int width)
+{
+    if (hyst < 0 || hyst > EM_TRIG_HYST_MAX ||
+        holdoff < 0 || holdoff > EM_TRIG_HOLDOFF_MAX ||
+        width < 0 || width > EM_TRIG_WIDTH_MAX)
+    {
+        return -1;
     }
-    self->trig.post_start = EM_FALSE;
+
+    self->trig.set.hyst = hyst;
+    self->trig.set.holdoff = holdoff;
+    self->trig.set.width = width; // applied by daq_trig_set
+    return 0;
+}
+
+static void daq_trig_awd_set(daq_data_t* self, uint8_t rising)
+{
+    /* trigger phase waits for edge at trigger level, rearm phase for opposite cross of rearm level */
+    uint32_t mid = (rising == self->trig.awd_rising ? self->trig.awd_mid : self->trig.awd_rearm);
+
+    if (rising) // fire above mid
+    {
+        LL_ADC_SetAnalogWDThresholds(self->trig.adc_trig, EM_ADC_AWD LL_ADC_AWD_THRESHOLD_HIGH, mid);
+        LL_ADC_SetAnalogWDThresholds(self->trig.adc_trig, EM_ADC_AWD LL_ADC_AWD_THRESHOLD_LOW, self->trig.awd_lo);
+    }
+    else // fire below mid
+    {
+        LL_ADC_SetAnalogWDThresholds(self->trig.adc_trig, EM_ADC_AWD LL_ADC_AWD_THRESHOLD_HIGH, self->trig.awd_hi);
+        LL_ADC_SetAnalogWDThresholds(self->trig.adc_trig, EM_ADC_AWD LL_ADC_AWD_THRESHOLD_LOW, mid);
+    }
+
+    self->trig.awd_rising2 = rising;
 }
 
 void daq_trig_update(daq_data_t* self)
@@ -661,32 +684,24 @@ int daq_trig_set(daq_data_t* self, uint32_t ch, uint8_t level, enum trig_edge ed
             res = LL_ADC_RESOLUTION_12B;
 #endif
 
+            uint32_t hyst_raw = ((uint32_t)self->adc_max_val * self->trig.set.hyst) / 100;
+
+            trig_qual_init(&self->trig.qual, level_raw, hyst_raw, self->trig.set.width, edge == RISING, (uint16_t)self->adc_max_val);
+
             self->trig.awd_hi = __LL_ADC_ANALOGWD_SET_THRESHOLD_RESOLUTION(res, (int)self->adc_max_val);
             self->trig.awd_mid = __LL_ADC_ANALOGWD_SET_THRESHOLD_RESOLUTION(res, level_raw);
+            self->trig.awd_rearm = __LL_ADC_ANALOGWD_SET_THRESHOLD_RESOLUTION(res, self->trig.qual.rearm);
             self->trig.awd_lo = __LL_ADC_ANALOGWD_SET_THRESHOLD_RESOLUTION(res, 0);
+            self->trig.awd_rising = (edge == RISING ? 1 : 0);
 
             if (edge == RISING)
-            {
                 memset(self->trig.buff_trig->data, (int)self->adc_max_val,
                        self->trig.buff_trig->len * (self->set.bits == B12 ? sizeof(uint16_t) : sizeof(uint8_t)));
-
-                LL_ADC_SetAnalogWDThresholds(adc, EM_ADC_AWD LL_ADC_AWD_THRESHOLD_HIGH, self->trig.awd_mid);
-                LL_ADC_SetAnalogWDThresholds(adc, EM_ADC_AWD LL_ADC_AWD_THRESHOLD_LOW, self->trig.awd_lo);
-
-                self->trig.awd_rising = 1;
-                self->trig.awd_rising2 = 1;
-            }
             else // (edge == FALLING)
-            {
                 memset(self->trig.buff_trig->data, 0,
                        self->trig.buff_trig->len * (self->set.bits == B12 ? sizeof(uint16_t) : sizeof(uint8_t)));
 
-                LL_ADC_SetAnalogWDThresholds(adc, EM_ADC_AWD LL_ADC_AWD_THRESHOLD_HIGH, self->trig.awd_hi);
-                LL_ADC_SetAnalogWDThresholds(adc, EM_ADC_AWD LL_ADC_AWD_THRESHOLD_LOW, self->trig.awd_mid);
-
-                self->trig.awd_rising = 0;
-                self->trig.awd_rising2 = 0;
-            }
+            daq_trig_awd_set(self, self->trig.awd_rising);
 
             self->trig.set.val = level_raw;
             self->trig.set.val_percent = level;
@@ -0,0 +1,163 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "dds.h"
+
+#include <math.h>
+
+
+#define DDS_PHASE_1     4294967296.0            // 2^32 = 1 period
+#define DDS_FRAC_BITS   15                      // interpolation between LUT entries
+
+static int16_t dds_lut[DDS_LUT_LEN + 1];        // sin 0 .. pi/2, Q15
+static uint8_t dds_lut_ready = 0;
+
+static void dds_take(dds_t* self);
+static inline uint32_t dds_out(int32_t val, int32_t max);
+
+
+void dds_init(dds_t* self)
+{
+    if (!dds_lut_ready) // once, shared by all instances
+    {
+        for (int i = 0; i <= DDS_LUT_LEN; i++)
+            dds_lut[i] = (int16_t)lround(sin(i * M_PI / 2.0 / DDS_LUT_LEN) * 32767.0);
+        dds_lut_ready = 1;
+    }
+
+    self->pending = 0;
+    self->now.wave = DDS_CONST;
+    self->now.step = 0;
+    self->now.ampl = 0;
+    self->now.offset = 0;
+    self->now.max = 0;
+
+    dds_reset(self);
+}
+
+void dds_set(dds_t* self, enum dds_wave wave, uint32_t step, uint16_t ampl, uint16_t offset, uint16_t max)
+{
+    self->pending = 0; // fill from ISR does not take half written settings
+
+    self->next.wave = wave;
+    self->next.step = step;
+    self->next.ampl = ampl;
+    self->next.offset = offset;
+    self->next.max = max;
+
+    self->pending = 1;
+}
+
+void dds_reset(dds_t* self)
+{
+    self->phase = 0;
+    self->rnd_w = 1;
+    self->rnd_z = 2;
+
+    if (self->pending)
+        dds_take(self);
+}
+
+void dds_fill(dds_t* self, uint32_t* data, int len)
+{
+    if (self->pending)
+        dds_take(self);
+
+    uint32_t phase = self->phase;
+    uint32_t step = self->now.step;
+    int32_t ampl = self->now.ampl;
+    int32_t offset = self->now.offset;
+    int32_t max = self->now.max;
+
+    switch (self->now.wave)
+    {
+    case DDS_SINE:
+        for (int i = 0; i < len; i++, phase += step)
+            data[i] = dds_out(offset + ((ampl * (dds_sin(phase) + 32768) + 32768) >> 16), max);
+        break;
+
+    case DDS_TRIANGLE:
+        for (int i = 0; i < len; i++, phase += step)
+        {
+            uint32_t t = phase << 1;
+            if (phase & 0x80000000u) // falling half
+                t = ~t;
+            data[i] = dds_out(offset + ((ampl * (int32_t)(t >> 16) + 32768) >> 16), max);
+        }
+        break;
+
+    case DDS_SAWTOOTH:
+        for (int i = 0; i < len; i++, phase += step)
+            data[i] = dds_out(offset + ((ampl * (int32_t)(phase >> 16) + 32768) >> 16), max);
+        break;
+
+    case DDS_SQUARE:
+        for (int i = 0; i < len; i++, phase += step)
+            data[i] = dds_out(offset + ((phase & 0x80000000u) ? ampl : 0), max);
+        break;
+
+    case DDS_NOISE:
+        for (int i = 0; i < len; i++, phase += step)
+        {
+            self->rnd_z = 36969L * (self->rnd_z & 65535L) + (self->rnd_z >> 16);
+            self->rnd_w = 18000L * (self->rnd_w & 65535L) + (self->rnd_w >> 16);
+            uint32_t rnd = ((uint32_t)self->rnd_z << 16) + (uint32_t)self->rnd_w;
+
+            data[i] = dds_out(offset + ((ampl * (int32_t)(rnd >> 16)) >> 16), max);
+        }
+        break;
+
+    default: // DDS_CONST - no offset
+        for (int i = 0; i < len; i++)
+            data[i] = dds_out(ampl, max);
+        break;
+    }
+
+    self->phase = phase;
+}
+
+uint32_t dds_step(double f, double fs)
+{
+    double step = f / fs * DDS_PHASE_1;
+
+    if (step < 0)
+        return 0;
+    if (step >= DDS_PHASE_1 / 2) // above Nyquist
+        return 0x7FFFFFFFu;
+    return (uint32_t)(step + 0.5);
+}
+
+double dds_freq(uint32_t step, double fs)
+{
+    return (double)step * fs / DDS_PHASE_1;
+}
+
+int32_t dds_sin(uint32_t phase)
+{
+    uint32_t x = (phase & 0x40000000u) ? ~phase : phase; // 2nd and 4th quadrant mirrored
+    x &= 0x3FFFFFFFu;
+
+    uint32_t idx = x >> (30 - DDS_LUT_BITS);
+    int32_t frac = (x >> (30 - DDS_LUT_BITS - DDS_FRAC_BITS)) & ((1 << DDS_FRAC_BITS) - 1);
+    int32_t s = dds_lut[idx] + (((dds_lut[idx + 1] - dds_lut[idx]) * frac) >> DDS_FRAC_BITS);
+
+    return (phase & 0x80000000u) ? -s : s;
+}
+
+static void dds_take(dds_t* self)
+{
+    self->now.wave = self->next.wave;
+    self->now.step = self->next.step;
+    self->now.ampl = self->next.ampl;
+    self->now.offset = self->next.offset;
+    self->now.max = self->next.max;
+
+    self->pending = 0;
+}
+
+static inline uint32_t dds_out(int32_t val, int32_t max)
+{
+    return (uint32_t)(val > max ? max : val);
+}
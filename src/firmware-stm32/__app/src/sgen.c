@@ -14,31 +14,31 @@
 
 #include <string.h>
 #include <math.h>
-#include <stdlib.h>
 
 
-static void gen_const(uint32_t* data, float A, int N);
-static void gen_sine(uint32_t* data, float A, float f, int offset, int N);
-static void gen_square(uint32_t* data, float A, float f, int offset, int N);
-static void gen_triangle(uint32_t* data, float A, float f, int offset, int N);
-static void gen_saw(uint32_t* data, float A, float f, int offset, int N);
-static void gen_noise(uint32_t* data, float A, float f, int offset, int N);
-
-static int get_rnd(int* m_w, int* m_z);
+static void sgen_dds_set(sgen_data_t* self, uint32_t step);
 
 
 void sgen_init(sgen_data_t* self)
 {
     self->enabled = EM_FALSE;
+    self->dds_on = EM_FALSE;
     self->freq = 1000;
     self->ampl = 50;
     self->offset = 50;
+    self->arb_len = 0;
     self->samples = EM_DAC_BUFF_LEN;
     self->tim_f = self->freq * EM_DAC_BUFF_LEN;
     self->tim_f_real = self->tim_f;
+    self->freq_real = self->freq;
 
     self->mode = SINE;
-    gen_sine(self->data, self->ampl, self->freq, self->offset, self->samples);
+    dds_init(&self->dds);
+    sgen_dds_set(self, dds_step(1, self->samples)); // one period per table
+    dds_reset(&self->dds);
+    dds_fill(&self->dds, self->data, self->samples);
+
+    NVIC_SetPriority(EM_IRQN_SGEN, NVIC_EncodePriority(NVIC_GetPriorityGrouping(), EM_IT_PRI_SGEN, 0));
 
     LL_DAC_Enable(EM_DAC, EM_DAC_CH);
 
@@ -47,54 +47,98 @@ void sgen_init(sgen_data_t* self)
         wait_loop_index--;
 }
 
-void sgen_enable(sgen_data_t* self, enum sgen_mode mode, float A, float f, int offset)
+void sgen_enable(sgen_data_t* self, enum sgen_mode mode, float A, double f, int offset)
 {
-    if (self->enabled == EM_TRUE) // first need to disable
-        return;
-
     ASSERT(f <= EM_SGEN_MAX_F);
+    ASSERT(A >= 0 && A <= 100 && (f > 0 || mode == CONST));
+    ASSERT(mode != ARB || (self->arb_len > 0 && f * self->arb_len <= EM_DAC_TIM_MAX_F));
+
+    uint8_t dds = (mode != CONST && mode != ARB && f <= EM_SGEN_DDS_MAX_F);
+
+    if (self->enabled == EM_TRUE && !(dds && self->dds_on)) // table has to be rebuilt
+        sgen_disable(self);
 
     self->mode = mode;
     self->freq = f;
     self->ampl = A;
     self->offset = offset;
-    self->tim_f = f * EM_DAC_BUFF_LEN;
-    self->samples = EM_DAC_BUFF_LEN;
 
-    if (self->tim_f > EM_DAC_TIM_MAX_F) // frequency too high, need to lower buffer size
+    if (self->enabled == EM_TRUE) // DDS running - IRQ takes new settings at next half buffer, phase goes on
     {
-        self->tim_f = EM_DAC_TIM_MAX_F;
-        self->samples = EM_DAC_TIM_MAX_F / self->freq;
-        ASSERT(self->samples > 0);
+        uint32_t step = dds_step(f, self->tim_f_real);
+        self->freq_real = dds_freq(step, self->tim_f_real);
+        sgen_dds_set(self, step);
+        return;
     }
 
-    if (mode == SINE)
-        gen_sine(self->data, self->ampl, self->freq, self->offset, self->samples);
-    else if (mode == SQUARE)
-        gen_square(self->data, self->ampl, self->freq, self->offset, self->samples);
-    else if (mode == TRIANGLE)
-        gen_triangle(self->data, self->ampl, self->freq, self->offset, self->samples);
-    else if (mode == SAWTOOTH)
-        gen_saw(self->data, self->ampl, self->freq, self->offset, self->samples);
-    else if (mode == NOISE)
-        gen_noise(self->data, self->ampl, self->freq, self->offset, self->samples);
-    else // mode == CONST
+    if (dds)
+    {
+        self->tim_f = EM_SGEN_DDS_FS;
+        self->samples = EM_DAC_BUFF_LEN;
+    }
+    else if (mode == ARB)
+    {
+        self->tim_f = (int)lround(f * self->arb_len); // timer rate is whole Hz, at least 1 (checked by caller)
+        self->samples = self->arb_len;
+        ASSERT(self->tim_f > 0);
+    }
+    else if (mode == CONST)
     {
         self->samples = EM_DAC_BUFF_LEN;
         self->tim_f = EM_DAC_BUFF_LEN;
-        gen_const(self->data, self->ampl, self->samples);
     }
+    else
+    {
+        self->tim_f = f * EM_DAC_BUFF_LEN;
+        self->samples = EM_DAC_BUFF_LEN;
 
+        if (self->tim_f > EM_DAC_TIM_MAX_F) // frequency too high, need to lower buffer size
+        {
+            self->tim_f = EM_DAC_TIM_MAX_F;
+            self->samples = EM_DAC_TIM_MAX_F / self->freq;
+            ASSERT(self->samples > 0);
+        }
+    }
 
     int prescaler = 1;
     int reload = 0;
 
     self->tim_f_real = get_freq(&prescaler, &reload, EM_TIM_SGEN_MAX, EM_TIM_SGEN_FREQ, self->tim_f);
 
+    if (dds)
+    {
+        uint32_t step = dds_step(f, self->tim_f_real);
+        self->freq_real = dds_freq(step, self->tim_f_real);
+        sgen_dds_set(self, step);
+    }
+    else
+    {
+        self->freq_real = self->tim_f_real / (double)self->samples;
+        if (mode != ARB)
+            sgen_dds_set(self, dds_step(1, self->samples)); // one period per table
+    }
+
+    if (mode != ARB)
+    {
+        self->arb_len = 0; // uploaded samples overwritten
+        dds_reset(&self->dds);
+        dds_fill(&self->dds, self->data, self->samples);
+    }
+
     dma_set((uint32_t)&self->data, EM_DMA_SGEN, EM_DMA_CH_SGEN,
             LL_DAC_DMA_GetRegAddr(EM_DAC, EM_DAC_CH, LL_DAC_DMA_REG_DATA_12BITS_RIGHT_ALIGNED), self->samples,
             LL_DMA_PDATAALIGN_WORD, LL_DMA_MDATAALIGN_WORD, LL_DMA_DIRECTION_MEMORY_TO_PERIPH);
 
+    if (dds)
+    {
+        EM_DMA_SGEN_FLAG(LL_DMA_ClearFlag_HT)(EM_DMA_SGEN);
+        EM_DMA_SGEN_FLAG(LL_DMA_ClearFlag_TC)(EM_DMA_SGEN);
+        LL_DMA_EnableIT_HT(EM_DMA_SGEN, EM_DMA_CH_SGEN);
+        LL_DMA_EnableIT_TC(EM_DMA_SGEN, EM_DMA_CH_SGEN);
+        NVIC_ClearPendingIRQ(EM_IRQN_SGEN);
+        NVIC_EnableIRQ(EM_IRQN_SGEN);
+    }
+
     /*
     if (mode == NOISE)
     {
@@ -113,12 +157,14 @@ void sgen_enable(sgen_data_t* self, enum sgen_mode mode, float A, float f, int o
     LL_TIM_SetPrescaler(EM_TIM_SGEN, prescaler);
     LL_TIM_EnableCounter(EM_TIM_SGEN);
 
+    self->dds_on = dds;
     self->enabled = EM_TRUE;
 }
 
 void sgen_disable(sgen_data_t* self)
 {
-    memset(self->data, 0x00, EM_DAC_BUFF_LEN * sizeof(uint32_t));
+    if (self->arb_len == 0) // uploaded samples stay for next enable
+        memset(self->data, 0x00, EM_DAC_BUFF_LEN * sizeof(uint32_t));
 
     /*
     uint32_t wait_loop_index = ((LL_DAC_DELAY_STARTUP_VOLTAGE_SETTLING_US * (SystemCoreClock / (100000 * 2))) / 10);
@@ -131,125 +177,53 @@ void sgen_disable(sgen_data_t* self)
     LL_DAC_DisableTrigger(EM_DAC, EM_DAC_CH);
     LL_DMA_DisableChannel(EM_DMA_SGEN, EM_DMA_CH_SGEN); // ADDED 29.5.21
 
-    self->enabled = EM_FALSE;
-}
-
-/**************************** wave generation functions **********************************/
-
-static void gen_const(uint32_t* data, float A, int N)
-{
-    ASSERT(A >= 0 && A <= 100);
-
-    float a = (A/100.0*EM_DAC_MAX_VAL);
+    NVIC_DisableIRQ(EM_IRQN_SGEN);
+    LL_DMA_DisableIT_HT(EM_DMA_SGEN, EM_DMA_CH_SGEN);
+    LL_DMA_DisableIT_TC(EM_DMA_SGEN, EM_DMA_CH_SGEN);
 
-    for (int i = 0; i < N; i++)
-    {
-        data[i] = (uint32_t)(a);
-    }
+    self->dds_on = EM_FALSE;
+    self->enabled = EM_FALSE;
 }
 
-static void gen_sine(uint32_t* data, float A, float f, int offset, int N)
+void sgen_dds_refill(sgen_data_t* self, uint8_t second)
 {
-    ASSERT(A >= 0 && A <= 100 && f > 0);
-
-    float max = EM_DAC_MAX_VAL;
-    float a = ((A/100.0*max)/2);
-    uint32_t o = (((float)offset / 100.0 * max) / 2.0);
+    int half = EM_DAC_BUFF_LEN / 2;
 
-    for (int i = 0; i < N; i++)
-    {
-        data[i] = (uint32_t)(a*(sin((float)i*2.0*PI/(float)N) + 1)) + o;
-
-        if (data[i] > EM_DAC_MAX_VAL)
-            data[i] = EM_DAC_MAX_VAL;
-    }
+    dds_fill(&self->dds, self->data + (second ? half : 0), half);
 }
 
-static void gen_square(uint32_t* data, float A, float f, int offset, int N)
+/* chunk of 12-bit samples, 16-bit little-endian, at offset 0 upload starts again - returns uploaded count, -1 = error */
+int sgen_arb_write(sgen_data_t* self, int offset, const uint8_t* data, int count)
 {
-    ASSERT(A >= 0 && A <= 100 && f > 0);
+    if (offset < 0 || count < 0 || offset > self->arb_len || offset + count > EM_DAC_BUFF_LEN)
+        return -1;
 
-    float max = EM_DAC_MAX_VAL;
-    float a = (A/100.0*max);
-    uint32_t o = (((float)offset / 100.0 * max) / 2.0);
+    if (self->enabled == EM_TRUE && self->mode != ARB) // DDS or generated table would overwrite it
+        sgen_disable(self);
 
-    int half = N / 2;
-
-    for (int i = 0; i < N; i++)
-    {
-        data[i] = (uint32_t)(i >= half ? a : 0) + o;
-
-        if (data[i] > EM_DAC_MAX_VAL)
-            data[i] = EM_DAC_MAX_VAL;
-    }
-}
-
-static void gen_triangle(uint32_t* data, float A, float f, int offset, int N)
-{
-    ASSERT(A >= 0 && A <= 100 && f > 0);
-    
-    float max = EM_DAC_MAX_VAL;
-    float a = (A/100.0*max);
-    uint32_t o = (((float)offset / 100.0 * max) / 2.0);
+    if (offset == 0)
+        self->arb_len = 0;
 
-    int p = N / 2.0;
+    uint32_t* dst = self->data + offset;
 
-    for (int i = 0; i < N; i++)
+    for (int i = 0; i < count; i++)
     {
-        data[i] = (uint32_t)((a/(float)p) * (float)(p - abs(i % (2*p) - p) )) + o;
-
-        if (data[i] > EM_DAC_MAX_VAL)
-            data[i] = EM_DAC_MAX_VAL;
+        uint32_t val = data[2 * i] | ((uint32_t)data[2 * i + 1] << 8);
+        dst[i] = (val > EM_DAC_MAX_VAL ? EM_DAC_MAX_VAL : val);
     }
-}
-
-static void gen_saw(uint32_t* data, float A, float f, int offset, int N)
-{
-    ASSERT(A >= 0 && A <= 100 && f > 0);
-
-    float max = EM_DAC_MAX_VAL;
-    float a = (A/100.0*max);
-    uint32_t o =  (((float)offset / 100.0 * max) / 2.0);
-
-    float inc = a / (float)N;
-    float _a = 0;
-
-    for (int i = 0; i < N; i++)
-    {
-        data[i] = (uint32_t)(_a) + o;
 
-        if (data[i] > EM_DAC_MAX_VAL)
-            data[i] = EM_DAC_MAX_VAL;
+    if (offset + count > self->arb_len)
+        self->arb_len = offset + count;
 
-        _a += inc;
-    }
+    return self->arb_len;
 }
 
-static void gen_noise(uint32_t* data, float A, float f, int offset, int N)
+static void sgen_dds_set(sgen_data_t* self, uint32_t step)
 {
-    ASSERT(A >= 0 && A <= 100 && f > 0);
-
     float max = EM_DAC_MAX_VAL;
-    float a = (A/100.0*max);
-    uint32_t o =  (((float)offset / 100.0 * max) / 2.0);
-
-    int m_w = 1;
-    int m_z = 2;
-
-    for (int i = 0; i < N; i++)
-    {
-        data[i] = (uint32_t)(((float)get_rnd(&m_w, &m_z) / 2147483647.0) * a) + o;
 
-        if (data[i] > EM_DAC_MAX_VAL)
-            data[i] = EM_DAC_MAX_VAL;
-    }
+    dds_set(&self->dds, (enum dds_wave)self->mode, step, (uint16_t)(self->ampl / 100.0 * max),
+            (uint16_t)(((float)self->offset / 100.0 * max) / 2.0), (uint16_t)max);
 }
 
-static int get_rnd(int* m_w, int* m_z)
-{
-    *m_z = 36969L * (*m_z & 65535L) + (*m_z >> 16);
-    *m_w = 18000L * (*m_w & 65535L) + (*m_w >> 16);
-    return (*m_z << 16) + *m_w;
-} 
-
 #endif
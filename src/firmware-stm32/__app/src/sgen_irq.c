@@ -0,0 +1,36 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "cfg.h"
+
+#ifdef EM_DAC
+
+#include "app_data.h"
+#include "main.h"
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+/* DDS - DMA just played one half of buffer, fill it with next samples */
+void EM_DMA_SGEN_IRQh(void)
+{
+    traceISR_ENTER();
+
+    if (EM_DMA_SGEN_FLAG(LL_DMA_IsActiveFlag_HT)(EM_DMA_SGEN) == 1)
+    {
+        EM_DMA_SGEN_FLAG(LL_DMA_ClearFlag_HT)(EM_DMA_SGEN);
+        sgen_dds_refill(&sgen, EM_FALSE);
+    }
+
+    if (EM_DMA_SGEN_FLAG(LL_DMA_IsActiveFlag_TC)(EM_DMA_SGEN) == 1)
+    {
+        EM_DMA_SGEN_FLAG(LL_DMA_ClearFlag_TC)(EM_DMA_SGEN);
+        sgen_dds_refill(&sgen, EM_TRUE);
+    }
+
+    traceISR_EXIT();
+}
+
+#endif
@@ -0,0 +1,50 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "trig_qual.h"
+
+
+void trig_qual_init(trig_qual_t* self, uint16_t level, uint16_t hyst, uint16_t width, uint8_t rising, uint16_t max)
+{
+    self->level = level;
+    self->width = width;
+    self->rising = rising;
+
+    if (rising)
+        self->rearm = (level > hyst ? level - hyst : 0);
+    else
+        self->rearm = ((uint32_t)level + hyst < max ? level + hyst : max);
+
+    trig_qual_reset(self, TQ_ARMED);
+}
+
+void trig_qual_reset(trig_qual_t* self, enum trig_qual_state state)
+{
+    self->state = state;
+    self->run = 0;
+}
+
+int trig_qual_run(trig_qual_t* self, const void* data, uint8_t b8, int last, int cnt, int stride, int len)
+{
+    int age = -1;
+    int idx = last - (cnt - 1) * stride; // oldest sample of window
+
+    while (idx < 0)
+        idx += len;
+
+    for (int i = cnt - 1; i >= 0; i--)
+    {
+        uint16_t x = (b8 ? ((const uint8_t*)data)[idx] : ((const uint16_t*)data)[idx]);
+
+        if (trig_qual_step(self, x))
+            age = i; // samples from last, newest edge wins
+
+        idx += stride;
+        if (idx >= len)
+            idx -= len;
+    }
+
+    return age;
+}
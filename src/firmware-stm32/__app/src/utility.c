@@ -14,6 +14,10 @@
 
 void assert2(const char *file, uint32_t line)
 {
+#ifdef EM_HOST
+    fprintf(stderr, "ASSERT failed: %s:%u\n", file, (unsigned)line);
+    abort();
+#endif
     while(1);
     //__asm("bkpt 3");
 }
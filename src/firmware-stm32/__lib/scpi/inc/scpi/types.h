@@ -142,6 +142,7 @@ extern "C" {
     typedef size_t(*scpi_write_t)(scpi_t * context, const char * data, size_t len);
     typedef scpi_result_t(*scpi_write_control_t)(scpi_t * context, scpi_ctrl_name_t ctrl, scpi_reg_val_t val);
     typedef int (*scpi_error_callback_t)(scpi_t * context, int_fast16_t error);
+    typedef int32_t (*scpi_cmd_index_t)(const char * header, int len); // EDITED: candidate in cmdlist, -1 = none
 
     /* scpi lexer */
     enum _scpi_token_type_t {
@@ -386,6 +387,7 @@ extern "C" {
         char idn5[50];
         size_t arbitrary_reminding;
         void* comm;
+        scpi_cmd_index_t cmd_index; // EDITED: dispatch table, NULL = linear search only
     };
 
     enum _scpi_array_format_t {
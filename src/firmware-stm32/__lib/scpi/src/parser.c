@@ -171,6 +171,18 @@ static scpi_bool_t findCommandHeader(scpi_t * context, const char * header, int
     int32_t i;
     const scpi_command_t * cmd;
 
+    /* EDITED: only candidate of dispatch table is matched, linear search is fallback */
+    if (context->cmd_index != NULL) {
+        i = context->cmd_index(header, len);
+        if (i >= 0) {
+            cmd = &context->cmdlist[i];
+            if (matchCommand(cmd->pattern, header, len, NULL, 0, 0)) {
+                context->param_list.cmd = cmd;
+                return TRUE;
+            }
+        }
+    }
+
     for (i = 0; context->cmdlist[i].pattern != NULL; i++) {
         cmd = &context->cmdlist[i];
         if (matchCommand(cmd->pattern, header, len, NULL, 0, 0)) {
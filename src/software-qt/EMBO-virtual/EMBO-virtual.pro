@@ -0,0 +1,22 @@
+# Virtual EMBO instrument on Linux pseudo-terminal - for host benchmarks and CI without hardware
+
+TEMPLATE = app
+TARGET = embo-virtual
+
+CONFIG += console c++11
+CONFIG -= qt app_bundle
+
+VERSION = 0.2.2
+
+DEFINES += APP_VERSION=\\\"$$VERSION\\\"
+
+SOURCES += \
+    src/device.cpp \
+    src/link.cpp \
+    src/main.cpp \
+    src/waveform.cpp
+
+HEADERS += \
+    src/device.h \
+    src/link.h \
+    src/waveform.h
@@ -0,0 +1,1516 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "device.h"
+
+#include <thread>
+#include <algorithm>
+#include <string.h>
+
+#include <cmath>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+
+
+#define DEV_CNTR_MEAS_MS    2000
+#define DEV_LN2POW14        9.70406
+#define DEV_LN2POW10        6.93147
+#define DEV_ADC_C_F         0.000000000005
+#define DEV_ADC_R_OHM       1000.0
+#define DEV_DDS_PHASE_1     4294967296.0
+
+
+const VirtualDevice::Command VirtualDevice::s_commands[] =
+{
+    { "*IDN?",              &VirtualDevice::idnQ },
+    { "*RST",               &VirtualDevice::rst },
+    { "*STB?",              &VirtualDevice::stbQ },
+    { "*CLS",               &VirtualDevice::cls },
+
+    { "SYStem:MODE?",       &VirtualDevice::sysModeQ },
+    { "SYStem:MODE",        &VirtualDevice::sysMode },
+    { "SYStem:LIMits?",     &VirtualDevice::sysLimitsQ },
+    { "SYStem:INFO?",       &VirtualDevice::sysInfoQ },
+    { "SYStem:UPTime?",     &VirtualDevice::sysUptimeQ },
+    { "SYStem:BAUD?",       &VirtualDevice::sysBaudQ },
+    { "SYStem:BAUD",        &VirtualDevice::sysBaud },
+    { "SYStem:REARm?",      &VirtualDevice::sysRearmQ },
+
+    { "VM:READ?",           &VirtualDevice::vmReadQ },
+
+    { "SCOPe:READ?",        &VirtualDevice::scopReadQ },
+    { "SCOPe:SET?",         &VirtualDevice::scopSetQ },
+    { "SCOPe:SET",          &VirtualDevice::scopSet },
+    { "SCOPe:FORCetrig",    &VirtualDevice::scopForce },
+
+    { "LA:READ?",           &VirtualDevice::laReadQ },
+    { "LA:SET?",            &VirtualDevice::laSetQ },
+    { "LA:SET",             &VirtualDevice::laSet },
+    { "LA:FORCetrig",       &VirtualDevice::laForce },
+
+    { "CNTR:SET?",          &VirtualDevice::cntrSetQ },
+    { "CNTR:SET",           &VirtualDevice::cntrSet },
+    { "CNTR:READ?",         &VirtualDevice::cntrReadQ },
+    { "CNTR:RAW?",          &VirtualDevice::cntrRawQ },
+    { "CNTR:RAW",           &VirtualDevice::cntrRaw },
+
+    { "SGEN:SET?",          &VirtualDevice::sgenSetQ },
+    { "SGEN:SET",           &VirtualDevice::sgenSet },
+    { "SGEN:ARB?",          &VirtualDevice::sgenArbQ },
+    { "SGEN:ARB",           &VirtualDevice::sgenArb },
+
+    { "PWM:SET?",           &VirtualDevice::pwmSetQ },
+    { "PWM:SET",            &VirtualDevice::pwmSet },
+
+    { NULL, NULL }
+};
+
+VirtualDevice::VirtualDevice(const DeviceConfig& cfg) : m_cfg(cfg), m_wave(cfg.seed)
+{
+    m_wave.setPeriods(cfg.periods);
+    m_wave.setNoise(cfg.noise);
+
+    m_start = Clock::now();
+    m_now = m_start;
+    m_vm_last = m_start;
+    m_rx_last = m_start;
+
+    settingsInit(true, true);
+}
+
+std::string VirtualDevice::process(const std::string& line, Clock::time_point now)
+{
+    m_now = now;
+    m_rx_last = now;
+    m_async.clear();
+
+    if (m_cfg.latency_us > 0)
+        std::this_thread::sleep_for(std::chrono::microseconds(m_cfg.latency_us));
+
+    std::string out;
+    int output_count = 0;
+    int cmd_count = 0;
+
+    for (const std::string& cmd_raw : split(line, ';'))
+    {
+        size_t from = cmd_raw.find_first_not_of(" \t\r");
+        if (from == std::string::npos)
+            continue;
+
+        std::string cmd = cmd_raw.substr(from);
+        size_t space = cmd.find(' ');
+        std::string header = cmd.substr(0, space);
+        std::vector<std::string> params;
+
+        if (space != std::string::npos)
+        {
+            for (std::string param : split(cmd.substr(space + 1), ','))
+            {
+                size_t p_from = param.find_first_not_of(" \t\r");
+                size_t p_to = param.find_last_not_of(" \t\r");
+
+                if (p_from != std::string::npos && blockLen(param, p_from) > 0) // block data kept as is
+                    params.push_back(param.substr(p_from));
+                else if (p_from != std::string::npos)
+                    params.push_back(param.substr(p_from, p_to - p_from + 1));
+            }
+        }
+
+        m_commands++;
+        cmd_count++;
+
+        Result res;
+        const Command* it = s_commands;
+
+        while (it->pattern != NULL && !match(it->pattern, header))
+            it++;
+
+        if (it->pattern == NULL)
+            res.err = ERR_UNDEFINED_HEADER;
+        else
+            (this->*(it->handler))(params, res);
+
+        /* same separators as scpi lib - results by ',', commands by ';', error is written immediately */
+
+        if (output_count > 0)
+            out += ';';
+
+        if (res.err != 0)
+        {
+            char buff[100];
+            snprintf(buff, sizeof(buff), ";ERROR %d \"%s\";", res.err, errText(res.err));
+            out += buff;
+            output_count = 0;
+        }
+        else
+        {
+            for (size_t i = 0; i < res.fields.size(); i++)
+            {
+                if (i > 0)
+                    out += ',';
+                out += res.fields[i];
+            }
+            output_count = (int)res.fields.size();
+        }
+    }
+
+    if (m_baud_next != 0) // response is sent at old baud rate, caller switches after it
+    {
+        m_baud = m_baud_next;
+        m_baud_next = 0;
+    }
+
+    if (cmd_count == 0)
+        return m_async;
+
+    return m_async + out + "\r\n";
+}
+
+std::string VirtualDevice::poll(Clock::time_point now)
+{
+    m_now = now;
+
+    if (m_baud != DEV_UART_BAUD && now - m_rx_last > std::chrono::milliseconds(DEV_UART_IDLE_MS)) // host gone or failed
+        m_baud = DEV_UART_BAUD;
+
+    std::string ret;
+
+    if (m_cntr_en) // new gates pushed as "ReadyC",#<record>
+    {
+        cntrGates();
+
+        while (!m_cntr_res.empty())
+            ret += "\"ReadyC\"," + cntrRecord(DEV_CNTR_PUSH_LEN) + "\r\n";
+    }
+
+    if (m_mode == DM_VM || !m_armed || m_ready)
+        return ret;
+
+    const DaqState& daq = (m_mode == DM_SCOPE ? m_scope : m_la);
+    double frame_s = std::max((double)daq.mem / fsReal(daq.fs), 0.001);
+
+    if (std::chrono::duration<double>(now - m_arm_time).count() < frame_s)
+        return ret;
+
+    return ret + ready(daq.trig_mode);
+}
+
+/* private */
+
+bool VirtualDevice::match(const char* pattern, const std::string& header)
+{
+    std::string pat(pattern);
+    std::string hdr = header;
+
+    if (!hdr.empty() && hdr[0] == ':')
+        hdr.erase(0, 1);
+
+    bool pat_q = !pat.empty() && pat.back() == '?';
+    bool hdr_q = !hdr.empty() && hdr.back() == '?';
+
+    if (pat_q != hdr_q)
+        return false;
+    if (pat_q)
+    {
+        pat.pop_back();
+        hdr.pop_back();
+    }
+
+    std::vector<std::string> pat_nodes = split(pat, ':');
+    std::vector<std::string> hdr_nodes = split(hdr, ':');
+
+    if (pat_nodes.size() != hdr_nodes.size())
+        return false;
+
+    for (size_t i = 0; i < pat_nodes.size(); i++)
+    {
+        std::string full;
+        std::string shrt;
+
+        for (char c : pat_nodes[i])
+        {
+            full += (char)toupper((unsigned char)c);
+            if (!islower((unsigned char)c))
+                shrt += c;
+        }
+
+        std::string node;
+        for (char c : hdr_nodes[i])
+            node += (char)toupper((unsigned char)c);
+
+        if (node != full && node != shrt)
+            return false;
+    }
+
+    return true;
+}
+
+bool VirtualDevice::lineComplete(const std::string& line)
+{
+    for (size_t i = 0; i < line.size(); i++)
+    {
+        size_t len = blockLen(line, i);
+
+        if (len > line.size() - i)
+            return false;
+        if (len > 0)
+            i += len - 1;
+    }
+    return true;
+}
+
+/* delimiters inside block data do not split */
+std::vector<std::string> VirtualDevice::split(const std::string& str, char delim)
+{
+    std::vector<std::string> ret;
+    size_t from = 0;
+
+    while (true)
+    {
+        size_t pos = from;
+
+        for (; pos < str.size() && str[pos] != delim; pos++)
+        {
+            size_t len = blockLen(str, pos);
+            if (len > 0)
+                pos = std::min(pos + len, str.size()) - 1;
+        }
+        if (pos >= str.size())
+            pos = std::string::npos;
+        ret.push_back(str.substr(from, pos == std::string::npos ? std::string::npos : pos - from));
+
+        if (pos == std::string::npos)
+            break;
+
+        from = pos + 1;
+    }
+
+    return ret;
+}
+
+/* length of definite length arbitrary block #<n><len><data> at pos including header, 0 = no block there */
+size_t VirtualDevice::blockLen(const std::string& str, size_t pos)
+{
+    if (pos + 1 >= str.size() || str[pos] != '#' || str[pos + 1] < '1' || str[pos + 1] > '9')
+        return 0;
+
+    size_t digits = str[pos + 1] - '0';
+    size_t len = 0;
+
+    if (pos + 2 + digits > str.size())
+        return 0;
+
+    for (size_t i = pos + 2; i < pos + 2 + digits; i++)
+    {
+        if (str[i] < '0' || str[i] > '9')
+            return 0;
+        len = len * 10 + (str[i] - '0');
+    }
+
+    return 2 + digits + len;
+}
+
+bool VirtualDevice::blockData(const std::string& str, std::string& data)
+{
+    size_t len = blockLen(str, 0);
+
+    if (len == 0 || len != str.size())
+        return false;
+
+    data = str.substr(2 + (str[1] - '0'));
+    return true;
+}
+
+bool VirtualDevice::toUInt(const std::string& str, uint32_t& val)
+{
+    if (str.empty() || str.size() > 10)
+        return false;
+
+    uint64_t acc = 0;
+
+    for (char c : str)
+    {
+        if (c < '0' || c > '9')
+            return false;
+        acc = acc * 10 + (c - '0');
+    }
+
+    if (acc > 0xFFFFFFFFULL)
+        return false;
+
+    val = (uint32_t)acc;
+    return true;
+}
+
+bool VirtualDevice::toDouble(const std::string& str, double& val)
+{
+    if (str.empty())
+        return false;
+
+    char* end;
+    val = strtod(str.c_str(), &end);
+
+    return *end == '\0' && std::isfinite(val);
+}
+
+std::string VirtualDevice::fmt(double val, int decimals)
+{
+    char buff[40];
+    snprintf(buff, sizeof(buff), "%.*f", decimals, val);
+    return buff;
+}
+
+const char* VirtualDevice::errText(int err)
+{
+    switch (err)
+    {
+    case ERR_UNDEFINED_HEADER:        return "Undefined header";
+    case ERR_MISSING_PARAMETER:       return "Missing parameter";
+    case ERR_ILLEGAL_PARAMETER_VALUE: return "Illegal parameter value";
+    case ERR_TIME_OUT:                return "Time out error";
+    case ERR_DAC_NA:                  return "DAC not available";
+    case ERR_CNTR_NOT_ENABLED:        return "Counter is not enabled";
+    case ERR_INVALID_MODE:            return "Invalid mode";
+    case ERR_FUNCTION_NA:             return "Function not available for current settings";
+    case ERR_FUNCTION_NA2:            return "Function not available";
+    default:                          return "Unknown error";
+    }
+}
+
+/************************* [IEEE 488] *************************/
+
+void VirtualDevice::idnQ(const std::vector<std::string>&, Result& res)
+{
+    res.fields = { DEV_AUTHOR, DEV_NAME "-UART", "0", DEV_FW_VER " (virtual)" };
+}
+
+void VirtualDevice::rst(const std::vector<std::string>& params, Result& res)
+{
+    std::string p1 = params.empty() ? "" : params[0];
+
+    modeSet(DM_VM);
+
+    if (p1 == "S")
+    {
+        settingsInit(true, false);
+        modeSet(DM_SCOPE);
+    }
+    else if (p1 == "L")
+    {
+        settingsInit(false, true);
+        modeSet(DM_LA);
+    }
+    else
+    {
+        settingsInit(true, true);
+        m_cntr_en = false;
+        m_pwm_en1 = false;
+        m_pwm_en2 = false;
+        m_sgen_en = false;
+        m_sgen_dds = false;
+    }
+
+    res.fields = { quote("OK") };
+}
+
+void VirtualDevice::stbQ(const std::vector<std::string>&, Result& res)
+{
+    res.fields = { "0" };
+}
+
+void VirtualDevice::cls(const std::vector<std::string>&, Result&)
+{
+}
+
+/************************* [System Actions] *************************/
+
+void VirtualDevice::sysMode(const std::vector<std::string>& params, Result& res)
+{
+    if (params.empty())
+    {
+        res.err = ERR_MISSING_PARAMETER;
+        return;
+    }
+
+    if (params[0] == "SCOPE" || params[0] == "SCOP")
+        modeSet(DM_SCOPE);
+    else if (params[0] == "VM")
+        modeSet(DM_VM);
+    else if (params[0] == "LA")
+        modeSet(DM_LA);
+    else
+    {
+        res.err = ERR_ILLEGAL_PARAMETER_VALUE;
+        return;
+    }
+
+    res.fields = { quote("OK") };
+}
+
+void VirtualDevice::sysModeQ(const std::vector<std::string>&, Result& res)
+{
+    res.fields = { quote(m_mode == DM_SCOPE ? "SCOPE" : (m_mode == DM_VM ? "VM" : "LA")) };
+}
+
+void VirtualDevice::sysLimitsQ(const std::vector<std::string>&, Result& res)
+{
+    char buff[160];
+
+    snprintf(buff, sizeof(buff), "%d,%d,%d,%d,%d,%d,%d%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%s",
+             m_cfg.max_fs12, m_cfg.max_fs8, m_cfg.max_mem, m_cfg.max_la_fs, m_cfg.max_pwm_f, m_cfg.pwm2,
+             m_cfg.daq_ch, m_cfg.adc_num, m_cfg.bit8, m_cfg.dac, DEV_VM_FS, DEV_VM_MEM, DEV_CNTR_MEAS_MS,
+             m_cfg.max_sgen_f, m_cfg.sgen_mem, m_cfg.max_cntr_f, m_cfg.reserve, m_cfg.daq_ch == 4 ? "0123" : "0100");
+
+    res.fields = { buff };
+}
+
+void VirtualDevice::sysInfoQ(const std::vector<std::string>&, Result& res)
+{
+    res.fields = { "V10.3.1", "virtual", "PTY", std::to_string(DEV_FREQ_ADCCLK / 1000000), std::to_string(DEV_VCC_MV),
+                   "V1-V2-V3-V4", "L1-L2-L3-L4", "C1", "P1-P2", "S1" };
+}
+
+void VirtualDevice::sysUptimeQ(const std::vector<std::string>&, Result& res)
+{
+    int ms = (int)std::chrono::duration_cast<std::chrono::milliseconds>(m_now - m_start).count();
+
+    int h = ms / 3600000;
+    ms -= 3600000 * h;
+    int m = ms / 60000;
+    ms -= 60000 * m;
+    int s = ms / 1000;
+    ms -= 1000 * s;
+
+    char buff[40];
+    snprintf(buff, sizeof(buff), "%02d:%02d:%02d.%01d", h, m, s, ms / 100);
+
+    res.fields = { buff };
+}
+
+void VirtualDevice::sysBaud(const std::vector<std::string>& params, Result& res)
+{
+    uint32_t baud;
+
+    if (params.empty() || !toUInt(params[0], baud))
+    {
+        res.err = ERR_MISSING_PARAMETER;
+        return;
+    }
+
+    /* same check as comm_baud_valid - oversampling 16, BRR = USARTDIV */
+    uint32_t div = baud > 0 ? (DEV_UART_CLK + baud / 2) / baud : 0;
+    uint32_t real = div > 0 ? DEV_UART_CLK / div : 0;
+    uint32_t diff = real > baud ? real - baud : baud - real;
+
+    if (baud < DEV_UART_BAUD_MIN || baud > DEV_UART_BAUD_MAX || (uint64_t)diff * 1000 / baud > DEV_UART_BAUD_ERR)
+    {
+        res.err = ERR_ILLEGAL_PARAMETER_VALUE;
+        return;
+    }
+
+    m_baud_next = baud;
+    res.fields = { std::to_string(baud) };
+}
+
+void VirtualDevice::sysBaudQ(const std::vector<std::string>&, Result& res)
+{
+    res.fields = { std::to_string(m_baud) };
+}
+
+void VirtualDevice::sysRearmQ(const std::vector<std::string>&, Result& res)
+{
+    res.fields = { "0", "0", "0" }; // last, max settle us and timeouts - emulated DAQ re-arms at once
+}
+
+/************************* [VM Actions] *************************/
+
+void VirtualDevice::vmReadQ(const std::vector<std::string>& params, Result& res)
+{
+    if (m_mode != DM_VM)
+    {
+        res.err = ERR_INVALID_MODE;
+        return;
+    }
+
+    uint32_t p1 = 0;
+
+    if (!params.empty() && (!toUInt(params[0], p1) || p1 > 1))
+    {
+        res.err = ERR_ILLEGAL_PARAMETER_VALUE;
+        return;
+    }
+
+    if (p1 == 1) // sequential mode, each sample only once
+    {
+        if (std::chrono::duration<double>(m_now - m_vm_last).count() < 1.0 / DEV_VM_FS)
+        {
+            res.fields = { quote("Empty") };
+            return;
+        }
+        m_vm_last = m_now;
+    }
+
+    double t = std::chrono::duration<double>(m_now - m_start).count();
+    double vcc = DEV_VCC_MV / 1000.0;
+
+    for (int ch = 0; ch < 4; ch++)
+    {
+        double val = 0;
+
+        if (ch < m_cfg.daq_ch)
+        {
+            val = vcc / 2 + vcc / 4 * sin(2 * M_PI * 0.2 * (ch + 1) * t) + ((m_wave.random() % 201) / 100.0 - 1.0) * 0.002;
+            val = std::max(0.0, std::min(vcc, val));
+        }
+
+        res.fields.push_back(fmt(val, 4));
+    }
+
+    res.fields.push_back(fmt(vcc, 4));
+}
+
+/************************* [SCOPE Actions] *************************/
+
+void VirtualDevice::scopReadQ(const std::vector<std::string>&, Result& res)
+{
+    if (m_mode != DM_SCOPE)
+    {
+        res.err = ERR_INVALID_MODE;
+        return;
+    }
+
+    if (!m_ready)
+    {
+        res.fields = { quote("Not ready!") };
+        return;
+    }
+
+    res.fields = { m_data };
+    m_ready = false;
+
+    if (m_scope.trig_mode != 'S')
+        arm();
+}
+
+void VirtualDevice::scopSet(const std::vector<std::string>& params, Result& res)
+{
+    if (m_mode != DM_SCOPE)
+    {
+        res.err = ERR_INVALID_MODE;
+        return;
+    }
+
+    uint32_t p1, p2, p3, p5, p6, p9;
+
+    if (params.size() < 9 || params.size() > 12 || !toUInt(params[0], p1) || !toUInt(params[1], p2) ||
+        !toUInt(params[2], p3) || !toUInt(params[4], p5) || !toUInt(params[5], p6) || !toUInt(params[8], p9))
+    {
+        res.err = ERR_MISSING_PARAMETER;
+        return;
+    }
+
+    /* optional trigger qualifier - hysteresis %, holdoff ms, min pulse width samples, accepted and reported only */
+    uint32_t qual[3] = { (uint32_t)m_scope.trig_hyst, (uint32_t)m_scope.trig_holdoff, (uint32_t)m_scope.trig_width };
+    const uint32_t qual_max[3] = { DEV_TRIG_HYST_MAX, DEV_TRIG_HOLDOFF_MAX, DEV_TRIG_WIDTH_MAX };
+
+    for (size_t i = 9; i < params.size(); i++)
+    {
+        if (!toUInt(params[i], qual[i - 9]) || qual[i - 9] > qual_max[i - 9])
+        {
+            res.err = ERR_ILLEGAL_PARAMETER_VALUE;
+            return;
+        }
+    }
+
+    const std::string& p4 = params[3];
+    const std::string& p7 = params[6];
+    const std::string& p8 = params[7];
+
+    if (p4.size() != 4 || p7.size() != 1 || p8.size() != 1 || p4.find_first_not_of("01") != std::string::npos ||
+        (p7[0] != 'R' && p7[0] != 'F') || (p8[0] != 'A' && p8[0] != 'N' && p8[0] != 'S' && p8[0] != 'D'))
+    {
+        res.err = ERR_ILLEGAL_PARAMETER_VALUE;
+        return;
+    }
+
+    bool ch_en[4] = { p4[0] == '1', p4[1] == '1', p4[2] == '1', p4[3] == '1' };
+
+    if (daqSet(m_scope, p1, p2, p3, ch_en, p5, p6, p7[0], p8[0], p9) != 0)
+    {
+        res.err = ERR_ILLEGAL_PARAMETER_VALUE;
+        return;
+    }
+
+    m_scope.trig_hyst = qual[0];
+    m_scope.trig_holdoff = qual[1];
+    m_scope.trig_width = qual[2];
+
+    double ticks = smplTicks(m_scope);
+    double max_z = ((ticks - 0.5) / ((double)DEV_FREQ_ADCCLK * DEV_ADC_C_F * (m_scope.bits == 12 ? DEV_LN2POW14 : DEV_LN2POW10))) - DEV_ADC_R_OHM;
+
+    res.fields = { quote("OK"), fmt(max_z, 1), fmt(1.0 / DEV_FREQ_ADCCLK * ticks * 1000000000.0, 2), fmt(fsReal(m_scope.fs), 6) };
+    arm();
+}
+
+void VirtualDevice::scopSetQ(const std::vector<std::string>&, Result& res)
+{
+    if (m_mode != DM_SCOPE)
+    {
+        res.err = ERR_INVALID_MODE;
+        return;
+    }
+
+    std::string chans;
+    for (int ch = 0; ch < 4; ch++)
+        chans += m_scope.ch_en[ch] ? '1' : '0';
+
+    double ticks = smplTicks(m_scope);
+    double max_z = ((ticks - 0.5) / ((double)DEV_FREQ_ADCCLK * DEV_ADC_C_F * (m_scope.bits == 12 ? DEV_LN2POW14 : DEV_LN2POW10))) - DEV_ADC_R_OHM;
+
+    res.fields = { std::to_string(m_scope.bits), std::to_string(m_scope.mem), std::to_string(m_scope.fs), chans,
+                   std::to_string(m_scope.trig_ch), std::to_string(m_scope.trig_val), std::string(1, m_scope.trig_edge),
+                   std::string(1, m_scope.trig_mode), std::to_string(m_scope.trig_pre), fmt(max_z, 3),
+                   fmt(1.0 / DEV_FREQ_ADCCLK * ticks * 1000000000.0, 2), fmt(fsReal(m_scope.fs), 6),
+                   std::to_string(m_scope.trig_hyst), std::to_string(m_scope.trig_holdoff), std::to_string(m_scope.trig_width) };
+}
+
+void VirtualDevice::scopForce(const std::vector<std::string>&, Result& res)
+{
+    if (m_mode != DM_SCOPE)
+    {
+        res.err = ERR_INVALID_MODE;
+        return;
+    }
+
+    force(res);
+}
+
+/************************* [LA Actions] *************************/
+
+void VirtualDevice::laReadQ(const std::vector<std::string>&, Result& res)
+{
+    if (m_mode != DM_LA)
+    {
+        res.err = ERR_INVALID_MODE;
+        return;
+    }
+
+    if (!m_ready)
+    {
+        res.fields = { quote("Not ready!") };
+        return;
+    }
+
+    res.fields = { m_data };
+    m_ready = false;
+
+    if (m_la.trig_mode != 'S')
+        arm();
+}
+
+void VirtualDevice::laSet(const std::vector<std::string>& params, Result& res)
+{
+    if (m_mode != DM_LA)
+    {
+        res.err = ERR_INVALID_MODE;
+        return;
+    }
+
+    uint32_t p2, p3, p5, p9;
+
+    if (params.size() != 6 || !toUInt(params[0], p2) || !toUInt(params[1], p3) || !toUInt(params[2], p5) ||
+        !toUInt(params[5], p9))
+    {
+        res.err = ERR_MISSING_PARAMETER;
+        return;
+    }
+
+    const std::string& p7 = params[3];
+    const std::string& p8 = params[4];
+
+    if (p7.size() != 1 || p8.size() != 1 || (p7[0] != 'R' && p7[0] != 'F' && p7[0] != 'B') ||
+        (p8[0] != 'A' && p8[0] != 'N' && p8[0] != 'S' && p8[0] != 'D'))
+    {
+        res.err = ERR_ILLEGAL_PARAMETER_VALUE;
+        return;
+    }
+
+    bool ch_en[4] = { true, true, m_cfg.daq_ch == 4, m_cfg.daq_ch == 4 };
+
+    if (daqSet(m_la, 1, p2, p3, ch_en, p5, 0, p7[0], p8[0], p9) != 0)
+    {
+        res.err = ERR_ILLEGAL_PARAMETER_VALUE;
+        return;
+    }
+
+    res.fields = { quote("OK"), fmt(fsReal(m_la.fs), 6) };
+    arm();
+}
+
+void VirtualDevice::laSetQ(const std::vector<std::string>&, Result& res)
+{
+    if (m_mode != DM_LA)
+    {
+        res.err = ERR_INVALID_MODE;
+        return;
+    }
+
+    res.fields = { std::to_string(m_la.mem), std::to_string(m_la.fs), std::to_string(m_la.trig_ch),
+                   std::string(1, m_la.trig_edge), std::string(1, m_la.trig_mode), std::to_string(m_la.trig_pre),
+                   fmt(fsReal(m_la.fs), 6) };
+}
+
+void VirtualDevice::laForce(const std::vector<std::string>&, Result& res)
+{
+    if (m_mode != DM_LA)
+    {
+        res.err = ERR_INVALID_MODE;
+        return;
+    }
+
+    force(res);
+}
+
+/************************* [CNTR Actions] *************************/
+
+void VirtualDevice::cntrSet(const std::vector<std::string>& params, Result& res)
+{
+    uint32_t p1, p2;
+    uint32_t p3 = m_cntr_gate_ms; // optional gate time ms
+
+    if (params.size() < 2 || params.size() > 3 || !toUInt(params[0], p1) || !toUInt(params[1], p2) ||
+        (params.size() == 3 && !toUInt(params[2], p3)))
+    {
+        res.err = ERR_MISSING_PARAMETER;
+        return;
+    }
+
+    if (p1 > 1 || p2 > 1 || p3 < DEV_CNTR_GATE_MIN_MS || p3 > DEV_CNTR_GATE_MAX_MS)
+    {
+        res.err = ERR_ILLEGAL_PARAMETER_VALUE;
+        return;
+    }
+
+    m_cntr_en = p1;
+    m_cntr_fast = p2;
+    m_cntr_gate_ms = p3;
+    cntrRestart();
+
+    res.fields = { quote("OK") };
+}
+
+void VirtualDevice::cntrSetQ(const std::vector<std::string>&, Result& res)
+{
+    res.fields = { m_cntr_en ? "1" : "0", m_cntr_fast ? "1" : "0", std::to_string(m_cntr_gate_ms) };
+}
+
+void VirtualDevice::cntrReadQ(const std::vector<std::string>&, Result& res)
+{
+    if (!m_cntr_en)
+    {
+        res.err = ERR_CNTR_NOT_ENABLED;
+        return;
+    }
+
+    cntrGates();
+
+    if (m_cntr_res.empty()) // no gate closed since last push
+    {
+        res.fields = { quote("Empty") };
+        return;
+    }
+
+    res.fields = { cntrRecord(DEV_CNTR_RES_LEN) };
+}
+
+void VirtualDevice::cntrRaw(const std::vector<std::string>& params, Result& res)
+{
+    uint32_t p1, p2;
+
+    if (params.size() != 2 || !toUInt(params[0], p1) || !toUInt(params[1], p2))
+    {
+        res.err = ERR_MISSING_PARAMETER;
+        return;
+    }
+
+    if (!m_cntr_en)
+    {
+        res.err = ERR_CNTR_NOT_ENABLED;
+        return;
+    }
+
+    if (p1 < 2 || p1 > DEV_CNTR_RAW_MAX || p2 > 1)
+    {
+        res.err = ERR_ILLEGAL_PARAMETER_VALUE;
+        return;
+    }
+
+    cntrGates(); // gates closed before request are kept
+
+    if (p2 == 1 && m_cntr_prev <= 0) // duty prescaler needs frequency
+    {
+        res.err = ERR_FUNCTION_NA;
+        return;
+    }
+
+    double t = std::chrono::duration<double>(m_now - m_start).count();
+    int psc = (m_cntr_fast && p2 == 0) ? DEV_CNTR_PSC_FAST : 1;
+    double capture_s = (p1 + p2) * psc / cntrFreq(t);
+
+    m_cntr_raw = true;
+    m_cntr_raw_duty = p2 == 1;
+    m_cntr_raw_n = p1;
+    m_cntr_raw_end = m_now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(capture_s));
+
+    res.fields = { quote("OK") };
+}
+
+void VirtualDevice::cntrRawQ(const std::vector<std::string>&, Result& res)
+{
+    if (!m_cntr_en)
+    {
+        res.err = ERR_CNTR_NOT_ENABLED;
+        return;
+    }
+
+    if (!m_cntr_raw || m_now < m_cntr_raw_end) // not finished or not requested
+    {
+        res.fields = { quote("Empty") };
+        return;
+    }
+
+    res.fields = { cntrRawData() };
+
+    /* gates continue, numbering kept */
+    m_cntr_raw = false;
+    m_cntr_start = m_now - std::chrono::milliseconds((int64_t)m_cntr_seq * m_cntr_gate_ms);
+}
+
+/************************* [SGEN Actions] *************************/
+
+void VirtualDevice::sgenSet(const std::vector<std::string>& params, Result& res)
+{
+    if (!m_cfg.dac)
+    {
+        res.err = ERR_DAC_NA;
+        return;
+    }
+
+    double freq;
+    uint32_t p[4];
+
+    if (params.size() != 5 || !toDouble(params[0], freq))
+    {
+        res.err = ERR_ILLEGAL_PARAMETER_VALUE;
+        return;
+    }
+
+    for (int i = 0; i < 4; i++)
+    {
+        if (!toUInt(params[i + 1], p[i]))
+        {
+            res.err = ERR_ILLEGAL_PARAMETER_VALUE;
+            return;
+        }
+    }
+
+    if (freq < 0 || freq > m_cfg.max_sgen_f || p[0] > 1000 || p[1] > 100 || p[2] > 6 || p[3] > 1 ||
+        (p[3] == 1 && freq <= 0 && p[2] != 0)) // firmware asserts on zero freq of a wave
+    {
+        res.err = ERR_ILLEGAL_PARAMETER_VALUE;
+        return;
+    }
+
+    if (p[2] == 6 && p[3] == 1 && (m_sgen_arb_len == 0 || freq * m_sgen_arb_len < 1 ||
+                                   freq * m_sgen_arb_len > m_cfg.max_sgen_f))
+    {
+        res.err = ERR_ILLEGAL_PARAMETER_VALUE; // nothing uploaded, timer below 1 Hz or too fast for its length
+        return;
+    }
+
+    m_sgen_ampl = p[0];
+    m_sgen_offset = p[1];
+
+    if (p[3] == 1)
+        sgenEnable(p[2], freq);
+    else
+    {
+        m_sgen_en = false;
+        m_sgen_dds = false;
+    }
+
+    res.fields = { quote("OK"), fmt(m_sgen_freq_real, 3), std::to_string(m_sgen_samples) };
+}
+
+void VirtualDevice::sgenSetQ(const std::vector<std::string>&, Result& res)
+{
+    if (!m_cfg.dac)
+    {
+        res.err = ERR_DAC_NA;
+        return;
+    }
+
+    res.fields = { fmt(m_sgen_freq, 3), std::to_string(m_sgen_ampl), std::to_string(m_sgen_offset),
+                   std::to_string(m_sgen_mode), std::to_string(m_sgen_en), fmt(m_sgen_freq_real, 3),
+                   std::to_string(m_sgen_samples) };
+}
+
+void VirtualDevice::sgenArb(const std::vector<std::string>& params, Result& res)
+{
+    if (!m_cfg.dac)
+    {
+        res.err = ERR_DAC_NA;
+        return;
+    }
+
+    uint32_t offset;
+    std::string data;
+
+    if (params.size() != 2 || !toUInt(params[0], offset) || !blockData(params[1], data))
+    {
+        res.err = ERR_ILLEGAL_PARAMETER_VALUE;
+        return;
+    }
+
+    /* 16-bit samples, only count matters - emulated DAC output is not sampled */
+    uint32_t count = (uint32_t)data.size() / 2;
+
+    if (data.size() % 2 != 0 || count > DEV_SGEN_ARB_CHUNK || offset > (uint32_t)m_sgen_arb_len ||
+        offset + count > (uint32_t)m_cfg.sgen_mem)
+    {
+        res.err = ERR_ILLEGAL_PARAMETER_VALUE;
+        return;
+    }
+
+    if (m_sgen_en && m_sgen_mode != 6) // DDS or generated table would overwrite it
+    {
+        m_sgen_en = false;
+        m_sgen_dds = false;
+    }
+
+    if (offset == 0)
+        m_sgen_arb_len = 0;
+    if ((int)(offset + count) > m_sgen_arb_len)
+        m_sgen_arb_len = offset + count;
+
+    res.fields = { quote("OK"), std::to_string(m_sgen_arb_len) };
+}
+
+void VirtualDevice::sgenArbQ(const std::vector<std::string>&, Result& res)
+{
+    if (!m_cfg.dac)
+    {
+        res.err = ERR_DAC_NA;
+        return;
+    }
+
+    res.fields = { std::to_string(m_sgen_arb_len), std::to_string(m_cfg.sgen_mem), std::to_string(DEV_SGEN_ARB_CHUNK) };
+}
+
+/************************* [PWM Actions] *************************/
+
+void VirtualDevice::pwmSet(const std::vector<std::string>& params, Result& res)
+{
+    uint32_t p[6];
+
+    if (params.size() != 6)
+    {
+        res.err = ERR_ILLEGAL_PARAMETER_VALUE;
+        return;
+    }
+
+    for (int i = 0; i < 6; i++)
+    {
+        if (!toUInt(params[i], p[i]))
+        {
+            res.err = ERR_ILLEGAL_PARAMETER_VALUE;
+            return;
+        }
+    }
+
+    if (p[0] < 1 || p[0] > (uint32_t)m_cfg.max_pwm_f || p[1] > 100 || p[2] > 100 || p[3] > 100 || p[4] > 1 || p[5] > 1 ||
+        (!m_cfg.pwm2 && p[5] == 1))
+    {
+        res.err = ERR_ILLEGAL_PARAMETER_VALUE;
+        return;
+    }
+
+    m_pwm_freq = p[0];
+    m_pwm_duty1 = p[1];
+    m_pwm_duty2 = p[2];
+    m_pwm_offset = p[3];
+    m_pwm_en1 = p[4];
+    m_pwm_en2 = p[5];
+
+    res.fields = { quote("OK"), fmt((double)DEV_FREQ_ADCCLK / round((double)DEV_FREQ_ADCCLK / m_pwm_freq), 3) };
+}
+
+void VirtualDevice::pwmSetQ(const std::vector<std::string>&, Result& res)
+{
+    res.fields = { std::to_string(m_pwm_freq), std::to_string(m_pwm_duty1), std::to_string(m_pwm_duty2),
+                   std::to_string(m_pwm_offset), std::to_string(m_pwm_en1), std::to_string(m_pwm_en2),
+                   fmt((double)DEV_FREQ_ADCCLK / round((double)DEV_FREQ_ADCCLK / m_pwm_freq), 3) };
+}
+
+/************************* [CNTR emulation] *************************/
+
+void VirtualDevice::cntrRestart()
+{
+    m_cntr_start = m_now;
+    m_cntr_seq = 0;
+    m_cntr_res.clear();
+    m_cntr_n = 0;
+    m_cntr_min = 0;
+    m_cntr_max = 0;
+    m_cntr_mean = 0;
+    m_cntr_m2 = 0;
+    m_cntr_prev = 0;
+    m_cntr_a2 = 0;
+    m_cntr_na = 0;
+    m_cntr_raw = false;
+}
+
+/* gates closed since last call, running statistics as cntr_res_push */
+void VirtualDevice::cntrGates()
+{
+    if (m_cntr_raw)
+        return;
+
+    double elapsed_ms = std::chrono::duration<double, std::milli>(m_now - m_cntr_start).count();
+    uint32_t closed = (uint32_t)(elapsed_ms / m_cntr_gate_ms);
+
+    for (; m_cntr_seq < closed; m_cntr_seq++)
+    {
+        double f = cntrFreq((m_cntr_seq + 1) * m_cntr_gate_ms / 1000.0);
+
+        m_cntr_n++;
+        m_cntr_min = m_cntr_n == 1 ? f : std::min(m_cntr_min, f);
+        m_cntr_max = m_cntr_n == 1 ? f : std::max(m_cntr_max, f);
+
+        double delta = f - m_cntr_mean;
+        m_cntr_mean += delta / m_cntr_n;
+        m_cntr_m2 += delta * (f - m_cntr_mean);
+
+        if (m_cntr_prev > 0)
+        {
+            m_cntr_a2 += (f - m_cntr_prev) * (f - m_cntr_prev);
+            m_cntr_na++;
+        }
+        m_cntr_prev = f;
+
+        m_cntr_res.push_back(f);
+        if (m_cntr_res.size() > DEV_CNTR_RES_LEN) // oldest lost, same as full ring of firmware
+            m_cntr_res.erase(m_cntr_res.begin());
+    }
+}
+
+/* binary block #<n><len> of cntr_read: uint32 seq (gates since enable), n, double min, max, mean, std, adev, then gates [Hz] */
+std::string VirtualDevice::cntrRecord(int max_gates)
+{
+    int cnt = std::min((int)m_cntr_res.size(), max_gates);
+    uint32_t u32[2] = { m_cntr_seq, m_cntr_n };
+    double d[5] = { m_cntr_n > 0 ? m_cntr_min : -1, m_cntr_n > 0 ? m_cntr_max : -1, m_cntr_n > 0 ? m_cntr_mean : -1,
+                    m_cntr_n > 1 ? sqrt(m_cntr_m2 / (m_cntr_n - 1)) : 0,
+                    m_cntr_na > 0 && m_cntr_mean > 0 ? sqrt(m_cntr_a2 / (2.0 * m_cntr_na)) / m_cntr_mean : 0 };
+
+    std::string data(sizeof(u32) + sizeof(d) + cnt * sizeof(double), '\0');
+
+    memcpy(&data[0], u32, sizeof(u32));
+    memcpy(&data[sizeof(u32)], d, sizeof(d));
+    memcpy(&data[sizeof(u32) + sizeof(d)], m_cntr_res.data(), cnt * sizeof(double));
+
+    m_cntr_res.erase(m_cntr_res.begin(), m_cntr_res.begin() + cnt);
+
+    std::string len_s = std::to_string(data.size());
+    return "#" + std::to_string(len_s.size()) + len_s + data;
+}
+
+/* PWM output is looped back to counter input, otherwise 1 kHz with slow drift, both with 1 ppm gate jitter */
+double VirtualDevice::cntrFreq(double t)
+{
+    double f = m_pwm_en1 ? (double)DEV_FREQ_ADCCLK / round((double)DEV_FREQ_ADCCLK / m_pwm_freq) : 1000.0 + sin(t / 10.0);
+
+    return f * (1.0 + ((m_wave.random() % 2001) / 1000.0 - 1.0) * 0.000001);
+}
+
+/* binary block #<n><len> of cntr_raw_read header + 16-bit captures:
+ *   uint32 mode, len1, len2, IC psc, f_tim, timer psc, uint16 raw_pre, raw_post, then ccr[len1], aux[len2]
+ * emulated ovf store is never stale, so raw_pre > raw_post tells host to take aux as is */
+std::string VirtualDevice::cntrRawData()
+{
+    double t = std::chrono::duration<double>(m_now - m_start).count();
+    double f = cntrFreq(t);
+    uint32_t psc = (m_cntr_fast && !m_cntr_raw_duty) ? DEV_CNTR_PSC_FAST : 1;
+    uint32_t div = 1;
+
+    if (m_cntr_raw_duty) // period below half of timer range, same as cntr_raw
+    {
+        div = (uint32_t)((double)DEV_FREQ_ADCCLK / f / ((DEV_TIM_CNTR_MAX + 1) / 2)) + 1;
+        div = std::min(div, (uint32_t)DEV_TIM_CNTR_MAX + 1);
+    }
+
+    uint32_t len1 = m_cntr_raw_n;
+    uint32_t len2 = m_cntr_raw_duty ? len1 + 1 : len1;
+    double period = (double)DEV_FREQ_ADCCLK / div / f * psc; // ticks between captures
+    double duty = m_pwm_en1 ? m_pwm_duty1 / 100.0 : 0.5;
+    double t0 = m_wave.random() % 0xFFFFFFFF;
+
+    std::vector<uint16_t> ccr(len1);
+    std::vector<uint16_t> aux(len2);
+
+    for (uint32_t i = 0; i < len2; i++) // edges with +-1 tick jitter
+    {
+        double rise = t0 + i * period + (m_wave.random() % 3) - 1.0;
+        uint32_t ts = (uint32_t)fmod(rise, 4294967296.0);
+
+        if (i < len1)
+            ccr[i] = ts & 0xFFFF;
+
+        if (m_cntr_raw_duty)
+            aux[i] = (uint16_t)(ts + (uint32_t)(period * duty));
+        else
+            aux[i] = ts >> 16;
+    }
+
+    uint32_t u32[6] = { m_cntr_raw_duty ? 1u : 0u, len1, len2, psc, DEV_FREQ_ADCCLK, div };
+    uint16_t u16[2] = { DEV_TIM_CNTR_MAX, 0 };
+
+    std::string data(sizeof(u32) + sizeof(u16) + (len1 + len2) * sizeof(uint16_t), '\0');
+
+    memcpy(&data[0], u32, sizeof(u32));
+    memcpy(&data[sizeof(u32)], u16, sizeof(u16));
+    memcpy(&data[sizeof(u32) + sizeof(u16)], ccr.data(), len1 * sizeof(uint16_t));
+    memcpy(&data[sizeof(u32) + sizeof(u16) + len1 * sizeof(uint16_t)], aux.data(), len2 * sizeof(uint16_t));
+
+    std::string len_s = std::to_string(data.size());
+    return "#" + std::to_string(len_s.size()) + len_s + data;
+}
+
+/************************* [SGEN emulation] *************************/
+
+void VirtualDevice::sgenEnable(int mode, double f)
+{
+    bool dds = mode != 0 && mode != 6 && f <= DEV_SGEN_DDS_MAX_F;
+
+    if (m_sgen_en && !(dds && m_sgen_dds)) // table has to be rebuilt
+        m_sgen_en = false;
+
+    m_sgen_mode = mode;
+    m_sgen_freq = f;
+
+    if (!m_sgen_en)
+    {
+        double tim_f;
+
+        if (dds)
+        {
+            tim_f = DEV_SGEN_DDS_FS;
+            m_sgen_samples = m_cfg.sgen_mem;
+        }
+        else if (mode == 6) // arbitrary, freq is repetition rate of uploaded samples
+        {
+            tim_f = round(f * m_sgen_arb_len); // timer rate is whole Hz like firmware
+            m_sgen_samples = m_sgen_arb_len;
+        }
+        else if (mode == 0) // const
+        {
+            tim_f = m_cfg.sgen_mem;
+            m_sgen_samples = m_cfg.sgen_mem;
+        }
+        else
+        {
+            tim_f = f * m_cfg.sgen_mem;
+            m_sgen_samples = m_cfg.sgen_mem;
+
+            if (tim_f > m_cfg.max_sgen_f) // frequency too high, need to lower buffer size
+            {
+                tim_f = m_cfg.max_sgen_f;
+                m_sgen_samples = std::max(1, (int)(m_cfg.max_sgen_f / f));
+            }
+        }
+
+        m_sgen_tim_f = (double)DEV_FREQ_ADCCLK / round((double)DEV_FREQ_ADCCLK / tim_f);
+    }
+
+    if (dds) // 32-bit phase accumulator, resolution fs / 2^32
+    {
+        double step = std::min(round(f / m_sgen_tim_f * DEV_DDS_PHASE_1), DEV_DDS_PHASE_1 / 2 - 1);
+        m_sgen_freq_real = step * m_sgen_tim_f / DEV_DDS_PHASE_1;
+    }
+    else
+        m_sgen_freq_real = m_sgen_tim_f / m_sgen_samples;
+
+    if (mode != 6)
+        m_sgen_arb_len = 0; // uploaded samples overwritten
+
+    m_sgen_dds = dds;
+    m_sgen_en = true;
+}
+
+/************************* [DAQ emulation] *************************/
+
+void VirtualDevice::settingsInit(bool scope, bool la)
+{
+    if (scope)
+        m_scope = DaqState();
+
+    if (la)
+    {
+        m_la = DaqState();
+        m_la.bits = 1;
+        m_la.mem = 2000;
+        m_la.trig_val = 0;
+        for (int ch = 0; ch < 4; ch++)
+            m_la.ch_en[ch] = ch < m_cfg.daq_ch;
+    }
+}
+
+void VirtualDevice::modeSet(DevMode mode)
+{
+    m_mode = mode;
+    m_ready = false;
+    m_armed = false;
+
+    if (mode != DM_VM)
+        arm();
+}
+
+void VirtualDevice::arm()
+{
+    m_armed = true;
+    m_ready = false;
+    m_arm_time = m_now;
+}
+
+void VirtualDevice::force(Result& res)
+{
+    const DaqState& daq = (m_mode == DM_SCOPE ? m_scope : m_la);
+
+    if (m_ready || daq.trig_mode == 'D' || daq.trig_mode == 'A')
+    {
+        res.err = ERR_FUNCTION_NA;
+        return;
+    }
+
+    if (!m_armed) // single shot already done, rearm and let next trigger come
+    {
+        arm();
+        res.err = ERR_FUNCTION_NA2;
+        return;
+    }
+
+    m_async += ready('F');
+    res.fields = { quote("OK") };
+}
+
+std::string VirtualDevice::ready(char type)
+{
+    if (m_mode == DM_SCOPE)
+        generateScope();
+    else
+        generateLa();
+
+    m_frames++;
+    m_ready = true;
+    m_armed = false;
+
+    return "\"Ready" + std::string(1, type) + "\"," + std::to_string(m_firstPos) + "\r\n";
+}
+
+/* circular buffer(s) exactly as DMA leaves them - layout depends on number of ADCs, host must unwrap it from m_firstPos */
+void VirtualDevice::generateScope()
+{
+    const DaqState& daq = m_scope;
+    const int len = daq.mem + m_cfg.reserve;
+    const int pre = (int)((int64_t)daq.mem * daq.trig_pre / 100);
+    const int max_code = daq.bits == 12 ? 4095 : 255;
+    const int bytes = daq.bits == 12 ? 2 : 1;
+
+    /* buffers and their channels */
+
+    std::vector<std::vector<int>> buffs;
+
+    if (m_cfg.adc_num == 1)
+        buffs = { {} };
+    else if (m_cfg.adc_num == 2)
+        buffs = { {}, {} };
+    else
+        buffs = { {}, {}, {}, {} };
+
+    for (int ch = 0; ch < 4; ch++)
+    {
+        if (daq.ch_en[ch])
+            buffs[m_cfg.adc_num == 1 ? 0 : (m_cfg.adc_num == 2 ? ch / 2 : ch)].push_back(ch);
+    }
+
+    /* one first position is reported for all buffers, so it must be the same sample in each of them */
+
+    int slot0 = (int)(m_wave.random() % len);
+    int interleave = 0;
+
+    for (const std::vector<int>& buff : buffs)
+    {
+        if (buff.empty())
+            continue;
+        if (interleave != 0 && interleave != (int)buff.size())
+            slot0 = 0;
+        interleave = (int)buff.size();
+    }
+
+    m_firstPos = slot0 * interleave;
+    m_wave.arm(daq.trig_ch - 1, daq.trig_val / 100.0, daq.trig_edge == 'F');
+
+    /* generate */
+
+    std::vector<double> vals((size_t)len * 4);
+    double out[WAVE_CH_NUM];
+
+    for (int k = 0; k < len; k++)
+    {
+        m_wave.sample(k, pre, daq.mem, out);
+        for (int ch = 0; ch < 4; ch++)
+            vals[(size_t)k * 4 + ch] = out[ch];
+    }
+
+    std::string data;
+
+    for (const std::vector<int>& buff : buffs)
+    {
+        if (buff.empty())
+            continue;
+
+        int n = (int)buff.size();
+        size_t offset = data.size();
+        data.resize(offset + (size_t)len * n * bytes);
+        uint8_t* ptr = (uint8_t*)&data[offset];
+
+        for (int k = 0; k < len; k++)
+        {
+            int slot = (slot0 + k) % len;
+
+            for (int j = 0; j < n; j++)
+            {
+                uint16_t code = (uint16_t)lround(vals[(size_t)k * 4 + buff[j]] * max_code);
+                size_t idx = ((size_t)slot * n + j) * bytes;
+
+                ptr[idx] = (uint8_t)code;
+                if (bytes == 2)
+                    ptr[idx + 1] = (uint8_t)(code >> 8);
+            }
+        }
+    }
+
+    std::string len_s = std::to_string(data.size());
+    m_data = "#" + std::to_string(len_s.size()) + len_s + data;
+}
+
+void VirtualDevice::generateLa()
+{
+    const DaqState& daq = m_la;
+    const int len = daq.mem + m_cfg.reserve;
+    const int pre = (int)((int64_t)daq.mem * daq.trig_pre / 100);
+
+    int slot0 = (int)(m_wave.random() % len);
+    m_firstPos = slot0;
+    m_wave.arm(daq.trig_ch - 1, 0.5, daq.trig_edge == 'F');
+
+    std::string data((size_t)len, '\0');
+    double out[WAVE_CH_NUM];
+
+    for (int k = 0; k < len; k++)
+    {
+        m_wave.sample(k, pre, daq.mem, out);
+
+        uint8_t val = 0;
+        for (int ch = 0; ch < m_cfg.daq_ch; ch++)
+            val |= (out[ch] >= 0.5) << ch; // LA pins are 0 - 3
+
+        data[(slot0 + k) % len] = (char)val;
+    }
+
+    std::string len_s = std::to_string(data.size());
+    m_data = "#" + std::to_string(len_s.size()) + len_s + data;
+}
+
+int VirtualDevice::daqSet(DaqState& daq, uint32_t bits, uint32_t mem, uint32_t fs, const bool ch_en[4],
+                          uint32_t trig_ch, uint32_t trig_val, char edge, char mode, uint32_t pre)
+{
+    DaqState set = daq;
+    int ch_num = ch_en[0] + ch_en[1] + ch_en[2] + ch_en[3];
+
+    if (bits == 1) // LA
+    {
+        if (mem < 1 || mem > (uint32_t)m_cfg.max_mem || fs < 1 || fs > (uint32_t)m_cfg.max_la_fs)
+            return -1;
+    }
+    else
+    {
+        if ((bits != 12 && bits != 8) || (bits == 8 && !m_cfg.bit8) || ch_num == 0)
+            return -1;
+        if (m_cfg.daq_ch == 2 && (ch_en[2] || ch_en[3]))
+            return -1;
+
+        int max_len = bits == 12 ? m_cfg.max_mem / 2 : m_cfg.max_mem;
+        if (mem < 1 || mem > 65535 || (int64_t)mem * ch_num > max_len)
+            return -1;
+
+        set.bits = bits;
+        for (int ch = 0; ch < 4; ch++)
+            set.ch_en[ch] = ch_en[ch];
+
+        if (fs < 1 || smplTicks(set) < 0 || fs > (uint32_t)(bits == 12 ? m_cfg.max_fs12 : m_cfg.max_fs8))
+            return -1;
+    }
+
+    if (trig_ch < 1 || trig_ch > (uint32_t)m_cfg.daq_ch || trig_val > 100 || pre < 1 || pre > 99)
+        return -1;
+
+    set.mem = mem;
+    set.fs = fs;
+    set.trig_ch = trig_ch;
+    set.trig_val = trig_val;
+    set.trig_edge = edge;
+    set.trig_mode = mode;
+    set.trig_pre = pre;
+
+    if (bits != 1 && smplTicks(set) < 0) // too fast for enabled channels
+        return -1;
+
+    daq = set;
+    return 0;
+}
+
+double VirtualDevice::fsReal(int fs) const
+{
+    return (double)DEV_FREQ_ADCCLK / round((double)DEV_FREQ_ADCCLK / std::max(fs, 1));
+}
+
+/* longest ADC sampling time which still fits into sample period, -1 if even shortest does not */
+double VirtualDevice::smplTicks(const DaqState& daq) const
+{
+    static const double ticks[] = { 601.5, 181.5, 61.5, 19.5, 7.5, 4.5, 2.5, 1.5 };
+
+    int per_adc;
+
+    if (m_cfg.adc_num == 1)
+        per_adc = daq.ch_en[0] + daq.ch_en[1] + daq.ch_en[2] + daq.ch_en[3];
+    else if (m_cfg.adc_num == 2)
+        per_adc = std::max(daq.ch_en[0] + daq.ch_en[1], daq.ch_en[2] + daq.ch_en[3]);
+    else
+        per_adc = 1;
+
+    double tconv = daq.bits == 12 ? 12.5 : 8.5;
+    double period = (double)DEV_FREQ_ADCCLK / fsReal(daq.fs) / std::max(per_adc, 1);
+
+    for (double t : ticks)
+    {
+        if (t + tconv <= period)
+            return t;
+    }
+
+    return -1;
+}
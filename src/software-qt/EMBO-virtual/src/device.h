@@ -0,0 +1,295 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef DEVICE_H
+#define DEVICE_H
+
+#include "waveform.h"
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <stdint.h>
+
+
+#define DEV_NAME            "EMBO-Virtual"
+#define DEV_AUTHOR          "CTU/Jakub Parez"
+#define DEV_FW_VER          "0.2.2"
+
+#define DEV_VCC_MV          3300
+#define DEV_FREQ_ADCCLK     72000000
+#define DEV_VM_FS           100
+#define DEV_VM_MEM          100
+#define DEV_TRIG_HYST_MAX   50
+#define DEV_TRIG_HOLDOFF_MAX 60000
+#define DEV_TRIG_WIDTH_MAX  250
+
+#define DEV_SGEN_DDS_FS     200000      // DDS sample rate
+#define DEV_SGEN_DDS_MAX_F  20000       // DDS up to this freq, one period table above
+#define DEV_SGEN_ARB_CHUNK  256         // max samples of one :SGEN:ARB block
+
+#define DEV_CNTR_GATE_MS    100         // default gate time
+#define DEV_CNTR_GATE_MIN_MS 10
+#define DEV_CNTR_GATE_MAX_MS 10000
+#define DEV_CNTR_RES_LEN    16          // gate results not yet read or pushed
+#define DEV_CNTR_PUSH_LEN   4           // gate results per pushed "ReadyC" record
+#define DEV_CNTR_RAW_MAX    199         // max edges of one :CNTR:RAW capture
+#define DEV_CNTR_PSC_FAST   8           // IC prescaler of fast mode
+#define DEV_TIM_CNTR_MAX    65535
+
+#define DEV_UART_CLK        72000000
+#define DEV_UART_BAUD       115200      // default baud rate, after reset and when host is gone
+#define DEV_UART_BAUD_MIN   9600
+#define DEV_UART_BAUD_MAX   4500000     // DEV_UART_CLK / 16
+#define DEV_UART_BAUD_ERR   20          // max baud rate error [per mille]
+#define DEV_UART_IDLE_MS    3000        // no message at changed baud rate this long -> default baud rate
+
+/* SCPI error codes, same as firmware scpi lib */
+#define ERR_UNDEFINED_HEADER        -113
+#define ERR_MISSING_PARAMETER       -109
+#define ERR_ILLEGAL_PARAMETER_VALUE -224
+#define ERR_TIME_OUT                -365
+#define ERR_DAC_NA                  -370
+#define ERR_CNTR_NOT_ENABLED        -371
+#define ERR_INVALID_MODE            -372
+#define ERR_FUNCTION_NA             -373
+#define ERR_FUNCTION_NA2            -374
+
+typedef std::chrono::steady_clock Clock;
+
+/* what kind of board is emulated, equivalent of cfg_xxx.h of firmware */
+struct DeviceConfig
+{
+    int daq_ch = 4;                 // 2 or 4
+    int adc_num = 1;                // 1, 2 or 4 ADCs, decides layout of SCOP:READ? data
+    bool bit8 = true;
+    bool dac = true;
+    bool pwm2 = true;
+    int max_mem = 50000;            // total DAQ memory in bytes
+    int max_fs12 = 5000000;
+    int max_fs8 = 5000000;
+    int max_la_fs = 14400000;
+    int max_pwm_f = 36000000;
+    int max_sgen_f = 5000000;
+    int max_cntr_f = 57000000;
+    int sgen_mem = 1000;
+    int reserve = 10;               // circular buffer reserve per channel
+    int latency_us = 0;             // processing time added to every command line
+    double periods = 4;             // signal periods per frame
+    double noise = 0.01;            // of full scale
+    uint32_t seed = 1;
+};
+
+enum DevMode
+{
+    DM_VM,
+    DM_SCOPE,
+    DM_LA
+};
+
+struct DaqState
+{
+    int bits = 12;
+    int mem = 1000;
+    int fs = 100000;
+    bool ch_en[4] = { true, true, false, false };
+    int trig_ch = 1;                // 1 - 4
+    int trig_val = 50;              // [%]
+    char trig_edge = 'R';
+    char trig_mode = 'A';
+    int trig_pre = 50;              // [%]
+    int trig_hyst = 0;              // [%], scope only
+    int trig_holdoff = 0;           // [ms]
+    int trig_width = 0;             // [samples]
+};
+
+/* emulates SCPI command set of comm.c and comm_proto.c, text and binary responses are byte-exact */
+
+class VirtualDevice
+{
+public:
+    VirtualDevice(const DeviceConfig& cfg);
+
+    /* one received line without line ending, returns whole response including async messages */
+    std::string process(const std::string& line, Clock::time_point now);
+
+    /* async messages generated by time - DAQ ready, counter gates */
+    std::string poll(Clock::time_point now);
+
+    /* emulated UART rate, changes after response to :SYS:BAUD and back to default when host is idle */
+    uint32_t getBaud() const { return m_baud; }
+
+    /* false while line ends inside data of arbitrary block #<n><len><data>, which may contain \r\n */
+    static bool lineComplete(const std::string& line);
+
+    uint64_t getFrames() const { return m_frames; }
+    uint64_t getCommands() const { return m_commands; }
+
+private:
+    struct Result
+    {
+        std::vector<std::string> fields;
+        int err = 0;
+    };
+
+    typedef void (VirtualDevice::*Handler)(const std::vector<std::string>& params, Result& res);
+
+    struct Command
+    {
+        const char* pattern;
+        Handler handler;
+    };
+
+    static const Command s_commands[];
+
+    static bool match(const char* pattern, const std::string& header);
+    static std::vector<std::string> split(const std::string& str, char delim);
+    static size_t blockLen(const std::string& str, size_t pos);
+    static bool blockData(const std::string& str, std::string& data);
+    static bool toUInt(const std::string& str, uint32_t& val);
+    static bool toDouble(const std::string& str, double& val);
+    static std::string quote(const std::string& str) { return "\"" + str + "\""; }
+    static std::string fmt(double val, int decimals);
+    static const char* errText(int err);
+
+    /* IEEE 488 */
+    void idnQ(const std::vector<std::string>& params, Result& res);
+    void rst(const std::vector<std::string>& params, Result& res);
+    void stbQ(const std::vector<std::string>& params, Result& res);
+    void cls(const std::vector<std::string>& params, Result& res);
+
+    /* SYS */
+    void sysMode(const std::vector<std::string>& params, Result& res);
+    void sysModeQ(const std::vector<std::string>& params, Result& res);
+    void sysLimitsQ(const std::vector<std::string>& params, Result& res);
+    void sysInfoQ(const std::vector<std::string>& params, Result& res);
+    void sysUptimeQ(const std::vector<std::string>& params, Result& res);
+    void sysBaud(const std::vector<std::string>& params, Result& res);
+    void sysBaudQ(const std::vector<std::string>& params, Result& res);
+    void sysRearmQ(const std::vector<std::string>& params, Result& res);
+
+    /* VM */
+    void vmReadQ(const std::vector<std::string>& params, Result& res);
+
+    /* SCOPE */
+    void scopReadQ(const std::vector<std::string>& params, Result& res);
+    void scopSet(const std::vector<std::string>& params, Result& res);
+    void scopSetQ(const std::vector<std::string>& params, Result& res);
+    void scopForce(const std::vector<std::string>& params, Result& res);
+
+    /* LA */
+    void laReadQ(const std::vector<std::string>& params, Result& res);
+    void laSet(const std::vector<std::string>& params, Result& res);
+    void laSetQ(const std::vector<std::string>& params, Result& res);
+    void laForce(const std::vector<std::string>& params, Result& res);
+
+    /* CNTR */
+    void cntrSet(const std::vector<std::string>& params, Result& res);
+    void cntrSetQ(const std::vector<std::string>& params, Result& res);
+    void cntrReadQ(const std::vector<std::string>& params, Result& res);
+    void cntrRaw(const std::vector<std::string>& params, Result& res);
+    void cntrRawQ(const std::vector<std::string>& params, Result& res);
+
+    /* SGEN */
+    void sgenSet(const std::vector<std::string>& params, Result& res);
+    void sgenSetQ(const std::vector<std::string>& params, Result& res);
+    void sgenArb(const std::vector<std::string>& params, Result& res);
+    void sgenArbQ(const std::vector<std::string>& params, Result& res);
+
+    /* PWM */
+    void pwmSet(const std::vector<std::string>& params, Result& res);
+    void pwmSetQ(const std::vector<std::string>& params, Result& res);
+
+    /* CNTR emulation */
+    void cntrRestart();
+    void cntrGates();
+    std::string cntrRecord(int max_gates);
+    double cntrFreq(double t);
+    std::string cntrRawData();
+
+    /* SGEN emulation */
+    void sgenEnable(int mode, double f);
+
+    /* DAQ emulation */
+    void settingsInit(bool scope, bool la);
+    void modeSet(DevMode mode);
+    void arm();
+    void force(Result& res);
+    std::string ready(char type);
+    void generateScope();
+    void generateLa();
+    int daqSet(DaqState& daq, uint32_t bits, uint32_t mem, uint32_t fs, const bool ch_en[4],
+               uint32_t trig_ch, uint32_t trig_val, char edge, char mode, uint32_t pre);
+    double fsReal(int fs) const;
+    double smplTicks(const DaqState& daq) const;
+
+    DeviceConfig m_cfg;
+    Waveform m_wave;
+    Clock::time_point m_start;
+    Clock::time_point m_now;
+
+    /* DAQ */
+    DevMode m_mode = DM_VM;
+    DaqState m_scope;
+    DaqState m_la;
+    bool m_armed = false;
+    bool m_ready = false;
+    Clock::time_point m_arm_time;
+    std::string m_data;             // last frame, already in binary block format
+    int m_firstPos = 0;
+    Clock::time_point m_vm_last;
+    std::string m_async;            // sent before response of current line
+
+    /* UART */
+    uint32_t m_baud = DEV_UART_BAUD;
+    uint32_t m_baud_next = 0;       // applied after response
+    Clock::time_point m_rx_last;
+
+    /* CNTR - gates close in real time, results are pushed like cntr_meas does */
+    bool m_cntr_en = false;
+    bool m_cntr_fast = false;
+    int m_cntr_gate_ms = DEV_CNTR_GATE_MS;
+    Clock::time_point m_cntr_start;
+    uint32_t m_cntr_seq = 0;            // gates since enable
+    std::vector<double> m_cntr_res;     // not yet read or pushed, oldest first
+    uint32_t m_cntr_n = 0;              // running statistics, same as cntr_stat_t
+    double m_cntr_min = 0;
+    double m_cntr_max = 0;
+    double m_cntr_mean = 0;
+    double m_cntr_m2 = 0;
+    double m_cntr_prev = 0;
+    double m_cntr_a2 = 0;
+    uint32_t m_cntr_na = 0;
+    bool m_cntr_raw = false;            // raw capture requested and not read yet, gates paused
+    bool m_cntr_raw_duty = false;
+    int m_cntr_raw_n = 0;
+    Clock::time_point m_cntr_raw_end;   // capture of real input would take this long
+
+    /* SGEN - DDS up to DEV_SGEN_DDS_MAX_F, one period table above, same as sgen.c */
+    double m_sgen_freq = 1000;
+    double m_sgen_freq_real = 1000;
+    double m_sgen_tim_f = 0;        // real timer freq
+    int m_sgen_ampl = 1000;         // x10 [%]
+    int m_sgen_offset = 50;
+    int m_sgen_mode = 1;
+    bool m_sgen_en = false;
+    bool m_sgen_dds = false;        // DDS running - settings change without restart
+    int m_sgen_samples = 1000;
+    int m_sgen_arb_len = 0;         // uploaded samples, kept until other wave overwrites sgen memory
+
+    /* PWM */
+    int m_pwm_freq = 1000;
+    int m_pwm_duty1 = 50;
+    int m_pwm_duty2 = 50;
+    int m_pwm_offset = 0;
+    bool m_pwm_en1 = false;
+    bool m_pwm_en2 = false;
+
+    /* stats */
+    uint64_t m_frames = 0;
+    uint64_t m_commands = 0;
+};
+
+#endif // DEVICE_H
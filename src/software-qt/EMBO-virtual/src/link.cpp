@@ -0,0 +1,137 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "link.h"
+
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+
+#define LINK_CHUNK      64      // bytes written at once when throttled
+
+PtyLink::~PtyLink()
+{
+    if (!m_link.empty())
+        unlink(m_link.c_str());
+    if (m_slave >= 0)
+        close(m_slave);
+    if (m_master >= 0)
+        close(m_master);
+}
+
+bool PtyLink::open(const std::string& symlink_path)
+{
+    m_master = posix_openpt(O_RDWR | O_NOCTTY);
+
+    if (m_master < 0)
+        return fail("posix_openpt");
+
+    if (grantpt(m_master) != 0 || unlockpt(m_master) != 0)
+        return fail("grantpt");
+
+    const char* name = ptsname(m_master);
+
+    if (name == NULL)
+        return fail("ptsname");
+
+    m_path = name;
+    m_slave = ::open(name, O_RDWR | O_NOCTTY);
+
+    if (m_slave < 0)
+        return fail("open slave");
+
+    /* raw mode, no echo and no line discipline, binary blocks must pass untouched */
+
+    struct termios tio;
+
+    if (tcgetattr(m_slave, &tio) != 0)
+        return fail("tcgetattr");
+
+    cfmakeraw(&tio);
+
+    if (tcsetattr(m_slave, TCSANOW, &tio) != 0)
+        return fail("tcsetattr");
+
+    if (!symlink_path.empty())
+    {
+        unlink(symlink_path.c_str());
+
+        if (symlink(name, symlink_path.c_str()) != 0)
+            return fail("symlink " + symlink_path);
+
+        m_link = symlink_path;
+    }
+
+    return true;
+}
+
+bool PtyLink::waitRx(int timeout_ms)
+{
+    struct pollfd pfd = { m_master, POLLIN, 0 };
+
+    return poll(&pfd, 1, timeout_ms) > 0 && (pfd.revents & POLLIN);
+}
+
+int PtyLink::read(char* data, int len)
+{
+    int ret = ::read(m_master, data, len);
+
+    if (ret > 0)
+        m_rx_bytes += ret;
+
+    return ret;
+}
+
+bool PtyLink::write(const char* data, int len)
+{
+    auto start = std::chrono::steady_clock::now();
+    int sent = 0;
+
+    while (sent < len)
+    {
+        int chunk = m_throttle > 0 ? std::min(LINK_CHUNK, len - sent) : len - sent;
+        int ret = ::write(m_master, data + sent, chunk);
+
+        if (ret < 0)
+        {
+            if (errno == EINTR || errno == EAGAIN)
+                continue;
+
+            return fail("write");
+        }
+
+        sent += ret;
+        m_tx_bytes += ret;
+
+        if (m_throttle > 0) // sleep until link would have transmitted everything so far
+        {
+            auto due = start + std::chrono::microseconds((uint64_t)sent * 1000000 / m_throttle);
+            std::this_thread::sleep_until(due);
+        }
+    }
+
+    return true;
+}
+
+/* private */
+
+bool PtyLink::fail(const std::string& what)
+{
+    m_err = what + ": " + strerror(errno);
+    return false;
+}
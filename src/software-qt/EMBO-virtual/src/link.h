@@ -0,0 +1,48 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef LINK_H
+#define LINK_H
+
+#include <string>
+#include <stdint.h>
+
+
+/* master side of pseudo-terminal, slave side is opened by EMBO like real tty */
+
+class PtyLink
+{
+public:
+    PtyLink() {}
+    ~PtyLink();
+
+    bool open(const std::string& symlink_path);
+    const std::string& getPath() const { return m_path; }
+    const std::string& getError() const { return m_err; }
+
+    /* bytes per second, 0 = unlimited - emulates slow UART */
+    void setThrottle(uint32_t bytes_per_s) { m_throttle = bytes_per_s; }
+
+    bool waitRx(int timeout_ms);
+    int read(char* data, int len);
+    bool write(const char* data, int len);
+
+    uint64_t getTxBytes() const { return m_tx_bytes; }
+    uint64_t getRxBytes() const { return m_rx_bytes; }
+
+private:
+    bool fail(const std::string& what);
+
+    int m_master = -1;
+    int m_slave = -1;               // kept open, so master does not get EIO while EMBO is not connected
+    std::string m_path;
+    std::string m_link;
+    std::string m_err;
+    uint32_t m_throttle = 0;
+    uint64_t m_tx_bytes = 0;
+    uint64_t m_rx_bytes = 0;
+};
+
+#endif // LINK_H
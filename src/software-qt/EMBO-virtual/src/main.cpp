@@ -0,0 +1,193 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "device.h"
+#include "link.h"
+
+#include <string>
+#include <atomic>
+
+#include <getopt.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+
+#define RX_BUFF_SZ          4096
+#define RX_LINE_MAX         65536   // longer line is dropped, same as overflow in firmware
+
+
+static std::atomic<bool> s_run(true);
+
+static void on_signal(int)
+{
+    s_run = false;
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "Virtual EMBO instrument on pseudo-terminal.\n\n"
+            "  --link PATH      create symlink PATH to pty (e.g. /tmp/ttyEMBO)\n"
+            "  --ch N           DAQ channels, 2 or 4 (default 4)\n"
+            "  --adc N          ADCs, 1, 2 or 4 - layout of scope data (default 1)\n"
+            "  --mem N          DAQ memory in bytes (default 50000)\n"
+            "  --reserve N      circular buffer reserve per channel (default 10)\n"
+            "  --baud N         emulate UART speed, bytes/s = baud / 10 (default unlimited),\n"
+            "                   rate negotiated by :SYS:BAUD replaces N until device returns to default\n"
+            "  --latency US     processing time of every line in us (default 0)\n"
+            "  --no-dac         board without DAC\n"
+            "  --no-bit8        board without 8-bit ADC mode\n"
+            "  --periods N      signal periods per frame (default 4)\n"
+            "  --noise N        noise, fraction of full scale (default 0.01)\n"
+            "  --seed N         random seed (default 1)\n"
+            "  --stats          print throughput every second to stderr\n"
+            "  --help           this help\n", name);
+}
+
+int main(int argc, char* argv[])
+{
+    static const struct option opts[] =
+    {
+        { "link",       required_argument, NULL, 'l' },
+        { "ch",         required_argument, NULL, 'c' },
+        { "adc",        required_argument, NULL, 'a' },
+        { "mem",        required_argument, NULL, 'm' },
+        { "reserve",    required_argument, NULL, 'r' },
+        { "baud",       required_argument, NULL, 'b' },
+        { "latency",    required_argument, NULL, 't' },
+        { "no-dac",     no_argument,       NULL, 'D' },
+        { "no-bit8",    no_argument,       NULL, '8' },
+        { "periods",    required_argument, NULL, 'p' },
+        { "noise",      required_argument, NULL, 'n' },
+        { "seed",       required_argument, NULL, 's' },
+        { "stats",      no_argument,       NULL, 'S' },
+        { "help",       no_argument,       NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+
+    DeviceConfig cfg;
+    std::string link_path;
+    uint32_t baud = 0;
+    bool stats = false;
+    int opt;
+
+    while ((opt = getopt_long(argc, argv, "h", opts, NULL)) != -1)
+    {
+        switch (opt)
+        {
+        case 'l': link_path = optarg; break;
+        case 'c': cfg.daq_ch = atoi(optarg); break;
+        case 'a': cfg.adc_num = atoi(optarg); break;
+        case 'm': cfg.max_mem = atoi(optarg); break;
+        case 'r': cfg.reserve = atoi(optarg); break;
+        case 'b': baud = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 't': cfg.latency_us = atoi(optarg); break;
+        case 'D': cfg.dac = false; break;
+        case '8': cfg.bit8 = false; break;
+        case 'p': cfg.periods = atof(optarg); break;
+        case 'n': cfg.noise = atof(optarg); break;
+        case 's': cfg.seed = (uint32_t)strtoul(optarg, NULL, 10); break;
+        case 'S': stats = true; break;
+        default:  usage(argv[0]); return opt == 'h' ? 0 : 1;
+        }
+    }
+
+    /* same constraints as cfg.h of firmware */
+
+    if ((cfg.daq_ch != 2 && cfg.daq_ch != 4) || (cfg.adc_num != 1 && cfg.adc_num != 2 && cfg.adc_num != 4) ||
+        (cfg.daq_ch == 2 && cfg.adc_num != 1) || cfg.max_mem < 100 || cfg.reserve < 0 || cfg.periods <= 0)
+    {
+        fprintf(stderr, "Invalid configuration\n");
+        return 1;
+    }
+
+    PtyLink link;
+
+    if (!link.open(link_path))
+    {
+        fprintf(stderr, "%s\n", link.getError().c_str());
+        return 1;
+    }
+
+    VirtualDevice device(cfg);
+
+    /* 8N1, default rate of device stands for N, negotiated one is emulated as is */
+    auto throttle = [&]() {
+        if (baud > 0)
+            link.setThrottle((device.getBaud() == DEV_UART_BAUD ? baud : device.getBaud()) / 10);
+    };
+    throttle();
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    printf("%s\n", link.getPath().c_str());
+    fflush(stdout);
+
+    std::string line;
+    char buff[RX_BUFF_SZ];
+    bool overflow = false;
+
+    Clock::time_point stats_last = Clock::now();
+    uint64_t rx_last = 0, tx_last = 0, cmd_last = 0, frames_last = 0;
+
+    while (s_run)
+    {
+        if (link.waitRx(1))
+        {
+            int len = link.read(buff, sizeof(buff));
+
+            for (int i = 0; i < len; i++)
+            {
+                if (buff[i] == '\n' && (overflow || VirtualDevice::lineComplete(line)))
+                {
+                    if (!overflow)
+                    {
+                        if (!line.empty() && line.back() == '\r')
+                            line.pop_back();
+
+                        std::string resp = device.process(line, Clock::now());
+                        if (!resp.empty())
+                            link.write(resp.data(), (int)resp.size());
+                        throttle();
+                    }
+
+                    line.clear();
+                    overflow = false;
+                }
+                else if (line.size() < RX_LINE_MAX)
+                    line += buff[i];
+                else
+                    overflow = true;
+            }
+        }
+
+        Clock::time_point now = Clock::now();
+        std::string async = device.poll(now);
+        throttle();
+
+        if (!async.empty())
+            link.write(async.data(), (int)async.size());
+
+        if (stats && now - stats_last >= std::chrono::seconds(1))
+        {
+            double dt = std::chrono::duration<double>(now - stats_last).count();
+
+            fprintf(stderr, "rx %.1f kB/s  tx %.1f kB/s  cmd %.0f/s  frames %.1f/s\n",
+                    (link.getRxBytes() - rx_last) / dt / 1000.0, (link.getTxBytes() - tx_last) / dt / 1000.0,
+                    (device.getCommands() - cmd_last) / dt, (device.getFrames() - frames_last) / dt);
+
+            rx_last = link.getRxBytes();
+            tx_last = link.getTxBytes();
+            cmd_last = device.getCommands();
+            frames_last = device.getFrames();
+            stats_last = now;
+        }
+    }
+
+    return 0;
+}
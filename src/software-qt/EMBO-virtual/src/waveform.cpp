@@ -0,0 +1,88 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "waveform.h"
+
+#include <math.h>
+
+
+#define WAVE_AMPL       0.4     // of full scale, around mid scale
+
+Waveform::Waveform(uint32_t seed) : m_rng(seed == 0 ? 1 : seed)
+{
+    for (int ch = 0; ch < WAVE_CH_NUM; ch++)
+        m_phase0[ch] = 0;
+}
+
+void Waveform::arm(int trig_ch, double level, bool falling)
+{
+    double level_norm = (level - 0.5) / WAVE_AMPL;
+
+    if (level_norm > 0.99)
+        level_norm = 0.99;
+    if (level_norm < -0.99)
+        level_norm = -0.99;
+
+    for (int ch = 0; ch < WAVE_CH_NUM; ch++)
+    {
+        if (ch == trig_ch)
+            m_phase0[ch] = crossPhase((WaveShape)ch, level_norm, falling);
+        else
+            m_phase0[ch] = (random() % 1000) / 1000.0;
+    }
+}
+
+void Waveform::sample(int k, int pre, int len, double out[WAVE_CH_NUM])
+{
+    for (int ch = 0; ch < WAVE_CH_NUM; ch++)
+    {
+        double phase = m_phase0[ch] + (double)(k - pre) * m_periods * (ch + 1) / len;
+        phase -= floor(phase);
+
+        double val = shape((WaveShape)ch, phase);
+
+        if (ch == W_NOISY_SINE)
+            val += ((random() % 2001) / 1000.0 - 1.0) * 0.1;
+
+        val = 0.5 + WAVE_AMPL * val + ((random() % 2001) / 1000.0 - 1.0) * m_noise;
+
+        out[ch] = val < 0 ? 0 : (val > 1 ? 1 : val);
+    }
+}
+
+double Waveform::shape(WaveShape shape, double phase)
+{
+    switch (shape)
+    {
+    case W_SQUARE:   return phase < 0.5 ? 1.0 : -1.0;
+    case W_TRIANGLE: return phase < 0.5 ? -1.0 + 4.0 * phase : 3.0 - 4.0 * phase;
+    default:         return sin(2.0 * M_PI * phase);
+    }
+}
+
+/* xorshift32 - cheap and repeatable */
+uint32_t Waveform::random()
+{
+    m_rng ^= m_rng << 13;
+    m_rng ^= m_rng >> 17;
+    m_rng ^= m_rng << 5;
+    return m_rng;
+}
+
+/* private */
+
+double Waveform::crossPhase(WaveShape shape, double level, bool falling)
+{
+    switch (shape)
+    {
+    case W_SQUARE:   return falling ? 0.5 : 0.0;
+    case W_TRIANGLE: return falling ? (3.0 - level) / 4.0 : (level + 1.0) / 4.0;
+    default:
+    {
+        double phase = asin(level) / (2.0 * M_PI);
+        return falling ? 0.5 - phase : (phase < 0 ? phase + 1.0 : phase);
+    }
+    }
+}
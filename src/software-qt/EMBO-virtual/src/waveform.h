@@ -0,0 +1,53 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef WAVEFORM_H
+#define WAVEFORM_H
+
+#include <vector>
+#include <stdint.h>
+
+
+#define WAVE_CH_NUM     4
+
+enum WaveShape
+{
+    W_SINE,
+    W_SQUARE,
+    W_TRIANGLE,
+    W_NOISY_SINE
+};
+
+/* synthetic signal source - channel n has shape n and frequency multiplied by n + 1 */
+
+class Waveform
+{
+public:
+    Waveform(uint32_t seed = 1);
+
+    void setPeriods(double periods) { m_periods = periods; }
+    void setNoise(double noise) { m_noise = noise; }
+
+    /* new frame - trigger channel will cross level (0 - 1 of full scale) at trigger position, others are free running */
+    void arm(int trig_ch, double level, bool falling);
+
+    /* values 0 - 1 of full scale of all channels, sample k of frame with len samples, trigger at sample pre */
+    void sample(int k, int pre, int len, double out[WAVE_CH_NUM]);
+
+    /* normalized value -1 .. 1 of shape at phase 0 .. 1 */
+    static double shape(WaveShape shape, double phase);
+
+    uint32_t random();
+
+private:
+    static double crossPhase(WaveShape shape, double level, bool falling);
+
+    double m_periods = 4;           // trigger channel periods per frame
+    double m_noise = 0.01;          // of full scale
+    double m_phase0[WAVE_CH_NUM];   // phase at trigger position
+    uint32_t m_rng;
+};
+
+#endif // WAVEFORM_H
@@ -0,0 +1,166 @@
+# EMBO GUI application, acquisition itself is in libembo
+
+QT       += core gui network serialport help concurrent
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets printsupport
+
+TARGET = EMBO
+
+include(libembo/libembo.pri)
+
+win32:RC_ICONS = icon.ico
+macx: ICON = icon.icns
+
+
+greaterThan(QT_MAJOR_VERSION, 4){
+    TARGET_ARCH=$${QT_ARCH}
+}else{
+    TARGET_ARCH=$${QMAKE_HOST.arch}
+}
+
+CONFIG(release, debug|release): DESTDIR = $$OUT_PWD/release
+CONFIG(debug, debug|release): DESTDIR = $$OUT_PWD/debug
+
+
+include(__updater/QSimpleUpdater.pri)
+
+LINUX_LIB_DIR = ubuntu_18
+MACOS_LIB_DIR = mac_10.15
+
+win32 {
+
+    include(__crashhandler/qBreakpad.pri)
+
+    contains(TARGET_ARCH, x86_64) {
+
+        ARCHITECTURE = win64
+        QMAKE_LIBDIR += $$PWD/lib/win64
+        LIBS += $$PWD/lib/win64/libfftw3-3.dll
+        LIBS += $$PWD/lib/win64/libqBreakpad.a
+
+        inst.files += $$PWD/lib/win64/libfftw3-3.dll
+        inst.path += $${DESTDIR}
+        INSTALLS += inst
+
+    } else {
+
+        ARCHITECTURE = win32
+        QMAKE_LIBDIR += $$PWD/lib/win32
+        LIBS += $$PWD/lib/win32/libfftw3-3.dll
+        LIBS += $$PWD/lib/win32/libqBreakpad.a
+
+        inst.files += $$PWD/lib/win32/libfftw3-3.dll
+        inst.path += $${DESTDIR}
+        INSTALLS += inst
+    }
+}
+
+linux {
+
+    #include(__crashhandler/qBreakpad.pri)
+
+    ARCHITECTURE = linux
+    QMAKE_LIBDIR += $$PWD/lib/$$LINUX_LIB_DIR
+    LIBS += $$PWD/lib/$$LINUX_LIB_DIR/libfftw3.a
+    #LIBS += $$PWD/lib/$$LINUX_LIB_DIR/libqBreakpad.a
+}
+
+macx {
+
+    include(__crashhandler/qBreakpad.pri)
+
+    ARCHITECTURE = mac
+    QMAKE_LIBDIR += $$PWD/lib/$$MACOS_LIB_DIR
+    LIBS += -framework AppKit
+    LIBS += $$PWD/lib/$$MACOS_LIB_DIR/libfftw3.a
+    LIBS += $$PWD/lib/$$MACOS_LIB_DIR/libqBreakpad.a
+}
+
+#LIBS += -lOpenGL32
+#DEFINES += QCUSTOMPLOT_USE_OPENGL
+
+help.files += "$${PWD}/doc/EMBO.chm" \
+              "$${PWD}/doc/EMBO.pdf"
+help.path += $${DESTDIR}/doc
+INSTALLS += help
+
+QMAKE_TARGET_COMPANY = CTU Jakub Parez
+QMAKE_TARGET_PRODUCT = EMBO
+QMAKE_TARGET_DESCRIPTION = EMBedded Oscilloscope
+QMAKE_TARGET_COPYRIGHT = CTU Jakub Parez
+
+INCLUDEPATH += src/windows/
+
+SOURCES += \
+    lib/qdial2.cpp \
+    lib/ctkrangeslider.cpp \
+    lib/qcustomplot.cpp \
+    src/arbwave.cpp \
+    src/main.cpp \
+    src/masktest.cpp \
+    src/persistence.cpp \
+    src/qcpcursors.cpp \
+    src/recorder.cpp \
+    src/settings.cpp \
+    src/softtrig.cpp \
+    src/stripchart.cpp \
+    src/timeinterval.cpp \
+    src/trend.cpp \
+    src/utils.cpp \
+    src/xycurve.cpp \
+    src/windows/window__main.cpp \
+    src/windows/window_cntr.cpp \
+    src/windows/window_diag.cpp \
+    src/windows/window_la.cpp \
+    src/windows/window_pwm.cpp \
+    src/windows/window_scope.cpp \
+    src/windows/window_sgen.cpp \
+    src/windows/window_vm.cpp
+
+HEADERS += \
+    lib/qdial2.h \
+    src/css.h \
+    lib/ctkrangeslider.h \
+    lib/fftw3.h \
+    lib/qcustomplot.h \
+    src/arbwave.h \
+    src/masktest.h \
+    src/persistence.h \
+    src/qcpcursors.h \
+    src/recorder.h \
+    src/settings.h \
+    src/softtrig.h \
+    src/stripchart.h \
+    src/timeinterval.h \
+    src/trend.h \
+    src/utils.h \
+    src/xycurve.h \
+    src/windows/window__main.h \
+    src/windows/window_cntr.h \
+    src/windows/window_diag.h \
+    src/windows/window_la.h \
+    src/windows/window_pwm.h \
+    src/windows/window_scope.h \
+    src/windows/window_sgen.h \
+    src/windows/window_vm.h
+
+FORMS += \
+    src/windows/window__main.ui \
+    src/windows/window_cntr.ui \
+    src/windows/window_diag.ui \
+    src/windows/window_la.ui \
+    src/windows/window_pwm.ui \
+    src/windows/window_scope.ui \
+    src/windows/window_sgen.ui \
+    src/windows/window_vm.ui
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
+
+RESOURCES += resources/resources.qrc
+
+DISTFILES += \
+    icon.icns \
+    icon.ico
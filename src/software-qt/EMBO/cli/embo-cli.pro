@@ -0,0 +1,19 @@
+# embo-cli - headless acquisition, configures SCOPE, LA or VM and streams frames to stdout or file,
+# more devices (repeated --port) are captured concurrently, each by own Core thread
+
+QT = core serialport network
+
+TEMPLATE = app
+TARGET = embo-cli
+
+CONFIG += console
+CONFIG -= app_bundle
+
+include(../libembo/libembo.pri)
+
+SOURCES += \
+    embocli.cpp \
+    main.cpp
+
+HEADERS += \
+    embocli.h
@@ -0,0 +1,359 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "embocli.h"
+
+#include <QMetaObject>
+
+#include <stdio.h>
+#include <string.h>
+
+
+EmboCli::EmboCli(const CliOptions& opt, Core* core, QObject* parent) : QObject(parent), m_opt(opt)
+{
+    m_core = core;
+
+    if (m_opt.mode == SCOPE)
+    {
+        auto msg_set = new Msg_SCOP_Set(this);
+        auto msg_get = new Msg_SCOP_Set(this);
+        auto msg_read = new Msg_SCOP_Read(this);
+
+        connect(msg_set, &Msg_SCOP_Set::err, this, &EmboCli::on_msg_err, Qt::QueuedConnection);
+        connect(msg_get, &Msg_SCOP_Set::err, this, &EmboCli::on_msg_err, Qt::QueuedConnection);
+        connect(msg_get, &Msg_SCOP_Set::result, this, &EmboCli::on_msg_set, Qt::QueuedConnection);
+        connect(msg_read, &Msg_SCOP_Read::err, this, &EmboCli::on_msg_err, Qt::QueuedConnection);
+        connect(msg_read, &Msg_SCOP_Read::result, this, &EmboCli::on_msg_read, Qt::QueuedConnection);
+
+        m_msg_set = msg_set;
+        m_msg_get = msg_get;
+        m_msg_read = msg_read;
+    }
+    else if (m_opt.mode == LA)
+    {
+        auto msg_set = new Msg_LA_Set(this);
+        auto msg_get = new Msg_LA_Set(this);
+        auto msg_read = new Msg_LA_Read(this);
+
+        connect(msg_set, &Msg_LA_Set::err, this, &EmboCli::on_msg_err, Qt::QueuedConnection);
+        connect(msg_get, &Msg_LA_Set::err, this, &EmboCli::on_msg_err, Qt::QueuedConnection);
+        connect(msg_get, &Msg_LA_Set::result, this, &EmboCli::on_msg_set, Qt::QueuedConnection);
+        connect(msg_read, &Msg_LA_Read::err, this, &EmboCli::on_msg_err, Qt::QueuedConnection);
+        connect(msg_read, &Msg_LA_Read::result, this, &EmboCli::on_msg_read, Qt::QueuedConnection);
+
+        m_msg_set = msg_set;
+        m_msg_get = msg_get;
+        m_msg_read = msg_read;
+    }
+    else
+    {
+        m_msg_vm = new Msg_VM_Read(this);
+
+        connect(m_msg_vm, &Msg_VM_Read::err, this, &EmboCli::on_msg_err, Qt::QueuedConnection);
+        connect(m_msg_vm, &Msg_VM_Read::result, this, &EmboCli::on_msg_vm, Qt::QueuedConnection);
+    }
+
+    connect(core, &Core::stateChanged, this, &EmboCli::on_coreState_changed, Qt::QueuedConnection);
+    connect(core, &Core::msgDisplay, this, &EmboCli::on_msgDisplay, Qt::QueuedConnection);
+    connect(core, &Core::daqReady, this, &EmboCli::on_msg_daqReady, Qt::QueuedConnection);
+
+    m_core->emboInstruments.append(this);
+}
+
+void EmboCli::start(const QString& port)
+{
+    m_port = port;
+    m_started = true;
+
+    m_core->setCommPeriod(0); // next comm cycle right after response - maximum link rate
+    m_core->setBaudMax(m_opt.baud_max);
+    QMetaObject::invokeMethod(m_core, "on_openComm", Qt::QueuedConnection, Q_ARG(QString, port));
+}
+
+/********************************* slots *********************************/
+
+void EmboCli::on_coreState_changed(const State state)
+{
+    if (state == CONNECTED)
+        configure();
+    else if (state == DISCONNECTED && m_started)
+        finish(1); // closed by error, regular finish already set m_finished
+}
+
+void EmboCli::on_msgDisplay(const QString text, MsgBoxType type)
+{
+    fprintf(stderr, "[%s] %s: %s\n", qPrintable(m_port), type == CRITICAL ? "Error" : "Warning", qPrintable(text));
+}
+
+void EmboCli::on_msg_err(const QString text, MsgBoxType type, bool needClose)
+{
+    on_msgDisplay(text, type);
+
+    if (needClose)
+        finish(1);
+}
+
+void EmboCli::on_msg_set(const DaqSettings set)
+{
+    m_daqSet = set;
+    m_configured = true;
+
+    fprintf(stderr, "[%s] Sampling frequency: %s Hz, memory: %d\n", qPrintable(m_port), qPrintable(set.fs_real), set.mem);
+}
+
+void EmboCli::on_msg_daqReady(Ready, int firstPos)
+{
+    if (!m_configured || m_finished)
+        return;
+
+    m_firstPos = firstPos;
+    m_core->msgAdd(m_msg_read, true);
+}
+
+void EmboCli::on_msg_read(const QByteArray data)
+{
+    if (m_finished)
+        return;
+
+    auto info = m_core->getDevInfo();
+    m_bytesRx += data.size();
+
+    QVector<double> y1(m_daqSet.mem);
+    QVector<double> y2(m_daqSet.mem);
+    QVector<double> y3(m_daqSet.mem);
+    QVector<double> y4(m_daqSet.mem);
+
+    QVector<double>* y[DAQ_CH_NUM] = { NULL, NULL, NULL, NULL };
+    bool valid;
+
+    if (m_opt.mode == SCOPE)
+    {
+        int ch_num = m_daqSet.ch1_en + m_daqSet.ch2_en + m_daqSet.ch3_en + m_daqSet.ch4_en;
+
+        y[0] = (m_daqSet.ch1_en ? &y1 : NULL);
+        y[1] = (m_daqSet.ch2_en ? &y2 : NULL);
+        y[2] = (m_daqSet.ch3_en ? &y3 : NULL);
+        y[3] = (m_daqSet.ch4_en ? &y4 : NULL);
+
+        const double gain[DAQ_CH_NUM] = { 1, 1, 1, 1 };
+        const double offset[DAQ_CH_NUM] = { 0, 0, 0, 0 };
+
+        int found = scope_frame_to_vals(data, m_firstPos, m_daqSet, *info, gain, offset, y);
+        valid = ch_num > 0 && found == m_daqSet.mem * ch_num;
+    }
+    else
+    {
+        y[0] = &y1;
+        y[1] = &y2;
+
+        if (info->daq_ch == 4)
+        {
+            y[2] = &y3;
+            y[3] = &y4;
+        }
+
+        valid = data.size() == la_frame_size(m_daqSet.mem, *info);
+        if (valid)
+            la_frame_to_vals(data, m_firstPos, m_daqSet.mem, *info, y);
+    }
+
+    if (!valid) // wrong data size
+    {
+        m_err_cntr++;
+        if (m_err_cntr > READ_ERROR_CNT)
+            on_msg_err(QString(INVALID_MSG) + " (data size wrong -> " + QString::number(data.size()) + ")", CRITICAL, true);
+
+        return;
+    }
+
+    writeFrame(y, m_daqSet.mem, m_daqSet.fs_real_n);
+}
+
+void EmboCli::on_msg_vm(const VmData data)
+{
+    if (m_finished)
+        return;
+
+    if (m_opt.binary)
+    {
+        QVector<double> y1(1, data.ch1);
+        QVector<double> y2(1, data.ch2);
+        QVector<double> y3(1, data.ch3);
+        QVector<double> y4(1, data.ch4);
+
+        QVector<double>* y[DAQ_CH_NUM] = { &y1, &y2, &y3, &y4 };
+        writeFrame(y, 1, 0);
+        return;
+    }
+
+    double t_ms = m_core->getAlignedTimeMs();
+    double t = (t_ms - m_opt.t0_ms) / 1000.0;
+
+    QByteArray line = QByteArray::number(t, 'f', 6) + "," +
+                      QByteArray::number(m_core->getId()) + "," +
+                      QByteArray::number(data.ch1, 'f', 4) + "," +
+                      QByteArray::number(data.ch2, 'f', 4) + "," +
+                      QByteArray::number(data.ch3, 'f', 4) + "," +
+                      QByteArray::number(data.ch4, 'f', 4) + "," +
+                      QByteArray::number(data.vcc, 'f', 4) + "\n";
+    emit frame(m_core->getId(), t_ms, line);
+
+    if (m_opt.count > 0 && (int)++m_seq >= m_opt.count)
+        finish(0);
+}
+
+/******************************** private ********************************/
+
+void EmboCli::configure()
+{
+    auto core = m_core;
+    auto info = core->getDevInfo();
+
+    fprintf(stderr, "[%s] Connected: %s, FW %s, %d bps\n", qPrintable(m_port), qPrintable(info->name), qPrintable(info->fw),
+            core->getBaud());
+
+    core->setMode(m_opt.mode);
+    m_timer.start();
+
+    if (m_opt.mode == VM)
+    {
+        m_activeMsgs.push_back(m_msg_vm);
+        m_instrEnabled = true;
+        return;
+    }
+
+    const DaqSettings& set = m_opt.set;
+
+    QString trigEdge = (set.trig_edge == RISING ? "R" : (set.trig_edge == FALLING ? "F" : "B"));
+    QString trigMode = (set.trig_mode == AUTO ? "A" : (set.trig_mode == NORMAL ? "N" : (set.trig_mode == SINGLE ? "S" : "D")));
+    QString params;
+
+    if (m_opt.mode == SCOPE)
+    {
+        QString channs = "0000";
+        channs[0] = set.ch1_en ? '1' : '0';
+        channs[1] = set.ch2_en ? '1' : '0';
+        channs[2] = set.ch3_en ? '1' : '0';
+        channs[3] = set.ch4_en ? '1' : '0';
+
+        params = (set.bits == B12 ? "12," : "8," ) +     // bits
+                 QString::number(set.mem) + "," +       // mem
+                 QString::number(set.fs) + "," +        // fs
+                 channs + "," +                         // channs
+                 QString::number(set.trig_ch) + "," +   // trig ch
+                 QString::number(set.trig_val) + "," +  // trig val
+                 trigEdge + "," +                       // trig edge
+                 trigMode + "," +                       // trig mode
+                 QString::number(set.trig_pre);         // trig pre
+    }
+    else
+    {
+        params = QString::number(set.mem) + "," +       // mem
+                 QString::number(set.fs) + "," +        // fs
+                 QString::number(set.trig_ch) + "," +   // trig ch
+                 trigEdge + "," +                       // trig edge
+                 trigMode + "," +                       // trig mode
+                 QString::number(set.trig_pre);         // trig pre
+    }
+
+    core->msgAdd(m_msg_set, false, params);
+    core->msgAdd(m_msg_get, true, ""); // read back, conversion needs settings applied by device
+    m_instrEnabled = true;
+}
+
+void EmboCli::writeFrame(QVector<double>* y[DAQ_CH_NUM], int samples, double fs)
+{
+    double t_ms = m_core->getAlignedTimeMs();
+    double t = (t_ms - m_opt.t0_ms) / 1000.0;
+    QByteArray out;
+
+    if (m_opt.binary)
+    {
+        CliFrameHeader hdr;
+        memcpy(hdr.magic, CLI_FRAME_MAGIC, sizeof(hdr.magic));
+        hdr.seq = m_seq;
+        hdr.mode = (uint8_t)m_opt.mode;
+        hdr.ch_mask = 0;
+        hdr.device = m_core->getId();
+        hdr.samples = samples;
+        hdr.fs = fs;
+        hdr.t = t;
+
+        for (int ch = 0; ch < DAQ_CH_NUM; ch++)
+        {
+            if (y[ch] != NULL)
+                hdr.ch_mask |= (1 << ch);
+        }
+
+        out.reserve(sizeof(hdr) + (DAQ_CH_NUM * samples * sizeof(float)));
+        out.append((const char*)&hdr, sizeof(hdr));
+
+        for (int ch = 0; ch < DAQ_CH_NUM; ch++)
+        {
+            if (y[ch] == NULL)
+                continue;
+
+            for (int i = 0; i < samples; i++)
+            {
+                float val = (float)(*y[ch])[i];
+                out.append((const char*)&val, sizeof(val));
+            }
+        }
+    }
+    else
+    {
+        out = "# frame " + QByteArray::number(m_seq) +
+              " device " + QByteArray::number(m_core->getId()) +
+              " t=" + QByteArray::number(t, 'f', 6) +
+              " fs=" + QByteArray::number(fs, 'g', 10) +
+              " samples=" + QByteArray::number(samples) + "\n";
+
+        for (int i = 0; i < samples; i++)
+        {
+            bool first = true;
+
+            for (int ch = 0; ch < DAQ_CH_NUM; ch++)
+            {
+                if (y[ch] == NULL)
+                    continue;
+
+                if (!first)
+                    out.append(',');
+
+                out.append(QByteArray::number((*y[ch])[i], 'f', 4));
+                first = false;
+            }
+            out.append('\n');
+        }
+    }
+
+    emit frame(m_core->getId(), t_ms, out);
+
+    m_seq++;
+    if (m_opt.count > 0 && (int)m_seq >= m_opt.count)
+        finish(0);
+}
+
+void EmboCli::finish(int exitCode)
+{
+    if (m_finished)
+        return;
+
+    m_finished = true;
+    m_instrEnabled = false;
+    m_activeMsgs.clear();
+
+    if (m_timer.isValid())
+    {
+        double sec = m_timer.nsecsElapsed() / 1000000000.0;
+
+        if (sec > 0)
+            fprintf(stderr, "[%s] Frames: %u, %.1f frames/s, %.1f kB/s\n",
+                    qPrintable(m_port), m_seq, m_seq / sec, m_bytesRx / sec / 1000.0);
+    }
+
+    QMetaObject::invokeMethod(m_core, "on_closeComm", Qt::QueuedConnection, Q_ARG(bool, true));
+    emit finished(exitCode);
+}
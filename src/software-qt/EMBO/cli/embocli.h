@@ -0,0 +1,109 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef EMBOCLI_H
+#define EMBOCLI_H
+
+#include "core.h"
+#include "messages.h"
+#include "interfaces.h"
+#include "containers.h"
+#include "daqconv.h"
+
+#include <QObject>
+#include <QStringList>
+#include <QElapsedTimer>
+
+#include <stdint.h>
+
+
+#define CLI_FRAME_MAGIC     "EMBF"
+
+/* binary output - header followed by samples as float32, all samples of CH1, then CH2..,
+ * only channels set in ch_mask are present, native byte order (little-endian on all supported hosts) */
+
+#pragma pack(push, 1)
+struct CliFrameHeader
+{
+    char magic[4];          // CLI_FRAME_MAGIC
+    uint32_t seq;           // frame number from 0
+    uint8_t mode;           // Mode - VM, SCOPE, LA
+    uint8_t ch_mask;        // bit 0 = CH1 .. bit 3 = CH4
+    uint16_t device;        // index of --port
+    uint32_t samples;       // per channel, VM = 1
+    double fs;              // real sampling frequency [Hz], VM = 0
+    double t;               // device uptime aligned to common host clock, since start [s]
+};
+#pragma pack(pop)
+
+class CliOptions
+{
+public:
+    QStringList ports;      // one device per port
+    Mode mode = SCOPE;
+    DaqSettings set;        // bits, mem, fs, channels and trigger of SCOPE / LA
+    int count = 0;          // frames to receive, 0 = until interrupted
+    QString output;         // empty = stdout
+    bool binary = false;    // text is used only for stdout without --bin
+    double t0_ms = 0;       // Core::hostTimeMs() of start
+    int baud_max = BAUD_MAX_DEFAULT; // UART negotiation limit, 0 = keep default
+};
+
+/* headless instrument of one device - configures SCOPE, LA or VM and emits every frame formatted for output */
+
+class EmboCli : public QObject, public IEmboInstrument
+{
+    Q_OBJECT
+
+public:
+    explicit EmboCli(const CliOptions& opt, Core* core, QObject* parent = 0);
+
+    void start(const QString& port);
+
+    std::vector<Msg*>& getActiveMsgs() override { return m_activeMsgs; }
+    bool getInstrEnabled() override { return m_instrEnabled; }
+
+signals:
+    void frame(int device, double t_ms, const QByteArray data);
+    void finished(int exitCode);
+
+private slots:
+    void on_coreState_changed(const State state);
+    void on_msgDisplay(const QString text, MsgBoxType type);
+    void on_msg_err(const QString text, MsgBoxType type, bool needClose);
+    void on_msg_set(const DaqSettings set);
+    void on_msg_daqReady(Ready ready, int firstPos);
+    void on_msg_read(const QByteArray data);
+    void on_msg_vm(const VmData data);
+
+private:
+    void configure();
+    void writeFrame(QVector<double>* y[DAQ_CH_NUM], int samples, double fs);
+    void finish(int exitCode);
+
+    CliOptions m_opt;
+    DaqSettings m_daqSet;
+    QString m_port;
+
+    /* messages */
+    Msg* m_msg_set = Q_NULLPTR;
+    Msg* m_msg_get = Q_NULLPTR;
+    Msg* m_msg_read = Q_NULLPTR;
+    Msg_VM_Read* m_msg_vm = Q_NULLPTR;
+
+    /* state */
+    bool m_started = false;
+    bool m_configured = false;
+    bool m_finished = false;
+    int m_firstPos = 0;
+    uint32_t m_seq = 0;
+    int m_err_cntr = 0;
+
+    /* stats */
+    QElapsedTimer m_timer;
+    qint64 m_bytesRx = 0;
+};
+
+#endif // EMBOCLI_H
@@ -0,0 +1,230 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "embocli.h"
+#include "devices.h"
+#include "merger.h"
+#include "trace.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QLoggingCategory>
+#include <QRegExp>
+
+#include <stdio.h>
+#include <limits.h>
+
+
+static bool parse_int(const QCommandLineParser& parser, const QCommandLineOption& opt, int min, int max, int& val)
+{
+    if (!parser.isSet(opt))
+        return true;
+
+    bool ok;
+    int ret = parser.value(opt).toInt(&ok);
+
+    if (!ok || ret < min || ret > max)
+    {
+        fprintf(stderr, "Invalid value of --%s: %s\n", qPrintable(opt.names().last()), qPrintable(parser.value(opt)));
+        return false;
+    }
+
+    val = ret;
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName("embo-cli");
+    QCoreApplication::setApplicationVersion(APP_VERSION);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("EMBO headless acquisition - configures SCOPE, LA or VM and streams frames "
+                                     "to stdout (text) or file (binary) at maximum link rate. With more --port options, "
+                                     "all devices are captured concurrently and frames are merged by device time.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    QCommandLineOption optPort({"p", "port"}, "Serial port of EMBO device (required, repeat for more devices).", "port");
+    QCommandLineOption optMode({"m", "mode"}, "Instrument: scope, la, vm (default scope).", "mode", "scope");
+    QCommandLineOption optBits("bits", "SCOPE resolution: 8, 12 (default 12).", "bits", "12");
+    QCommandLineOption optMem("mem", "Samples per channel (default 1000).", "n", "1000");
+    QCommandLineOption optFs("fs", "Sampling frequency in Hz (default 10000).", "Hz", "10000");
+    QCommandLineOption optCh("ch", "SCOPE enabled channels CH1..CH4 (default 1111).", "mask", "1111");
+    QCommandLineOption optTrigCh("trig-ch", "Trigger channel 1..4 (default 1).", "ch", "1");
+    QCommandLineOption optTrigLevel("trig-level", "SCOPE trigger level in % of Vref (default 50).", "pct", "50");
+    QCommandLineOption optTrigEdge("trig-edge", "Trigger edge: R, F, B (default R).", "edge", "R");
+    QCommandLineOption optTrigMode("trig-mode", "Trigger mode: A, N, S, D (default A).", "mode", "A");
+    QCommandLineOption optPre("pre", "Pretrigger in % (default 50).", "pct", "50");
+    QCommandLineOption optCount({"n", "count"}, "Frames to receive, 0 = until interrupted (default 0).", "n", "0");
+    QCommandLineOption optOutput({"o", "output"}, "Binary output file instead of stdout.", "file");
+    QCommandLineOption optBin("bin", "Binary output also to stdout.");
+    QCommandLineOption optBaud("baud-max", "Max negotiated UART baud rate, 0 = keep 115200 (default 2000000).", "bps", "2000000");
+    QCommandLineOption optVerbose({"v", "verbose"}, "Print comm log to stderr.");
+
+    parser.addOptions({ optPort, optMode, optBits, optMem, optFs, optCh, optTrigCh, optTrigLevel, optTrigEdge,
+                        optTrigMode, optPre, optCount, optOutput, optBin, optBaud, optVerbose });
+    parser.process(a);
+
+    CliOptions opt;
+    DaqSettings& set = opt.set;
+
+    opt.ports = parser.values(optPort);
+    opt.output = parser.value(optOutput);
+    opt.binary = parser.isSet(optBin) || !opt.output.isEmpty();
+
+    if (opt.ports.isEmpty())
+    {
+        fprintf(stderr, "Serial port is required!\n\n");
+        parser.showHelp(1);
+    }
+
+    QString mode = parser.value(optMode).toLower();
+    if (mode == "scope") opt.mode = SCOPE;
+    else if (mode == "la") opt.mode = LA;
+    else if (mode == "vm") opt.mode = VM;
+    else
+    {
+        fprintf(stderr, "Invalid mode: %s\n", qPrintable(mode));
+        return 1;
+    }
+
+    int bits = 12;
+    set.mem = 1000;
+    set.fs = 10000;
+    set.trig_ch = 1;
+    set.trig_val = 50;
+    set.trig_pre = 50;
+
+    if (!parse_int(parser, optBits, 8, 12, bits) ||
+        !parse_int(parser, optMem, 2, INT_MAX, set.mem) ||
+        !parse_int(parser, optFs, 1, INT_MAX, set.fs) ||
+        !parse_int(parser, optTrigCh, 1, 4, set.trig_ch) ||
+        !parse_int(parser, optTrigLevel, 0, 100, set.trig_val) ||
+        !parse_int(parser, optPre, 0, 100, set.trig_pre) ||
+        !parse_int(parser, optCount, 0, INT_MAX, opt.count) ||
+        !parse_int(parser, optBaud, 0, INT_MAX, opt.baud_max))
+        return 1;
+
+    if (bits != 8 && bits != 12)
+    {
+        fprintf(stderr, "Invalid value of --bits: %d\n", bits);
+        return 1;
+    }
+
+    set.bits = (bits == 8 ? B8 : B12);
+
+    QString ch = parser.value(optCh);
+    if (ch.size() != 4 || ch.contains(QRegExp("[^01]")) || !ch.contains('1'))
+    {
+        fprintf(stderr, "Invalid channels: %s\n", qPrintable(ch));
+        return 1;
+    }
+
+    set.ch1_en = ch[0] == '1';
+    set.ch2_en = ch[1] == '1';
+    set.ch3_en = ch[2] == '1';
+    set.ch4_en = ch[3] == '1';
+
+    QString edge = parser.value(optTrigEdge).toUpper();
+    if (edge == "R") set.trig_edge = RISING;
+    else if (edge == "F") set.trig_edge = FALLING;
+    else if (edge == "B") set.trig_edge = BOTH;
+    else
+    {
+        fprintf(stderr, "Invalid trigger edge: %s\n", qPrintable(edge));
+        return 1;
+    }
+
+    QString trigMode = parser.value(optTrigMode).toUpper();
+    if (trigMode == "A") set.trig_mode = AUTO;
+    else if (trigMode == "N") set.trig_mode = NORMAL;
+    else if (trigMode == "S") set.trig_mode = SINGLE;
+    else if (trigMode == "D") set.trig_mode = DISABLED;
+    else
+    {
+        fprintf(stderr, "Invalid trigger mode: %s\n", qPrintable(trigMode));
+        return 1;
+    }
+
+    if (!parser.isSet(optVerbose))
+        QLoggingCategory::setFilterRules("*.info=false");
+
+    Trace::setLevel(TRACE_ERR); // keep comm layer lean
+
+    qRegisterMetaType<State>("State");
+    qRegisterMetaType<MsgBoxType>("MsgBoxType");
+    qRegisterMetaType<Ready>("Ready");
+    qRegisterMetaType<DaqSettings>("DaqSettings");
+    qRegisterMetaType<VmData>("VmData");
+
+    QFile out;
+    bool opened;
+
+    if (opt.output.isEmpty())
+        opened = out.open(stdout, QIODevice::WriteOnly);
+    else
+    {
+        out.setFileName(opt.output);
+        opened = out.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    }
+
+    if (!opened)
+    {
+        fprintf(stderr, "Output opening failed! %s\n", qPrintable(out.errorString()));
+        return 1;
+    }
+
+    if (opt.mode == VM && !opt.binary)
+        out.write("t,device,ch1,ch2,ch3,ch4,vcc\n");
+
+    /* one Core thread per device, frames merged in main thread */
+
+    Devices devices;
+    StreamMerger merger(opt.ports.size());
+    QVector<EmboCli*> clis;
+    int running = opt.ports.size();
+    int exitCode = 0;
+
+    opt.t0_ms = Core::hostTimeMs();
+
+    QObject::connect(&merger, &StreamMerger::frame, [&out](int, double, const QByteArray data)
+    {
+        out.write(data);
+        out.flush(); // consumer of pipe gets whole frames immediately
+    });
+
+    for (int i = 0; i < opt.ports.size(); i++)
+    {
+        auto cli = new EmboCli(opt, devices.add());
+
+        QObject::connect(cli, &EmboCli::frame, &merger, &StreamMerger::push);
+        QObject::connect(cli, &EmboCli::finished, [&, i](int code)
+        {
+            exitCode = qMax(exitCode, code);
+            merger.finish(i);
+
+            if (--running == 0)
+            {
+                merger.flush();
+                QCoreApplication::exit(exitCode);
+            }
+        });
+
+        clis.push_back(cli);
+    }
+
+    for (int i = 0; i < clis.size(); i++)
+        clis[i]->start(opt.ports[i]);
+
+    int ret = a.exec();
+
+    devices.removeAll(); // waits for threads, pending close of ports is done
+    qDeleteAll(clis);
+
+    return ret;
+}
@@ -0,0 +1,21 @@
+# common settings of libembo, GUI and embo-cli
+
+CONFIG += c++11
+
+VERSION = 0.1.5
+MIN_FW = 0.2.1
+
+DEFINES += APP_VERSION=\\\"$$VERSION\\\"
+DEFINES += MIN_FW_VER=\\\"$$MIN_FW\\\"
+
+# The following define makes your compiler emit warnings if you use
+# any Qt feature that has been marked deprecated (the exact warnings
+# depend on your compiler). Please consult the documentation of the
+# deprecated API in order to know how to port your code away from it.
+DEFINES += QT_DEPRECATED_WARNINGS
+
+QMAKE_CXXFLAGS += -Wno-deprecated -Wno-deprecated-declarations
+
+INCLUDEPATH += $$PWD/src/
+
+LIBEMBO_DIR = $$shadowed($$PWD)/libembo
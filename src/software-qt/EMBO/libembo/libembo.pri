@@ -0,0 +1,8 @@
+# link against libembo
+
+include(../embo.pri)
+
+LIBS += -L$$LIBEMBO_DIR -lembo
+
+win32-msvc*: PRE_TARGETDEPS += $$LIBEMBO_DIR/embo.lib
+else: PRE_TARGETDEPS += $$LIBEMBO_DIR/libembo.a
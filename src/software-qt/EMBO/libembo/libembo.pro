@@ -0,0 +1,42 @@
+# libembo - connection, message scheduling, response decoding and sample conversion
+# without GUI dependency, shared by EMBO GUI and embo-cli, local server for external clients
+
+QT = core serialport network
+
+TEMPLATE = lib
+TARGET = embo
+
+CONFIG += staticlib
+
+include(../embo.pri)
+
+DESTDIR = $$LIBEMBO_DIR
+
+SOURCES += \
+    ../src/core.cpp \
+    ../src/daqconv.cpp \
+    ../src/devices.cpp \
+    ../src/histogram.cpp \
+    ../src/merger.cpp \
+    ../src/messages.cpp \
+    ../src/msg.cpp \
+    ../src/server.cpp \
+    ../src/shmring.cpp \
+    ../src/tokens.cpp \
+    ../src/trace.cpp
+
+HEADERS += \
+    ../src/containers.h \
+    ../src/core.h \
+    ../src/daqconv.h \
+    ../src/devices.h \
+    ../src/histogram.h \
+    ../src/interfaces.h \
+    ../src/merger.h \
+    ../src/messages.h \
+    ../src/msg.h \
+    ../src/server.h \
+    ../src/shmring.h \
+    ../src/streamstats.h \
+    ../src/tokens.h \
+    ../src/trace.h
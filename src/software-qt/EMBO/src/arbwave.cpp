@@ -0,0 +1,155 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "arbwave.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QStringList>
+#include <QRegExp>
+
+#include <algorithm>
+#include <cmath>
+#include <assert.h>
+
+
+ArbWave::ArbWave()
+{
+}
+
+void ArbWave::clear()
+{
+    m_src.clear();
+    m_samples.clear();
+}
+
+/*
+ * Waveform file - one period, any number of points:
+ *   .bin .raw  - signed 16-bit little endian samples
+ *   else       - text, one point per line, last numeric column is value (time column is ignored)
+ * Empty lines, lines starting with # and header lines without number are ignored.
+ */
+bool ArbWave::loadFile(const QString path, QString& err)
+{
+    QFile file(path);
+    QString suffix = QFileInfo(path).suffix().toLower();
+    bool binary = (suffix == "bin" || suffix == "raw");
+
+    if (!file.open(binary ? QIODevice::ReadOnly : QIODevice::ReadOnly | QIODevice::Text))
+    {
+        err = "Waveform file opening failed! " + file.errorString();
+        return false;
+    }
+
+    QVector<double> src;
+
+    if (binary)
+    {
+        QByteArray data = file.readAll();
+        const uchar* p = (const uchar*)data.constData();
+
+        src.reserve(data.size() / 2);
+        for (int i = 0; i + 1 < data.size(); i += 2)
+            src.append((qint16)(p[i] | (p[i + 1] << 8)));
+    }
+    else
+    {
+        QTextStream stream(&file);
+
+        while (!stream.atEnd())
+        {
+            QString line = stream.readLine().trimmed();
+
+            if (line.isEmpty() || line.startsWith('#'))
+                continue;
+
+            QStringList tokens = line.split(QRegExp("[,;\\t ]"), QString::SkipEmptyParts);
+            bool ok = false;
+            double val = tokens.isEmpty() ? 0 : tokens.last().toDouble(&ok);
+
+            if (ok && std::isfinite(val))
+                src.append(val);
+        }
+    }
+
+    if (src.size() < 2)
+    {
+        err = "Waveform file needs at least 2 points!";
+        return false;
+    }
+
+    m_src = src;
+    m_samples.clear();
+
+    return true;
+}
+
+/* linear resample to at most maxSamples, min..max of source -> ampl [%] of full scale above offset [%] / 2,
+ * same scale as generated waves */
+void ArbWave::compile(int maxSamples, int maxVal, double ampl, double offset)
+{
+    assert(!m_src.isEmpty() && maxSamples >= 2);
+
+    int n = std::min(m_src.size(), maxSamples);
+    auto range = std::minmax_element(m_src.constBegin(), m_src.constEnd());
+    double lo = *range.first;
+    double span = *range.second - lo;
+
+    double bottom = offset / 100.0 * maxVal / 2.0;
+    double height = ampl / 100.0 * maxVal;
+
+    m_samples.resize(n);
+
+    for (int i = 0; i < n; i++)
+    {
+        double x = (double)i * m_src.size() / n; // period is kept, last point wraps to first
+        double norm = (span > 0 ? (interp(m_src, x) - lo) / span : 0.5);
+        long val = lround(bottom + norm * height);
+
+        m_samples[i] = (quint16)std::max(0L, std::min((long)maxVal, val));
+    }
+}
+
+int ArbWave::getChunks(int chunk) const
+{
+    assert(chunk > 0);
+    return (m_samples.size() + chunk - 1) / chunk;
+}
+
+QString ArbWave::chunkParams(int idx, int chunk) const
+{
+    return QString::number(idx * chunk) + ",";
+}
+
+QByteArray ArbWave::chunkBlock(int idx, int chunk) const
+{
+    int from = idx * chunk;
+    int count = std::min(chunk, m_samples.size() - from);
+
+    assert(count > 0);
+
+    QByteArray len = QByteArray::number(count * 2);
+    QByteArray ret = "#" + QByteArray::number(len.size()) + len;
+
+    ret.reserve(ret.size() + count * 2);
+    for (int i = from; i < from + count; i++)
+    {
+        ret.append((char)(m_samples[i] & 0xFF));
+        ret.append((char)(m_samples[i] >> 8));
+    }
+    return ret;
+}
+
+/* private */
+
+double ArbWave::interp(const QVector<double>& y, double x)
+{
+    int i = (int)x;
+    double frac = x - i;
+    int n = y.size();
+
+    return y[i % n] + (y[(i + 1) % n] - y[i % n]) * frac;
+}
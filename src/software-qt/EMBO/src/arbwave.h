@@ -0,0 +1,41 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef ARBWAVE_H
+#define ARBWAVE_H
+
+#include <QString>
+#include <QVector>
+#include <QByteArray>
+
+
+/* arbitrary waveform of signal generator - loaded from file, resampled to device memory,
+ * scaled to DAC and split to binary blocks of :SGEN:ARB <offset>,#<n><len><16-bit LE samples> */
+
+class ArbWave
+{
+public:
+    ArbWave();
+
+    void clear();
+    bool loadFile(const QString path, QString& err);
+    bool isEmpty() const { return m_src.isEmpty(); }
+    int getSrcSize() const { return m_src.size(); }
+
+    void compile(int maxSamples, int maxVal, double ampl, double offset);
+    const QVector<quint16>& getSamples() const { return m_samples; }
+
+    int getChunks(int chunk) const;
+    QString chunkParams(int idx, int chunk) const;
+    QByteArray chunkBlock(int idx, int chunk) const;
+
+private:
+    static double interp(const QVector<double>& y, double x);
+
+    QVector<double> m_src;      // as loaded
+    QVector<quint16> m_samples; // compiled for DAC
+};
+
+#endif // ARBWAVE_H
@@ -6,7 +6,10 @@
 #ifndef CONTAINERS_H
 #define CONTAINERS_H
 
+#include "histogram.h"
+
 #include <QString>
+#include <QVector>
 
 enum MsgBoxType
 {
@@ -50,7 +53,8 @@ enum SgenMode
     TRIANGLE = 2,
     SAWTOOTH = 3,
     SQUARE   = 4,
-    NOISE    = 5
+    NOISE    = 5,
+    ARB      = 6
 };
 
 enum DaqBits
@@ -146,4 +150,51 @@ public:
     QString fs_real;
 };
 
+class VmData
+{
+public:
+    double ch1;
+    double ch2;
+    double ch3;
+    double ch4;
+    double vcc;
+};
+
+class CntrData
+{
+public:
+    quint32 seq;                // gates since enable
+    quint32 n;                  // gates with signal
+    double min;                 // statistics of gates with signal [Hz], -1 = none yet
+    double max;
+    double mean;
+    double std;
+    double adev;                // Allan deviation of consecutive gates, fractional
+    QVector<double> freqs;      // gates since last read [Hz], -1 = no signal
+};
+
+class CntrRaw
+{
+public:
+    bool duty;                  // false = edges: ccr + ovf store, true = rising + falling ccr
+    quint32 icPsc;              // input edges per capture
+    quint32 fTim;               // timer clock [Hz]
+    quint32 timDiv;             // timer prescaler
+    quint16 ovfPre;             // counter range of ovf store write - captures before it hold previous ovf
+    quint16 ovfPost;
+    QVector<quint16> ccr;       // rising edges
+    QVector<quint16> aux;       // ovf store of each edge, or falling edges
+};
+
+struct CmdLatency
+{
+    QString cmd;
+    LatencyHistogram hist;      // send to arrival of reply line [us]
+};
+
+struct CommStats
+{
+    QVector<CmdLatency> cmds;
+};
+
 #endif // CONTAINERS_H
@@ -4,18 +4,19 @@
  */
 
 #include "core.h"
-#include "utils.h"
+#include "tokens.h"
 #include "msg.h"
+#include "trace.h"
 
 #include <QObject>
 #include <QDebug>
 #include <QTimer>
 #include <QElapsedTimer>
-#include <QSettings>
-#include <QDesktopServices>
 #include <QtSerialPort>
 #include <QtSerialPort/QSerialPortInfo>
 
+#include <chrono>
+
 
 #define TIMER_COMM          10
 #define TIMER_COMM_MIN      1
@@ -24,12 +25,14 @@
 
 #define MOVEMEAN_LATENCY    100
 
+static const int baud_rates[] = { 2000000, 1000000, 921600, 460800, 230400 };
 
-Core* Core::m_instance = Q_NULLPTR;
 
-Core::Core(QObject* parent) : QObject(parent)
+Core::Core(QObject* parent, int id) : QObject(parent), m_id(id), m_frameTap(false), m_uptimeMs(0), m_uptimeHostMs(0), m_clockOffsetMs(0), m_baud(BAUD_DEFAULT)
 {
     m_meanLatency.setSize(MOVEMEAN_LATENCY);
+    m_clockOffset.setSize(CLOCK_OFFSET_CNT);
+    m_commPeriodMs = TIMER_COMM;
 }
 
 Core::~Core()
@@ -40,7 +43,7 @@ Core::~Core()
 void Core::on_startThread()
 {
     m_serial = new QSerialPort();
-    m_serial->setBaudRate(QSerialPort::Baud115200);
+    m_serial->setBaudRate(BAUD_DEFAULT);
     m_serial->setDataBits(QSerialPort::Data8);
     m_serial->setParity(QSerialPort::NoParity);
     m_serial->setStopBits(QSerialPort::OneStop);
@@ -49,9 +52,11 @@ void Core::on_startThread()
     m_timer_rxTimeout = new QTimer();
     m_timer_render = new QTimer();
     m_timer_comm = new QTimer();
+    m_timer_baud = new QTimer();
 
     m_timer_rxTimeout->setSingleShot(true);
     m_timer_comm->setSingleShot(true);
+    m_timer_baud->setSingleShot(true);
 
     m_timer_rxTimeout->setTimerType(Qt::PreciseTimer);
     m_timer_comm->setTimerType(Qt::PreciseTimer);
@@ -66,6 +71,7 @@ void Core::on_startThread()
     m_msg_sys_info = new Msg_SYS_Info(this);
     m_msg_sys_mode = new Msg_SYS_Mode(this);
     m_msg_sys_uptime = new Msg_SYS_Uptime(this);
+    m_msg_sys_baud = new Msg_SYS_Baud(this);
 
     connect(m_serial, &QSerialPort::errorOccurred, this, &Core::on_serial_errorOccurred);
     connect(m_serial, &QSerialPort::readyRead, this, &Core::on_serial_readyRead);
@@ -73,6 +79,7 @@ void Core::on_startThread()
     connect(m_timer_rxTimeout, &QTimer::timeout, this, &Core::on_timer_rxTimeout);
     connect(m_timer_comm, &QTimer::timeout, this, &Core::on_timer_comm);
     connect(m_timer_render, &QTimer::timeout, this, &Core::on_timer_render);
+    connect(m_timer_baud, &QTimer::timeout, this, &Core::on_timer_baud);
 
     qInfo() << "Core thread started";
 }
@@ -80,7 +87,14 @@ void Core::on_startThread()
 bool Core::openComm(QString port)
 {
     m_serial->setPortName(port);
+    m_serial->setBaudRate(BAUD_DEFAULT);
     m_state = OPENING;
+
+    m_baud = BAUD_DEFAULT;
+    m_baudIdx = -1;
+    m_baudAccepted = false;
+    m_baudDone = (m_baudMax <= BAUD_DEFAULT);
+    m_baudEcho = false;
     emit stateChanged(m_state);
 
     if (m_serial->open(QIODevice::ReadWrite))
@@ -92,9 +106,12 @@ bool Core::openComm(QString port)
         m_serial->clear();
 
         m_mainBuffer.clear();
-        m_waitingMsgs.clear();
         m_activeMsgs.clear();
 
+        m_waitingMutex.lock();
+        m_waitingMsgs.clear();
+        m_waitingMutex.unlock();
+
         assert(m_activeMsgs.isEmpty());
         m_activeMsgs.append(m_msg_dummy);
 
@@ -118,11 +135,20 @@ void Core::openCommInit()
 
 bool Core::closeComm()
 {
+    if (m_state == CONNECTED && m_baud > BAUD_DEFAULT) // return device to default rate, otherwise it waits for idle
+    {
+        QByteArray tx = QByteArray(EMBO_SYS_BAUD " ") + QByteArray::number(BAUD_DEFAULT) + EMBO_NEWLINE;
+        m_serial->write(tx);
+        m_serial->waitForBytesWritten(50);
+    }
+
     m_state = DISCONNECTED;
     m_serial->close(); // TODO enque
     m_timer_rxTimeout->stop();
     m_timer_comm->stop();
     m_timer_render->stop();
+    m_timer_baud->stop();
+    m_baudEcho = false;
 
     qInfo() << ">>Disconnected<<";
     emit stateChanged(m_state);
@@ -134,32 +160,90 @@ void Core::startComm()
     qInfo() << ">>Connected2<<";
     m_state = CONNECTED;
     emit stateChanged(m_state);
-    m_timer_comm->start(TIMER_COMM);
+    m_timer_comm->start(m_commPeriodMs);
     m_timer_latency.restart();
     m_meanLatency.reset();
+    m_cmdLatency.clear();
+    m_clockOffset.reset();
     m_timer_render->start(TIMER_RENDER);
 }
 
 void Core::err(QString name, bool needClose)
 {
     emit msgDisplay(name, needClose ? CRITICAL : WARNING);
+    QByteArray name_raw = name.toLatin1();
+    Trace::record(TRACE_ERR, TR_ERR, name_raw.constData(), name_raw.size());
     qInfo() << "ERR: " + name;
 
     if (needClose)
         closeComm();
 }
 
-void Core::msgAdd(Msg* msg, bool isQuery, QString params)
+void Core::msgAdd(Msg* msg, bool isQuery, QString params, const QByteArray& block)
 {
     assert(msg != Q_NULLPTR);
 
     msg->setIsQuery(isQuery);
     //if (!params.isEmpty())
     msg->setParams(params);
+    msg->setBlock(block);
 
+    QMutexLocker lock(&m_waitingMutex);
     m_waitingMsgs.append(msg);
 }
 
+void Core::setUptime(QString uptime)
+{
+    m_uptime = uptime;
+
+    QStringList hms = uptime.split(':'); // HH:MM:SS.d
+    if (hms.size() != 3)
+        return;
+
+    double ms = (hms[0].toInt() * 3600.0 + hms[1].toInt() * 60.0 + hms[2].toDouble()) * 1000.0;
+    double host_ms = hostTimeMs();
+
+    /* uptime is truncated and arrives late, so min of (host - device) over last responses is closest to true offset */
+    m_clockOffset.addVal(host_ms - ms);
+
+    m_uptimeMs.store(ms, std::memory_order_relaxed);
+    m_uptimeHostMs.store(host_ms, std::memory_order_relaxed);
+    m_clockOffsetMs.store(m_clockOffset.getMin(), std::memory_order_relaxed);
+}
+
+void Core::setBaudResult(const QByteArray& data)
+{
+    bool ok;
+    int baud = data.trimmed().toInt(&ok);
+
+    if (!ok) // rejected, next lower rate is tried
+        return;
+
+    if (baud == 0) // USB, there is no baud rate
+    {
+        m_baud = 0;
+        m_baudDone = true;
+    }
+    else if (baud == m_baudTry)
+        m_baudAccepted = true;
+}
+
+double Core::getDeviceTimeMs() const
+{
+    double host_ms = m_uptimeHostMs.load(std::memory_order_relaxed);
+
+    if (host_ms == 0)
+        return 0;
+
+    return m_uptimeMs.load(std::memory_order_relaxed) + (hostTimeMs() - host_ms);
+}
+
+double Core::hostTimeMs()
+{
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
 void Core::getLatencyMs(double& mean, double& max)
 {
     mean = m_meanLatency.getMean(); // m_latency > TIMER_COMM ? m_latency - TIMER_COMM : 0);
@@ -172,15 +256,20 @@ void Core::sendRst(Mode mode)
     //msgAdd(m_msg_sys_mode, false, (mode == SCOPE ? "SCOPE" : (mode == LA ? "LA" : "VM"))); // TODO CHECK
 }
 
-void Core::on_actionEMBO_Help()
+void Core::on_commStatsRequest()
 {
-#if defined(Q_OS_WIN)
-    QString help_path = QDir(QDir::currentPath() + QDir::separator() + "doc").filePath("EMBO.chm");
-    qInfo() << help_path;
-    QDesktopServices::openUrl(QUrl::fromUserInput(help_path));
-#elif defined(Q_OS_UNIX) || defined(Q_OS_MAC)
-    QDesktopServices::openUrl(QUrl(HELP_URL));
-#endif
+    CommStats stats;
+
+    for (auto it = m_cmdLatency.constBegin(); it != m_cmdLatency.constEnd(); ++it)
+        stats.cmds.append({ it.key(), it.value() });
+
+    emit commStats(stats);
+}
+
+void Core::on_commStatsReset()
+{
+    m_cmdLatency.clear();
+    m_meanLatency.reset();
 }
 
 /* private */
@@ -189,32 +278,83 @@ void Core::send()
 {
     assert(m_activeMsgs.size() > 0);
 
-    QString tx;
+    QByteArray tx; // binary safe, block may contain any byte
     int it = 0;
 
     for(auto msg : m_activeMsgs)
     {
+        msg->setCore(this);
+
         if (it > 0)
             tx.append(EMBO_DELIM1);
 
-        tx.append( msg->getCmd() +
+        tx.append((msg->getCmd() +
                   (msg->getIsQuery() ? "?" : "") +
-                  (msg->getParams().isEmpty() ? "" : " " + msg->getParams()));
+                  (msg->getParams().isEmpty() && msg->getBlock().isEmpty() ? "" : " " + msg->getParams())).toLatin1());
+        tx.append(msg->getBlock());
         it++;
     }
     tx.append(EMBO_NEWLINE);
 
-    m_serial->write(tx.toStdString().c_str(), tx.size());
+    m_serial->write(tx);
+
+    const QByteArray& tag = m_activeMsgs[0]->getTag();
+    Trace::record(TRACE_COMM, TR_TX, tag.constData(), tag.size(), tx.size(), m_activeMsgs.size());
+
+    if (Trace::enabled(TRACE_VERBOSE))
+        qInfo() << "sent: " << tx;
 
-    qInfo() << "sent: " << tx;
     m_timer_rxTimeout->start(TIMER_RX);
     m_timer_comm->stop();
+    m_timer_rtt.restart();
 
     m_latency = m_timer_latency.elapsed();
     m_meanLatency.addVal(m_latency);
     m_timer_latency.restart();
 }
 
+void Core::baudNegotiate()
+{
+    if (m_baudAccepted) // device switched after its response, verify by echo at new rate
+    {
+        m_baudAccepted = false;
+        m_baudEcho = true;
+
+        m_serial->setBaudRate(m_baudTry);
+        m_serial->clear();
+        m_mainBuffer.clear();
+
+        m_serial->write(EMBO_SYS_BAUD "?" EMBO_NEWLINE);
+        m_timer_rxTimeout->start(BAUD_ECHO_TIMEOUT);
+        return;
+    }
+
+    while (!m_baudDone && ++m_baudIdx < (int)(sizeof(baud_rates) / sizeof(baud_rates[0])))
+    {
+        if (baud_rates[m_baudIdx] > m_baudMax)
+            continue;
+
+        m_baudTry = baud_rates[m_baudIdx];
+        m_msg_sys_baud->setIsQuery(false);
+        m_msg_sys_baud->setParams(QString::number(m_baudTry));
+        m_activeMsgs.append(m_msg_sys_baud);
+
+        send();
+        return;
+    }
+
+    startComm();
+}
+
+void Core::baudFallback()
+{
+    Trace::record(TRACE_ERR, TR_ERR, EMBO_SYS_BAUD, sizeof(EMBO_SYS_BAUD) - 1, m_baudTry); // size = failed rate
+
+    m_serial->setBaudRate(BAUD_DEFAULT);
+    m_baud = BAUD_DEFAULT;
+    m_timer_baud->start(BAUD_REVERT_MS); // wait for device to return to default rate, then try lower
+}
+
 void Core::openComm2()
 {
     m_open_comm = false;
@@ -260,6 +400,7 @@ void Core::on_dispose()
     m_timer_rxTimeout->deleteLater();
     m_timer_comm->deleteLater();
     m_timer_render->deleteLater();
+    m_timer_baud->deleteLater();
 
     emit finished();
     //this->thread()->quit();
@@ -277,7 +418,36 @@ void Core::on_serial_readyRead()
 {
     /************************************* 1. READ ALL - APPEND TO BUFFER  *************************************/
 
-    m_mainBuffer.append(m_serial->readAll());
+    QByteArray rx = m_serial->readAll();
+
+    if (!rx.isEmpty()) // reply lines completed by these bytes arrived now, not when dispatched
+        m_rxUs = m_timer_rtt.nsecsElapsed() / 1000;
+
+    m_mainBuffer.append(rx);
+
+    if (m_baudEcho) // response to echo test is handled here, garbage at wrong rate must not reach parser
+    {
+        int nl = m_mainBuffer.indexOf('\n');
+
+        if (nl < 0 && m_mainBuffer.size() < 64)
+            return;
+
+        bool ok;
+        int baud = m_mainBuffer.left(nl).trimmed().toInt(&ok);
+
+        m_mainBuffer.clear();
+        m_timer_rxTimeout->stop();
+        m_baudEcho = false;
+
+        if (ok && baud == m_baudTry)
+        {
+            m_baud = baud;
+            startComm();
+        }
+        else
+            baudFallback();
+        return;
+    }
 
     /************************************* 2. SPLIT BUFFER INTO MESSAGES  **************************************/
 
@@ -319,6 +489,8 @@ void Core::on_serial_readyRead()
                     }
                 }
                 for(int i = bin_msg_end + 1; i < m_mainBuffer.length(); i++) { // split right side of buffer
+                    if (m_mainBuffer.at(i) == '#') // next binary message (pushed record) - split by next pass
+                        break;
                     if (m_mainBuffer.at(i) == '\n') {
                         messages.append(m_mainBuffer.mid(j, (i - 1) - j));
                         msg_cnt++;
@@ -358,6 +530,23 @@ void Core::on_serial_readyRead()
 
         /************************************* 4. HANDLE ASYNC MESSAGE  *************************************/
 
+        if (i == bin_msg_it && messages[i].startsWith("\"" EMBO_READY_C "\"")) // counter record pushed by device
+        {
+            Trace::record(TRACE_COMM, TR_READY, messages[i].constData(), 8, messages[i].size());
+            CntrData data;
+
+            if (Msg_CNTR_Read::parse(messages[i].mid(messages[i].indexOf('#') + bin_header_len), data))
+            {
+                emit cntrReady(data);
+                continue;
+            }
+            else
+            {
+                err(COMM_FATAL_ERR + messages[i] + m_mainBuffer, true);
+                return;
+            }
+        }
+
         Ready ready = Ready::NOT_READY;
 
         if (messages[i].contains(EMBO_READY_A)) ready = Ready::READY_AUTO;
@@ -368,12 +557,12 @@ void Core::on_serial_readyRead()
 
         if (ready != Ready::NOT_READY) // handle RDY async message, which is different
         {
-            qInfo() << messages[i];
-            auto toks = messages[i].split(',');
+            Trace::record(TRACE_COMM, TR_READY, messages[i].constData(), messages[i].size(), messages[i].size());
+            MsgTokens toks(messages[i]);
 
             if (toks.size() == 2)
             {
-                emit daqReady(ready, toks[1].toInt());
+                emit daqReady(ready, toks.toInt(1));
                 continue;
             }
             else
@@ -441,10 +630,20 @@ void Core::on_serial_readyRead()
 
             /************************************* 7. EMIT CALLBACKS ****************************************/
 
+            Msg* msg = m_activeMsgs[m_submsgIt++];
+            m_cmdLatency[msg->getCmd()].addVal((uint32_t)m_rxUs);
+
             if (submessage.at(0) == '#')
-                m_activeMsgs[m_submsgIt++]->fire(submessage.right(submessage.size() - bin_header_len)); // fire binary data action
+            {
+                QByteArray data = submessage.right(submessage.size() - bin_header_len);
+
+                if (m_frameTap.load(std::memory_order_relaxed) && qobject_cast<Msg_Raw*>(msg) == Q_NULLPTR)
+                    emit frameRx(msg->getCmd(), data); // shared, no copy
+
+                msg->fire(data, true); // fire binary data action
+            }
             else
-                m_activeMsgs[m_submsgIt++]->fire(QString(submessage)); // fire standard text message action
+                msg->fire(submessage, false); // fire standard text message action
         }
 
         /************************************** 8. LAST MESSAGE - CLEANUP ***********************************/
@@ -455,22 +654,38 @@ void Core::on_serial_readyRead()
             m_timer_rxTimeout->stop();
             m_activeMsgs.clear();
 
-            m_commTimeoutMs = TIMER_COMM - m_latencyAvgMs;
+            m_commTimeoutMs = m_commPeriodMs - m_latencyAvgMs;
             if (m_commTimeoutMs < TIMER_COMM_MIN)
                 m_commTimeoutMs = TIMER_COMM_MIN;
 
             if (m_state == CONNECTING2)
-                startComm();
+                baudNegotiate();
             else if (m_state == CONNECTED)
                 m_timer_comm->start(m_commTimeoutMs);
         }
     }
+    if (bin_msg_it >= 0 && m_mainBuffer.contains('#')) // another binary message waits in buffer
+        QMetaObject::invokeMethod(this, "on_serial_readyRead", Qt::QueuedConnection);
+
     if (m_open_comm)
         openComm2();
 }
 
 void Core::on_timer_rxTimeout()
 {
+    if (m_baudEcho) // no response at new rate
+    {
+        m_baudEcho = false;
+        baudFallback();
+        return;
+    }
+
+    if (!m_activeMsgs.isEmpty())
+    {
+        const QByteArray& tag = m_activeMsgs[0]->getTag();
+        Trace::record(TRACE_ERR, TR_TIMEOUT, tag.constData(), tag.size());
+    }
+
     err("Communication timeout!", true);
 }
 
@@ -497,12 +712,32 @@ void Core::on_timer_comm()
     }
     m_mode_last = m_mode;
 
+    m_waitingMutex.lock();
     int waitingSize = m_waitingMsgs.size(); // add messages from waiting queue
+    if (waitingSize > 0 && !m_waitingMsgs[0]->getBlock().isEmpty() && m_activeMsgs.isEmpty())
+    {
+        /* message with block goes alone in its line, so line fits device RX buffer */
+        m_activeMsgs.append(m_waitingMsgs[0]);
+        m_waitingMsgs.remove(0, 1);
+        m_waitingMutex.unlock();
+
+        send();
+        return;
+    }
+    for (int i = 0; i < waitingSize; i++)
+    {
+        if (!m_waitingMsgs[i]->getBlock().isEmpty()) // next tick
+        {
+            waitingSize = i;
+            break;
+        }
+    }
     if (waitingSize > 0)
     {
         m_activeMsgs.append(m_waitingMsgs.mid(0, waitingSize));
         m_waitingMsgs.remove(0, waitingSize);
     }
+    m_waitingMutex.unlock();
 
     for (auto instr : emboInstruments) // add active permanent messages
     {
@@ -515,6 +750,16 @@ void Core::on_timer_comm()
     send(); // finally send all
 }
 
+void Core::on_timer_baud()
+{
+    if (m_state != CONNECTING2)
+        return;
+
+    m_serial->clear();
+    m_mainBuffer.clear();
+    baudNegotiate();
+}
+
 void Core::on_timer_render()
 {
     double latency_mean;
@@ -9,7 +9,8 @@
 #include "msg.h"
 #include "messages.h"
 #include "interfaces.h"
-#include "movemean.h"
+#include "streamstats.h"
+#include "histogram.h"
 #include "containers.h"
 
 #include <QObject>
@@ -18,7 +19,10 @@
 #include <QString>
 #include <QSerialPort>
 #include <QVector>
+#include <QMap>
+#include <QMutex>
 
+#include <atomic>
 #include <assert.h>
 
 #define UPDATE_URL      "http://embo.jakubparez.com/updates.json"
@@ -48,6 +52,10 @@ PWM and signal generator.<br>And of course, it's opensource! \
 <a href='https://github.com/parezj/EMBO'>github.com/parezj/EMBO</a>"
 
 #define CFG_MAIN_PORT       "main/port"
+#define CFG_MAIN_TRACE      "main/trace"
+#define CFG_MAIN_SERVER     "main/server"
+#define ENV_EXTRA_PORTS     "EMBO_EXTRA_PORTS"  // e.g. pty of EMBO-virtual
+
 #define CFG_REC_DIR         "rec/dir"
 
 #define CFG_VM_CH1_EN       "vm/ch1_en"
@@ -74,19 +82,29 @@ PWM and signal generator.<br>And of course, it's opensource! \
 #define EMBO_READY_F        "ReadyF"
 #define EMBO_READY_S        "ReadyS"
 #define EMBO_READY_D        "ReadyD"
+#define EMBO_READY_C        "ReadyC"    // counter gates, binary record follows
 
 #define READ_ERROR_CNT      5  // when more than 5 read erros happen, instrument is closed
+#define CLOCK_OFFSET_CNT    100  // uptime responses for device to host clock offset
+
+#define BAUD_DEFAULT        115200      // after reset of device and when it is not negotiated
+#define BAUD_MAX_DEFAULT    2000000     // ST-LINK VCP and common USB-UART bridges
+#define BAUD_ECHO_TIMEOUT   200         // echo test at new baud rate
+#define BAUD_REVERT_MS      3500        // device returns to default baud rate after 3 s without message
 
 #define TITLE_LEFT          10
 #define TITLE_TOP_WIN       6
 #define TITLE_TOP_UNIX      10
 
 
+/* one connected device - serial port, message queues and scheduling, lives in its own thread */
+
 class Core : public QObject
 {
 Q_OBJECT
 
 public:
+    explicit Core(QObject* parent = 0, int id = 0);
     ~Core();
 
     void setUp();
@@ -95,26 +113,28 @@ public:
     bool closeComm();
     void startComm();
     void err(QString name, bool needClose);
-    void msgAdd(Msg* msg, bool isQuery, QString params = "");
+    void msgAdd(Msg* msg, bool isQuery, QString params = "", const QByteArray& block = QByteArray());
     void sendRst(Mode mode);
 
     QVector<IEmboInstrument*> emboInstruments;
 
      /* setters getters */
+    int getId() const { return m_id; }
     const QString getPort() const { return m_serial->portName(); }
     DevInfo* getDevInfo() { return &m_devInfo; }
     void getLatencyMs(double& mean, double& max);
     QString getUptime() const { return m_uptime; }
-    void setUptime(QString uptime) { m_uptime = uptime; }
+    void setUptime(QString uptime);
+    double getDeviceTimeMs() const;
+    double getAlignedTimeMs() const { return getDeviceTimeMs() + m_clockOffsetMs.load(std::memory_order_relaxed); }
     void setMode(Mode mode, bool alsoLast = false) { m_mode = mode; if (alsoLast) m_mode_last = mode; }
+    void setCommPeriod(int ms) { m_commPeriodMs = ms; } // period of comm cycle, min 1 ms
+    void setBaudMax(int baud) { m_baudMax = baud; } // before open, 0 = no negotiation
+    void setBaudResult(const QByteArray& data);
+    int getBaud() const { return m_baud.load(std::memory_order_relaxed); } // 0 = USB
+    void setFrameTap(bool en) { m_frameTap.store(en, std::memory_order_relaxed); } // emit frameRx for binary responses
 
-     /* singleton */
-    static Core* getInstance(QObject* parent = 0)
-    {
-        if (m_instance == Q_NULLPTR)
-            m_instance = new Core(parent);
-        return m_instance;
-    }
+    static double hostTimeMs(); // monotonic, common for all devices
 
 public slots:
     void on_startThread();
@@ -122,13 +142,17 @@ public slots:
     //void on_msgAdd(Msg* msg);
     void on_closeComm(bool force);
     void on_dispose();
-    void on_actionEMBO_Help();
+    void on_commStatsRequest();
+    void on_commStatsReset();
 
 signals:
     void daqReady(Ready ready, int firstPos);
+    void cntrReady(const CntrData data);
     void stateChanged(const State state);
     void msgDisplay(const QString name, MsgBoxType type);
     void latencyAndUptime(int latency_fix, int latency_mean, int latency_max, const QString uptime);
+    void commStats(const CommStats stats);
+    void frameRx(const QString cmd, const QByteArray data); // binary response of instrument, only with frame tap
     void finished();
     void coreRender();
 
@@ -138,15 +162,16 @@ private slots:
     void on_timer_rxTimeout();
     void on_timer_comm();
     void on_timer_render();
+    void on_timer_baud();
 
 private:
-    explicit Core(QObject* parent = 0);
-
     void send();
     void openComm2();
+    void baudNegotiate();
+    void baudFallback();
 
     /* instance */
-    static Core* m_instance;
+    int m_id;
 
     QSerialPort* m_serial = Q_NULLPTR;
     State m_state = DISCONNECTED;
@@ -155,6 +180,7 @@ private:
     bool m_binary_mode = false;
     bool m_close_init = false;
     bool m_open_comm = false;
+    std::atomic<bool> m_frameTap;
     Mode m_mode = Mode::NO_MODE;
     Mode m_mode_last = Mode::NO_MODE;
 
@@ -162,21 +188,44 @@ private:
     QTimer* m_timer_rxTimeout;
     QTimer* m_timer_render;
     QTimer* m_timer_comm;
+    QTimer* m_timer_baud;
 
     /* latency timer */
     QElapsedTimer m_timer_latency;
     int m_latency = 0;
-    MoveMean<int> m_meanLatency;
+    StreamStats<int> m_meanLatency;
+
+    /* per command latency */
+    QElapsedTimer m_timer_rtt;
+    QMap<QString, LatencyHistogram> m_cmdLatency;
+    qint64 m_rxUs = 0;                  // arrival of last received bytes since send [us]
 
     /* latency avg val and rx timeout */
     int m_latencyAvgMs = 0;
     int m_commTimeoutMs = 0;
+    int m_commPeriodMs;
 
     /* data */
     DevInfo m_devInfo;
     QString m_uptime = "";
 
+    /* device clock - last uptime and host time of its arrival, offset to host clock of min latency */
+    std::atomic<double> m_uptimeMs;
+    std::atomic<double> m_uptimeHostMs;
+    std::atomic<double> m_clockOffsetMs;
+    StreamStats<double> m_clockOffset;
+
+    /* baud rate negotiation - after IDN rates are tried from highest, each verified by echo */
+    int m_baudMax = BAUD_MAX_DEFAULT;
+    int m_baudIdx = -1;
+    int m_baudTry = 0;
+    bool m_baudAccepted = false;
+    bool m_baudDone = false;
+    bool m_baudEcho = false;
+    std::atomic<int> m_baud;
+
     /* message buffers */
+    QMutex m_waitingMutex; // msgAdd is called from instrument threads
     QVector<Msg*> m_waitingMsgs;
     QVector<Msg*> m_activeMsgs;
     QByteArray m_mainBuffer;
@@ -192,6 +241,7 @@ private:
     Msg_SYS_Info* m_msg_sys_info;
     Msg_SYS_Mode* m_msg_sys_mode;
     Msg_SYS_Uptime* m_msg_sys_uptime;
+    Msg_SYS_Baud* m_msg_sys_baud;
 };
 
 #endif // CORE_H
@@ -0,0 +1,238 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "daqconv.h"
+
+#include <assert.h>
+
+
+int get_vals_from_circ(int from, int total, int bufflen, DaqBits daq_bits, double vcc, uint8_t* buff,
+                       QVector<double>* ch1, QVector<double>* ch2, QVector<double>* ch3, QVector<double>* ch4,
+                       double gain1, double gain2, double gain3, double gain4,
+                       double offset1, double offset2, double offset3, double offset4)
+{
+    assert(total > 0 && bufflen >= total && buff != NULL);
+
+    int found = 0;
+    int ch_num = 0;
+
+    if (ch1 != NULL) ch_num++;
+    if (ch2 != NULL) ch_num++;
+    if (ch3 != NULL) ch_num++;
+    if (ch4 != NULL) ch_num++;
+
+    QVector<double>* _ch1 = NULL;
+    QVector<double>* _ch2 = NULL;
+    QVector<double>* _ch3 = NULL;
+    QVector<double>* _ch4 = NULL;
+
+    QVector<double>* ch1_copy = ch1;
+    QVector<double>* ch2_copy = ch2;
+    QVector<double>* ch3_copy = ch3;
+
+    QVector<double>** it;
+
+    for (int i = 0; i < ch_num; i++) // sort algorithm
+    {
+        if      (i == 0) it = &_ch1;
+        else if (i == 1) it = &_ch2;
+        else if (i == 2) it = &_ch3;
+        else             it = &_ch4;
+
+        if      (i < 1 && ch1_copy != NULL) { *it = ch1_copy; ch1_copy = NULL; continue; }
+        else if (i < 2 && ch2_copy != NULL) { *it = ch2_copy; ch2_copy = NULL; continue; }
+        else if (i < 3 && ch3_copy != NULL) { *it = ch3_copy; ch3_copy = NULL; continue; }
+        else                                { *it = ch4; continue; }
+    }
+
+    int k1 = 0, k2 = 0, k3 = 0, k4 = 0;
+    for (int k = 0, i = from; k < total; k++, i++)
+    {
+        if (i >= bufflen)
+            i = 0;
+
+        found++;
+        double val;
+
+        if (daq_bits == B12)
+        {
+            uint16_t raw = (*((uint16_t*)(((uint8_t*)buff)+(i*2))));
+            val = (raw / 4095.0) * vcc;
+        }
+        else if (daq_bits == B8)
+        {
+            uint16_t raw = (((uint8_t*)buff)[i]);
+            val = (raw / 255.0) * vcc;
+        }
+        else assert(0);
+
+        if (i % ch_num == 0)
+        {
+            if (_ch1 != NULL)
+                (*_ch1)[k1++] = (gain1 * val) + offset1;
+        }
+        else if (ch_num > 1 && i % ch_num == 1)
+        {
+            if (_ch2 != NULL)
+                (*_ch2)[k2++] = (gain2 * val) + offset2;
+        }
+        else if (ch_num > 2 && i % ch_num == 2)
+        {
+            if (_ch3 != NULL)
+                (*_ch3)[k3++] = (gain3 * val) + offset3;
+        }
+        else if (ch_num > 3) // && i % ch_num == 3)
+        {
+            if (_ch4 != NULL)
+                (*_ch4)[k4++] = (gain4 * val) + offset4;
+        }
+    }
+    return found;
+}
+
+int scope_frame_to_vals(const QByteArray& data, int firstPos, const DaqSettings& set, const DevInfo& info,
+                        const double gain[DAQ_CH_NUM], const double offset[DAQ_CH_NUM],
+                        QVector<double>* y[DAQ_CH_NUM])
+{
+    int ch_num = set.ch1_en + set.ch2_en + set.ch3_en + set.ch4_en;
+
+    uint8_t* dataU8 = (uint8_t*)data.constData();
+    double vcc = info.ref_mv / 1000.0;
+    int found = 0;
+
+    if (ch_num == 0)
+        return 0;
+
+    if (info.adc_num == 1)
+    {
+        uint8_t* buff1 = dataU8;
+        int buff1_len = data.size();
+
+        if (set.bits == B12)
+            buff1_len /= 2;
+
+        int buff1_mem = buff1_len - (info.daq_reserve * ch_num);
+
+        found += get_vals_from_circ(firstPos, buff1_mem, buff1_len, set.bits, vcc, buff1, y[0], y[1], y[2], y[3],
+                                    gain[0], gain[1], gain[2], gain[3], offset[0], offset[1], offset[2], offset[3]);
+
+    }
+    else if (info.adc_num == 2)
+    {
+        int buff_part = data.size();
+        int buff_part_raw = buff_part;
+
+        if (set.bits == B12)
+            buff_part /= 2;
+        buff_part /= ch_num;
+        buff_part_raw /= ch_num;
+
+        uint8_t* buff_it = dataU8;
+
+        uint8_t* buff1 = NULL;
+        int buff1_len = 0;
+        int buff1_mem;
+
+        uint8_t* buff2 = NULL;
+        int buff2_len = 0;
+        int buff2_mem;
+
+        if (set.ch1_en)
+        {
+            buff1 = buff_it;
+            buff_it += buff_part_raw;
+            buff1_len += buff_part;
+        }
+        if (set.ch2_en)
+        {
+            if (!set.ch1_en)
+                buff1 = buff_it;
+            buff_it += buff_part_raw;
+            buff1_len += buff_part;
+        }
+        if (set.ch3_en)
+        {
+            buff2 = buff_it;
+            buff_it += buff_part_raw;
+            buff2_len += buff_part;
+        }
+        if (set.ch4_en)
+        {
+            if (!set.ch3_en)
+                buff2 = buff_it;
+            //buff_it += buff_part_raw;
+            buff2_len += buff_part;
+        }
+
+        buff1_mem = buff1_len - (info.daq_reserve * (set.ch1_en + set.ch2_en));
+        buff2_mem = buff2_len - (info.daq_reserve * (set.ch3_en + set.ch4_en));
+
+        if (set.ch1_en || set.ch2_en)
+            found += get_vals_from_circ(firstPos, buff1_mem, buff1_len, set.bits, vcc, buff1, y[0], y[1], NULL, NULL,
+                                        gain[0], gain[1], 0, 0, offset[0], offset[1], 0, 0);
+        if (set.ch3_en || set.ch4_en)
+            found += get_vals_from_circ(firstPos, buff2_mem, buff2_len, set.bits, vcc, buff2, y[2], y[3], NULL, NULL,
+                                        gain[2], gain[3], 0, 0, offset[2], offset[3], 0, 0);
+
+    }
+    else if (info.adc_num == 4)
+    {
+        int buff_part = data.size();
+        int buff_part_raw = buff_part;
+
+        if (set.bits == B12)
+            buff_part /= 2;
+        buff_part /= ch_num;
+        buff_part_raw /= ch_num;
+
+        bool en[DAQ_CH_NUM] = { set.ch1_en, set.ch2_en, set.ch3_en, set.ch4_en };
+        uint8_t* buff_it = dataU8;
+
+        int buff_len = buff_part;
+        int buff_mem = buff_len - (info.daq_reserve);
+
+        for (int ch = 0; ch < DAQ_CH_NUM; ch++) // one ADC per channel, buffers follow each other
+        {
+            if (!en[ch])
+                continue;
+
+            found += get_vals_from_circ(firstPos, buff_mem, buff_len, set.bits, vcc, buff_it, y[ch], NULL, NULL, NULL,
+                                        gain[ch], 0, 0, 0, offset[ch], 0, 0, 0);
+            buff_it += buff_part_raw;
+        }
+    }
+    else assert(0);
+
+    return found;
+}
+
+int la_frame_size(int mem, const DevInfo& info)
+{
+    return mem + (info.daq_reserve * 1);
+}
+
+int la_frame_to_vals(const QByteArray& data, int firstPos, int mem, const DevInfo& info,
+                     QVector<double>* y[DAQ_CH_NUM])
+{
+    const char* raw = data.constData();
+    int data_sz = data.size();
+
+    int pins[DAQ_CH_NUM] = { info.la_ch1_pin, info.la_ch2_pin, info.la_ch3_pin, info.la_ch4_pin };
+    int ch_num = (info.daq_ch == 4) ? 4 : 2;
+
+    for (int k = 0, i = firstPos; k < mem; k++, i++)
+    {
+        if (i >= data_sz)
+            i = 0;
+
+        for (int ch = 0; ch < ch_num; ch++)
+        {
+            if (y[ch] != NULL)
+                (*y[ch])[k] = (raw[i] & (1 << pins[ch])) != 0 ? 1.0 : 0.0;
+        }
+    }
+
+    return mem;
+}
@@ -0,0 +1,39 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef DAQCONV_H
+#define DAQCONV_H
+
+#include "containers.h"
+
+#include <QByteArray>
+#include <QVector>
+
+#include <stdint.h>
+
+
+#define DAQ_CH_NUM      4
+
+/* conversion of raw DAQ frames (:SCOP:READ, :LA:READ) to samples, no GUI dependency */
+
+int get_vals_from_circ(int from, int total, int bufflen, DaqBits daq_bits, double vcc, uint8_t* buff,
+                       QVector<double>* ch1, QVector<double>* ch2, QVector<double>* ch3, QVector<double>* ch4,
+                       double gain1, double gain2, double gain3, double gain4,
+                       double offset1, double offset2, double offset3, double offset4);
+
+/* split circular buffer(s) of all ADCs and scale to volts, y[i] is NULL if channel is disabled,
+ * returns samples found over all channels, must be mem * enabled channels */
+int scope_frame_to_vals(const QByteArray& data, int firstPos, const DaqSettings& set, const DevInfo& info,
+                        const double gain[DAQ_CH_NUM], const double offset[DAQ_CH_NUM],
+                        QVector<double>* y[DAQ_CH_NUM]);
+
+/* expected size of :LA:READ data */
+int la_frame_size(int mem, const DevInfo& info);
+
+/* unpack GPIO port samples of circular buffer to 0/1, y[2] and y[3] only with 4 channel devices */
+int la_frame_to_vals(const QByteArray& data, int firstPos, int mem, const DevInfo& info,
+                     QVector<double>* y[DAQ_CH_NUM]);
+
+#endif // DAQCONV_H
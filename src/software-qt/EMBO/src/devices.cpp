@@ -0,0 +1,61 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "devices.h"
+
+#include <QThread>
+#include <QMetaObject>
+
+
+Devices::~Devices()
+{
+    removeAll();
+}
+
+Core* Devices::add()
+{
+    QThread* thread = new QThread();
+    Core* core = new Core(Q_NULLPTR, m_id_next++); // no parent, it is moved to thread
+
+    thread->setObjectName("Core" + QString::number(core->getId()));
+
+    connect(thread, &QThread::started, core, &Core::on_startThread);
+    connect(core, &Core::finished, thread, &QThread::quit, Qt::DirectConnection);
+    connect(core, &Core::finished, core, &Core::deleteLater);
+    connect(thread, &QThread::finished, thread, &QThread::deleteLater);
+
+    core->moveToThread(thread);
+    thread->start();
+
+    m_devices.append(core);
+    return core;
+}
+
+void Devices::remove(Core* core)
+{
+    if (!m_devices.removeOne(core))
+        return;
+
+    QThread* thread = core->thread();
+
+    QMetaObject::invokeMethod(core, "on_dispose", Qt::QueuedConnection);
+    thread->wait();
+}
+
+void Devices::removeAll()
+{
+    while (!m_devices.isEmpty())
+        remove(m_devices.last());
+}
+
+Core* Devices::get(int id) const
+{
+    for (auto core : m_devices)
+    {
+        if (core->getId() == id)
+            return core;
+    }
+    return Q_NULLPTR;
+}
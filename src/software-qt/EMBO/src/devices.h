@@ -0,0 +1,37 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef DEVICES_H
+#define DEVICES_H
+
+#include "core.h"
+
+#include <QObject>
+#include <QVector>
+
+
+/* connected boards - every device has own Core in own thread, so throughput scales with boards */
+
+class Devices : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit Devices(QObject* parent = 0) : QObject(parent) {}
+    ~Devices();
+
+    Core* add();
+    void remove(Core* core);
+    void removeAll();
+
+    const QVector<Core*>& list() const { return m_devices; }
+    Core* get(int id) const;
+
+private:
+    QVector<Core*> m_devices;
+    int m_id_next = 0;
+};
+
+#endif // DEVICES_H
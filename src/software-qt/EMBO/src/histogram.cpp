@@ -0,0 +1,93 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "histogram.h"
+
+#include <string.h>
+
+
+static inline int msb(uint32_t val)
+{
+    int ret = 0;
+
+    while (val >>= 1)
+        ret++;
+
+    return ret;
+}
+
+void LatencyHistogram::addVal(uint32_t us)
+{
+    m_buckets[bucketIdx(us)]++;
+    m_cnt++;
+    m_sum += us;
+
+    if (us < m_min)
+        m_min = us;
+    if (us > m_max)
+        m_max = us;
+}
+
+void LatencyHistogram::reset()
+{
+    memset(m_buckets, 0, sizeof(m_buckets));
+    m_cnt = 0;
+    m_sum = 0;
+    m_min = UINT32_MAX;
+    m_max = 0;
+}
+
+uint32_t LatencyHistogram::getPercentile(double p) const
+{
+    if (m_cnt == 0)
+        return 0;
+
+    uint64_t target = (uint64_t)(p / 100.0 * m_cnt + 0.5);
+    if (target < 1)
+        target = 1;
+
+    uint64_t acc = 0;
+
+    for (int i = 0; i < HIST_BUCKETS; i++)
+    {
+        acc += m_buckets[i];
+
+        if (acc >= target)
+            return bucketHigh(i) < m_max ? bucketHigh(i) : m_max;
+    }
+
+    return m_max;
+}
+
+/* values below HIST_SUB are exact, then each power of 2 is split into HIST_SUB buckets */
+int LatencyHistogram::bucketIdx(uint32_t us)
+{
+    if (us < HIST_SUB)
+        return us;
+
+    int shift = msb(us) - HIST_SUB_BITS;
+
+    return (shift + 1) * HIST_SUB + (int)(us >> shift) - HIST_SUB;
+}
+
+uint32_t LatencyHistogram::bucketLow(int idx)
+{
+    int range = idx / HIST_SUB;
+
+    if (range < 2)
+        return idx;
+
+    return (uint32_t)(HIST_SUB + idx % HIST_SUB) << (range - 1);
+}
+
+uint32_t LatencyHistogram::bucketHigh(int idx)
+{
+    int range = idx / HIST_SUB;
+
+    if (range < 2)
+        return idx;
+
+    return bucketLow(idx) + ((1u << (range - 1)) - 1);
+}
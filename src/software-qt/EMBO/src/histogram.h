@@ -0,0 +1,46 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdint.h>
+
+
+#define HIST_SUB_BITS       5                                   // 32 sub-buckets per power of 2, ~3 % resolution
+#define HIST_SUB            (1 << HIST_SUB_BITS)
+#define HIST_RANGES         (32 - HIST_SUB_BITS + 1)            // up to 2^32 us
+#define HIST_BUCKETS        (HIST_RANGES * HIST_SUB)
+
+/* HDR style log-linear histogram of latencies in us, constant memory, O(1) insert */
+
+class LatencyHistogram
+{
+public:
+    LatencyHistogram() { reset(); }
+
+    void addVal(uint32_t us);
+    void reset();
+
+    uint64_t getCount() const { return m_cnt; }
+    double getMean() const { return m_cnt > 0 ? (double)m_sum / m_cnt : 0; }
+    uint32_t getMin() const { return m_cnt > 0 ? m_min : 0; }
+    uint32_t getMax() const { return m_max; }
+    uint32_t getPercentile(double p) const;
+
+    uint32_t getBucketCount(int idx) const { return m_buckets[idx]; }
+    static int bucketIdx(uint32_t us);
+    static uint32_t bucketLow(int idx);
+    static uint32_t bucketHigh(int idx);
+
+private:
+    uint32_t m_buckets[HIST_BUCKETS];
+    uint64_t m_cnt;
+    uint64_t m_sum;
+    uint32_t m_min;
+    uint32_t m_max;
+};
+
+#endif // HISTOGRAM_H
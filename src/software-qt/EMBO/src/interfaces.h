@@ -9,6 +9,8 @@
 #include "msg.h"
 
 
+class Core;
+
 class IEmboInstrument
 {
 public :
@@ -19,6 +21,7 @@ public :
 
     bool m_instrEnabled = false;
     std::vector<Msg*> m_activeMsgs;
+    Core* m_core = Q_NULLPTR; // device instrument is bound to
 };
 
 #endif // INTERFACES_H
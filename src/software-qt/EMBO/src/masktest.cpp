@@ -0,0 +1,300 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "masktest.h"
+
+#include <QFile>
+#include <QTextStream>
+#include <QStringList>
+
+#include <algorithm>
+#include <limits>
+#include <assert.h>
+
+
+#define MASK_INF    std::numeric_limits<double>::infinity()
+
+
+MaskTest::MaskTest()
+{
+}
+
+void MaskTest::clear()
+{
+    m_golden_t.clear();
+    for (int ch = 0; ch < MASK_CH_NUM; ch++)
+        m_golden_y[ch].clear();
+
+    m_upper.clear();
+    m_lower.clear();
+    m_compiled = false;
+
+    reset();
+}
+
+void MaskTest::reset()
+{
+    m_pass = 0;
+    m_fail = 0;
+    m_violations = 0;
+    m_first_fail_idx = -1;
+    m_first_fail_ch = -1;
+    m_first_fail_frame = -1;
+}
+
+void MaskTest::setGolden(int ch, const QVector<double>& t, const QVector<double>& y, double tol)
+{
+    assert(ch >= 0 && ch < MASK_CH_NUM);
+
+    m_golden_t = t;
+    m_golden_y[ch] = y;
+    m_golden_tol = tol;
+    m_compiled = false;
+}
+
+/*
+ * Mask file - time [s] and voltage [V] pairs, polygons introduced by keyword:
+ *   upper      - region above signal, signal must stay below it
+ *   lower      - region below signal, signal must stay above it
+ * Empty lines and lines starting with # are ignored.
+ */
+bool MaskTest::loadFile(const QString path, QString& err)
+{
+    QFile file(path);
+
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        err = "Mask file opening failed! " + file.errorString();
+        return false;
+    }
+
+    QVector<QVector<QPointF>> upper;
+    QVector<QVector<QPointF>> lower;
+    QVector<QVector<QPointF>>* target = NULL;
+
+    QTextStream stream(&file);
+    int line_num = 0;
+
+    while (!stream.atEnd())
+    {
+        QString line = stream.readLine().trimmed();
+        line_num++;
+
+        if (line.isEmpty() || line.startsWith('#'))
+            continue;
+
+        if (line.compare("upper", Qt::CaseInsensitive) == 0 || line.compare("lower", Qt::CaseInsensitive) == 0)
+        {
+            target = line.compare("upper", Qt::CaseInsensitive) == 0 ? &upper : &lower;
+            target->append(QVector<QPointF>());
+            continue;
+        }
+
+        QStringList tokens = line.split(QRegExp("[,;\\t ]"), QString::SkipEmptyParts);
+        bool ok1 = false, ok2 = false;
+
+        if (target == NULL || tokens.size() != 2)
+        {
+            err = "Mask file invalid at line " + QString::number(line_num) + "!";
+            return false;
+        }
+
+        QPointF point(tokens[0].toDouble(&ok1), tokens[1].toDouble(&ok2));
+
+        if (!ok1 || !ok2)
+        {
+            err = "Mask file invalid at line " + QString::number(line_num) + "!";
+            return false;
+        }
+
+        target->last().append(point);
+    }
+
+    for (const auto& poly : upper + lower)
+    {
+        if (poly.size() < 3)
+        {
+            err = "Mask polygon needs at least 3 points!";
+            return false;
+        }
+    }
+
+    m_upper = upper;
+    m_lower = lower;
+    m_compiled = false;
+
+    reset();
+    return true;
+}
+
+void MaskTest::compile(const QVector<double>& t)
+{
+    if (t.isEmpty())
+        return;
+
+    if (m_compiled && t.size() == m_t_size && t.last() == m_t_last)
+        return;
+
+    int n = t.size();
+
+    for (int ch = 0; ch < MASK_CH_NUM; ch++)
+    {
+        m_lo[ch].assign(n, -MASK_INF);
+        m_hi[ch].assign(n, MASK_INF);
+        m_active[ch] = !m_golden_y[ch].isEmpty() || !m_upper.isEmpty() || !m_lower.isEmpty();
+
+        if (!m_active[ch])
+            continue;
+
+        double* lo = m_lo[ch].data();
+        double* hi = m_hi[ch].data();
+
+        /* golden envelope */
+
+        if (!m_golden_y[ch].isEmpty())
+        {
+            for (int i = 0; i < n; i++)
+            {
+                double y = interp(m_golden_t, m_golden_y[ch], t[i]);
+
+                if (y == y) // not NaN - inside golden capture
+                {
+                    lo[i] = y - m_golden_tol;
+                    hi[i] = y + m_golden_tol;
+                }
+            }
+        }
+
+        /* polygon regions */
+
+        for (auto& poly : m_upper)
+        {
+            for (int i = 0; i < n; i++)
+            {
+                double span_lo, span_hi;
+                polygonSpan(poly, t[i], span_lo, span_hi);
+
+                if (span_lo <= span_hi)
+                    hi[i] = std::min(hi[i], span_lo);
+            }
+        }
+
+        for (auto& poly : m_lower)
+        {
+            for (int i = 0; i < n; i++)
+            {
+                double span_lo, span_hi;
+                polygonSpan(poly, t[i], span_lo, span_hi);
+
+                if (span_lo <= span_hi)
+                    lo[i] = std::max(lo[i], span_hi);
+            }
+        }
+    }
+
+    m_t_size = n;
+    m_t_last = t.last();
+    m_compiled = true;
+}
+
+bool MaskTest::test(QVector<double>* y[MASK_CH_NUM])
+{
+    if (!m_compiled)
+        return true;
+
+    bool pass = true;
+
+    for (int ch = 0; ch < MASK_CH_NUM; ch++)
+    {
+        if (y[ch] == NULL || !m_active[ch])
+            continue;
+
+        const double* data = y[ch]->constData();
+        const double* lo = m_lo[ch].data();
+        const double* hi = m_hi[ch].data();
+        int n = std::min(y[ch]->size(), m_t_size);
+
+        int violations = countViolations(data, lo, hi, n);
+
+        if (violations == 0)
+            continue;
+
+        m_violations += violations;
+
+        if (m_first_fail_frame < 0) // slow path, only once
+        {
+            for (int i = 0; i < n; i++)
+            {
+                if (data[i] < lo[i] || data[i] > hi[i])
+                {
+                    m_first_fail_idx = i;
+                    m_first_fail_ch = ch;
+                    m_first_fail_frame = m_pass + m_fail;
+                    break;
+                }
+            }
+        }
+
+        pass = false;
+    }
+
+    if (pass)
+        m_pass++;
+    else
+        m_fail++;
+
+    return pass;
+}
+
+/* private */
+
+int MaskTest::countViolations(const double* y, const double* lo, const double* hi, int n)
+{
+    int cnt = 0;
+
+    // branchless, so compiler can vectorize it
+    for (int i = 0; i < n; i++)
+        cnt += (y[i] < lo[i]) | (y[i] > hi[i]);
+
+    return cnt;
+}
+
+void MaskTest::polygonSpan(const QVector<QPointF>& poly, double x, double& lo, double& hi)
+{
+    lo = MASK_INF;
+    hi = -MASK_INF;
+
+    int sz = poly.size();
+
+    for (int i = 0, j = sz - 1; i < sz; j = i++)
+    {
+        const QPointF& a = poly[j];
+        const QPointF& b = poly[i];
+
+        if ((a.x() <= x && x < b.x()) || (b.x() <= x && x < a.x()))
+        {
+            double y = a.y() + (x - a.x()) * (b.y() - a.y()) / (b.x() - a.x());
+
+            lo = std::min(lo, y);
+            hi = std::max(hi, y);
+        }
+    }
+}
+
+double MaskTest::interp(const QVector<double>& t, const QVector<double>& y, double x)
+{
+    int n = std::min(t.size(), y.size());
+
+    if (n == 0 || x < t[0] || x > t[n - 1])
+        return std::numeric_limits<double>::quiet_NaN();
+
+    int i = std::lower_bound(t.constBegin(), t.constBegin() + n, x) - t.constBegin();
+
+    if (i == 0 || t[i] == x)
+        return y[i];
+
+    double k = (x - t[i - 1]) / (t[i] - t[i - 1]);
+    return y[i - 1] + k * (y[i] - y[i - 1]);
+}
@@ -0,0 +1,72 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef MASKTEST_H
+#define MASKTEST_H
+
+#include <QString>
+#include <QVector>
+#include <QPointF>
+
+#include <vector>
+
+
+#define MASK_CH_NUM         4
+#define MASK_TOL_DEFAULT    0.1     // golden envelope tolerance [V]
+
+/* mask / limit test - mask is precompiled into per-sample min/max tables for current time axis */
+
+class MaskTest
+{
+public:
+    MaskTest();
+
+    void clear();
+    void reset();
+
+    void setGolden(int ch, const QVector<double>& t, const QVector<double>& y, double tol);
+    bool loadFile(const QString path, QString& err);
+    bool isEmpty() const { return m_golden_t.isEmpty() && m_upper.isEmpty() && m_lower.isEmpty(); }
+
+    void compile(const QVector<double>& t);
+    bool test(QVector<double>* y[MASK_CH_NUM]);
+
+    long long getPass() const { return m_pass; }
+    long long getFail() const { return m_fail; }
+    long long getViolations() const { return m_violations; }
+    int getFirstFailIdx() const { return m_first_fail_idx; }
+    int getFirstFailCh() const { return m_first_fail_ch; }
+    long long getFirstFailFrame() const { return m_first_fail_frame; }
+
+private:
+    static int countViolations(const double* y, const double* lo, const double* hi, int n);
+    static void polygonSpan(const QVector<QPointF>& poly, double x, double& lo, double& hi);
+    static double interp(const QVector<double>& t, const QVector<double>& y, double x);
+
+    /* mask sources - kept in time domain, so they survive fs / mem change */
+    QVector<double> m_golden_t;
+    QVector<double> m_golden_y[MASK_CH_NUM];
+    double m_golden_tol = MASK_TOL_DEFAULT;
+    QVector<QVector<QPointF>> m_upper;
+    QVector<QVector<QPointF>> m_lower;
+
+    /* compiled limits */
+    std::vector<double> m_lo[MASK_CH_NUM];
+    std::vector<double> m_hi[MASK_CH_NUM];
+    bool m_active[MASK_CH_NUM] = { false, false, false, false };
+    bool m_compiled = false;
+    int m_t_size = 0;
+    double m_t_last = 0;
+
+    /* statistics */
+    long long m_pass = 0;
+    long long m_fail = 0;
+    long long m_violations = 0;
+    int m_first_fail_idx = -1;
+    int m_first_fail_ch = -1;
+    long long m_first_fail_frame = -1;
+};
+
+#endif // MASKTEST_H
@@ -0,0 +1,69 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "merger.h"
+#include "core.h"
+
+#include <limits>
+
+
+StreamMerger::StreamMerger(int devices, double window_ms, QObject* parent) : QObject(parent),
+    m_last_ms(devices, -std::numeric_limits<double>::infinity()),
+    m_last_host_ms(devices, Core::hostTimeMs()),
+    m_finished(devices, false),
+    m_window_ms(window_ms)
+{
+}
+
+void StreamMerger::push(int device, double t_ms, const QByteArray& data)
+{
+    Q_ASSERT(device >= 0 && device < m_last_ms.size());
+
+    m_pending.insert(t_ms, { device, data });
+
+    m_last_ms[device] = t_ms;
+    m_last_host_ms[device] = Core::hostTimeMs();
+
+    release();
+}
+
+void StreamMerger::finish(int device)
+{
+    m_finished[device] = true;
+    release();
+}
+
+void StreamMerger::flush()
+{
+    for (auto it = m_pending.begin(); it != m_pending.end(); it = m_pending.erase(it))
+        emit frame(it.value().device, it.key(), it.value().data);
+}
+
+void StreamMerger::release()
+{
+    /* watermark - no active device can deliver frame older than its last one */
+    double host_ms = Core::hostTimeMs();
+    double watermark = std::numeric_limits<double>::infinity();
+
+    for (int i = 0; i < m_last_ms.size(); i++)
+    {
+        if (m_finished[i])
+            continue;
+
+        if (host_ms - m_last_host_ms[i] > m_window_ms) // silent device
+            continue;
+
+        if (m_last_ms[i] < watermark)
+            watermark = m_last_ms[i];
+    }
+
+    auto it = m_pending.begin();
+
+    while (it != m_pending.end() && it.key() <= watermark)
+    {
+        emit frame(it.value().device, it.key(), it.value().data);
+        it = m_pending.erase(it);
+    }
+}
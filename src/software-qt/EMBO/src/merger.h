@@ -0,0 +1,50 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef MERGER_H
+#define MERGER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QMultiMap>
+#include <QVector>
+
+
+#define MERGER_WINDOW_MS    500     // device silent longer does not hold back others
+
+/* merges frames of several devices into one stream ordered by aligned device time (Core::getAlignedTimeMs),
+ * frame is released when all active devices delivered a later one - k-way merge with watermark */
+
+class StreamMerger : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit StreamMerger(int devices, double window_ms = MERGER_WINDOW_MS, QObject* parent = 0);
+
+    void push(int device, double t_ms, const QByteArray& data);
+    void finish(int device);        // no more frames from device
+    void flush();                   // release all pending frames
+
+signals:
+    void frame(int device, double t_ms, const QByteArray data);
+
+private:
+    struct Pending
+    {
+        int device;
+        QByteArray data;
+    };
+
+    void release();
+
+    QMultiMap<double, Pending> m_pending;   // ordered by time
+    QVector<double> m_last_ms;              // last frame time per device
+    QVector<double> m_last_host_ms;         // host time of last frame per device
+    QVector<bool> m_finished;
+    double m_window_ms;
+};
+
+#endif // MERGER_H
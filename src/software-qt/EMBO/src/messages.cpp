@@ -6,15 +6,17 @@
 
 #include "messages.h"
 #include "core.h"
+#include "tokens.h"
+
+#include <cstring>
 
 /****************************** Messages - SCPI ******************************/
 
 void Msg_Idn::on_dataRx()
 {
-    qInfo() << "IDN: " << m_rxData;
-    auto core = Core::getInstance(this);
+    auto core = m_core;
 
-    QStringList tokens = m_rxData.split(EMBO_DELIM2, QString::SkipEmptyParts);
+    MsgTokens tokens(m_rxData);
 
     if (tokens.size() != 4)
     {
@@ -22,8 +24,8 @@ void Msg_Idn::on_dataRx()
         return;
     }
 
-    core->getDevInfo()->name = tokens[1];
-    core->getDevInfo()->fw = tokens[3];
+    core->getDevInfo()->name = tokens.toString(1);
+    core->getDevInfo()->fw = tokens.toString(3);
 
     QStringList tokens_ver1 = core->getDevInfo()->fw.split(" ", QString::SkipEmptyParts);
 
@@ -62,8 +64,7 @@ void Msg_Idn::on_dataRx()
 
 void Msg_Rst::on_dataRx()
 {
-    qInfo() << "RST: " << m_rxData;
-    auto core = Core::getInstance(this);
+    auto core = m_core;
 
     if (!m_rxData.contains(EMBO_OK))
         core->err("Reset failed! " + m_rxData, false);
@@ -72,8 +73,7 @@ void Msg_Rst::on_dataRx()
 
 void Msg_Stb::on_dataRx()
 {
-    qInfo() << "STB: " <<  m_rxData;
-    auto core = Core::getInstance(this);
+    auto core = m_core;
 
     if (m_rxData.isEmpty())
     {
@@ -90,12 +90,11 @@ void Msg_Cls::on_dataRx()
 
 void Msg_SYS_Lims::on_dataRx()
 {
-    qInfo() << "SYS:LIM: " <<  m_rxData;
-    auto core = Core::getInstance(this);
+    auto core = m_core;
 
-    QStringList tokens = m_rxData.split(EMBO_DELIM2, QString::SkipEmptyParts);
+    MsgTokens tokens(m_rxData);
 
-    if (tokens.size() != 17 || tokens[6].size() < 2 || tokens[16].size() != 4)
+    if (tokens.size() != 17 || tokens.len(6) < 2 || tokens.len(16) != 4)
     {
         core->err(INVALID_MSG + m_rxData, true);
         return;
@@ -103,38 +102,37 @@ void Msg_SYS_Lims::on_dataRx()
 
     auto devInfo = core->getDevInfo();
 
-    devInfo->adc_fs_12b = tokens[0].toInt();
-    devInfo->adc_fs_8b = tokens[1].toInt();
-    devInfo->mem = tokens[2].toInt();
-    devInfo->la_fs = tokens[3].toInt();
-    devInfo->pwm_fs = tokens[4].toInt();
-    devInfo->pwm2 = tokens[5] == '1';
-    devInfo->daq_ch = (tokens[6])[0].digitValue();
-    devInfo->adc_num = (tokens[6])[1].digitValue();
-    devInfo->adc_dualmode = tokens[6].contains('D');
-    devInfo->adc_interleaved = tokens[6].contains('I');
-    devInfo->adc_bit8 = tokens[7] == '1';
-    devInfo->dac = tokens[8] == '1';
-    devInfo->vm_fs = tokens[9].toInt();
-    devInfo->vm_mem = tokens[10].toInt();
-    devInfo->cntr_timeout = tokens[11].toInt();
-    devInfo->sgen_maxf = tokens[12].toInt();
-    devInfo->sgen_maxmem = tokens[13].toInt();
-    devInfo->cntr_maxf = tokens[14].toInt();
-    devInfo->daq_reserve = tokens[15].toInt();
-    devInfo->la_ch1_pin = tokens[16][0].toLatin1() - '0';
-    devInfo->la_ch2_pin = tokens[16][1].toLatin1() - '0';
-    devInfo->la_ch3_pin = tokens[16][2].toLatin1() - '0';
-    devInfo->la_ch4_pin = tokens[16][3].toLatin1() - '0';
+    devInfo->adc_fs_12b = tokens.toInt(0);
+    devInfo->adc_fs_8b = tokens.toInt(1);
+    devInfo->mem = tokens.toInt(2);
+    devInfo->la_fs = tokens.toInt(3);
+    devInfo->pwm_fs = tokens.toInt(4);
+    devInfo->pwm2 = tokens.equals(5, EMBO_TRUE);
+    devInfo->daq_ch = tokens.at(6, 0) - '0';
+    devInfo->adc_num = tokens.at(6, 1) - '0';
+    devInfo->adc_dualmode = tokens.contains(6, 'D');
+    devInfo->adc_interleaved = tokens.contains(6, 'I');
+    devInfo->adc_bit8 = tokens.equals(7, EMBO_TRUE);
+    devInfo->dac = tokens.equals(8, EMBO_TRUE);
+    devInfo->vm_fs = tokens.toInt(9);
+    devInfo->vm_mem = tokens.toInt(10);
+    devInfo->cntr_timeout = tokens.toInt(11);
+    devInfo->sgen_maxf = tokens.toInt(12);
+    devInfo->sgen_maxmem = tokens.toInt(13);
+    devInfo->cntr_maxf = tokens.toInt(14);
+    devInfo->daq_reserve = tokens.toInt(15);
+    devInfo->la_ch1_pin = tokens.at(16, 0) - '0';
+    devInfo->la_ch2_pin = tokens.at(16, 1) - '0';
+    devInfo->la_ch3_pin = tokens.at(16, 2) - '0';
+    devInfo->la_ch4_pin = tokens.at(16, 3) - '0';
 }
 
 
 void Msg_SYS_Info::on_dataRx()
 {
-    qInfo() << "SYS:INFO: " <<  m_rxData;
-    auto core = Core::getInstance(this);
+    auto core = m_core;
 
-    QStringList tokens = m_rxData.split(EMBO_DELIM2, QString::SkipEmptyParts);
+    MsgTokens tokens(m_rxData);
 
     if (tokens.size() != 10)
     {
@@ -144,22 +142,21 @@ void Msg_SYS_Info::on_dataRx()
 
     auto devInfo = core->getDevInfo();
 
-    devInfo->rtos = tokens[0];
-    devInfo->ll = tokens[1];
-    devInfo->comm = tokens[2];
-    devInfo->fcpu = tokens[3];
-    devInfo->ref_mv = tokens[4].toInt();
-    devInfo->pins_scope_vm = tokens[5];
-    devInfo->pins_la = tokens[6];
-    devInfo->pins_cntr = tokens[7];
-    devInfo->pins_pwm = tokens[8];
-    devInfo->pins_sgen = tokens[9];
+    devInfo->rtos = tokens.toString(0);
+    devInfo->ll = tokens.toString(1);
+    devInfo->comm = tokens.toString(2);
+    devInfo->fcpu = tokens.toString(3);
+    devInfo->ref_mv = tokens.toInt(4);
+    devInfo->pins_scope_vm = tokens.toString(5);
+    devInfo->pins_la = tokens.toString(6);
+    devInfo->pins_cntr = tokens.toString(7);
+    devInfo->pins_pwm = tokens.toString(8);
+    devInfo->pins_sgen = tokens.toString(9);
 }
 
 void Msg_SYS_Mode::on_dataRx()
 {
-    qInfo() << "SYS:MODE: " <<  m_rxData;
-    auto core = Core::getInstance(this);
+    auto core = m_core;
 
     if (getIsQuery())
     {
@@ -181,8 +178,7 @@ void Msg_SYS_Mode::on_dataRx()
 
 void Msg_SYS_Uptime::on_dataRx()
 {
-    qInfo() << "SYS:UPT: " <<  m_rxData;
-    auto core = Core::getInstance(this);
+    auto core = m_core;
 
     if (m_rxData.size() < 10)
     {
@@ -190,26 +186,27 @@ void Msg_SYS_Uptime::on_dataRx()
         return;
     }
 
-    core->setUptime(m_rxData);
+    core->setUptime(QString::fromLatin1(m_rxData));
 }
 
-void Msg_Dummy::on_dataRx()
+void Msg_SYS_Baud::on_dataRx()
 {
-    qInfo() << "STB: " <<  m_rxData;
+    m_core->setBaudResult(m_rxData); // SCPI error means rate is not supported
+}
 
-    Core::getInstance()->openCommInit();
+void Msg_Dummy::on_dataRx()
+{
+    m_core->openCommInit();
 }
 
 /***************************** Messages - VM ****************************/
 
 void Msg_VM_Read::on_dataRx()
 {
-    qInfo() << "VM:READ: " <<  m_rxData;
-
     if (m_rxData.contains("Empty"))
         return;
 
-    QStringList tokens = m_rxData.split(EMBO_DELIM2, QString::SkipEmptyParts);
+    MsgTokens tokens(m_rxData);
 
     if (tokens.size() != 5)
     {
@@ -217,79 +214,92 @@ void Msg_VM_Read::on_dataRx()
         return;
     }
 
-    emit result(tokens[0], tokens[1], tokens[2], tokens[3], tokens[4]);
+    VmData data;
+    data.ch1 = tokens.toDouble(0);
+    data.ch2 = tokens.toDouble(1);
+    data.ch3 = tokens.toDouble(2);
+    data.ch4 = tokens.toDouble(3);
+    data.vcc = tokens.toDouble(4);
+
+    emit result(data);
 }
 
 /***************************** Messages - SCOP **************************/
 
 void Msg_SCOP_Read::on_dataRx()
 {
-    qInfo() << "SCOP:READ: size: " <<  m_rxDataBin.size();
-    //qInfo () << m_rxDataBin.toHex();
-
     emit result(m_rxDataBin);
 }
 
 void Msg_SCOP_Set::on_dataRx()
 {
-    qInfo() << "SCOP:SET: " <<  m_rxData;
-
-    QStringList tokens = m_rxData.split(EMBO_DELIM2, QString::SkipEmptyParts);
+    MsgTokens tokens(m_rxData);
+    DaqSettings set;
 
     if (getIsQuery())
     {
-        QStringList tokens = m_rxData.split(EMBO_DELIM2, QString::SkipEmptyParts);
-
-        if (tokens.size() != 12)
+        if (tokens.size() < 12)
         {
             emit err(INVALID_MSG + m_rxData, CRITICAL, true);
             return;
         }
 
-        DaqBits bits = B1;
-        DaqTrigEdge edge = RISING;
-        DaqTrigMode mode = DISABLED;
+        set.bits = B1;
+        set.trig_edge = RISING;
+        set.trig_mode = DISABLED;
+
+        if (tokens.equals(0, "8")) set.bits = B8;
+        else if (tokens.equals(0, "12")) set.bits = B12;
+
+        if (tokens.equals(6, "F")) set.trig_edge = FALLING;
+        else if (tokens.equals(6, "B")) set.trig_edge = BOTH;
 
-        if (tokens[0] == "8") bits = B8;
-        else if (tokens[0] == "12") bits = B12;
+        if (tokens.equals(7, "A")) set.trig_mode = AUTO;
+        else if (tokens.equals(7, "N")) set.trig_mode = NORMAL;
+        else if (tokens.equals(7, "S")) set.trig_mode = SINGLE;
 
-        if (tokens[6] == "F") edge = FALLING;
-        else if (tokens[6] == "B") edge = BOTH;
+        set.mem = tokens.toInt(1);
+        set.fs = tokens.toInt(2);
+        set.ch1_en = tokens.at(3, 0) == '1';
+        set.ch2_en = tokens.at(3, 1) == '1';
+        set.ch3_en = tokens.at(3, 2) == '1';
+        set.ch4_en = tokens.at(3, 3) == '1';
+        set.trig_ch = tokens.toInt(4);
+        set.trig_val = tokens.toInt(5);
+        set.trig_pre = tokens.toInt(8);
 
-        if (tokens[7] == "A") mode = AUTO;
-        else if (tokens[7] == "N") mode = NORMAL;
-        else if (tokens[7] == "S") mode = SINGLE;
+        set.maxZ_ohm = tokens.toDouble(9);
+        if (set.maxZ_ohm < 0)
+            set.maxZ_ohm = 10;
 
-        double maxZ = tokens[9].toDouble();
-        if (maxZ < 0)
-            maxZ = 10;
+        set.smpl_time = tokens.toDouble(10) / 1000000000.0;
+        set.fs_real_n = tokens.toDouble(11);
+        set.fs_real = tokens.toString(11);
 
-        emit result(bits, tokens[1].toInt(), tokens[2].toInt(),
-                    tokens[3][0] == '1', tokens[3][1] == '1', tokens[3][2] == '1', tokens[3][3] == '1',
-                    tokens[4].toInt(), tokens[5].toInt(), edge, mode, tokens[8].toInt(),
-                    maxZ, tokens[10].toDouble() / 1000000000.0, tokens[11].toDouble(), tokens[11]);
+        emit result(set);
     }
     else
     {
-        if (tokens.size() != 4 && !m_rxData.contains(EMBO_OK))
+        if (tokens.size() != 4)
         {
             emit err("SCOPE set failed! " + m_rxData, CRITICAL, true);
             return;
         }
 
-        double maxZ = tokens[1].toDouble();
-        if (maxZ < 0)
-            maxZ = 10;
+        set.maxZ_ohm = tokens.toDouble(1);
+        if (set.maxZ_ohm < 0)
+            set.maxZ_ohm = 10;
 
-        emit ok2(maxZ, tokens[2].toDouble() / 1000000000.0, tokens[3].toDouble(), tokens[3]);
+        set.smpl_time = tokens.toDouble(2) / 1000000000.0;
+        set.fs_real_n = tokens.toDouble(3);
+        set.fs_real = tokens.toString(3);
+
+        emit ok2(set);
     }
 }
 
 void Msg_SCOP_ForceTrig::on_dataRx()
 {
-    qInfo() << "SCOP:FORC: " <<  m_rxData;
-    //auto core = Core::getInstance(this);
-
     emit ok();
 }
 
@@ -297,58 +307,58 @@ void Msg_SCOP_ForceTrig::on_dataRx()
 
 void Msg_LA_Read::on_dataRx()
 {
-    qInfo() << "LA:READ: size: " <<  m_rxDataBin.size();
-    //qInfo () << m_rxDataBin.toHex();
-
     emit result(m_rxDataBin);
 }
 
 void Msg_LA_Set::on_dataRx()
 {
-    qInfo() << "LA:SET: " <<  m_rxData;
-
-    QStringList tokens = m_rxData.split(EMBO_DELIM2, QString::SkipEmptyParts);
+    MsgTokens tokens(m_rxData);
+    DaqSettings set;
 
     if (getIsQuery())
     {
-        QStringList tokens = m_rxData.split(EMBO_DELIM2, QString::SkipEmptyParts);
-
         if (tokens.size() != 7)
         {
             emit err(INVALID_MSG + m_rxData, CRITICAL, true);
             return;
         }
 
-        DaqTrigEdge edge = RISING;
-        DaqTrigMode mode = DISABLED;
+        set.trig_edge = RISING;
+        set.trig_mode = DISABLED;
+
+        if (tokens.equals(3, "F")) set.trig_edge = FALLING;
+        else if (tokens.equals(3, "B")) set.trig_edge = BOTH;
 
-        if (tokens[3] == "F") edge = FALLING;
-        else if (tokens[6] == "B") edge = BOTH;
+        if (tokens.equals(4, "A")) set.trig_mode = AUTO;
+        else if (tokens.equals(4, "N")) set.trig_mode = NORMAL;
+        else if (tokens.equals(4, "S")) set.trig_mode = SINGLE;
 
-        if (tokens[4] == "A") mode = AUTO;
-        else if (tokens[4] == "N") mode = NORMAL;
-        else if (tokens[4] == "S") mode = SINGLE;
+        set.mem = tokens.toInt(0);
+        set.fs = tokens.toInt(1);
+        set.trig_ch = tokens.toInt(2);
+        set.trig_pre = tokens.toInt(5);
+        set.fs_real_n = tokens.toDouble(6);
+        set.fs_real = tokens.toString(6);
 
-        emit result(tokens[0].toInt(), tokens[1].toInt(), tokens[2].toInt(),
-                    edge, mode, tokens[5].toInt(), tokens[6].toDouble(), tokens[6]);
+        emit result(set);
     }
     else
     {
-        if (tokens.size() != 2 && !m_rxData.contains(EMBO_OK))
+        if (tokens.size() != 2)
         {
             emit err("LA set failed! " + m_rxData, CRITICAL, true);
             return;
         }
 
-        emit ok2(tokens[1].toDouble(), tokens[1]);
+        set.fs_real_n = tokens.toDouble(1);
+        set.fs_real = tokens.toString(1);
+
+        emit ok2(set);
     }
 }
 
 void Msg_LA_ForceTrig::on_dataRx()
 {
-    qInfo() << "LA:FORC: " <<  m_rxData;
-    //auto core = Core::getInstance(this);
-
     emit ok();
 }
 
@@ -356,19 +366,17 @@ void Msg_LA_ForceTrig::on_dataRx()
 
 void Msg_CNTR_Enable::on_dataRx()
 {
-    qInfo() << "CNTR:ENA: " <<  m_rxData;
-
     if (getIsQuery())
     {
-        QStringList tokens = m_rxData.split(EMBO_DELIM2, QString::SkipEmptyParts);
+        MsgTokens tokens(m_rxData);
 
-        if (tokens.size() != 2)
+        if (tokens.size() != 3)
         {
             emit err(INVALID_MSG + m_rxData, CRITICAL, true);
             return;
         }
 
-        emit result(tokens[0].contains(EMBO_TRUE), tokens[1].contains(EMBO_TRUE));
+        emit result(tokens.contains(0, '1'), tokens.contains(1, '1'), tokens.toInt(2));
     }
     else
     {
@@ -381,49 +389,158 @@ void Msg_CNTR_Enable::on_dataRx()
 
 void Msg_CNTR_Read::on_dataRx()
 {
-    qInfo() << "CNTR:READ: " <<  m_rxData;
+    if (m_rxDataBin.isEmpty()) // text - no gate closed yet, or error
+    {
+        if (!m_rxData.contains("Empty"))
+            emit err(INVALID_MSG + m_rxData, CRITICAL, true);
+        return;
+    }
 
-    QStringList tokens = m_rxData.split(EMBO_DELIM2, QString::SkipEmptyParts);
+    QByteArray bin = m_rxDataBin;
+    m_rxDataBin.clear(); // next response may be text
 
-    if (tokens.size() == 0)
+    CntrData data;
+
+    if (!parse(bin, data))
     {
-        emit err(INVALID_MSG + m_rxData, CRITICAL, true);
+        emit err(INVALID_MSG + QString::number(bin.size()) + " B", CRITICAL, true);
         return;
     }
 
-    emit result(tokens[0], tokens.size() > 1 ? tokens[1] : "");
+    emit result(data);
+}
+
+bool Msg_CNTR_Read::parse(const QByteArray& bin, CntrData& data)
+{
+    /* uint32 seq, n, double min, max, mean, std, adev, then gates - little endian as device */
+    const int headLen = 2 * sizeof(quint32) + 5 * sizeof(double);
+
+    if (bin.size() < headLen || (bin.size() - headLen) % sizeof(double) != 0)
+        return false;
+
+    const char* p = bin.constData();
+
+    memcpy(&data.seq, p, sizeof(quint32));
+    memcpy(&data.n, p + 4, sizeof(quint32));
+    memcpy(&data.min, p + 8, sizeof(double));
+    memcpy(&data.max, p + 16, sizeof(double));
+    memcpy(&data.mean, p + 24, sizeof(double));
+    memcpy(&data.std, p + 32, sizeof(double));
+    memcpy(&data.adev, p + 40, sizeof(double));
+
+    data.freqs.resize((bin.size() - headLen) / sizeof(double));
+    memcpy(data.freqs.data(), p + headLen, data.freqs.size() * sizeof(double));
+
+    return true;
+}
+
+void Msg_CNTR_Raw::on_dataRx()
+{
+    if (!getIsQuery())
+    {
+        if (m_rxData.contains(EMBO_OK))
+            emit ok();
+        else
+            emit err("Raw capture failed! " + m_rxData, WARNING, false);
+        return;
+    }
+
+    if (m_rxDataBin.isEmpty()) // text - capture not finished yet, or error
+    {
+        if (!m_rxData.contains("Empty"))
+            emit err(INVALID_MSG + m_rxData, WARNING, false);
+        return;
+    }
+
+    /* uint32 mode, len1, len2, IC psc, f_tim, timer psc, uint16 ovf_pre, ovf_post, then uint16 ccr[len1], aux[len2] */
+    const int headLen = 6 * sizeof(quint32) + 2 * sizeof(quint16);
+    QByteArray bin = m_rxDataBin;
+    m_rxDataBin.clear(); // next response may be text
+
+    quint32 u32[6] = {};
+    quint16 u16[2] = {};
+
+    if (bin.size() >= headLen)
+    {
+        memcpy(u32, bin.constData(), sizeof(u32));
+        memcpy(u16, bin.constData() + sizeof(u32), sizeof(u16));
+    }
+
+    if (bin.size() < headLen || bin.size() != headLen + (int)(u32[1] + u32[2]) * (int)sizeof(quint16) || u32[5] == 0)
+    {
+        emit err(INVALID_MSG + QString::number(bin.size()) + " B", WARNING, false);
+        return;
+    }
+
+    CntrRaw data;
+
+    data.duty = u32[0] == 1;
+    data.icPsc = u32[3];
+    data.fTim = u32[4];
+    data.timDiv = u32[5];
+    data.ovfPre = u16[0];
+    data.ovfPost = u16[1];
+
+    data.ccr.resize(u32[1]);
+    data.aux.resize(u32[2]);
+    memcpy(data.ccr.data(), bin.constData() + headLen, data.ccr.size() * sizeof(quint16));
+    memcpy(data.aux.data(), bin.constData() + headLen + data.ccr.size() * sizeof(quint16), data.aux.size() * sizeof(quint16));
+
+    emit result(data);
 }
 
 /***************************** Messages - SGEN **************************/
 
 void Msg_SGEN_Set::on_dataRx()
 {
-    qInfo() << "SGEN:SET: " <<  m_rxData;
-
-    QStringList tokens = m_rxData.split(EMBO_DELIM2, QString::SkipEmptyParts);
+    MsgTokens tokens(m_rxData);
 
     if (getIsQuery())
     {
-        QStringList tokens = m_rxData.split(EMBO_DELIM2, QString::SkipEmptyParts);
-
         if (tokens.size() != 7)
         {
             emit err(INVALID_MSG + m_rxData, CRITICAL, true);
             return;
         }
 
-        emit result(tokens[0].toInt(), tokens[1].toInt(), tokens[2].toInt(),
-                    (SgenMode)tokens[3].toInt(), tokens[4] == "1", tokens[5], tokens[6]);
+        emit result(tokens.toDouble(0), tokens.toInt(1), tokens.toInt(2),
+                    (SgenMode)tokens.toInt(3), tokens.equals(4, EMBO_TRUE), tokens.toString(5), tokens.toString(6));
     }
     else
     {
-        if (tokens.size() != 3 && !m_rxData.contains(EMBO_OK))
+        if (tokens.size() != 3)
         {
             emit err("Signal Generator set failed! " + m_rxData, CRITICAL, true);
             return;
         }
 
-        emit ok(tokens[1], tokens[2]);
+        emit ok(tokens.toString(1), tokens.toString(2));
+    }
+}
+
+void Msg_SGEN_Arb::on_dataRx()
+{
+    MsgTokens tokens(m_rxData);
+
+    if (getIsQuery())
+    {
+        if (tokens.size() != 3)
+        {
+            emit err(INVALID_MSG + m_rxData, CRITICAL, true);
+            return;
+        }
+
+        emit result(tokens.toInt(0), tokens.toInt(1), tokens.toInt(2));
+    }
+    else
+    {
+        if (tokens.size() != 2)
+        {
+            emit err("Arbitrary waveform upload failed! " + m_rxData, WARNING, false);
+            return;
+        }
+
+        emit ok(tokens.toString(1));
     }
 }
 
@@ -431,31 +548,37 @@ void Msg_SGEN_Set::on_dataRx()
 
 void Msg_PWM_Set::on_dataRx()
 {
-    qInfo() << "PWM:SET: " <<  m_rxData;
-
-    QStringList tokens = m_rxData.split(EMBO_DELIM2, QString::SkipEmptyParts);
+    MsgTokens tokens(m_rxData);
 
     if (getIsQuery())
     {
-        QStringList tokens = m_rxData.split(EMBO_DELIM2, QString::SkipEmptyParts);
-
         if (tokens.size() != 7)
         {
             emit err(INVALID_MSG + m_rxData, CRITICAL, true);
             return;
         }
 
-        emit result(tokens[0].toInt(), tokens[1].toInt(), tokens[2].toInt(), tokens[3].toInt(),
-                    tokens[4] == "1", tokens[5] == "1", tokens[6]);
+        emit result(tokens.toInt(0), tokens.toInt(1), tokens.toInt(2), tokens.toInt(3),
+                    tokens.equals(4, EMBO_TRUE), tokens.equals(5, EMBO_TRUE), tokens.toString(6));
     }
     else
     {
-        if (tokens.size() != 2 && !m_rxData.contains(EMBO_OK))
+        if (tokens.size() != 2)
         {
             emit err("PWM Generator set failed! " + m_rxData, CRITICAL, true);
             return;
         }
 
-        emit ok(tokens[1]);
+        emit ok(tokens.toString(1));
     }
 }
+
+/****************************** Messages - RAW *******************************/
+
+void Msg_Raw::on_dataRx()
+{
+    if (m_rxDataBin.isEmpty()) // object is used for one response only
+        emit result(m_rxData, false);
+    else
+        emit result(m_rxDataBin, true);
+}
@@ -20,6 +20,7 @@
 #define EMBO_SYS_INFO       ":SYS:INFO"
 #define EMBO_SYS_MODE       ":SYS:MODE"
 #define EMBO_SYS_UPTIME     ":SYS:UPT"
+#define EMBO_SYS_BAUD       ":SYS:BAUD"
 
 #define EMBO_VM_READ        ":VM:READ"
 
@@ -33,8 +34,10 @@
 
 #define EMBO_CNTR_SET       ":CNTR:SET"
 #define EMBO_CNTR_READ      ":CNTR:READ"
+#define EMBO_CNTR_RAW       ":CNTR:RAW"
 
 #define EMBO_SGEN_SET       ":SGEN:SET"
+#define EMBO_SGEN_ARB       ":SGEN:ARB"
 
 #define EMBO_PWM_SET        ":PWM:SET"
 
@@ -109,6 +112,14 @@ public:
     virtual void on_dataRx() override;
 };
 
+class Msg_SYS_Baud : public Msg
+{
+    Q_OBJECT
+public:
+    explicit Msg_SYS_Baud(QObject* parent=0) : Msg(EMBO_SYS_BAUD, false, parent) {};
+    virtual void on_dataRx() override;
+};
+
 class Msg_Dummy : public Msg
 {
     Q_OBJECT
@@ -126,7 +137,7 @@ public:
     explicit Msg_VM_Read(QObject* parent=0) : Msg(EMBO_VM_READ, true, parent) {};
     virtual void on_dataRx() override;
 signals:
-    void result(const QString ch1, const QString ch2, const QString ch3, const QString ch4, const QString vcc);
+    void result(const VmData data);
 };
 
 /***************************** Messages - SCOP **************************/
@@ -148,10 +159,8 @@ public:
     explicit Msg_SCOP_Set(QObject* parent=0) : Msg(EMBO_SCOP_SET, true, parent) {};
     virtual void on_dataRx() override;
 signals:
-    void ok2(double maxZ, double smpl_time, double fs_real_n, const QString fs_real);
-    void result(DaqBits bits, int mem, int fs, bool ch1, bool ch2, bool ch3, bool ch4, int trig_ch, int trig_val,
-                DaqTrigEdge trig_edge, DaqTrigMode trig_mode, int trig_pre,
-                double maxZ,  double smpl_time, double fs_real_n, const QString fs_real);
+    void ok2(const DaqSettings set); // read-only part only
+    void result(const DaqSettings set);
 };
 
 class Msg_SCOP_ForceTrig : public Msg
@@ -181,8 +190,8 @@ public:
     explicit Msg_LA_Set(QObject* parent=0) : Msg(EMBO_LA_SET, true, parent) {};
     virtual void on_dataRx() override;
 signals:
-    void ok2(double fs_real_n, const QString fs_real);
-    void result(int mem, int fs, int trig_ch, DaqTrigEdge trig_edge, DaqTrigMode trig_mode, int trig_pre, double fs_real_n, const QString fs_real);
+    void ok2(const DaqSettings set); // fs_real only
+    void result(const DaqSettings set);
 };
 
 class Msg_LA_ForceTrig : public Msg
@@ -202,7 +211,7 @@ public:
     explicit Msg_CNTR_Enable(QObject* parent=0) : Msg(EMBO_CNTR_SET, true, parent) {};
     virtual void on_dataRx() override;
 signals:
-    void result(bool enabled, bool fastMode);
+    void result(bool enabled, bool fastMode, int gateMs);
 };
 
 class Msg_CNTR_Read : public Msg
@@ -211,8 +220,19 @@ class Msg_CNTR_Read : public Msg
 public:
     explicit Msg_CNTR_Read(QObject* parent=0) : Msg(EMBO_CNTR_READ, true, parent) {};
     virtual void on_dataRx() override;
+    static bool parse(const QByteArray& bin, CntrData& data); // also "ReadyC" record pushed by device
+signals:
+    void result(const CntrData data);
+};
+
+class Msg_CNTR_Raw : public Msg
+{
+    Q_OBJECT
+public:
+    explicit Msg_CNTR_Raw(QObject* parent=0) : Msg(EMBO_CNTR_RAW, true, parent) {};
+    virtual void on_dataRx() override;
 signals:
-    void result(const QString freq, const QString period);
+    void result(const CntrRaw data);
 };
 
 /***************************** Messages - SGEN **************************/
@@ -227,6 +247,16 @@ signals:
     void result(double freq, int ampl, int offset, SgenMode mode, bool enable, const QString N, const QString real_freq);
 };
 
+class Msg_SGEN_Arb : public Msg
+{
+    Q_OBJECT
+public:
+    explicit Msg_SGEN_Arb(QObject* parent=0) : Msg(EMBO_SGEN_ARB, true, parent) {};
+    virtual void on_dataRx() override;
+signals:
+    void result(int len, int maxLen, int chunk);
+};
+
 /***************************** Messages - PWM ***************************/
 
 class Msg_PWM_Set : public Msg
@@ -239,4 +269,16 @@ signals:
     void result(int freq, int duty1, int duty2, int offset, bool en1, bool en2, const QString freq_real);
 };
 
+/***************************** Messages - RAW ***************************/
+
+class Msg_Raw : public Msg // command of external client (EmboServer), one object per request
+{
+    Q_OBJECT
+public:
+    explicit Msg_Raw(const QString cmd, QObject* parent=0) : Msg(cmd, true, parent) { m_logPayload = false; };
+    virtual void on_dataRx() override;
+signals:
+    void result(const QByteArray data, bool isBinary);
+};
+
 #endif // MESSAGES_H
@@ -4,30 +4,47 @@
  */
 
 #include "msg.h"
+#include "trace.h"
 
 #include <QString>
 
 Msg::Msg(const Msg& msg) : QObject(msg.parent())
 {
     m_cmd = msg.m_cmd;
+    m_tag = msg.m_tag;
     m_isQuery = msg.m_isQuery;
     m_params = msg.m_params;
+    m_block = msg.m_block;
+    m_core = msg.m_core;
+    m_logPayload = msg.m_logPayload;
 }
 
-Msg::Msg(const QString cmd, bool isQuery, QObject* parent) : QObject(parent), m_cmd(cmd), m_isQuery(isQuery)
+Msg::Msg(const QString cmd, bool isQuery, QObject* parent) : QObject(parent), m_cmd(cmd), m_tag(cmd.toLatin1()), m_isQuery(isQuery)
 {
     connect(this, &Msg::rx, this, &Msg::on_dataRx, Qt::DirectConnection);
     connect(this, &Msg::rx_bin, this, &Msg::on_dataRx, Qt::DirectConnection);
 }
 
-void Msg::fire(const QString data)
+void Msg::fire(const QByteArray data, bool isBinary)
 {
-    m_rxData = data.isEmpty() ? "" : data;
-    emit rx();
-}
+    Trace::record(TRACE_COMM, isBinary ? TR_RX_BIN : TR_RX, m_tag.constData(), m_tag.size(), data.size());
 
-void Msg::fire(const QByteArray data)
-{
-    m_rxDataBin = data;
-    emit rx_bin();
+    if (m_logPayload && Trace::enabled(TRACE_VERBOSE))
+    {
+        if (isBinary)
+            qInfo() << m_cmd << ": size: " << data.size();
+        else
+            qInfo() << m_cmd << ": " << data;
+    }
+
+    if (isBinary)
+    {
+        m_rxDataBin = data;
+        emit rx_bin();
+    }
+    else
+    {
+        m_rxData = data;
+        emit rx();
+    }
 }
@@ -13,6 +13,8 @@
 #include <QDebug>
 
 
+class Core;
+
 class Msg : public QObject
 {
     Q_OBJECT
@@ -22,15 +24,19 @@ public:
     explicit Msg(const QString cmd = "", bool isQuery = true, QObject* parent = 0);
     virtual ~Msg() {};
 
-    void fire(const QString data);
-    void fire(const QByteArray data);
+    void fire(const QByteArray data, bool isBinary);
 
     QString getCmd() { return this->m_cmd; }
+    const QByteArray& getTag() { return this->m_tag; }
     bool getIsQuery() { return this->m_isQuery; }
     QString getParams() { return this->m_params; }
+    const QByteArray& getBlock() { return this->m_block; }
+    Core* getCore() { return this->m_core; }
 
     void setIsQuery(bool val) { this->m_isQuery = val; }
     void setParams(QString val) { this->m_params = val; }
+    void setBlock(const QByteArray& val) { this->m_block = val; }
+    void setCore(Core* core) { this->m_core = core; }
 
 protected slots:
     virtual void on_dataRx() {};
@@ -44,10 +50,14 @@ signals:
 
 protected:
     QString m_cmd;
-    QString m_rxData;
+    QByteArray m_tag; // m_cmd for trace, converted once
+    QByteArray m_rxData;
     QByteArray m_rxDataBin;
     bool m_isQuery;
     QString m_params = "";
+    QByteArray m_block; // binary arbitrary block appended to params, sent alone in line
+    Core* m_core = Q_NULLPTR; // device which sent this message
+    bool m_logPayload = true; // payload printed at TRACE_VERBOSE, otherwise only traced
 };
 
 
@@ -0,0 +1,256 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "persistence.h"
+
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <math.h>
+#include <assert.h>
+
+
+#define PERSISTENCE_HIT     16      // one hit = 16, lower 4 bits let single hits fade out slowly
+#define PERSISTENCE_SAT     0xFFFF
+
+
+Persistence::Persistence()
+{
+}
+
+bool Persistence::setSize(int width, int height)
+{
+    if (width < 1 || height < 1)
+        return false;
+
+    if (width == m_width && height == m_height)
+        return false;
+
+    m_width = width;
+    m_height = height;
+    m_bins.assign((size_t)m_width * m_height, 0);
+    m_frames = 0;
+
+    return true;
+}
+
+bool Persistence::setRange(const QCPRange& x, const QCPRange& y)
+{
+    if (x == m_x && y == m_y)
+        return false;
+
+    m_x = x;
+    m_y = y;
+    clear();
+
+    return true;
+}
+
+void Persistence::clear()
+{
+    std::fill(m_bins.begin(), m_bins.end(), 0);
+    m_frames = 0;
+}
+
+void Persistence::addFrame(const QVector<double>& t, const QVector<double>& y)
+{
+    /* to pixel coords, time axis must be monotonic (YT mode) */
+
+    int n = toPixels(t, y);
+
+    if (n < 2)
+        return;
+
+    /* split columns into bands, each band owns its columns - no locking needed */
+
+    int segs = n - 1;
+    int bands = segs < PERSISTENCE_MIN_SEG ? 1 : PERSISTENCE_BANDS;
+
+    if (bands == 1)
+    {
+        rasterize(0, m_width, 0, segs);
+    }
+    else
+    {
+        QVector<int> band_idx(bands);
+        for (int i = 0; i < bands; i++)
+            band_idx[i] = i;
+
+        QtConcurrent::blockingMap(band_idx, [this, bands, segs](int& band)
+        {
+            int col_from = (m_width * band) / bands;
+            int col_to = (m_width * (band + 1)) / bands;
+
+            // first segment ending in band, first segment starting after band
+            int seg_from = std::lower_bound(m_px.begin() + 1, m_px.end(), (float)col_from) - m_px.begin() - 1;
+            int seg_to = std::lower_bound(m_px.begin(), m_px.end(), (float)col_to) - m_px.begin();
+
+            rasterize(col_from, col_to, std::max(seg_from, 0), std::min(seg_to, segs));
+        });
+    }
+
+    m_frames++;
+}
+
+void Persistence::addFrameXY(const QVector<double>& x, const QVector<double>& y)
+{
+    int n = toPixels(x, y);
+
+    if (n < 2)
+        return;
+
+    rasterizeXY(n - 1);
+
+    m_frames++;
+}
+
+void Persistence::render(QCPColorMapData* data, double decay)
+{
+    assert(data != NULL);
+
+    if (m_bins.empty())
+        return;
+
+    static float lut[PERSISTENCE_SAT + 1];
+    static bool lut_ready = false;
+
+    if (!lut_ready) // log intensity, so rare glitches are visible next to the main trace
+    {
+        for (int i = 0; i <= PERSISTENCE_SAT; i++)
+            lut[i] = log2f(1.0f + (float)i / PERSISTENCE_HIT);
+        lut_ready = true;
+    }
+
+    if (data->keySize() != m_width || data->valueSize() != m_height)
+        data->setSize(m_width, m_height);
+
+    data->setRange(QCPRange(m_x.lower + (m_x.size() / m_width / 2.0), m_x.upper - (m_x.size() / m_width / 2.0)),
+                   QCPRange(m_y.lower + (m_y.size() / m_height / 2.0), m_y.upper - (m_y.size() / m_height / 2.0)));
+
+    uint32_t k = (uint32_t)(decay * 65536.0);
+    uint16_t* bin = m_bins.data();
+
+    for (int c = 0; c < m_width; c++)
+    {
+        for (int r = 0; r < m_height; r++, bin++)
+        {
+            data->setCell(c, r, lut[*bin]);
+
+            if (*bin != 0)
+                *bin = (uint16_t)((*bin * k) >> 16);
+        }
+    }
+}
+
+/* returns count of points, 0 if nothing can be drawn */
+int Persistence::toPixels(const QVector<double>& x, const QVector<double>& y)
+{
+    int n = std::min(x.size(), y.size());
+
+    if (n < 2 || m_bins.empty() || m_x.size() <= 0 || m_y.size() <= 0)
+        return 0;
+
+    m_px.resize(n);
+    m_py.resize(n);
+
+    const double kx = m_width / m_x.size();
+    const double ky = m_height / m_y.size();
+    const double x0 = m_x.lower;
+    const double y0 = m_y.lower;
+    const double* x_data = x.constData();
+    const double* y_data = y.constData();
+
+    for (int i = 0; i < n; i++)
+    {
+        m_px[i] = (float)((x_data[i] - x0) * kx);
+        m_py[i] = (float)((y_data[i] - y0) * ky);
+    }
+
+    return n;
+}
+
+void Persistence::rasterize(int col_from, int col_to, int seg_from, int seg_to)
+{
+    const int h_max = m_height - 1;
+
+    for (int i = seg_from; i < seg_to; i++)
+    {
+        float xa = m_px[i];
+        float xb = m_px[i + 1];
+        float ya = m_py[i];
+        float yb = m_py[i + 1];
+
+        if (xb < xa)
+            continue; // not monotonic, skip
+
+        int ca = (int)std::max((float)col_from, floorf(xa));
+        int cb = (int)std::min((float)(col_to - 1), floorf(xb));
+
+        float slope = (xb > xa) ? (yb - ya) / (xb - xa) : 0;
+
+        /* vertical span per column */
+
+        for (int c = ca; c <= cb; c++)
+        {
+            float xl = std::max(xa, (float)c);
+            float xr = std::min(xb, (float)(c + 1));
+
+            float yl = ya + (xl - xa) * slope;
+            float yr = ya + (xr - xa) * slope;
+
+            int lo = (int)floorf(std::min(yl, yr));
+            int hi = (int)floorf(std::max(yl, yr));
+
+            if (hi < 0 || lo > h_max)
+                continue;
+
+            lo = std::max(lo, 0);
+            hi = std::min(hi, h_max);
+
+            uint16_t* col = &m_bins[(size_t)c * m_height];
+
+            for (int r = lo; r <= hi; r++)
+                col[r] = (col[r] > PERSISTENCE_SAT - PERSISTENCE_HIT) ? PERSISTENCE_SAT : col[r] + PERSISTENCE_HIT;
+        }
+    }
+}
+
+/* DDA, one step per pixel of longer axis, start of segment is end of previous one - hit once */
+void Persistence::rasterizeXY(int segs)
+{
+    const float w = (float)m_width;
+    const float h = (float)m_height;
+    const int steps_max = 2 * (m_width + m_height); // far out of view when zoomed in, approximate
+
+    for (int i = 0; i < segs; i++)
+    {
+        float xa = m_px[i];
+        float xb = m_px[i + 1];
+        float ya = m_py[i];
+        float yb = m_py[i + 1];
+
+        if ((xa < 0 && xb < 0) || (xa >= w && xb >= w) || (ya < 0 && yb < 0) || (ya >= h && yb >= h))
+            continue; // whole segment out of view
+
+        float dx = xb - xa;
+        float dy = yb - ya;
+        int steps = std::min((int)ceilf(std::max(fabsf(dx), fabsf(dy))), steps_max);
+
+        if (steps < 1)
+            steps = 1;
+
+        for (int s = (i == 0 ? 0 : 1); s <= steps; s++)
+        {
+            float fx = xa + dx * s / steps;
+            float fy = ya + dy * s / steps;
+
+            if (fx < 0 || fx >= w || fy < 0 || fy >= h)
+                continue;
+
+            uint16_t* bin = &m_bins[(size_t)fx * m_height + (size_t)fy];
+            *bin = (*bin > PERSISTENCE_SAT - PERSISTENCE_HIT) ? PERSISTENCE_SAT : *bin + PERSISTENCE_HIT;
+        }
+    }
+}
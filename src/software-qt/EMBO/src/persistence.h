@@ -0,0 +1,61 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef PERSISTENCE_H
+#define PERSISTENCE_H
+
+#include "lib/qcustomplot.h"
+
+#include <QVector>
+
+#include <vector>
+#include <stdint.h>
+
+
+#define PERSISTENCE_DECAY       0.90    // intensity multiplier per render tick
+#define PERSISTENCE_BANDS       4       // column bands rasterized in parallel
+#define PERSISTENCE_MIN_SEG     2048    // below this segment count, rasterize in caller thread
+
+/* digital phosphor - 2D time x voltage hit-count histogram, one bin per plot pixel.
+ * XY frames (x, y in any order) are drawn by DDA in caller thread, segments may cross any column */
+
+class Persistence
+{
+public:
+    Persistence();
+
+    bool setSize(int width, int height);
+    bool setRange(const QCPRange& x, const QCPRange& y);
+    void clear();
+
+    void addFrame(const QVector<double>& t, const QVector<double>& y);
+    void addFrameXY(const QVector<double>& x, const QVector<double>& y);
+    void render(QCPColorMapData* data, double decay = PERSISTENCE_DECAY);
+
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+    int getFrames() const { return m_frames; }
+
+private:
+    int toPixels(const QVector<double>& x, const QVector<double>& y);
+    void rasterize(int col_from, int col_to, int seg_from, int seg_to);
+    void rasterizeXY(int segs);
+
+    /* bins are column-major, so every band owns contiguous memory */
+    std::vector<uint16_t> m_bins;
+
+    /* pixel coordinates of the current frame */
+    std::vector<float> m_px;
+    std::vector<float> m_py;
+
+    int m_width = 0;
+    int m_height = 0;
+    int m_frames = 0;
+
+    QCPRange m_x;
+    QCPRange m_y;
+};
+
+#endif // PERSISTENCE_H
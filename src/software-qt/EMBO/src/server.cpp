@@ -0,0 +1,315 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "server.h"
+
+#include <QDebug>
+
+
+/* split compound line by ';' outside of "..." and '...' string params */
+static QList<QByteArray> splitCommands(const QByteArray& line)
+{
+    QList<QByteArray> parts;
+    char quote = 0;
+    int start = 0;
+
+    for (int i = 0; i < line.size(); i++)
+    {
+        char c = line.at(i);
+
+        if (quote != 0)
+        {
+            if (c == quote)
+                quote = 0;
+        }
+        else if (c == '"' || c == '\'')
+            quote = c;
+        else if (c == ';')
+        {
+            parts.append(line.mid(start, i - start));
+            start = i + 1;
+        }
+    }
+    parts.append(line.mid(start));
+
+    return parts;
+}
+
+EmboServer::EmboServer(Core* core, QObject* parent) : QObject(parent), m_core(core),
+    m_ring(SERVER_NAME + QString::number(core->getId()) + SERVER_SHM_SUFFIX)
+{
+    m_name = SERVER_NAME + QString::number(core->getId());
+    m_server = new QLocalServer(this);
+
+    connect(m_server, &QLocalServer::newConnection, this, &EmboServer::on_newConnection);
+}
+
+EmboServer::~EmboServer()
+{
+    stop();
+}
+
+bool EmboServer::start()
+{
+    if (m_server->isListening())
+        return true;
+
+    QLocalServer::removeServer(m_name); // stale socket of crashed instance
+
+    if (!m_server->listen(m_name))
+    {
+        m_error = "Local server failed! " + m_server->errorString();
+        return false;
+    }
+
+    if (!m_ring.create())
+    {
+        m_error = "Shared memory failed! " + m_ring.getError();
+        m_server->close();
+        return false;
+    }
+
+    connect(m_core, &Core::frameRx, this, &EmboServer::on_core_frameRx, Qt::QueuedConnection);
+    connect(m_core, &Core::daqReady, this, &EmboServer::on_core_daqReady, Qt::QueuedConnection);
+    connect(m_core, &Core::cntrReady, this, &EmboServer::on_core_cntrReady, Qt::QueuedConnection);
+    connect(m_core, &Core::stateChanged, this, &EmboServer::on_coreState_changed, Qt::QueuedConnection);
+
+    m_core->setFrameTap(true);
+
+    qInfo() << "Server listening:" << m_server->fullServerName() << "shm:" << m_ring.getKey();
+    return true;
+}
+
+void EmboServer::stop()
+{
+    if (!m_server->isListening())
+        return;
+
+    m_core->setFrameTap(false);
+    disconnect(m_core, Q_NULLPTR, this, Q_NULLPTR);
+
+    m_server->close();
+
+    for (auto client : m_rxBuffers.keys())
+    {
+        client->disconnect(this);
+        client->abort();
+        client->deleteLater();
+    }
+
+    m_rxBuffers.clear();
+    m_subscribers.clear();
+
+    for (auto it = m_pending.begin(); it != m_pending.end(); ++it)
+        it.value() = Q_NULLPTR; // message may still be queued in Core, deleted with its response
+
+    m_ring.destroy();
+}
+
+/********************************* slots *********************************/
+
+void EmboServer::on_newConnection()
+{
+    while (m_server->hasPendingConnections())
+    {
+        QLocalSocket* client = m_server->nextPendingConnection();
+
+        connect(client, &QLocalSocket::readyRead, this, &EmboServer::on_client_readyRead);
+        connect(client, &QLocalSocket::disconnected, this, &EmboServer::on_client_disconnected);
+
+        m_rxBuffers.insert(client, QByteArray());
+    }
+}
+
+void EmboServer::on_client_readyRead()
+{
+    QLocalSocket* client = qobject_cast<QLocalSocket*>(sender());
+
+    if (client == Q_NULLPTR || !m_rxBuffers.contains(client))
+        return;
+
+    QByteArray& buffer = m_rxBuffers[client];
+    buffer.append(client->readAll());
+
+    int nl;
+    while ((nl = buffer.indexOf('\n')) >= 0)
+    {
+        QByteArray line = buffer.left(nl).trimmed();
+        buffer.remove(0, nl + 1);
+
+        if (!line.isEmpty())
+            request(client, line);
+    }
+}
+
+void EmboServer::on_client_disconnected()
+{
+    QLocalSocket* client = qobject_cast<QLocalSocket*>(sender());
+
+    if (client == Q_NULLPTR)
+        return;
+
+    m_rxBuffers.remove(client);
+    m_subscribers.removeAll(client);
+
+    for (auto it = m_pending.begin(); it != m_pending.end(); ++it)
+    {
+        if (it.value() == client)
+            it.value() = Q_NULLPTR;
+    }
+
+    client->deleteLater();
+}
+
+void EmboServer::on_msg_result(const QByteArray data, bool isBinary)
+{
+    Msg_Raw* msg = qobject_cast<Msg_Raw*>(sender());
+
+    if (msg == Q_NULLPTR || !m_pending.contains(msg))
+        return;
+
+    QLocalSocket* client = m_pending.take(msg);
+    msg->deleteLater();
+
+    if (client == Q_NULLPTR)
+        return;
+
+    reply(client, isBinary ? publish(msg->getCmd(), data) : data);
+}
+
+void EmboServer::on_core_frameRx(const QString cmd, const QByteArray data)
+{
+    if (m_subscribers.isEmpty())
+        return;
+
+    QByteArray line = publish(cmd, data);
+
+    for (auto client : m_subscribers)
+        reply(client, line);
+}
+
+void EmboServer::on_core_daqReady(Ready ready, int firstPos)
+{
+    static const char ready_char[] = { '-', 'A', 'N', 'F', 'S', 'D' };
+
+    QByteArray line = QByteArray("!READY ") + ready_char[ready] + "," + QByteArray::number(firstPos);
+
+    for (auto client : m_subscribers)
+        reply(client, line);
+}
+
+void EmboServer::on_core_cntrReady(const CntrData data)
+{
+    if (m_subscribers.isEmpty())
+        return;
+
+    QByteArray line = QByteArray("!CNTR ") + QByteArray::number(data.seq) + "," + QByteArray::number(data.n);
+
+    for (double val : { data.min, data.max, data.mean, data.std, data.adev })
+        line += "," + QByteArray::number(val, 'g', 12);
+
+    for (double freq : data.freqs)
+        line += "," + QByteArray::number(freq, 'g', 12);
+
+    for (auto client : m_subscribers)
+        reply(client, line);
+}
+
+void EmboServer::on_coreState_changed(const State state)
+{
+    m_state = state;
+
+    if (state != DISCONNECTED)
+        return;
+
+    /* queued commands will never be answered */
+    for (auto it = m_pending.begin(); it != m_pending.end(); ++it)
+    {
+        if (it.value() != Q_NULLPTR)
+            reply(it.value(), "ERR disconnected");
+
+        it.key()->deleteLater();
+    }
+
+    m_pending.clear();
+}
+
+/******************************** private ********************************/
+
+void EmboServer::request(QLocalSocket* client, const QByteArray& line)
+{
+    if (line.startsWith('!')) // server command
+    {
+        QByteArray cmd = line.toUpper();
+
+        if (cmd == "!SHM?")
+            reply(client, m_ring.getKey().toUtf8() + "," + QByteArray::number(m_ring.getSlots()) + "," +
+                          QByteArray::number(m_ring.getSlotSize()));
+        else if (cmd == "!SUB")
+        {
+            if (!m_subscribers.contains(client))
+                m_subscribers.append(client);
+            reply(client, EMBO_OK);
+        }
+        else if (cmd == "!UNSUB")
+        {
+            m_subscribers.removeAll(client);
+            reply(client, EMBO_OK);
+        }
+        else
+            reply(client, "ERR unknown server command");
+
+        return;
+    }
+
+    for (const QByteArray& part : splitCommands(line))
+    {
+        QByteArray cmd = part.trimmed();
+
+        if (cmd.isEmpty())
+            continue;
+
+        if (m_state != CONNECTED)
+        {
+            reply(client, "ERR not connected");
+            continue;
+        }
+
+        /* header[?] [params] - Core::send composes it back */
+        int space = cmd.indexOf(' ');
+        QString header = (space < 0 ? cmd : cmd.left(space));
+        QString params = (space < 0 ? "" : cmd.mid(space + 1).trimmed());
+        bool isQuery = header.endsWith('?');
+
+        if (isQuery)
+            header.chop(1);
+
+        /* Core::send joins messages of one tick by ';', relative header would follow path of previous one */
+        if (!header.startsWith(':') && !header.startsWith('*'))
+            header.prepend(':');
+
+        Msg_Raw* msg = new Msg_Raw(header, this);
+        connect(msg, &Msg_Raw::result, this, &EmboServer::on_msg_result, Qt::QueuedConnection);
+
+        m_pending.insert(msg, client);
+        m_core->msgAdd(msg, isQuery, params);
+    }
+}
+
+void EmboServer::reply(QLocalSocket* client, const QByteArray& line)
+{
+    client->write(line);
+    client->write("\n");
+}
+
+QByteArray EmboServer::publish(const QString& cmd, const QByteArray& data)
+{
+    uint64_t seq = m_ring.write(m_core->getId(), m_core->getAlignedTimeMs(), cmd, data);
+
+    if (seq == 0)
+        return "ERR frame too large (" + QByteArray::number(data.size()) + ")";
+
+    return "#FRAME " + QByteArray::number((qulonglong)seq) + "," + cmd.toLatin1() + "," + QByteArray::number(data.size());
+}
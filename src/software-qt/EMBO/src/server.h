@@ -0,0 +1,84 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "core.h"
+#include "messages.h"
+#include "shmring.h"
+
+#include <QObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QMap>
+
+
+#define SERVER_NAME         "embo-"         // + Core id, local socket (unix) or named pipe (windows)
+#define SERVER_SHM_SUFFIX   "-frames"       // + server name, shared memory key
+
+/* local server - external clients (scripts, dashboards) share device with EMBO app.
+ *
+ * client sends lines of raw SCPI, compound commands split by ';' outside of quotes are queued as more messages,
+ * each header is taken from root (leading ':' is added),
+ * every command gets one response line in order:
+ *   text response as sent by device
+ *   #FRAME <seq>,<cmd>,<size>      binary response, data are in shared memory ring (ShmRing) under seq
+ *   ERR <reason>
+ * server commands:
+ *   !SHM?                          native key of shared memory, slots, slot size
+ *   !SUB / !UNSUB                  notifications of all frames read by EMBO app, of device readiness
+ *                                  and of counter gates pushed by device:
+ *                                  #FRAME <seq>,<cmd>,<size>   !READY <A|N|F|S|D>,<first pos>
+ *                                  !CNTR <seq>,<n>,<min>,<max>,<mean>,<std>,<adev>[,<gate freq>...]
+ *
+ * commands are scheduled by Core::msgAdd with messages of EMBO app, so changing mode or settings by client
+ * affects opened instrument windows */
+
+class EmboServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit EmboServer(Core* core, QObject* parent = 0);
+    ~EmboServer();
+
+    bool start();
+    void stop();
+
+    bool isRunning() const { return m_server->isListening(); }
+    QString getName() const { return m_name; }
+    QString getShmKey() const { return m_ring.getKey(); }
+    QString getError() const { return m_error; }
+
+private slots:
+    void on_newConnection();
+    void on_client_readyRead();
+    void on_client_disconnected();
+    void on_msg_result(const QByteArray data, bool isBinary);
+    void on_core_frameRx(const QString cmd, const QByteArray data);
+    void on_core_daqReady(Ready ready, int firstPos);
+    void on_core_cntrReady(const CntrData data);
+    void on_coreState_changed(const State state);
+
+private:
+    void request(QLocalSocket* client, const QByteArray& line);
+    void reply(QLocalSocket* client, const QByteArray& line);
+    QByteArray publish(const QString& cmd, const QByteArray& data);
+
+    Core* m_core;
+    QLocalServer* m_server;
+    ShmRing m_ring;
+    QString m_name;
+    QString m_error;
+    State m_state = DISCONNECTED;
+
+    /* clients */
+    QMap<QLocalSocket*, QByteArray> m_rxBuffers;
+    QList<QLocalSocket*> m_subscribers;
+    QMap<Msg_Raw*, QLocalSocket*> m_pending; // client is null when it left before response
+};
+
+#endif // SERVER_H
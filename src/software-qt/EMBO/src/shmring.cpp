@@ -0,0 +1,90 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "shmring.h"
+
+#include <string.h>
+
+
+ShmRing::ShmRing(const QString& key, int slots, int slotSize) : m_shm(key), m_slots(slots), m_slotSize(slotSize)
+{
+    m_stride = (sizeof(ShmRingSlot) + slotSize + SHM_RING_ALIGN - 1) / SHM_RING_ALIGN * SHM_RING_ALIGN;
+}
+
+ShmRing::~ShmRing()
+{
+    destroy();
+}
+
+bool ShmRing::create()
+{
+    if (m_shm.isAttached())
+        return true;
+
+    int size = SHM_RING_ALIGN + (m_slots * m_stride);
+
+    if (!m_shm.create(size))
+    {
+        if (m_shm.error() != QSharedMemory::AlreadyExists)
+            return false;
+
+        /* left by crashed instance on unix - last detach removes it */
+        if (m_shm.attach())
+            m_shm.detach();
+
+        if (!m_shm.create(size))
+            return false;
+    }
+
+    char* mem = (char*)m_shm.data();
+    memset(mem, 0, size);
+
+    m_header = (ShmRingHeader*)mem;
+    memcpy(m_header->magic, SHM_RING_MAGIC, sizeof(m_header->magic));
+    m_header->version = SHM_RING_VERSION;
+    m_header->slot_count = m_slots;
+    m_header->slot_size = m_slotSize;
+    m_header->slot_stride = m_stride;
+    m_header->slots_offset = SHM_RING_ALIGN;
+    m_header->seq.store(0, std::memory_order_release);
+
+    m_seq = 0;
+    return true;
+}
+
+void ShmRing::destroy()
+{
+    if (m_shm.isAttached())
+        m_shm.detach();
+
+    m_header = Q_NULLPTR;
+}
+
+uint64_t ShmRing::write(int device, double t_ms, const QString& cmd, const QByteArray& data)
+{
+    if (m_header == Q_NULLPTR || data.size() > m_slotSize)
+        return 0;
+
+    uint64_t seq = ++m_seq;
+    char* base = (char*)m_header + m_header->slots_offset + ((seq - 1) % m_slots) * m_stride;
+    ShmRingSlot* slot = (ShmRingSlot*)base;
+
+    slot->seq.store(0, std::memory_order_release); // readers of previous frame in slot must drop it
+    std::atomic_thread_fence(std::memory_order_release);
+
+    QByteArray cmd_raw = cmd.toLatin1();
+
+    slot->size = data.size();
+    slot->device = device;
+    slot->t_ms = t_ms;
+    memset(slot->cmd, 0, sizeof(slot->cmd));
+    memcpy(slot->cmd, cmd_raw.constData(), qMin((int)sizeof(slot->cmd) - 1, cmd_raw.size()));
+    memcpy(base + sizeof(ShmRingSlot), data.constData(), data.size());
+
+    slot->seq.store(seq, std::memory_order_release);
+    m_header->seq.store(seq, std::memory_order_release);
+
+    return seq;
+}
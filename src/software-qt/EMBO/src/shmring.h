@@ -0,0 +1,82 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef SHMRING_H
+#define SHMRING_H
+
+#include <QSharedMemory>
+#include <QString>
+#include <QByteArray>
+
+#include <atomic>
+#include <stdint.h>
+
+
+#define SHM_RING_MAGIC      "EMBR"
+#define SHM_RING_VERSION    1
+#define SHM_RING_SLOTS      16
+#define SHM_RING_SLOT_SIZE  (256 * 1024)    // payload bytes, largest :SCOP:READ of supported MCUs fits
+#define SHM_RING_ALIGN      64
+
+/* shared memory layout - one writer (EMBO), any number of readers, no locks:
+ *
+ *   ShmRingHeader | slot 0 | slot 1 | .. | slot N-1       slot = ShmRingSlot + payload, stride is slot_stride
+ *
+ * writer sets slot.seq = 0, copies payload, sets slot.seq = frame seq, then header.seq = frame seq.
+ * reader takes seq from notification (or header.seq), reads slot (seq - 1) % slot_count in place
+ * and accepts data only if slot.seq == seq both before and after reading - otherwise it was overwritten */
+
+#pragma pack(push, 1)
+struct ShmRingHeader
+{
+    char magic[4];                  // SHM_RING_MAGIC
+    uint32_t version;               // SHM_RING_VERSION
+    uint32_t slot_count;
+    uint32_t slot_size;             // max payload
+    uint32_t slot_stride;           // bytes from slot to next slot
+    uint32_t slots_offset;          // bytes from start of memory to slot 0
+    std::atomic<uint64_t> seq;      // last written frame from 1, 0 = none
+};
+
+struct ShmRingSlot
+{
+    std::atomic<uint64_t> seq;      // frame in slot, 0 = being written
+    uint32_t size;                  // payload bytes
+    uint16_t device;                // Core id
+    uint16_t reserved;
+    double t_ms;                    // aligned device time (Core::getAlignedTimeMs)
+    char cmd[16];                   // command of response, zero terminated
+};
+#pragma pack(pop)
+
+static_assert(sizeof(ShmRingHeader) % 8 == 0, "header must keep seq aligned");
+static_assert(sizeof(ShmRingSlot) % 8 == 0, "slot must keep seq aligned");
+
+class ShmRing
+{
+public:
+    explicit ShmRing(const QString& key, int slots = SHM_RING_SLOTS, int slotSize = SHM_RING_SLOT_SIZE);
+    ~ShmRing();
+
+    bool create();
+    void destroy();
+    uint64_t write(int device, double t_ms, const QString& cmd, const QByteArray& data); // seq, 0 = not written
+
+    bool isCreated() const { return m_shm.isAttached(); }
+    QString getKey() const { return m_shm.nativeKey(); } // for clients outside of Qt (file mapping name / ftok path)
+    QString getError() const { return m_shm.errorString(); }
+    int getSlots() const { return m_slots; }
+    int getSlotSize() const { return m_slotSize; }
+
+private:
+    QSharedMemory m_shm;
+    ShmRingHeader* m_header = Q_NULLPTR;
+    int m_slots;
+    int m_slotSize;
+    int m_stride;
+    uint64_t m_seq = 0;
+};
+
+#endif // SHMRING_H
@@ -0,0 +1,296 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "softtrig.h"
+
+#include <algorithm>
+#include <string.h>
+#include <assert.h>
+
+
+SoftTrigger::SoftTrigger()
+{
+}
+
+int SoftTrigger::find(const QVector<double>& t, QVector<double>* y[SOFTTRIG_CH_NUM])
+{
+    if (m_set.type == ST_PATTERN)
+    {
+        int n = t.size();
+
+        for (int ch = 0; ch < SOFTTRIG_CH_NUM; ch++)
+        {
+            if (m_set.pattern[ch] == SP_X)
+                continue;
+
+            if (y[ch] == NULL) // channel in pattern is disabled
+                return -1;
+
+            n = std::min(n, y[ch]->size());
+        }
+
+        return n < 2 ? -1 : findPattern(y, n);
+    }
+
+    assert(m_set.ch >= 0 && m_set.ch < SOFTTRIG_CH_NUM);
+
+    if (y[m_set.ch] == NULL)
+        return -1;
+
+    int n = std::min(t.size(), y[m_set.ch]->size());
+
+    if (n < 2)
+        return -1;
+
+    const double* t_data = t.constData();
+    const double* y_data = y[m_set.ch]->constData();
+
+    crossings(y_data, n, m_set.level_lo, m_state_lo, m_rise_lo, m_fall_lo);
+
+    if (m_set.type != ST_PULSE_WIDTH)
+        crossings(y_data, n, m_set.level_hi, m_state_hi, m_rise_hi, m_fall_hi);
+
+    switch (m_set.type)
+    {
+    case ST_PULSE_WIDTH: return findPulseWidth(t_data, y_data);
+    case ST_RUNT:        return findRunt(t_data, y_data);
+    case ST_WINDOW:      return findWindow();
+    case ST_SLOPE_TIME:  return findSlopeTime(t_data, y_data);
+    default:             return -1;
+    }
+}
+
+/* branchless, so compiler can vectorize it */
+void SoftTrigger::threshold(const double* y, int n, double level, uint8_t* out)
+{
+    for (int i = 0; i < n; i++)
+        out[i] = (uint8_t)(y[i] > level);
+}
+
+void SoftTrigger::transitions(const uint8_t* s, int n, std::vector<int>& rise, std::vector<int>& fall)
+{
+    rise.clear();
+    fall.clear();
+
+    int i = 1;
+
+    while (i < n)
+    {
+        if (i + 8 <= n) // compare 8 samples with their predecessors at once, most of them are equal
+        {
+            uint64_t prev, curr;
+            memcpy(&prev, s + i - 1, sizeof(uint64_t));
+            memcpy(&curr, s + i, sizeof(uint64_t));
+
+            if (prev == curr)
+            {
+                i += 8;
+                continue;
+            }
+        }
+
+        if (s[i] != s[i - 1])
+        {
+            if (s[i])
+                rise.push_back(i);
+            else
+                fall.push_back(i);
+        }
+
+        i++;
+    }
+}
+
+/* private */
+
+int SoftTrigger::findPulseWidth(const double* t, const double* y)
+{
+    const std::vector<int>& start = m_set.negative ? m_fall_lo : m_rise_lo;
+    const std::vector<int>& end = m_set.negative ? m_rise_lo : m_fall_lo;
+
+    size_t e = 0;
+
+    for (size_t s = 0; s < start.size(); s++)
+    {
+        while (e < end.size() && end[e] <= start[s])
+            e++;
+
+        if (e == end.size())
+            break;
+
+        double width = crossTime(t, y, end[e], m_set.level_lo) - crossTime(t, y, start[s], m_set.level_lo);
+
+        if (inLimits(width))
+            return end[e]; // trigger at pulse end, when width is known
+    }
+
+    return -1;
+}
+
+int SoftTrigger::findRunt(const double* t, const double* y)
+{
+    /* positive runt starts and ends at low level, negative at high level */
+
+    const std::vector<int>& start = m_set.negative ? m_fall_hi : m_rise_lo;
+    const std::vector<int>& end = m_set.negative ? m_rise_hi : m_fall_lo;
+    const std::vector<int>& over = m_set.negative ? m_fall_lo : m_rise_hi;
+    double level = m_set.negative ? m_set.level_hi : m_set.level_lo;
+
+    size_t e = 0;
+    size_t o = 0;
+
+    for (size_t s = 0; s < start.size(); s++)
+    {
+        while (e < end.size() && end[e] <= start[s])
+            e++;
+
+        if (e == end.size())
+            break;
+
+        while (o < over.size() && over[o] < start[s])
+            o++;
+
+        if (o < over.size() && over[o] <= end[e]) // reached other level, full pulse
+            continue;
+
+        double width = crossTime(t, y, end[e], level) - crossTime(t, y, start[s], level);
+
+        if (inLimits(width))
+            return end[e];
+    }
+
+    return -1;
+}
+
+int SoftTrigger::findWindow()
+{
+    const std::vector<int>& a = m_set.negative ? m_fall_hi : m_rise_hi;
+    const std::vector<int>& b = m_set.negative ? m_rise_lo : m_fall_lo;
+
+    if (a.empty())
+        return b.empty() ? -1 : b[0];
+
+    return b.empty() ? a[0] : std::min(a[0], b[0]);
+}
+
+int SoftTrigger::findSlopeTime(const double* t, const double* y)
+{
+    const std::vector<int>& from = m_set.negative ? m_fall_hi : m_rise_lo;
+    const std::vector<int>& to = m_set.negative ? m_fall_lo : m_rise_hi;
+    double level_from = m_set.negative ? m_set.level_hi : m_set.level_lo;
+    double level_to = m_set.negative ? m_set.level_lo : m_set.level_hi;
+
+    if (from.empty())
+        return -1;
+
+    size_t f = 0;
+
+    for (size_t i = 0; i < to.size(); i++)
+    {
+        while (f + 1 < from.size() && from[f + 1] <= to[i])
+            f++;
+
+        if (from[f] > to[i])
+            continue;
+
+        if (i > 0 && from[f] <= to[i - 1]) // no new transition since last one
+            continue;
+
+        double dt = crossTime(t, y, to[i], level_to) - crossTime(t, y, from[f], level_from);
+
+        if (inLimits(dt))
+            return to[i];
+    }
+
+    return -1;
+}
+
+int SoftTrigger::findPattern(QVector<double>* y[SOFTTRIG_CH_NUM], int n)
+{
+    m_state_lo.assign(n, 1);
+    uint8_t* match = m_state_lo.data();
+
+    for (int ch = 0; ch < SOFTTRIG_CH_NUM; ch++)
+    {
+        if (m_set.pattern[ch] == SP_X)
+            continue;
+
+        const double* data = y[ch]->constData();
+        const double level = m_set.level_lo;
+        const uint8_t inv = (m_set.pattern[ch] == SP_L);
+
+        for (int i = 0; i < n; i++)
+            match[i] &= (uint8_t)(data[i] > level) ^ inv;
+    }
+
+    transitions(match, n, m_rise_lo, m_fall_lo);
+
+    const std::vector<int>& edges = m_set.negative ? m_fall_lo : m_rise_lo;
+
+    return edges.empty() ? -1 : edges[0];
+}
+
+void SoftTrigger::crossings(const double* y, int n, double level, std::vector<uint8_t>& state, std::vector<int>& rise, std::vector<int>& fall)
+{
+    state.resize(n);
+    threshold(y, n, level, state.data());
+    transitions(state.data(), n, rise, fall);
+}
+
+bool SoftTrigger::inLimits(double dt) const
+{
+    return dt >= m_set.time_min && (m_set.time_max <= 0 || dt <= m_set.time_max);
+}
+
+double SoftTrigger::crossTime(const double* t, const double* y, int i, double level)
+{
+    assert(i > 0);
+
+    double dy = y[i] - y[i - 1];
+
+    if (dy == 0)
+        return t[i];
+
+    return t[i - 1] + ((level - y[i - 1]) / dy) * (t[i] - t[i - 1]);
+}
+
+/********************************* history *********************************/
+
+FrameHistory::FrameHistory(int depth)
+{
+    setDepth(depth);
+}
+
+void FrameHistory::setDepth(int depth)
+{
+    m_frames = QVector<HistoryFrame>(std::max(depth, 1));
+    m_head = 0;
+    m_count = 0;
+}
+
+void FrameHistory::clear()
+{
+    setDepth(m_frames.size());
+}
+
+void FrameHistory::push(const HistoryFrame& frame)
+{
+    m_frames[m_head] = frame;
+    m_head = (m_head + 1) % m_frames.size();
+
+    if (m_count < m_frames.size())
+        m_count++;
+}
+
+const HistoryFrame& FrameHistory::at(int back) const
+{
+    assert(back >= 0 && back < m_count);
+
+    int i = m_head - 1 - back;
+    if (i < 0)
+        i += m_frames.size();
+
+    return m_frames[i];
+}
@@ -0,0 +1,111 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef SOFTTRIG_H
+#define SOFTTRIG_H
+
+#include <QVector>
+
+#include <vector>
+#include <stdint.h>
+
+
+#define SOFTTRIG_CH_NUM         4
+#define SOFTTRIG_HISTORY_DEF    32      // frames kept for history playback
+
+
+enum SoftTrigType
+{
+    ST_PULSE_WIDTH,     // pulse between level crossings, width in time limits
+    ST_RUNT,            // pulse crosses low level, but not high level
+    ST_WINDOW,          // signal leaves (or enters) window between levels
+    ST_SLOPE_TIME,      // transition time between low and high level in time limits
+    ST_PATTERN          // logic state of all channels matches pattern
+};
+
+enum SoftTrigPattern
+{
+    SP_X,               // don't care
+    SP_L,               // below low level
+    SP_H                // above low level
+};
+
+struct SoftTrigSettings
+{
+    SoftTrigType type = ST_PULSE_WIDTH;
+    int ch = 0;
+    bool negative = false;          // negative pulse / falling slope / window enter / pattern exit
+    double level_lo = 1.0;          // [V], pulse width and pattern use low level only
+    double level_hi = 2.0;          // [V]
+    double time_min = 0;            // [s]
+    double time_max = 0;            // [s], 0 = no limit
+    SoftTrigPattern pattern[SOFTTRIG_CH_NUM] = { SP_H, SP_X, SP_X, SP_X };
+};
+
+/* host side trigger - searches decoded frame for complex trigger condition */
+
+class SoftTrigger
+{
+public:
+    SoftTrigger();
+
+    void setSettings(const SoftTrigSettings& settings) { m_set = settings; }
+    const SoftTrigSettings& getSettings() const { return m_set; }
+
+    int find(const QVector<double>& t, QVector<double>* y[SOFTTRIG_CH_NUM]);
+
+    static void threshold(const double* y, int n, double level, uint8_t* out);
+    static void transitions(const uint8_t* s, int n, std::vector<int>& rise, std::vector<int>& fall);
+
+private:
+    int findPulseWidth(const double* t, const double* y);
+    int findRunt(const double* t, const double* y);
+    int findWindow();
+    int findSlopeTime(const double* t, const double* y);
+    int findPattern(QVector<double>* y[SOFTTRIG_CH_NUM], int n);
+
+    void crossings(const double* y, int n, double level, std::vector<uint8_t>& state, std::vector<int>& rise, std::vector<int>& fall);
+    bool inLimits(double dt) const;
+    static double crossTime(const double* t, const double* y, int i, double level);
+
+    SoftTrigSettings m_set;
+
+    /* work buffers - reused between frames, so search does not allocate */
+    std::vector<uint8_t> m_state_lo;
+    std::vector<uint8_t> m_state_hi;
+    std::vector<int> m_rise_lo;
+    std::vector<int> m_fall_lo;
+    std::vector<int> m_rise_hi;
+    std::vector<int> m_fall_hi;
+};
+
+/* ring of last N displayed frames, data are implicitly shared, so push is cheap */
+
+struct HistoryFrame
+{
+    QVector<double> t;
+    QVector<double> y[SOFTTRIG_CH_NUM];
+};
+
+class FrameHistory
+{
+public:
+    FrameHistory(int depth = SOFTTRIG_HISTORY_DEF);
+
+    void setDepth(int depth);
+    int getDepth() const { return m_frames.size(); }
+    int getCount() const { return m_count; }
+    void clear();
+
+    void push(const HistoryFrame& frame);
+    const HistoryFrame& at(int back) const; // 0 = newest
+
+private:
+    QVector<HistoryFrame> m_frames;
+    int m_head = 0;
+    int m_count = 0;
+};
+
+#endif // SOFTTRIG_H
@@ -0,0 +1,126 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef STREAMSTATS_H
+#define STREAMSTATS_H
+
+#include <vector>
+#include <deque>
+#include <utility>
+#include <stdint.h>
+
+
+/* O(1) statistics over last N values - mean and variance updated by Welford,
+ * min and max kept in monotonic deques (amortized O(1)) */
+
+template <class T>
+class StreamStats
+{
+public:
+    StreamStats(int size = 1) { setSize(size); }
+    bool setSize(int size);
+    void addVal(T const& val);
+    void reset();
+
+    int getCount() const { return m_cnt; }
+    double getMean() const { return m_mean; }
+    double getMean(T const& val) { addVal(val); return m_mean; }
+    double getVariance() const { return m_cnt > 1 ? m_m2 / (m_cnt - 1) : 0; }
+    double getMax() const { return m_max.empty() ? 0 : (double)m_max.front().second; }
+    double getMin() const { return m_min.empty() ? 0 : (double)m_min.front().second; }
+
+private:
+    std::vector<T> m_buff;
+    std::deque<std::pair<uint64_t,T>> m_max;    // decreasing values, front is max
+    std::deque<std::pair<uint64_t,T>> m_min;    // increasing values, front is min
+    uint64_t m_idx = 0;                         // values added since reset
+    int m_it = 0;
+    int m_cnt = 0;
+    int m_sz = 1;
+    double m_mean = 0;
+    double m_m2 = 0;                            // sum of squared differences from mean
+};
+
+template <class T>
+bool StreamStats<T>::setSize(int size)
+{
+    if (size < 1)
+        return false;
+
+    m_sz = size;
+    reset();
+
+    return true;
+}
+
+template <class T>
+void StreamStats<T>::addVal(T const& val)
+{
+    /* remove oldest value from mean and variance */
+
+    if (m_cnt == m_sz)
+    {
+        double old = (double)m_buff[m_it];
+
+        if (--m_cnt == 0)
+        {
+            m_mean = 0;
+            m_m2 = 0;
+        }
+        else
+        {
+            double delta = old - m_mean;
+            m_mean -= delta / m_cnt;
+            m_m2 -= delta * (old - m_mean);
+        }
+    }
+
+    /* add new value */
+
+    m_buff[m_it] = val;
+
+    if (++m_it >= m_sz)
+        m_it = 0;
+
+    double delta = (double)val - m_mean;
+    m_cnt++;
+    m_mean += delta / m_cnt;
+    m_m2 += delta * ((double)val - m_mean);
+
+    if (m_m2 < 0) // rounding after removals
+        m_m2 = 0;
+
+    /* windowed min and max */
+
+    while (!m_max.empty() && m_max.back().second <= val)
+        m_max.pop_back();
+    m_max.emplace_back(m_idx, val);
+
+    while (!m_min.empty() && m_min.back().second >= val)
+        m_min.pop_back();
+    m_min.emplace_back(m_idx, val);
+
+    if (m_max.front().first + m_sz <= m_idx)
+        m_max.pop_front();
+    if (m_min.front().first + m_sz <= m_idx)
+        m_min.pop_front();
+
+    m_idx++;
+}
+
+template <class T>
+void StreamStats<T>::reset()
+{
+    m_buff.assign(m_sz, T());
+    m_max.clear();
+    m_min.clear();
+    m_idx = 0;
+    m_it = 0;
+    m_cnt = 0;
+    m_mean = 0;
+    m_m2 = 0;
+}
+
+#endif // STREAMSTATS_H
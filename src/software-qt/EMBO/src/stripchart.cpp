@@ -0,0 +1,44 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "stripchart.h"
+
+
+StripChart::StripChart(int capacity) : m_cap(qMax(2, capacity))
+{
+    setAutoSqueeze(false); // squeeze would move the window out of the ring
+    reset();
+}
+
+void StripChart::append(double key, double value)
+{
+    if (mData.size() < m_cap || (!isEmpty() && key < (constEnd() - 1)->key))
+        reset();
+
+    int count = qMin(size() + 1, m_cap);
+    int p = mData.size() - m_cap;
+
+    mData[p] = QCPGraphData(key, value);    // lower mirror, read after wrap
+    mData.append(QCPGraphData(key, value)); // upper - within reserved capacity
+
+    if (mData.size() == 2 * m_cap)
+        mData.resize(m_cap);                // wrap, lower half holds the same values
+
+    mPreallocSize = mData.size() - count;
+}
+
+void StripChart::evictBefore(double key)
+{
+    while (!isEmpty() && constBegin()->key < key)
+        mPreallocSize++;
+}
+
+void StripChart::reset()
+{
+    mData.reserve(2 * m_cap);
+    mData.resize(m_cap);
+    mPreallocSize = m_cap;
+    mPreallocIteration = 0;
+}
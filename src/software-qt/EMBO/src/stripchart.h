@@ -0,0 +1,38 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef STRIPCHART_H
+#define STRIPCHART_H
+
+#include "lib/qcustomplot.h"
+
+
+#define STRIP_CAP_DEFAULT   8192
+
+/* fixed capacity rolling graph data for strip charts - QCPGraph draws it directly via setData.
+ * mirrored ring: every value is written to slot p and p + cap of buffer reserved for 2 * cap,
+ * so last count values are always contiguous [size - count, size) and QCP iterators stay valid:
+ *
+ *   append - O(1), buffer end shrinks back to cap when it reaches 2 * cap (no reallocation),
+ *   evict  - O(1) per removed value, only begin of window (mPreallocSize) is moved.
+ *
+ * keys must not decrease, older key restarts the chart. base clear() is safe, ring is rebuilt. */
+
+class StripChart : public QCPGraphDataContainer
+{
+public:
+    explicit StripChart(int capacity = STRIP_CAP_DEFAULT);
+
+    void append(double key, double value);
+    void evictBefore(double key);
+    void reset();
+
+    int capacity() const { return m_cap; }
+
+private:
+    int m_cap;
+};
+
+#endif // STRIPCHART_H
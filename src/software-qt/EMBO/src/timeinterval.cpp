@@ -0,0 +1,236 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "timeinterval.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+
+void TimeInterval::clear()
+{
+    m_periods.clear();
+    m_duty.clear();
+    m_tieTime.clear();
+    m_tie.clear();
+    m_captures = 0;
+}
+
+/* returns false if capture has less than 2 edges */
+bool TimeInterval::addCapture(const CntrRaw& raw)
+{
+    double tick = (double)raw.timDiv / raw.fTim;
+    QVector<qint64> rise, fall;
+
+    if (raw.duty)
+        extendDuty(raw, rise, fall);
+    else
+        rise = extendEdges(raw);
+
+    if (rise.size() < 2)
+        return false;
+
+    /* differences of 64-bit ticks are exact, one pass without branches - vectorized by compiler.
+     * with IC prescaler every capture is psc input periods, period is their mean */
+    int n = rise.size() - 1;
+    double k = raw.duty ? tick : tick / raw.icPsc;
+    QVector<double> periods(n);
+
+    for (int i = 0; i < n; i++)
+        periods[i] = (double)(rise[i + 1] - rise[i]) * k;
+
+    append(m_periods, periods);
+
+    if (raw.duty)
+    {
+        int nd = std::min(n, fall.size());
+        QVector<double> duty(nd);
+
+        for (int i = 0; i < nd; i++)
+            duty[i] = 100.0 * (double)(fall[i] - rise[i]) / (double)(rise[i + 1] - rise[i]);
+
+        append(m_duty, duty);
+    }
+
+    computeTie(rise, tick);
+    m_captures++;
+
+    return true;
+}
+
+QVector<qint64> TimeInterval::extendEdges(const CntrRaw& raw)
+{
+    int n = std::min(raw.ccr.size(), raw.aux.size());
+    bool known = raw.ovfPre <= raw.ovfPost; // device saw at least one ovf store write
+    QVector<qint64> ts(n);
+    qint64 high = 0;                        // 32-bit wraps
+    qint64 period = 0;                      // last period, predicts ambiguous edge
+
+    for (int i = 0; i < n; i++)
+    {
+        quint16 ccr = raw.ccr[i];
+        quint32 v0 = ((quint32)raw.aux[i] << 16) | ccr;
+        quint32 v1 = ((quint32)(quint16)(raw.aux[i] + 1) << 16) | ccr;
+        quint32 v = v0;
+
+        if (known && ccr < raw.ovfPre) // captured before ovf store write
+        {
+            v = v1;
+        }
+        else if (known && ccr < raw.ovfPost && i > 0)
+        {
+            quint32 pred = (quint32)(ts[i - 1] + period);
+            v = std::abs((qint64)(qint32)(v0 - pred)) <= std::abs((qint64)(qint32)(v1 - pred)) ? v0 : v1;
+        }
+
+        qint64 t = high + v;
+
+        if (i > 0 && t < ts[i - 1])
+        {
+            high += (qint64)1 << 32;
+            t += (qint64)1 << 32;
+        }
+
+        if (i > 0)
+            period = t - ts[i - 1];
+        ts[i] = t;
+    }
+    return ts;
+}
+
+/* period of prescaled timer is below 2^15 ticks, so 16-bit difference of consecutive edges is unambiguous */
+void TimeInterval::extendDuty(const CntrRaw& raw, QVector<qint64>& rise, QVector<qint64>& fall)
+{
+    int nr = raw.ccr.size();
+
+    rise.clear();
+    fall.clear();
+
+    if (nr < 2)
+        return;
+
+    rise.resize(nr);
+    rise[0] = raw.ccr[0];
+
+    for (int i = 1; i < nr; i++)
+        rise[i] = rise[i - 1] + (quint16)(raw.ccr[i] - raw.ccr[i - 1]);
+
+    /* falling edge captured before first rising one belongs to previous period */
+    int skip = (!raw.aux.isEmpty() && (quint16)(raw.aux[0] - raw.ccr[0]) >= (quint16)(raw.ccr[1] - raw.ccr[0])) ? 1 : 0;
+    int nf = std::min(nr, raw.aux.size() - skip);
+
+    if (nf <= 0)
+        return;
+
+    fall.resize(nf);
+
+    for (int i = 0; i < nf; i++)
+        fall[i] = rise[i] + (quint16)(raw.aux[i + skip] - raw.ccr[i]);
+}
+
+/* keys are bin centers */
+void TimeInterval::histogram(const QVector<double>& vals, int bins, QVector<double>& keys, QVector<double>& counts)
+{
+    keys.clear();
+    counts.clear();
+
+    if (vals.isEmpty() || bins < 1)
+        return;
+
+    auto range = std::minmax_element(vals.constBegin(), vals.constEnd());
+    double lo = *range.first;
+    double span = *range.second - lo;
+
+    if (span <= 0) // all equal - one bin
+    {
+        keys.append(lo);
+        counts.append(vals.size());
+        return;
+    }
+
+    double width = span / bins;
+
+    keys.resize(bins);
+    counts.fill(0, bins);
+
+    for (int i = 0; i < bins; i++)
+        keys[i] = lo + (i + 0.5) * width;
+
+    for (double val : vals)
+        counts[std::min(bins - 1, (int)((val - lo) / width))] += 1;
+}
+
+double TimeInterval::mean(const QVector<double>& vals)
+{
+    if (vals.isEmpty())
+        return 0;
+
+    double sum = 0;
+    for (double val : vals)
+        sum += val;
+
+    return sum / vals.size();
+}
+
+double TimeInterval::stdDev(const QVector<double>& vals)
+{
+    if (vals.size() < 2)
+        return 0;
+
+    double m = mean(vals);
+    double sum = 0;
+
+    for (double val : vals)
+        sum += (val - m) * (val - m);
+
+    return std::sqrt(sum / (vals.size() - 1));
+}
+
+/* private */
+
+void TimeInterval::append(QVector<double>& dst, const QVector<double>& src)
+{
+    dst += src;
+
+    if (dst.size() > TI_MAX_VALS)
+        dst.remove(0, dst.size() - TI_MAX_VALS);
+}
+
+/* TIE against least squares line through edges - removes frequency offset, leaves phase noise */
+void TimeInterval::computeTie(const QVector<qint64>& ts, double tick)
+{
+    int n = ts.size();
+    double im = (n - 1) / 2.0;
+    double tm = 0;
+    QVector<double> y(n);
+
+    for (int i = 0; i < n; i++)
+    {
+        y[i] = (double)(ts[i] - ts[0]); // exact up to 2^53 ticks
+        tm += y[i];
+    }
+    tm /= n;
+
+    double sxy = 0;
+    double sxx = 0;
+
+    for (int i = 0; i < n; i++)
+    {
+        sxy += (i - im) * (y[i] - tm);
+        sxx += (i - im) * (i - im);
+    }
+
+    double slope = sxy / sxx;
+
+    m_tieTime.resize(n);
+    m_tie.resize(n);
+
+    for (int i = 0; i < n; i++)
+    {
+        m_tieTime[i] = y[i] * tick;
+        m_tie[i] = (y[i] - (tm + slope * (i - im))) * tick;
+    }
+}
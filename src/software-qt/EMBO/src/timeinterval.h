@@ -0,0 +1,59 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef TIMEINTERVAL_H
+#define TIMEINTERVAL_H
+
+#include "containers.h"
+
+#include <QVector>
+
+
+#define TI_MAX_VALS     100000      // accumulated periods / duty cycles, oldest dropped
+#define TI_HIST_BINS    60
+
+/* time interval analysis of raw counter captures :CNTR:RAW? - device sends 16-bit captures only,
+ * here they are extended to 64-bit timer ticks:
+ *
+ *   edges - ovf:ccr, ovf store older than capture is recognized by ccr below counter range of its write,
+ *           ambiguous ccr inside that range takes the candidate closer to previous period, 32-bit wraps by order
+ *   duty  - timer is prescaled so period < half of 16-bit range, edges are unwrapped by 16-bit differences
+ *
+ * periods and duty cycles are accumulated over captures for histograms, TIE (time interval error) is
+ * deviation of last capture edges from least squares ideal clock. */
+
+class TimeInterval
+{
+public:
+    TimeInterval() {};
+
+    void clear();
+    bool addCapture(const CntrRaw& raw);
+
+    const QVector<double>& getPeriods() const { return m_periods; }
+    const QVector<double>& getDuty() const { return m_duty; }
+    const QVector<double>& getTieTime() const { return m_tieTime; }
+    const QVector<double>& getTie() const { return m_tie; }
+    int getCaptures() const { return m_captures; }
+    bool hasDuty() const { return !m_duty.isEmpty(); }
+
+    static QVector<qint64> extendEdges(const CntrRaw& raw);
+    static void extendDuty(const CntrRaw& raw, QVector<qint64>& rise, QVector<qint64>& fall);
+    static void histogram(const QVector<double>& vals, int bins, QVector<double>& keys, QVector<double>& counts);
+    static double mean(const QVector<double>& vals);
+    static double stdDev(const QVector<double>& vals);
+
+private:
+    void append(QVector<double>& dst, const QVector<double>& src);
+    void computeTie(const QVector<qint64>& ts, double tick);
+
+    QVector<double> m_periods;  // [s]
+    QVector<double> m_duty;     // [%]
+    QVector<double> m_tieTime;  // [s] from first edge of last capture
+    QVector<double> m_tie;      // [s]
+    int m_captures = 0;
+};
+
+#endif // TIMEINTERVAL_H
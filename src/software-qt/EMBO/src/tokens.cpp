@@ -0,0 +1,177 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "tokens.h"
+
+#include <math.h>
+#include <string.h>
+#include <stdint.h>
+
+
+MsgTokens::MsgTokens(const QByteArray& data, char delim) : m_data(data.constData())
+{
+    const int sz = data.size();
+    int from = 0;
+
+    for (int i = 0; i <= sz; i++)
+    {
+        if (i < sz && m_data[i] != delim)
+            continue;
+
+        if (i > from) // skip empty parts
+        {
+            if (m_cnt == TOKENS_MAX)
+            {
+                m_overflow = true;
+                return;
+            }
+
+            m_begin[m_cnt] = from;
+            m_len[m_cnt] = i - from;
+            m_cnt++;
+        }
+
+        from = i + 1;
+    }
+}
+
+bool MsgTokens::equals(int i, const char* str) const
+{
+    int n = (int)strlen(str);
+    return n == m_len[i] && memcmp(data(i), str, n) == 0;
+}
+
+bool MsgTokens::contains(int i, char c) const
+{
+    return memchr(data(i), c, m_len[i]) != NULL;
+}
+
+int MsgTokens::toInt(int i, bool* ok) const
+{
+    return parse<int>(i, ok);
+}
+
+double MsgTokens::toDouble(int i, bool* ok) const
+{
+    return parse<double>(i, ok);
+}
+
+template <typename T> T MsgTokens::parse(int i, bool* ok) const
+{
+    const char* first = data(i);
+    const char* last = first + m_len[i];
+
+    while (first < last && *first == ' ') // same as QString, ignore surrounding spaces
+        first++;
+    while (last > first && *(last - 1) == ' ')
+        last--;
+
+    T value = 0;
+    const char* end = fromChars(first, last, value);
+    bool valid = (end == last && end != first);
+
+    if (ok != nullptr)
+        *ok = valid;
+
+    return valid ? value : 0;
+}
+
+const char* MsgTokens::fromChars(const char* first, const char* last, int& value)
+{
+    const char* it = first;
+    bool neg = false;
+
+    if (it < last && (*it == '-' || *it == '+'))
+        neg = (*it++ == '-');
+
+    const char* digits = it;
+    int64_t acc = 0;
+
+    for (; it < last && *it >= '0' && *it <= '9'; it++)
+    {
+        acc = acc * 10 + (*it - '0');
+
+        if (acc > 0x80000000LL) // out of range
+            return first;
+    }
+
+    if (it == digits || (!neg && acc > 0x7FFFFFFFLL))
+        return first;
+
+    value = (int)(neg ? -acc : acc);
+    return it;
+}
+
+const char* MsgTokens::fromChars(const char* first, const char* last, double& value)
+{
+    static const double pow10[] = { 1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+    const char* it = first;
+    bool neg = false;
+
+    if (it < last && (*it == '-' || *it == '+'))
+        neg = (*it++ == '-');
+
+    uint64_t mant = 0;
+    int mant_digits = 0;
+    int exp10 = 0;
+    bool any = false;
+
+    for (; it < last && *it >= '0' && *it <= '9'; it++, any = true)
+    {
+        if (mant_digits < 19)
+        {
+            mant = mant * 10 + (*it - '0');
+            if (mant != 0)
+                mant_digits++;
+        }
+        else
+            exp10++; // beyond precision, only scale
+    }
+
+    if (it < last && *it == '.')
+    {
+        for (it++; it < last && *it >= '0' && *it <= '9'; it++, any = true)
+        {
+            if (mant_digits < 19)
+            {
+                mant = mant * 10 + (*it - '0');
+                if (mant != 0)
+                    mant_digits++;
+                exp10--;
+            }
+        }
+    }
+
+    if (!any)
+        return first;
+
+    if (it < last && (*it == 'e' || *it == 'E'))
+    {
+        int exp_val = 0;
+        const char* exp_end = fromChars(it + 1, last, exp_val);
+
+        if (exp_end != it + 1) // otherwise 'e' is not part of number
+        {
+            exp10 += exp_val;
+            it = exp_end;
+        }
+    }
+
+    double result = (double)mant;
+
+    if (exp10 == 0 || mant == 0)
+        ;
+    else if (exp10 > 0 && exp10 <= 22 && mant < (1ULL << 53)) // exact
+        result *= pow10[exp10];
+    else if (exp10 < 0 && exp10 >= -22 && mant < (1ULL << 53)) // exact
+        result /= pow10[-exp10];
+    else
+        result *= pow(10.0, exp10);
+
+    value = neg ? -result : result;
+    return it;
+}
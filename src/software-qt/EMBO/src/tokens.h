@@ -0,0 +1,50 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef TOKENS_H
+#define TOKENS_H
+
+#include <QByteArray>
+#include <QString>
+
+
+#define TOKENS_MAX      24      // max fields in one response
+
+/* zero-allocation tokenizer - tokens are only offsets into source bytes, which must outlive tokens */
+
+class MsgTokens
+{
+public:
+    MsgTokens(const QByteArray& data, char delim = ',');
+
+    int size() const { return m_cnt; }
+    bool overflow() const { return m_overflow; }
+
+    const char* data(int i) const { return m_data + m_begin[i]; }
+    int len(int i) const { return m_len[i]; }
+    char at(int i, int k) const { return k < m_len[i] ? m_data[m_begin[i] + k] : '\0'; }
+
+    bool equals(int i, const char* str) const;
+    bool contains(int i, char c) const;
+
+    int toInt(int i, bool* ok = nullptr) const;
+    double toDouble(int i, bool* ok = nullptr) const;
+    QString toString(int i) const { return QString::fromLatin1(data(i), len(i)); }
+
+    /* std::from_chars style - returns pointer past last parsed char, or first if nothing was parsed */
+    static const char* fromChars(const char* first, const char* last, int& value);
+    static const char* fromChars(const char* first, const char* last, double& value);
+
+private:
+    template <typename T> T parse(int i, bool* ok) const;
+
+    const char* m_data;
+    int m_begin[TOKENS_MAX];
+    int m_len[TOKENS_MAX];
+    int m_cnt = 0;
+    bool m_overflow = false;
+};
+
+#endif // TOKENS_H
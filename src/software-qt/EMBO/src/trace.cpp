@@ -0,0 +1,298 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "trace.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include <chrono>
+#include <algorithm>
+#include <signal.h>
+#include <string.h>
+#include <fcntl.h>
+
+#ifdef Q_OS_WIN
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <io.h>
+#include <sys/stat.h>
+#define TRACE_OPEN(path)        _open(path, _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE)
+#define TRACE_WRITE(fd, p, len) _write(fd, p, len)
+#define TRACE_CLOSE(fd)         _close(fd)
+#else
+#include <unistd.h>
+#define TRACE_OPEN(path)        open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644)
+#define TRACE_WRITE(fd, p, len) write(fd, p, len)
+#define TRACE_CLOSE(fd)         close(fd)
+#endif
+
+
+static const std::chrono::steady_clock::time_point s_start = std::chrono::steady_clock::now();
+
+static const char* const s_event_names[] = { "TX", "RX", "RX_BIN", "READY", "TIMEOUT", "ERR" };
+
+TraceRecord Trace::s_ring[TRACE_SIZE];
+std::atomic<uint32_t> Trace::s_head(0);
+std::atomic<int> Trace::s_level(TRACE_COMM);
+std::atomic<uint64_t> Trace::s_last_tx(0);
+char Trace::s_crash_path[512] = { 0 };
+
+/* crash handlers chain to the ones installed before (Breakpad), so its minidump is still written */
+static std::atomic_flag s_crashed = ATOMIC_FLAG_INIT;
+#ifdef Q_OS_WIN
+static LPTOP_LEVEL_EXCEPTION_FILTER s_prev_filter = NULL;
+static void (*s_prev_abort)(int) = SIG_DFL;
+#else
+static const int s_signals[] = { SIGSEGV, SIGABRT, SIGFPE, SIGILL, SIGBUS };
+static struct sigaction s_prev[sizeof(s_signals) / sizeof(s_signals[0])];
+#endif
+
+#ifdef Q_OS_WIN
+static LONG WINAPI onException(EXCEPTION_POINTERS* info);
+static void onAbort(int sig);
+#else
+static void onCrash(int sig, siginfo_t* info, void* ctx);
+#endif
+
+
+void Trace::record(TraceLevel level, TraceEvent event, const char* tag, int tag_len, uint32_t size, uint16_t count)
+{
+    if (!enabled(level))
+        return;
+
+    uint64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s_start).count();
+    uint32_t latency_us = 0;
+
+    if (event == TR_TX)
+    {
+        uint64_t last = s_last_tx.exchange(now, std::memory_order_relaxed);
+        latency_us = last == 0 ? 0 : (uint32_t)((now - last) / 1000);
+    }
+    else if (event == TR_RX || event == TR_RX_BIN)
+    {
+        latency_us = (uint32_t)((now - s_last_tx.load(std::memory_order_relaxed)) / 1000);
+    }
+
+    /* claim slot, invalidate it, fill it, publish it */
+
+    uint32_t idx = s_head.fetch_add(1, std::memory_order_relaxed);
+    TraceRecord& rec = s_ring[idx & (TRACE_SIZE - 1)];
+
+    rec.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    rec.t_ns = now;
+    rec.size = size;
+    rec.latency_us = latency_us;
+    rec.event = (uint16_t)event;
+    rec.count = count;
+
+    int len = std::min(std::max(tag_len, 0), TRACE_TAG_LEN);
+    memcpy(rec.tag, tag, len);
+    if (len < TRACE_TAG_LEN)
+        rec.tag[len] = '\0';
+
+    rec.seq.store(idx + 1, std::memory_order_release);
+}
+
+bool Trace::dump(const QString& path)
+{
+    int fd = TRACE_OPEN(QFile::encodeName(path).constData());
+
+    if (fd < 0)
+        return false;
+
+    dumpRaw(fd);
+
+    return TRACE_CLOSE(fd) == 0;
+}
+
+void Trace::installCrashHandler(const QString& path)
+{
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    QByteArray path_raw = QFile::encodeName(path);
+    strncpy(s_crash_path, path_raw.constData(), sizeof(s_crash_path) - 1);
+
+#ifdef Q_OS_WIN
+    /* crashes are SEH exceptions, Breakpad filter is called after the dump */
+    s_prev_filter = SetUnhandledExceptionFilter(onException);
+    s_prev_abort = signal(SIGABRT, onAbort);
+#else
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sigemptyset(&sa.sa_mask);
+    sa.sa_sigaction = onCrash;
+    sa.sa_flags = SA_SIGINFO | SA_ONSTACK;
+
+    for (size_t i = 0; i < sizeof(s_signals) / sizeof(s_signals[0]); i++)
+        sigaction(s_signals[i], &sa, &s_prev[i]);
+#endif
+}
+
+/* private */
+
+/* async-signal-safe: no allocation, no stdio, only write() */
+void Trace::dumpRaw(int fd)
+{
+    static const char head[] = "t_ms,event,tag,size,latency_us,count\n";
+    char buff[2048];
+    int len = sizeof(head) - 1;
+
+    memcpy(buff, head, len);
+
+    uint32_t head_idx = s_head.load(std::memory_order_acquire);
+    uint32_t from = head_idx > TRACE_SIZE ? head_idx - TRACE_SIZE : 0;
+
+    for (uint32_t idx = from; idx < head_idx; idx++)
+    {
+        if (len > (int)sizeof(buff) - TRACE_LINE_LEN)
+        {
+            if (TRACE_WRITE(fd, buff, len) != len)
+                return;
+            len = 0;
+        }
+
+        len += formatLine(buff + len, s_ring[idx & (TRACE_SIZE - 1)], idx);
+    }
+
+    if (len > 0)
+        TRACE_WRITE(fd, buff, len);
+}
+
+static char* putUInt(char* p, uint64_t val, int min_digits = 1)
+{
+    char tmp[20];
+    int n = 0;
+
+    do
+    {
+        tmp[n++] = '0' + (char)(val % 10);
+        val /= 10;
+    } while (val > 0 || n < min_digits);
+
+    while (n > 0)
+        *p++ = tmp[--n];
+
+    return p;
+}
+
+/* one CSV line of complete record, at most TRACE_LINE_LEN chars, 0 = record not complete or overwritten */
+int Trace::formatLine(char* buff, const TraceRecord& rec, uint32_t idx)
+{
+    if (rec.seq.load(std::memory_order_acquire) != idx + 1)
+        return 0;
+
+    uint64_t t_ns = rec.t_ns;
+    uint32_t size = rec.size;
+    uint32_t latency_us = rec.latency_us;
+    uint16_t event = rec.event;
+    uint16_t count = rec.count;
+    char tag[TRACE_TAG_LEN];
+    memcpy(tag, rec.tag, TRACE_TAG_LEN);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    if (rec.seq.load(std::memory_order_relaxed) != idx + 1) // overwritten while reading
+        return 0;
+
+    const char* name = event < 6 ? s_event_names[event] : "?";
+    char* p = buff;
+
+    p = putUInt(p, t_ns / 1000000);
+    *p++ = '.';
+    p = putUInt(p, t_ns % 1000000, 6);
+    *p++ = ',';
+    while (*name)
+        *p++ = *name++;
+    *p++ = ',';
+    for (int i = 0; i < TRACE_TAG_LEN && tag[i] != '\0'; i++)
+        *p++ = tag[i];
+    *p++ = ',';
+    p = putUInt(p, size);
+    *p++ = ',';
+    p = putUInt(p, latency_us);
+    *p++ = ',';
+    p = putUInt(p, count);
+    *p++ = '\n';
+
+    return (int)(p - buff);
+}
+
+/* best effort, once, process is going down anyway - async-signal-safe */
+void Trace::crashDump()
+{
+    if (s_crashed.test_and_set() || s_crash_path[0] == '\0')
+        return;
+
+    int fd = TRACE_OPEN(s_crash_path);
+
+    if (fd >= 0)
+    {
+        dumpRaw(fd);
+        TRACE_CLOSE(fd);
+    }
+}
+
+#ifdef Q_OS_WIN
+
+static LONG WINAPI onException(EXCEPTION_POINTERS* info)
+{
+    Trace::crashDump();
+
+    return s_prev_filter != NULL ? s_prev_filter(info) : EXCEPTION_CONTINUE_SEARCH;
+}
+
+static void onAbort(int sig)
+{
+    Trace::crashDump();
+
+    if (s_prev_abort != SIG_DFL && s_prev_abort != SIG_IGN && s_prev_abort != SIG_ERR)
+    {
+        s_prev_abort(sig);
+        return;
+    }
+
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+#else
+
+static void onCrash(int sig, siginfo_t* info, void* ctx)
+{
+    Trace::crashDump();
+
+    size_t i = 0;
+    while (i < sizeof(s_signals) / sizeof(s_signals[0]) - 1 && s_signals[i] != sig)
+        i++;
+
+    const struct sigaction& prev = s_prev[i];
+
+    if ((prev.sa_flags & SA_SIGINFO) && prev.sa_sigaction != NULL)
+    {
+        prev.sa_sigaction(sig, info, ctx);
+        return;
+    }
+
+    if (!(prev.sa_flags & SA_SIGINFO) && prev.sa_handler != SIG_DFL && prev.sa_handler != SIG_IGN)
+    {
+        prev.sa_handler(sig);
+        return;
+    }
+
+    /* default action: a fault returns and repeats the instruction under it (core dump keeps the
+     * faulting context), a signal sent by kill or raise has to be sent again */
+    sigaction(sig, &prev, NULL);
+
+    if (info == NULL || info->si_code <= 0)
+        raise(sig);
+}
+
+#endif
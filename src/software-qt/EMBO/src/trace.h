@@ -0,0 +1,77 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QString>
+
+#include <atomic>
+#include <stdint.h>
+
+
+#define TRACE_SIZE          4096    // records in ring, must be power of 2
+#define TRACE_TAG_LEN       12      // command chars kept per record
+#define TRACE_CRASH_FILE    "crashes/trace.csv"
+#define TRACE_LINE_LEN      96      // one formatted CSV line
+
+enum TraceLevel
+{
+    TRACE_OFF     = 0,
+    TRACE_ERR     = 1,      // errors and timeouts only
+    TRACE_COMM    = 2,      // every sent and received message, binary only
+    TRACE_VERBOSE = 3       // as COMM, plus formatted qInfo() output
+};
+
+enum TraceEvent
+{
+    TR_TX,
+    TR_RX,
+    TR_RX_BIN,
+    TR_READY,
+    TR_TIMEOUT,
+    TR_ERR
+};
+
+/* one event, no formatting is done when recorded */
+struct TraceRecord
+{
+    uint64_t t_ns;                  // since trace start
+    uint32_t size;                  // payload bytes
+    uint32_t latency_us;            // RX: since last TX, TX: since previous TX
+    uint16_t event;
+    uint16_t count;                 // TX: commands in message
+    char tag[TRACE_TAG_LEN];
+    std::atomic<uint32_t> seq;      // written last, reader checks record is complete
+};
+
+/* lock-free in-memory trace ring of comm layer */
+
+class Trace
+{
+public:
+    static void setLevel(TraceLevel level) { s_level.store(level, std::memory_order_relaxed); }
+    static TraceLevel getLevel() { return (TraceLevel)s_level.load(std::memory_order_relaxed); }
+    static bool enabled(TraceLevel level) { return s_level.load(std::memory_order_relaxed) >= level; }
+
+    static void record(TraceLevel level, TraceEvent event, const char* tag, int tag_len,
+                       uint32_t size = 0, uint16_t count = 0);
+
+    static bool dump(const QString& path);
+    static void installCrashHandler(const QString& path = TRACE_CRASH_FILE);
+    static void crashDump();
+
+private:
+    static void dumpRaw(int fd);
+    static int formatLine(char* buff, const TraceRecord& rec, uint32_t idx);
+
+    static TraceRecord s_ring[TRACE_SIZE];
+    static std::atomic<uint32_t> s_head;
+    static std::atomic<int> s_level;
+    static std::atomic<uint64_t> s_last_tx;
+    static char s_crash_path[512];
+};
+
+#endif // TRACE_H
@@ -0,0 +1,273 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "trend.h"
+
+#include <QFile>
+#include <QDataStream>
+
+#include <algorithm>
+
+
+#define TREND_FILE_MAGIC    0x454D5452  // "EMTR"
+#define TREND_FILE_VER      1
+
+
+static QDataStream& operator<<(QDataStream& out, const TrendBin& bin)
+{
+    return out << bin.min << bin.max << bin.sum << bin.count;
+}
+
+static QDataStream& operator>>(QDataStream& in, TrendBin& bin)
+{
+    return in >> bin.min >> bin.max >> bin.sum >> bin.count;
+}
+
+static inline void merge(TrendBin& dst, const TrendBin& src)
+{
+    dst.min = std::min(dst.min, src.min);
+    dst.max = std::max(dst.max, src.max);
+    dst.sum += src.sum;
+    dst.count += src.count;
+}
+
+
+Trend::Trend(int channels) : m_channels(std::max(1, channels))
+{
+    reset();
+}
+
+void Trend::reset()
+{
+    m_levels.clear();
+    m_levels.resize(TREND_LEVELS);
+
+    for (auto& lv : m_levels)
+    {
+        lv.bins.resize(m_channels);
+        lv.open.resize(m_channels);
+    }
+
+    m_last = 0;
+    m_samples = 0;
+}
+
+void Trend::addSample(double t, const double* vals)
+{
+    if (m_samples > 0 && t < m_last)
+        reset();
+
+    Level& lv = m_levels[0];
+
+    if (lv.openN == 0)
+        lv.openKey = t;
+
+    for (int ch = 0; ch < m_channels; ch++)
+    {
+        TrendBin& bin = lv.open[ch];
+        bin.min = std::min(bin.min, vals[ch]);
+        bin.max = std::max(bin.max, vals[ch]);
+        bin.sum += vals[ch];
+        bin.count++;
+    }
+
+    m_last = t;
+    m_samples++;
+
+    if (++lv.openN == TREND_BASE)
+        close(0);
+}
+
+double Trend::getFirstKey() const
+{
+    for (int i = m_levels.size() - 1; i >= 0; i--) // coarsest level reaches furthest
+    {
+        if (!m_levels[i].keys.isEmpty())
+            return m_levels[i].keys.first();
+    }
+    return m_levels[0].openKey;
+}
+
+/* lowest level covering range start with at most maxBins bins in range */
+int Trend::selectLevel(double from, double to, int maxBins) const
+{
+    int ret = 0;
+
+    for (int i = 0; i < m_levels.size(); i++)
+    {
+        const auto& keys = m_levels[i].keys;
+
+        if (keys.isEmpty()) // higher levels are empty too
+            break;
+
+        ret = i;
+
+        auto lo = std::lower_bound(keys.constBegin(), keys.constEnd(), from);
+        auto hi = std::upper_bound(keys.constBegin(), keys.constEnd(), to);
+
+        if (hi - lo <= maxBins && keys.first() <= from)
+            break;
+    }
+    return ret;
+}
+
+/* one bin beyond range on each side, so lines continue out of view */
+void Trend::getRange(int level, int ch, double from, double to,
+                     QVector<double>& keys, QVector<double>& min, QVector<double>& mean, QVector<double>& max) const
+{
+    keys.clear();
+    min.clear();
+    mean.clear();
+    max.clear();
+
+    if (level < 0 || level >= m_levels.size() || ch < 0 || ch >= m_channels)
+        return;
+
+    const Level& lv = m_levels[level];
+    const auto& bins = lv.bins[ch];
+
+    int lo = std::lower_bound(lv.keys.constBegin(), lv.keys.constEnd(), from) - lv.keys.constBegin();
+    int hi = std::upper_bound(lv.keys.constBegin(), lv.keys.constEnd(), to) - lv.keys.constBegin();
+
+    lo = std::max(0, lo - 1);
+    hi = std::min(lv.keys.size(), hi + 1);
+
+    int n = std::max(0, hi - lo) + 1;
+
+    keys.reserve(n);
+    min.reserve(n);
+    mean.reserve(n);
+    max.reserve(n);
+
+    for (int i = lo; i < hi; i++)
+    {
+        keys.append(lv.keys[i]);
+        min.append(bins[i].min);
+        mean.append(bins[i].mean());
+        max.append(bins[i].max);
+    }
+
+    if (lv.openN > 0 && lv.open[ch].count > 0 && lv.openKey <= to)
+    {
+        keys.append(lv.openKey);
+        min.append(lv.open[ch].min);
+        mean.append(lv.open[ch].mean());
+        max.append(lv.open[ch].max);
+    }
+}
+
+bool Trend::save(const QString& path) const
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+
+    out << (quint32)TREND_FILE_MAGIC << (quint32)TREND_FILE_VER << (qint32)m_channels << (qint32)m_levels.size();
+    out << m_last << m_samples;
+
+    for (const auto& lv : m_levels)
+    {
+        out << lv.keys << lv.openKey << (qint32)lv.openN;
+
+        for (int ch = 0; ch < m_channels; ch++)
+            out << lv.bins[ch] << lv.open[ch];
+    }
+
+    return out.status() == QDataStream::Ok;
+}
+
+bool Trend::load(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic, ver;
+    qint32 channels, levels;
+
+    in >> magic >> ver >> channels >> levels;
+
+    if (in.status() != QDataStream::Ok || magic != TREND_FILE_MAGIC || ver != TREND_FILE_VER ||
+        channels != m_channels || levels != TREND_LEVELS)
+        return false;
+
+    QVector<Level> lvs(levels);
+    double last;
+    quint64 samples;
+
+    in >> last >> samples;
+
+    for (auto& lv : lvs)
+    {
+        qint32 openN;
+
+        in >> lv.keys >> lv.openKey >> openN;
+        lv.openN = openN;
+        lv.bins.resize(channels);
+        lv.open.resize(channels);
+
+        for (int ch = 0; ch < channels; ch++)
+        {
+            in >> lv.bins[ch] >> lv.open[ch];
+
+            if (lv.bins[ch].size() != lv.keys.size())
+                return false;
+        }
+    }
+
+    if (in.status() != QDataStream::Ok)
+        return false;
+
+    m_levels = lvs;
+    m_last = last;
+    m_samples = samples;
+
+    return true;
+}
+
+/* private */
+
+void Trend::close(int level)
+{
+    Level& lv = m_levels[level];
+
+    lv.keys.append(lv.openKey);
+    for (int ch = 0; ch < m_channels; ch++)
+        lv.bins[ch].append(lv.open[ch]);
+
+    if (lv.keys.size() >= TREND_LEVEL_MAX + TREND_LEVEL_MAX / 4) // drop by chunks - amortized O(1)
+    {
+        int drop = lv.keys.size() - TREND_LEVEL_MAX;
+
+        lv.keys.remove(0, drop);
+        for (int ch = 0; ch < m_channels; ch++)
+            lv.bins[ch].remove(0, drop);
+    }
+
+    if (level + 1 < m_levels.size())
+    {
+        Level& up = m_levels[level + 1];
+
+        if (up.openN == 0)
+            up.openKey = lv.openKey;
+
+        for (int ch = 0; ch < m_channels; ch++)
+            merge(up.open[ch], lv.open[ch]);
+
+        if (++up.openN == TREND_FACTOR)
+            close(level + 1);
+    }
+
+    for (int ch = 0; ch < m_channels; ch++)
+        lv.open[ch] = TrendBin();
+
+    lv.openN = 0;
+}
@@ -0,0 +1,81 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef TREND_H
+#define TREND_H
+
+#include <QVector>
+#include <QString>
+
+#include <limits>
+
+
+#define TREND_BASE          10      // samples in bin of level 0 (100 ms at 100 Hz)
+#define TREND_FACTOR        4       // bins merged to one bin of next level
+#define TREND_LEVELS        8       // level 7 bin = 10 * 4^7 samples = 27 min at 100 Hz
+#define TREND_LEVEL_MAX     16384   // bins kept per level, oldest dropped - level 3 holds 29 h, level 7 310 days
+#define TREND_FILE_EXT      ".trend"
+
+
+class TrendBin
+{
+public:
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+    double sum = 0;
+    quint32 count = 0;
+
+    double mean() const { return count ? sum / count : 0; }
+};
+
+/* level of detail pyramid of long term trend - (min, max, mean, count) of every channel built incrementally:
+ *
+ *   level 0 bin aggregates TREND_BASE samples, level L + 1 bin aggregates TREND_FACTOR bins of level L,
+ *   each level keeps last TREND_LEVEL_MAX bins, so memory is bounded and old data survives in coarse levels,
+ *   sample costs O(1) amortized, plot takes level with at most as many bins in visible range as pixels.
+ *
+ * bin key is time of its first sample. open (not yet complete) bin of each level is returned as last one.
+ * older key than last one restarts the trend. file: magic, version, channels, levels, then every level. */
+
+class Trend
+{
+public:
+    Trend(int channels = 1);
+
+    void reset();
+    void addSample(double t, const double* vals);
+
+    int getChannels() const { return m_channels; }
+    double getFirstKey() const;
+    double getLastKey() const { return m_last; }
+    bool isEmpty() const { return m_samples == 0; }
+
+    int selectLevel(double from, double to, int maxBins) const;
+    void getRange(int level, int ch, double from, double to,
+                  QVector<double>& keys, QVector<double>& min, QVector<double>& mean, QVector<double>& max) const;
+
+    bool save(const QString& path) const;
+    bool load(const QString& path);
+
+private:
+    class Level
+    {
+    public:
+        QVector<double> keys;
+        QVector<QVector<TrendBin>> bins;    // [ch][bin]
+        QVector<TrendBin> open;             // [ch]
+        double openKey = 0;
+        int openN = 0;                      // samples or bins merged into open bin
+    };
+
+    void close(int level);
+
+    int m_channels;
+    QVector<Level> m_levels;
+    double m_last = 0;
+    quint64 m_samples = 0;
+};
+
+#endif // TREND_H
@@ -5,13 +5,16 @@
 
 #include "utils.h"
 #include "containers.h"
+#include "core.h"
 
 #include <QString>
 #include <QDebug>
 #include <QMessageBox>
+#include <QDir>
+#include <QUrl>
+#include <QDesktopServices>
 
 #include <math.h>
-#include <assert.h>
 
 
 QString format_unit(double value, QString unit, int precision)
@@ -128,91 +131,16 @@ void msgBox(QMainWindow* window, QString text, MsgBoxType type)
    msgBox->open(window, SLOT(msgBoxClosed(QAbstractButton*)));
 }
 
-int get_vals_from_circ(int from, int total, int bufflen, DaqBits daq_bits, double vcc, uint8_t* buff,
-                       QVector<double>* ch1, QVector<double>* ch2, QVector<double>* ch3, QVector<double>* ch4,
-                       double gain1, double gain2, double gain3, double gain4,
-                       double offset1, double offset2, double offset3, double offset4)
+void open_help()
 {
-    assert(total > 0 && bufflen >= total && buff != NULL);
-
-    int found = 0;
-    int ch_num = 0;
-
-    if (ch1 != NULL) ch_num++;
-    if (ch2 != NULL) ch_num++;
-    if (ch3 != NULL) ch_num++;
-    if (ch4 != NULL) ch_num++;
-
-    QVector<double>* _ch1 = NULL;
-    QVector<double>* _ch2 = NULL;
-    QVector<double>* _ch3 = NULL;
-    QVector<double>* _ch4 = NULL;
-
-    QVector<double>* ch1_copy = ch1;
-    QVector<double>* ch2_copy = ch2;
-    QVector<double>* ch3_copy = ch3;
-
-    QVector<double>** it;
-
-    for (int i = 0; i < ch_num; i++) // sort algorithm
-    {
-        if      (i == 0) it = &_ch1;
-        else if (i == 1) it = &_ch2;
-        else if (i == 2) it = &_ch3;
-        else             it = &_ch4;
-
-        if      (i < 1 && ch1_copy != NULL) { *it = ch1_copy; ch1_copy = NULL; continue; }
-        else if (i < 2 && ch2_copy != NULL) { *it = ch2_copy; ch2_copy = NULL; continue; }
-        else if (i < 3 && ch3_copy != NULL) { *it = ch3_copy; ch3_copy = NULL; continue; }
-        else                                { *it = ch4; continue; }
-    }
-
-    int k1 = 0, k2 = 0, k3 = 0, k4 = 0;
-    for (int k = 0, i = from; k < total; k++, i++)
-    {
-        if (i >= bufflen)
-            i = 0;
-
-        found++;
-        double val;
-
-        if (daq_bits == B12)
-        {
-            uint16_t raw = (*((uint16_t*)(((uint8_t*)buff)+(i*2))));
-            val = (raw / 4095.0) * vcc;
-        }
-        else if (daq_bits == B8)
-        {
-            uint16_t raw = (((uint8_t*)buff)[i]);
-            val = (raw / 255.0) * vcc;
-        }
-        else assert(0);
-
-        if (i % ch_num == 0)
-        {
-            if (_ch1 != NULL)
-                (*_ch1)[k1++] = (gain1 * val) + offset1;
-        }
-        else if (ch_num > 1 && i % ch_num == 1)
-        {
-            if (_ch2 != NULL)
-                (*_ch2)[k2++] = (gain2 * val) + offset2;
-        }
-        else if (ch_num > 2 && i % ch_num == 2)
-        {
-            if (_ch3 != NULL)
-                (*_ch3)[k3++] = (gain3 * val) + offset3;
-        }
-        else if (ch_num > 3) // && i % ch_num == 3)
-        {
-            if (_ch4 != NULL)
-                (*_ch4)[k4++] = (gain4 * val) + offset4;
-        }
-    }
-    return found;
+#if defined(Q_OS_WIN)
+    QString help_path = QDir(QDir::currentPath() + QDir::separator() + "doc").filePath("EMBO.chm");
+    QDesktopServices::openUrl(QUrl::fromUserInput(help_path));
+#elif defined(Q_OS_UNIX) || defined(Q_OS_MAC)
+    QDesktopServices::openUrl(QUrl(HELP_URL));
+#endif
 }
 
-
 const QString h_manual_to_auto(double fs, int mem, double& div_format, double& div_sec)
 {
     double sec = (1.0 / fs) * (double)mem;
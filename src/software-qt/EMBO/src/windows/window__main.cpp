@@ -31,6 +31,7 @@
 #include <QTimer>
 #include <QSettings>
 #include <QCloseEvent>
+#include <QFileDialog>
 #include <QtSerialPort/QSerialPortInfo>
 
 
@@ -47,16 +48,20 @@ WindowMain::WindowMain(QWidget *parent) : QMainWindow(parent), m_ui(new Ui::Wind
 #ifndef Q_OS_UNIX
     QBreakpadInstance.setDumpPath(QLatin1String("crashes"));
 #endif
+    Trace::installCrashHandler(); // after Breakpad, chains to it
+    traceSetLevel((TraceLevel)Settings::getValue(CFG_MAIN_TRACE, TRACE_COMM).toInt());
 
-    QThread* t1 = new QThread(this);
-    auto core = Core::getInstance();
+    m_devices = new Devices(this);
+    m_core = m_devices->add(); // GUI drives one device, instrument windows are bound to it
+    auto core = m_core;
 
-    m_w_scope = new WindowScope();
-    m_w_la = new WindowLa();
-    m_w_vm = new WindowVm();
-    m_w_cntr = new WindowCntr();
-    m_w_pwm = new WindowPwm();
-    m_w_sgen = new WindowSgen();
+    m_w_scope = new WindowScope(core);
+    m_w_la = new WindowLa(core);
+    m_w_vm = new WindowVm(core);
+    m_w_cntr = new WindowCntr(core);
+    m_w_pwm = new WindowPwm(core);
+    m_w_sgen = new WindowSgen(core);
+    m_w_diag = new WindowDiag(core);
 
     core->emboInstruments.append(m_w_scope);
     core->emboInstruments.append(m_w_la);
@@ -65,6 +70,8 @@ WindowMain::WindowMain(QWidget *parent) : QMainWindow(parent), m_ui(new Ui::Wind
     core->emboInstruments.append(m_w_pwm);
     core->emboInstruments.append(m_w_sgen);
 
+    m_server = new EmboServer(core, this);
+
     qRegisterMetaType<State>("State");
     qRegisterMetaType<Msg>("Msg");
     qRegisterMetaType<MsgBoxType>("MsgBoxType");
@@ -73,6 +80,11 @@ WindowMain::WindowMain(QWidget *parent) : QMainWindow(parent), m_ui(new Ui::Wind
     qRegisterMetaType<DaqTrigEdge>("DaqTrigEdge");
     qRegisterMetaType<DaqTrigMode>("DaqTrigMode");
     qRegisterMetaType<SgenMode>("SgenMode");
+    qRegisterMetaType<DaqSettings>("DaqSettings");
+    qRegisterMetaType<VmData>("VmData");
+    qRegisterMetaType<CntrData>("CntrData");
+    qRegisterMetaType<CntrRaw>("CntrRaw");
+    qRegisterMetaType<CommStats>("CommStats");
 
     //connect(qApp, SIGNAL(aboutToQuit()), this, SLOT(on_close()));
 
@@ -81,12 +93,6 @@ WindowMain::WindowMain(QWidget *parent) : QMainWindow(parent), m_ui(new Ui::Wind
     connect(core, &Core::msgDisplay, this, &WindowMain::on_msgDisplay, Qt::QueuedConnection);
     connect(this, &WindowMain::openComm, core, &Core::on_openComm, Qt::QueuedConnection);
     connect(this, &WindowMain::closeComm, core, &Core::on_closeComm, Qt::QueuedConnection);
-    connect(this, &WindowMain::disposeCore, core, &Core::on_dispose, Qt::QueuedConnection);
-
-    connect(t1, SIGNAL(started()), core, SLOT(on_startThread()));
-    connect(core, SIGNAL(finished()), t1, SLOT(quit()), Qt::DirectConnection);
-    connect(core, SIGNAL(finished()), core, SLOT(deleteLater()));
-    connect(t1, SIGNAL(finished()), t1, SLOT(deleteLater()));
 
     connect(m_w_scope, &WindowScope::closing, this, &WindowMain::on_instrClose);
     connect(m_w_scope, &WindowScope::showPwm, this, &WindowMain::on_showPwm);
@@ -96,10 +102,9 @@ WindowMain::WindowMain(QWidget *parent) : QMainWindow(parent), m_ui(new Ui::Wind
     connect(m_w_pwm, &WindowPwm::closing, this, &WindowMain::on_instrClose);
     connect(m_w_sgen, &WindowSgen::closing, this, &WindowMain::on_instrClose);
 
-    connect(m_ui->actionEMBO_Help, SIGNAL(triggered()), Core::getInstance(), SLOT(on_actionEMBO_Help()));
+    connect(m_ui->actionEMBO_Help, &QAction::triggered, this, open_help);
 
-    core->moveToThread(t1);
-    t1->start();
+    serverSetEnabled(Settings::getValue(CFG_MAIN_SERVER, false).toBool(), false);
 
     m_ui->pushButton_disconnect->hide();
     m_ui->groupBox_scope->hide();
@@ -182,6 +187,7 @@ WindowMain::~WindowMain()
     delete m_w_cntr;
     delete m_w_pwm;
     delete m_w_sgen;
+    delete m_w_diag;
 }
 
 /* private methods */
@@ -311,13 +317,47 @@ void WindowMain::saveSettings()
     Settings::setValue(CFG_MAIN_PORT, m_ui->listWidget_ports->currentItem()->data(Qt::UserRole).toString());
 }
 
+void WindowMain::traceSetLevel(TraceLevel level)
+{
+    if (level < TRACE_OFF || level > TRACE_VERBOSE)
+        level = TRACE_COMM;
+
+    Trace::setLevel(level);
+    Settings::setValue(CFG_MAIN_TRACE, level);
+
+    m_ui->actionTraceOff->setChecked(level == TRACE_OFF);
+    m_ui->actionTraceErrors->setChecked(level == TRACE_ERR);
+    m_ui->actionTraceComm->setChecked(level == TRACE_COMM);
+    m_ui->actionTraceVerbose->setChecked(level == TRACE_VERBOSE);
+}
+
+void WindowMain::serverSetEnabled(bool enabled, bool notify)
+{
+    if (enabled && !m_server->start())
+    {
+        if (notify)
+            msgBox(this, m_server->getError(), CRITICAL);
+        enabled = false;
+    }
+    else if (!enabled)
+        m_server->stop();
+
+    Settings::setValue(CFG_MAIN_SERVER, enabled);
+    m_ui->actionServer->setChecked(enabled);
+
+    if (enabled && notify)
+        msgBox(this, "Local server: " + m_server->getName() + "<br>Shared memory: " + m_server->getShmKey(), INFO);
+}
+
 void WindowMain::setConnected()
 {
     m_ui->pushButton_connect->hide();
     m_ui->pushButton_disconnect->show();
 
     this->setWindowTitle(EMBO_TITLE2 " (" + m_ui->listWidget_ports->currentItem()->toolTip()+ ")");
-    m_status_comm->setText(" Connected (" + m_ui->listWidget_ports->currentItem()->data(Qt::UserRole).toString() + ")");
+    int baud = m_core->getBaud();
+    m_status_comm->setText(" Connected (" + m_ui->listWidget_ports->currentItem()->data(Qt::UserRole).toString() +
+                           (baud > 0 ? ", " + QString::number(baud) + " bps" : "") + ")");
     m_ui->listWidget_ports->currentItem()->setIcon(QIcon(":/main/img/serial2_busy.png"));
 
     m_status_icon_comm->setPixmap(m_icon_plugOn);
@@ -329,7 +369,7 @@ void WindowMain::setConnected()
     m_ui->groupBox_sgen->show();
     m_ui->groupBox_cntr->show();
 
-    auto info = Core::getInstance()->getDevInfo();
+    auto info = m_core->getDevInfo();
 
     m_ui->label_deviceName->setText(info->name);
     m_ui->label_dev_fw->setText(info->fw);
@@ -548,11 +588,11 @@ void WindowMain::closeEvent(QCloseEvent* event)
     m_w_cntr->close();
     m_w_pwm->close();
     m_w_sgen->close();
+    m_w_diag->close();
 
-    auto core = Core::getInstance();
-    emit disposeCore();
-    if (core != Q_NULLPTR)
-        core->thread()->wait();
+    m_server->stop();
+    m_devices->remove(m_core); // dispose and join its thread
+    m_core = Q_NULLPTR;
 
     qInfo() << "Core thread joined";
 
@@ -573,7 +613,11 @@ void WindowMain::on_pushButton_scan_clicked()
     m_ui->listWidget_ports->clear();
 
     auto ports = QSerialPortInfo::availablePorts();
-    int ports_sz = ports.size();
+
+    /* ports not enumerated by system (e.g. pty of virtual device), separated by ':' */
+    QStringList extra_ports = QString::fromLocal8Bit(qgetenv(ENV_EXTRA_PORTS)).split(':', QString::SkipEmptyParts);
+
+    int ports_sz = ports.size() + extra_ports.size();
 
     m_ui->label_titlePorts->setText("Ports (" + QString::number(ports_sz) + ")");
 
@@ -592,6 +636,16 @@ void WindowMain::on_pushButton_scan_clicked()
 
             m_ui->listWidget_ports->addItem(item);
         }
+        for(auto port : extra_ports)
+        {
+            QListWidgetItem* item = new QListWidgetItem(m_ui->listWidget_ports);
+            item->setIcon(QIcon(":/main/img/serial2.png"));
+            item->setText(port.size() <= 20 ? port : "..." + port.right(16));
+            item->setToolTip(port + " (" ENV_EXTRA_PORTS ")");
+            item->setData(Qt::UserRole, port);
+
+            m_ui->listWidget_ports->addItem(item);
+        }
         m_ui->listWidget_ports->setCurrentRow(0);
         m_ui->pushButton_connect->setEnabled(true);
     }
@@ -640,8 +694,8 @@ void WindowMain::on_latencyAndUptime(int latency_fix, int latency_mean, int late
                               " ms (max " + QString::number(latency_max) + " ms)");
     m_status_uptime->setText("Uptime: " + uptime);
 
-    if (m_w_vm->isVisible())
-        m_ui->label_dev_vref->setText(QString::number(Core::getInstance()->getDevInfo()->ref_mv) + " mV");
+    if (m_w_vm->isVisible() && m_core != Q_NULLPTR)
+        m_ui->label_dev_vref->setText(QString::number(m_core->getDevInfo()->ref_mv) + " mV");
 }
 
 void WindowMain::on_coreState_changed(const State newState)
@@ -839,6 +893,50 @@ void WindowMain::on_actionCheck_Updates_triggered()
     updater->checkForUpdates(UPDATE_URL);
 }
 
+void WindowMain::on_actionServer_triggered(bool checked)
+{
+    serverSetEnabled(checked, true);
+}
+
+void WindowMain::on_actionTraceOff_triggered()
+{
+    traceSetLevel(TRACE_OFF);
+}
+
+void WindowMain::on_actionTraceErrors_triggered()
+{
+    traceSetLevel(TRACE_ERR);
+}
+
+void WindowMain::on_actionTraceComm_triggered()
+{
+    traceSetLevel(TRACE_COMM);
+}
+
+void WindowMain::on_actionTraceVerbose_triggered()
+{
+    traceSetLevel(TRACE_VERBOSE);
+}
+
+void WindowMain::on_actionTraceSave_triggered()
+{
+    QString path = QFileDialog::getSaveFileName(this, "Save Comm Trace", "trace.csv", "CSV (*.csv)");
+
+    if (path.isEmpty())
+        return;
+
+    if (Trace::dump(path))
+        msgBox(this, "Trace saved to " + path, INFO);
+    else
+        msgBox(this, "Failed to save trace to " + path, WARNING);
+}
+
+void WindowMain::on_actionCommDiag_triggered()
+{
+    m_w_diag->show();
+    m_w_diag->raise();
+}
+
 void WindowMain::on_showPwm()
 {
     m_w_pwm->show();
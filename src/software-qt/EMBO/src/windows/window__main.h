@@ -12,8 +12,12 @@
 #include "window_cntr.h"
 #include "window_pwm.h"
 #include "window_sgen.h"
+#include "window_diag.h"
 
 #include "core.h"
+#include "devices.h"
+#include "server.h"
+#include "trace.h"
 
 #include <QMainWindow>
 #include <QSerialPort>
@@ -41,7 +45,6 @@ public:
 signals:
     void openComm(const QString port);
     void closeComm(bool force);
-    void disposeCore();
 
 private slots:
     void closeEvent(QCloseEvent *event);
@@ -64,6 +67,13 @@ private slots:
     void on_pushButton_pwm_clicked();
     void on_pushButton_sgen_clicked();
     void on_actionCheck_Updates_triggered();
+    void on_actionTraceOff_triggered();
+    void on_actionTraceErrors_triggered();
+    void on_actionTraceComm_triggered();
+    void on_actionTraceVerbose_triggered();
+    void on_actionTraceSave_triggered();
+    void on_actionCommDiag_triggered();
+    void on_actionServer_triggered(bool checked);
 
 private:
     void instrFirstRowEnable(bool enable);
@@ -72,6 +82,8 @@ private:
     void loadSettings();
     void saveSettings();
     void setConnected();
+    void traceSetLevel(TraceLevel level);
+    void serverSetEnabled(bool enabled, bool notify);
     void setDisconnected();
     void updateChangelog (const QString& url);
     void displayAppcast (const QString& url, const QByteArray& reply);
@@ -79,6 +91,11 @@ private:
     /* main window */
     Ui::WindowMain* m_ui = Q_NULLPTR;
 
+    /* devices */
+    Devices* m_devices = Q_NULLPTR;
+    Core* m_core = Q_NULLPTR;
+    EmboServer* m_server = Q_NULLPTR;
+
     /* state flags */
     bool m_connected = false;
     bool m_close_init = false;
@@ -112,6 +129,7 @@ private:
     WindowCntr* m_w_cntr = Q_NULLPTR;
     WindowPwm* m_w_pwm = Q_NULLPTR;
     WindowSgen* m_w_sgen = Q_NULLPTR;
+    WindowDiag* m_w_diag = Q_NULLPTR;
 
 };
 #endif // MAINWINDOW_H
@@ -17,26 +17,53 @@
 #include <QPixmap>
 #include <QTimer>
 
+#include <algorithm>
+#include <cmath>
 
-WindowCntr::WindowCntr(QWidget *parent) : QMainWindow(parent), m_ui(new Ui::WindowCntr)
+
+WindowCntr::WindowCntr(Core* core, QWidget *parent) : QMainWindow(parent), m_ui(new Ui::WindowCntr)
 {
     m_ui->setupUi(this);
+    m_core = core;
 
     m_timer_render = new QTimer(this);
 
     m_msg_enable = new Msg_CNTR_Enable(this);
-    m_msg_read = new Msg_CNTR_Read(this);
+    m_msg_raw_req = new Msg_CNTR_Raw(this);
+    m_msg_raw = new Msg_CNTR_Raw(this);
 
     connect(m_msg_enable, &Msg_CNTR_Enable::ok, this, &WindowCntr::on_msg_ok, Qt::QueuedConnection);
     connect(m_msg_enable, &Msg_CNTR_Enable::err, this, &WindowCntr::on_msg_err, Qt::QueuedConnection);
     connect(m_msg_enable, &Msg_CNTR_Enable::result, this, &WindowCntr::on_msg_enable, Qt::QueuedConnection);
 
-    connect(m_msg_read, &Msg_CNTR_Read::err, this, &WindowCntr::on_msg_err, Qt::QueuedConnection);
-    connect(m_msg_read, &Msg_CNTR_Read::result, this, &WindowCntr::on_msg_read, Qt::QueuedConnection);
+    connect(m_core, &Core::cntrReady, this, &WindowCntr::on_msg_cntrReady, Qt::QueuedConnection); // pushed by device
+
+    connect(m_msg_raw_req, &Msg_CNTR_Raw::ok, this, &WindowCntr::on_msg_raw_ok, Qt::QueuedConnection);
+    connect(m_msg_raw_req, &Msg_CNTR_Raw::err, this, &WindowCntr::on_msg_raw_err, Qt::QueuedConnection);
+    connect(m_msg_raw, &Msg_CNTR_Raw::err, this, &WindowCntr::on_msg_raw_err, Qt::QueuedConnection);
+    connect(m_msg_raw, &Msg_CNTR_Raw::result, this, &WindowCntr::on_msg_raw, Qt::QueuedConnection);
+
+    m_gates = new QActionGroup(this);
+    m_gates->addAction(m_ui->actionGate10ms)->setData(10);
+    m_gates->addAction(m_ui->actionGate100ms)->setData(100);
+    m_gates->addAction(m_ui->actionGate1s)->setData(1000);
+    m_gates->addAction(m_ui->actionGate10s)->setData(10000);
+    m_gates->setExclusive(true);
+
+    connect(m_gates, &QActionGroup::triggered, this, &WindowCntr::on_gate_selected);
+
+    m_views = new QActionGroup(this);
+    m_views->addAction(m_ui->actionViewPeriod)->setData(CNTR_VIEW_PERIOD);
+    m_views->addAction(m_ui->actionViewTie)->setData(CNTR_VIEW_TIE);
+    m_views->addAction(m_ui->actionViewDuty)->setData(CNTR_VIEW_DUTY);
+    m_views->setExclusive(true);
+    m_ui->actionViewPeriod->setChecked(true);
+
+    connect(m_views, &QActionGroup::triggered, this, &WindowCntr::on_view_selected);
 
     connect(m_timer_render, &QTimer::timeout, this, &WindowCntr::on_timer_render);
 
-    connect(m_ui->actionEMBO_Help, SIGNAL(triggered()), Core::getInstance(), SLOT(on_actionEMBO_Help()));
+    connect(m_ui->actionEMBO_Help, &QAction::triggered, this, open_help);
 
     m_status_enabled = new QLabel(" Disabled", this);
     QWidget* widget = new QWidget(this);
@@ -68,6 +95,10 @@ WindowCntr::WindowCntr(QWidget *parent) : QMainWindow(parent), m_ui(new Ui::Wind
 
     m_ui->textBrowser_freq->setStyleSheet(CSS_TEXTBOX);
     m_ui->textBrowser_period->setStyleSheet(CSS_TEXTBOX);
+
+    initPlot();
+    initPlotRaw();
+    setGate(m_gateMs);
 }
 
 WindowCntr::~WindowCntr()
@@ -85,10 +116,8 @@ void WindowCntr::on_msg_ok(const QString, const QString)
         m_instrEnabled = !m_instrEnabled;
     }
 
-    if (m_instrEnabled)
-        m_activeMsgs.push_back(m_msg_read);
-    else
-        m_activeMsgs.clear();
+    m_activeMsgs.clear();
+    m_raw_busy = false; // device drops raw capture with new settings
 
     enableAll(true);
 }
@@ -103,29 +132,66 @@ void WindowCntr::on_msg_err(const QString text, MsgBoxType type, bool needClose)
     msgBox(this, text, type);
 }
 
-void WindowCntr::on_msg_enable(bool enabled, bool fastMode)
+void WindowCntr::on_msg_enable(bool enabled, bool fastMode, int gateMs)
 {
     m_instrEnabled = enabled;
     m_fastMode = fastMode;
 
-    if (m_instrEnabled)
-        m_activeMsgs.push_back(m_msg_read);
-    else
-        m_activeMsgs.clear();
-
     m_ui->radioButton_fast->setChecked(m_fastMode);
     m_ui->radioButton_precise->setChecked(!m_fastMode);
 
+    setGate(gateMs);
+
     enableAll(true);
 }
 
-void WindowCntr::on_msg_read(const QString freq, const QString period)
+void WindowCntr::on_msg_cntrReady(const CntrData data)
 {
-    m_data_freq = freq;
-    m_data_period = period;
+    if (!m_instrEnabled)
+        return;
+
+    if (data.seq < m_seq_last) // device restarted measurement
+        resetPlot();
+
+    /* last pushed gate has seq, older ones before */
+    for (int i = 0; i < data.freqs.size(); i++)
+    {
+        double key = ((double)data.seq - data.freqs.size() + i + 1) * m_gateMs / 1000.0;
+        double val = data.freqs[i];
+
+        m_ui->customPlot->graph(0)->addData(key, val > 0 ? val : qQNaN()); // no signal - gap
+    }
+
+    m_seq_last = data.seq;
+    m_data = data;
     m_data_fresh = true;
 }
 
+void WindowCntr::on_msg_raw_ok(const QString, const QString)
+{
+    if (m_instrEnabled && m_raw_busy)
+        m_activeMsgs.push_back(m_msg_raw); // poll until capture is done
+}
+
+void WindowCntr::on_msg_raw_err(const QString text, MsgBoxType type, bool)
+{
+    stopRaw();
+    msgBox(this, text, type);
+}
+
+void WindowCntr::on_msg_raw(const CntrRaw data)
+{
+    stopRaw();
+
+    if (!m_ti.addCapture(data))
+        m_ui->label_raw->setText("No edges captured");
+    else
+        renderRaw();
+
+    if (m_ui->actionCaptureRepeat->isChecked() && m_instrEnabled)
+        sendRaw(data.duty);
+}
+
 void WindowCntr::on_actionAbout_triggered()
 {
     QMessageBox::about(this, EMBO_TITLE, EMBO_ABOUT_TXT);
@@ -157,6 +223,44 @@ void WindowCntr::on_radioButton_fast_clicked()
     sendEnable(m_instrEnabled);
 }
 
+void WindowCntr::on_gate_selected(QAction* action)
+{
+    setGate(action->data().toInt());
+    sendEnable(m_instrEnabled);
+}
+
+void WindowCntr::on_actionResetStats_triggered()
+{
+    sendEnable(m_instrEnabled); // device restarts statistics with settings
+}
+
+void WindowCntr::on_actionCaptureEdges_triggered()
+{
+    if (m_view == CNTR_VIEW_DUTY)
+        m_ui->actionViewPeriod->trigger();
+
+    sendRaw(false);
+}
+
+void WindowCntr::on_actionCaptureDuty_triggered()
+{
+    m_ui->actionViewDuty->trigger();
+
+    sendRaw(true);
+}
+
+void WindowCntr::on_actionClearAnalysis_triggered()
+{
+    m_ti.clear();
+    renderRaw();
+}
+
+void WindowCntr::on_view_selected(QAction* action)
+{
+    m_view = (CntrRawView)action->data().toInt();
+    renderRaw();
+}
+
 void WindowCntr::on_timer_render()
 {
     if (m_instrEnabled)
@@ -164,28 +268,49 @@ void WindowCntr::on_timer_render()
         if (!m_data_fresh)
             return;
 
-        QString freq = m_data_freq;
-        QString period = m_data_period;
+        double freq = m_data.freqs.isEmpty() ? -1 : m_data.freqs.last();
 
-        if (freq.contains("Time out"))
+        if (freq <= 0)
         {
             m_ui->textBrowser_freq->setHtml("<p align=\"right\"> " FREQ_TIMEOUT);
             m_ui->textBrowser_period->setHtml("<p align=\"right\"> " PERIOD_TIMEOUT);
         }
-        else if (freq.contains("ERROR"))
+        else // ALL GOOD
         {
-            //m_status_enabled->setText(" " + freq);
+            m_ui->textBrowser_freq->setHtml("<p align=\"right\">" + formatFreq(freq) + " ");
+            m_ui->textBrowser_period->setHtml("<p align=\"right\">" + formatPeriod(freq) + " ");
         }
-        else // ALL GOOD
+
+        if (m_data.n > 0)
         {
-            QString period2 = period;
-            if (freq.contains("kHz") || freq.contains("MHz"))
-                 period2 = period2.replace(" ", "&nbsp;&nbsp;");
+            m_ui->label_stats->setText("min:  " + formatFreq(m_data.min) + "\n" +
+                                       "max:  " + formatFreq(m_data.max) + "\n" +
+                                       "mean: " + formatFreq(m_data.mean) + "\n" +
+                                       "std:  " + QString::number(m_data.std, 'g', 3) + " Hz\n" +
+                                       "ADEV: " + QString::number(m_data.adev, 'e', 2) + "\n" +
+                                       "n:    " + QString::number(m_data.n) + " / " + QString::number(m_data.seq));
+        }
+        else
+            m_ui->label_stats->setText("n:    0 / " + QString::number(m_data.seq));
 
-            m_ui->textBrowser_freq->setHtml("<p align=\"right\">" + freq + " ");
-            m_ui->textBrowser_period->setHtml("<p align=\"right\">" + period + " ");
+        if (!m_ui->customPlot->graph(0)->data()->isEmpty())
+        {
+            double key_last = (double)m_seq_last * m_gateMs / 1000.0;
+            bool found = false;
+
+            m_ui->customPlot->graph(0)->data()->removeBefore(key_last - CNTR_TREND_LEN * m_gateMs / 1000.0);
+            m_ui->customPlot->xAxis->setRange(key_last - CNTR_TREND_LEN * m_gateMs / 1000.0, key_last);
+
+            QCPRange rng = m_ui->customPlot->graph(0)->getValueRange(found);
+            if (found)
+            {
+                double margin = rng.size() > 0 ? rng.size() * 0.1 : std::abs(rng.center()) * 1e-6 + 1e-3;
+                m_ui->customPlot->yAxis->setRange(rng.lower - margin, rng.upper + margin);
+            }
         }
 
+        m_ui->customPlot->replot();
+
         m_data_fresh = false;
     }
 }
@@ -195,6 +320,7 @@ void WindowCntr::on_timer_render()
 void WindowCntr::closeEvent(QCloseEvent*)
 {
     m_activeMsgs.clear();
+    m_raw_busy = false;
     emit closing(WindowCntr::staticMetaObject.className());
 }
 
@@ -205,10 +331,14 @@ void WindowCntr::showEvent(QShowEvent*)
 
     m_ui->textBrowser_freq->setEnabled(false);
     m_ui->textBrowser_period->setEnabled(false);
+    m_ui->label_stats->setText("");
 
+    resetPlot();
+    m_ti.clear();
+    renderRaw();
     enableAll(false);
 
-    Core::getInstance()->msgAdd(m_msg_enable, true, "");
+    m_core->msgAdd(m_msg_enable, true, "");
 }
 
 void WindowCntr::enableAll(bool enable)
@@ -218,6 +348,8 @@ void WindowCntr::enableAll(bool enable)
 
     m_ui->radioButton_fast->setEnabled(enable);
     m_ui->radioButton_precise->setEnabled(enable);
+    m_gates->setEnabled(enable);
+    enableCapture(enable);
 
     m_ui->textBrowser_freq->setEnabled(m_instrEnabled);
     m_ui->textBrowser_period->setEnabled(m_instrEnabled);
@@ -251,7 +383,200 @@ void WindowCntr::sendEnable(bool enable)
 {
     enableAll(false);
 
-    Core::getInstance()->msgAdd(m_msg_enable, false,
+    m_core->msgAdd(m_msg_enable, false,
                                 (enable ? QString(EMBO_SET_TRUE) : QString(EMBO_SET_FALSE)) + EMBO_DELIM2 +
-                                (m_fastMode ? EMBO_SET_TRUE : EMBO_SET_FALSE));
+                                (m_fastMode ? EMBO_SET_TRUE : EMBO_SET_FALSE) + EMBO_DELIM2 +
+                                QString::number(m_gateMs));
+
+    resetPlot();
+}
+
+void WindowCntr::setGate(int gateMs)
+{
+    m_gateMs = gateMs;
+
+    for (auto action : m_gates->actions())
+        action->setChecked(action->data().toInt() == gateMs);
+}
+
+void WindowCntr::initPlot()
+{
+    m_ui->customPlot->addGraph();
+    m_ui->customPlot->graph(0)->setPen(QPen(QColor(COLOR1)));
+    m_ui->customPlot->graph(0)->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssDisc, 3));
+
+    m_ui->customPlot->axisRect()->setMinimumMargins(QMargins(45,15,15,30));
+
+    QSharedPointer<QCPAxisTickerTime> timeTicker(new QCPAxisTickerTime);
+    timeTicker->setTimeFormat("%h:%m:%s");
+    m_ui->customPlot->xAxis->setTicker(timeTicker);
+    m_ui->customPlot->axisRect()->setupFullAxesBox();
+
+    m_ui->customPlot->yAxis->setNumberFormat("g");
+    m_ui->customPlot->yAxis->setNumberPrecision(9);
+    m_ui->customPlot->yAxis->setLabel("f [Hz]");
+
+    QFont font2("Roboto", 8, QFont::Normal);
+    m_ui->customPlot->xAxis->setTickLabelFont(font2);
+    m_ui->customPlot->yAxis->setTickLabelFont(font2);
+    m_ui->customPlot->xAxis->setLabelFont(font2);
+    m_ui->customPlot->yAxis->setLabelFont(font2);
+
+    connect(m_ui->customPlot->xAxis, SIGNAL(rangeChanged(QCPRange)), m_ui->customPlot->xAxis2, SLOT(setRange(QCPRange)));
+    connect(m_ui->customPlot->yAxis, SIGNAL(rangeChanged(QCPRange)), m_ui->customPlot->yAxis2, SLOT(setRange(QCPRange)));
+}
+
+void WindowCntr::resetPlot()
+{
+    m_seq_last = 0;
+    m_ui->customPlot->graph(0)->data()->clear();
+    m_ui->customPlot->replot();
+}
+
+void WindowCntr::initPlotRaw()
+{
+    QCustomPlot* plot = m_ui->customPlot_raw;
+
+    m_bars = new QCPBars(plot->xAxis, plot->yAxis);
+    m_bars->setPen(QPen(QColor(COLOR1)));
+    m_bars->setBrush(QColor(COLOR1));
+
+    plot->addGraph();
+    plot->graph(0)->setPen(QPen(QColor(COLOR2)));
+    plot->graph(0)->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssDisc, 3));
+    plot->graph(0)->setVisible(false);
+
+    plot->axisRect()->setMinimumMargins(QMargins(45,15,15,30));
+    plot->axisRect()->setupFullAxesBox();
+    plot->yAxis->setNumberFormat("g");
+
+    QFont font2("Roboto", 8, QFont::Normal);
+    plot->xAxis->setTickLabelFont(font2);
+    plot->yAxis->setTickLabelFont(font2);
+    plot->xAxis->setLabelFont(font2);
+    plot->yAxis->setLabelFont(font2);
+
+    connect(plot->xAxis, SIGNAL(rangeChanged(QCPRange)), plot->xAxis2, SLOT(setRange(QCPRange)));
+    connect(plot->yAxis, SIGNAL(rangeChanged(QCPRange)), plot->yAxis2, SLOT(setRange(QCPRange)));
+}
+
+/* histogram of accumulated periods or duty cycles, or TIE of last capture */
+void WindowCntr::renderRaw()
+{
+    QCustomPlot* plot = m_ui->customPlot_raw;
+    QString n = "  n: " + QString::number(m_view == CNTR_VIEW_DUTY ? m_ti.getDuty().size() : m_ti.getPeriods().size()) +
+                " / " + QString::number(m_ti.getCaptures());
+
+    if (m_view == CNTR_VIEW_TIE)
+    {
+        QVector<double> t = m_ti.getTieTime();
+        QVector<double> tie = m_ti.getTie();
+
+        std::transform(t.begin(), t.end(), t.begin(), [](double x) { return x * 1e3; });
+        std::transform(tie.begin(), tie.end(), tie.begin(), [](double x) { return x * 1e9; });
+
+        m_bars->setVisible(false);
+        plot->graph(0)->setVisible(true);
+        plot->graph(0)->setData(t, tie, true);
+        plot->xAxis->setLabel("t [ms]");
+        plot->yAxis->setLabel("TIE [ns]");
+
+        if (!tie.isEmpty())
+        {
+            auto range = std::minmax_element(tie.constBegin(), tie.constEnd());
+            m_ui->label_raw->setText("TIE rms: " + QString::number(TimeInterval::stdDev(tie), 'g', 4) + " ns" +
+                                     "  pk-pk: " + QString::number(*range.second - *range.first, 'g', 4) + " ns" +
+                                     "  edges: " + QString::number(tie.size()));
+        }
+        else
+            m_ui->label_raw->setText("");
+    }
+    else
+    {
+        bool duty = m_view == CNTR_VIEW_DUTY;
+        QVector<double> vals = duty ? m_ti.getDuty() : m_ti.getPeriods();
+        QVector<double> keys, counts;
+        double scale = 1;
+        QString unit = "%";
+
+        if (!duty) // period in readable units
+        {
+            double T = TimeInterval::mean(vals);
+            scale = T >= 1 ? 1 : (T >= 1e-3 ? 1e3 : (T >= 1e-6 ? 1e6 : 1e9));
+            unit = T >= 1 ? "s" : (T >= 1e-3 ? "ms" : (T >= 1e-6 ? "us" : "ns"));
+
+            std::transform(vals.begin(), vals.end(), vals.begin(), [scale](double x) { return x * scale; });
+        }
+
+        TimeInterval::histogram(vals, TI_HIST_BINS, keys, counts);
+
+        m_bars->setVisible(true);
+        m_bars->setWidth(keys.size() > 1 ? keys[1] - keys[0] : (keys.isEmpty() ? 1 : std::abs(keys[0]) * 1e-3 + 1e-9));
+        m_bars->setData(keys, counts, true);
+        plot->graph(0)->setVisible(false);
+        plot->xAxis->setLabel((duty ? "duty [" : "T [") + unit + "]");
+        plot->yAxis->setLabel("count");
+
+        if (!vals.isEmpty())
+            m_ui->label_raw->setText("mean: " + QString::number(TimeInterval::mean(vals), 'g', 9) + " " + unit +
+                                     "  std: " + QString::number(TimeInterval::stdDev(vals), 'g', 4) + " " + unit + n);
+        else
+            m_ui->label_raw->setText("");
+    }
+
+    plot->rescaleAxes();
+    plot->replot();
+}
+
+/* one capture of consecutive edges, n, mode (0 = edges, 1 = duty) */
+void WindowCntr::sendRaw(bool duty)
+{
+    if (!m_instrEnabled || m_raw_busy)
+        return;
+
+    m_raw_busy = true;
+    enableCapture(true);
+
+    m_core->msgAdd(m_msg_raw_req, false, QString::number(CNTR_RAW_EDGES) + EMBO_DELIM2 + QString::number(duty ? 1 : 0));
+}
+
+void WindowCntr::stopRaw()
+{
+    m_raw_busy = false;
+    m_activeMsgs.erase(std::remove(m_activeMsgs.begin(), m_activeMsgs.end(), m_msg_raw), m_activeMsgs.end());
+    enableCapture(true);
+}
+
+void WindowCntr::enableCapture(bool enable)
+{
+    m_ui->actionCaptureEdges->setEnabled(enable && m_instrEnabled && !m_raw_busy);
+    m_ui->actionCaptureDuty->setEnabled(enable && m_instrEnabled && !m_raw_busy);
+}
+
+/* digits by gate - reciprocal resolution is about timer period / gate */
+QString WindowCntr::formatFreq(double freq)
+{
+    int prec = m_gateMs >= 10000 ? 6 : (m_gateMs >= 1000 ? 5 : (m_gateMs >= 100 ? 4 : 3));
+
+    if (freq < 1000)
+        return QString::number(freq, 'f', prec) + " Hz";
+    else if (freq < 1000000)
+        return QString::number(freq / 1000.0, 'f', prec) + " kHz";
+    else
+        return QString::number(freq / 1000000.0, 'f', prec) + " MHz";
+}
+
+QString WindowCntr::formatPeriod(double freq)
+{
+    int prec = m_gateMs >= 1000 ? 5 : 3;
+    double T = 1.0 / freq;
+
+    if (T >= 1)
+        return QString::number(T, 'f', prec) + " s";
+    else if (T >= 0.001)
+        return QString::number(T * 1000.0, 'f', prec) + " ms";
+    else if (T >= 0.000001)
+        return QString::number(T * 1000000.0, 'f', prec) + " us";
+    else
+        return QString::number(T * 1000000000.0, 'f', prec) + " ns";
 }
@@ -8,11 +8,14 @@
 
 #include "interfaces.h"
 #include "messages.h"
+#include "timeinterval.h"
+#include "lib/qcustomplot.h"
 
 #include <QString>
 #include <QMainWindow>
 #include <QLabel>
 #include <QButtonGroup>
+#include <QActionGroup>
 #include <QTimer>
 
 
@@ -21,6 +24,17 @@
 
 #define TIMER_CNTR_RENDER   100
 
+#define CNTR_GATE_DEFAULT   100     // ms, until device reports its gate
+#define CNTR_TREND_LEN      300     // gates in trend plot
+#define CNTR_RAW_EDGES      199     // edges per raw capture, device buffer - 1
+
+enum CntrRawView
+{
+    CNTR_VIEW_PERIOD,
+    CNTR_VIEW_TIE,
+    CNTR_VIEW_DUTY
+};
+
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class WindowCntr; }
@@ -32,7 +46,7 @@ class WindowCntr : public QMainWindow, public IEmboInstrument
     Q_OBJECT
 
 public:
-    explicit WindowCntr(QWidget *parent = nullptr);
+    explicit WindowCntr(Core* core, QWidget *parent = nullptr);
     ~WindowCntr();
 
     bool getInstrEnabled() override { return m_instrEnabled; };
@@ -44,8 +58,11 @@ signals:
 private slots:
     void on_msg_ok(const QString val1, const QString val2);
     void on_msg_err(const QString text, MsgBoxType type, bool needClose);
-    void on_msg_enable(bool enabled, bool fastMode);
-    void on_msg_read(const QString freq, const QString period);
+    void on_msg_enable(bool enabled, bool fastMode, int gateMs);
+    void on_msg_cntrReady(const CntrData data);
+    void on_msg_raw_ok(const QString val1, const QString val2);
+    void on_msg_raw_err(const QString text, MsgBoxType type, bool needClose);
+    void on_msg_raw(const CntrRaw data);
 
     void on_actionAbout_triggered();
     void on_pushButton_disable_clicked();
@@ -54,6 +71,14 @@ private slots:
     void on_radioButton_precise_clicked();
     void on_radioButton_fast_clicked();
 
+    void on_gate_selected(QAction* action);
+    void on_actionResetStats_triggered();
+
+    void on_actionCaptureEdges_triggered();
+    void on_actionCaptureDuty_triggered();
+    void on_actionClearAnalysis_triggered();
+    void on_view_selected(QAction* action);
+
     void on_timer_render();
 
 private:
@@ -61,13 +86,24 @@ private:
     void showEvent(QShowEvent* event) override;
     void enableAll(bool enable);
     void sendEnable(bool enable);
+    void setGate(int gateMs);
+    void initPlot();
+    void resetPlot();
+    void initPlotRaw();
+    void renderRaw();
+    void sendRaw(bool duty);
+    void stopRaw();
+    void enableCapture(bool enable);
+    QString formatFreq(double freq);
+    QString formatPeriod(double freq);
 
     /* main window */
     Ui::WindowCntr* m_ui;
 
     /* messages */
     Msg_CNTR_Enable* m_msg_enable;
-    Msg_CNTR_Read* m_msg_read;
+    Msg_CNTR_Raw* m_msg_raw_req;
+    Msg_CNTR_Raw* m_msg_raw;
 
     /* status bar */
     QLabel* m_status_enabled;
@@ -80,10 +116,21 @@ private:
     bool m_fastMode = false;
     bool m_enable_wantSwitch = false;
 
-    /* data */
-    QString m_data_freq;
-    QString m_data_period;
+    /* gate */
+    QActionGroup* m_gates;
+    int m_gateMs = CNTR_GATE_DEFAULT;
+
+    /* data - last gate and statistics from device, trend keyed by gate sequence */
+    CntrData m_data;
+    quint32 m_seq_last = 0;
     bool m_data_fresh = false;
+
+    /* raw capture - polled until done, analysis accumulates captures */
+    QActionGroup* m_views;
+    CntrRawView m_view = CNTR_VIEW_PERIOD;
+    TimeInterval m_ti;
+    QCPBars* m_bars;
+    bool m_raw_busy = false;
 };
 
 #endif // WINDOW_CNTR_H
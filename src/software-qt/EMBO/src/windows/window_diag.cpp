@@ -0,0 +1,152 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "window_diag.h"
+#include "ui_window_diag.h"
+#include "core.h"
+#include "utils.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QFileDialog>
+#include <QTextStream>
+#include <QHeaderView>
+
+#include <algorithm>
+
+
+#define TIMER_DIAG          1000
+
+WindowDiag::WindowDiag(Core* core, QWidget *parent) : QMainWindow(parent), m_ui(new Ui::WindowDiag), m_core(core)
+{
+    m_ui->setupUi(this);
+
+    connect(this, &WindowDiag::commStatsRequest, core, &Core::on_commStatsRequest, Qt::QueuedConnection);
+    connect(this, &WindowDiag::commStatsReset, core, &Core::on_commStatsReset, Qt::QueuedConnection);
+    connect(core, &Core::commStats, this, &WindowDiag::on_commStats, Qt::QueuedConnection);
+
+    m_timer_refresh = new QTimer(this);
+    connect(m_timer_refresh, &QTimer::timeout, this, &WindowDiag::commStatsRequest);
+
+    m_ui->tableWidget_latency->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+}
+
+WindowDiag::~WindowDiag()
+{
+    delete m_ui;
+}
+
+void WindowDiag::on_commStats(const CommStats stats)
+{
+    m_stats = stats;
+
+    /* sort by total time spent, so most expensive command is on top */
+
+    std::sort(m_stats.cmds.begin(), m_stats.cmds.end(), [](const CmdLatency& a, const CmdLatency& b)
+    {
+        return a.hist.getMean() * a.hist.getCount() > b.hist.getMean() * b.hist.getCount();
+    });
+
+    double total = 0;
+    for (const CmdLatency& cmd : m_stats.cmds)
+        total += cmd.hist.getMean() * cmd.hist.getCount();
+
+    auto table = m_ui->tableWidget_latency;
+    table->setRowCount(m_stats.cmds.size());
+
+    for (int i = 0; i < m_stats.cmds.size(); i++)
+    {
+        const LatencyHistogram& hist = m_stats.cmds[i].hist;
+        double share = total > 0 ? hist.getMean() * hist.getCount() / total * 100.0 : 0;
+
+        const QString cells[] = { m_stats.cmds[i].cmd,
+                                  QString::number(hist.getCount()),
+                                  QString::number(hist.getMean() / 1000.0, 'f', 2),
+                                  QString::number(hist.getPercentile(50) / 1000.0, 'f', 2),
+                                  QString::number(hist.getPercentile(90) / 1000.0, 'f', 2),
+                                  QString::number(hist.getPercentile(99) / 1000.0, 'f', 2),
+                                  QString::number(hist.getMax() / 1000.0, 'f', 2),
+                                  QString::number(share, 'f', 1) };
+
+        for (int col = 0; col < 8; col++)
+        {
+            QTableWidgetItem* item = table->item(i, col);
+
+            if (item == Q_NULLPTR)
+            {
+                item = new QTableWidgetItem();
+                item->setTextAlignment(col == 0 ? (Qt::AlignLeft | Qt::AlignVCenter) : (Qt::AlignRight | Qt::AlignVCenter));
+                table->setItem(i, col, item);
+            }
+            item->setText(cells[col]);
+        }
+    }
+}
+
+void WindowDiag::on_pushButton_reset_clicked()
+{
+    emit commStatsReset();
+    emit commStatsRequest();
+}
+
+void WindowDiag::on_pushButton_save_clicked()
+{
+    QString path = QFileDialog::getSaveFileName(this, "Save Comm Latency", "latency.csv", "CSV (*.csv)");
+
+    if (path.isEmpty())
+        return;
+
+    QFile file(path);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        msgBox(this, "Failed to save latency to " + path, WARNING);
+        return;
+    }
+
+    QTextStream stream(&file);
+
+    /* summary, then non empty buckets of every histogram */
+
+    stream << "cmd,count,mean_us,min_us,p50_us,p90_us,p99_us,max_us\n";
+
+    for (const CmdLatency& cmd : m_stats.cmds)
+    {
+        const LatencyHistogram& hist = cmd.hist;
+
+        stream << cmd.cmd << "," << hist.getCount() << "," << QString::number(hist.getMean(), 'f', 1) << ","
+               << hist.getMin() << "," << hist.getPercentile(50) << "," << hist.getPercentile(90) << ","
+               << hist.getPercentile(99) << "," << hist.getMax() << "\n";
+    }
+
+    stream << "\ncmd,bucket_from_us,bucket_to_us,count\n";
+
+    for (const CmdLatency& cmd : m_stats.cmds)
+    {
+        for (int i = 0; i < HIST_BUCKETS; i++)
+        {
+            if (cmd.hist.getBucketCount(i) == 0)
+                continue;
+
+            stream << cmd.cmd << "," << LatencyHistogram::bucketLow(i) << ","
+                   << LatencyHistogram::bucketHigh(i) << "," << cmd.hist.getBucketCount(i) << "\n";
+        }
+    }
+
+    file.close();
+}
+
+/* private */
+
+void WindowDiag::closeEvent(QCloseEvent*)
+{
+    m_timer_refresh->stop();
+}
+
+void WindowDiag::showEvent(QShowEvent*)
+{
+    emit commStatsRequest();
+    m_timer_refresh->start(TIMER_DIAG);
+}
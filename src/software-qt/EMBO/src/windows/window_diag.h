@@ -0,0 +1,56 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef WINDOW_DIAG_H
+#define WINDOW_DIAG_H
+
+#include "containers.h"
+
+#include <QMainWindow>
+#include <QTimer>
+
+
+QT_BEGIN_NAMESPACE
+namespace Ui { class WindowDiag; }
+QT_END_NAMESPACE
+
+class Core;
+
+
+class WindowDiag : public QMainWindow
+{
+    Q_OBJECT
+
+public:
+    explicit WindowDiag(Core* core, QWidget *parent = nullptr);
+    ~WindowDiag();
+
+signals:
+    void commStatsRequest();
+    void commStatsReset();
+
+private slots:
+    void on_commStats(const CommStats stats);
+    void on_pushButton_reset_clicked();
+    void on_pushButton_save_clicked();
+
+private:
+    void closeEvent(QCloseEvent *event) override;
+    void showEvent(QShowEvent* event) override;
+
+    /* main window */
+    Ui::WindowDiag* m_ui;
+
+    /* device */
+    Core* m_core;
+
+    /* refresh timer */
+    QTimer* m_timer_refresh;
+
+    /* data */
+    CommStats m_stats;
+};
+
+#endif // WINDOW_DIAG_H
@@ -7,6 +7,7 @@
 #include "ui_window_la.h"
 #include "core.h"
 #include "utils.h"
+#include "daqconv.h"
 #include "settings.h"
 #include "css.h"
 
@@ -18,9 +19,10 @@
 #define TRIG_VAL_PRE_TIMEOUT    3000
 
 
-WindowLa::WindowLa(QWidget *parent) : QMainWindow(parent), m_ui(new Ui::WindowLa), m_rec(0)
+WindowLa::WindowLa(Core* core, QWidget *parent) : QMainWindow(parent), m_ui(new Ui::WindowLa), m_rec(0)
 {
     m_ui->setupUi(this);
+    m_core = core;
 
     m_timer_plot = new QTimer(this);
     m_timer_plot->setTimerType(Qt::PreciseTimer);
@@ -42,12 +44,12 @@ WindowLa::WindowLa(QWidget *parent) : QMainWindow(parent), m_ui(new Ui::WindowLa
     connect(m_msg_forceTrig, &Msg_LA_ForceTrig::ok, this, &WindowLa::on_msg_ok_forceTrig, Qt::QueuedConnection);
     //connect(m_msg_forceTrig, &Msg_LA_ForceTrig::err, this, &WindowLa::on_msg_err, Qt::QueuedConnection);
 
-    connect(Core::getInstance(), &Core::daqReady, this, &WindowLa::on_msg_daqReady, Qt::QueuedConnection);
+    connect(m_core, &Core::daqReady, this, &WindowLa::on_msg_daqReady, Qt::QueuedConnection);
 
     connect(m_timer_plot, &QTimer::timeout, this, &WindowLa::on_timer_plot);
     connect(m_timer_trigSliders, &QTimer::timeout, this, &WindowLa::on_hideTrigSliders);
 
-    connect(m_ui->actionEMBO_Help, SIGNAL(triggered()), Core::getInstance(), SLOT(on_actionEMBO_Help()));
+    connect(m_ui->actionEMBO_Help, &QAction::triggered, this, open_help);
 
     /* QCP */
 
@@ -321,34 +323,34 @@ void WindowLa::on_msg_err(const QString text, MsgBoxType type, bool needClose)
     msgBox(this, text, type);
 }
 
-void WindowLa::on_msg_ok_set(double fs_real_n, const QString fs_real)
+void WindowLa::on_msg_ok_set(const DaqSettings set)
 {
-    m_daqSet.fs_real = fs_real;
-    m_daqSet.fs_real_n = fs_real_n;
+    m_daqSet.fs_real = set.fs_real;
+    m_daqSet.fs_real_n = set.fs_real_n;
 
     updatePanel();
     m_msgPending = false;
 }
 
-void WindowLa::on_msg_set(int mem, int fs, int trig_ch, DaqTrigEdge trig_edge, DaqTrigMode trig_mode, int trig_pre, double fs_real_n, const QString fs_real)
+void WindowLa::on_msg_set(const DaqSettings set)
 {
-    auto info = Core::getInstance()->getDevInfo();
+    auto info = m_core->getDevInfo();
 
     m_daqSet.bits = B1;
-    m_daqSet.mem = mem;
-    m_daqSet.fs = fs;
+    m_daqSet.mem = set.mem;
+    m_daqSet.fs = set.fs;
     m_daqSet.ch1_en = true;
     m_daqSet.ch2_en = true;
     m_daqSet.ch3_en = info->daq_ch == 4 ? true : false;
     m_daqSet.ch4_en = info->daq_ch == 4 ? true : false;
-    m_daqSet.trig_ch = trig_ch;
+    m_daqSet.trig_ch = set.trig_ch;
     m_daqSet.trig_val = 0;
-    m_daqSet.trig_edge = trig_edge;
-    m_daqSet.trig_mode = trig_mode;
-    m_daqSet.trig_pre = trig_pre;
+    m_daqSet.trig_edge = set.trig_edge;
+    m_daqSet.trig_mode = set.trig_mode;
+    m_daqSet.trig_pre = set.trig_pre;
     m_daqSet.maxZ_ohm = 0;
-    m_daqSet.fs_real = fs_real;
-    m_daqSet.fs_real_n = fs_real_n;
+    m_daqSet.fs_real = set.fs_real;
+    m_daqSet.fs_real_n = set.fs_real_n;
 
     updatePanel();
     m_msgPending = false;
@@ -359,10 +361,10 @@ void WindowLa::on_msg_read(const QByteArray data)
     if (m_msgPending)
         return;
 
-    auto info = Core::getInstance()->getDevInfo();
+    auto info = m_core->getDevInfo();
     int data_sz = data.size();
 
-    int data_sz_wanted = m_daqSet.mem + (info->daq_reserve * 1);
+    int data_sz_wanted = la_frame_size(m_daqSet.mem, *info);
     if (data_sz != data_sz_wanted) // wrong data size
     {
         m_err_cntr++;
@@ -376,37 +378,13 @@ void WindowLa::on_msg_read(const QByteArray data)
         return;
     }
 
-    std::vector<qreal> buff(data_sz);
-
     QVector<double> y1(m_daqSet.mem);
     QVector<double> y2(m_daqSet.mem);
     QVector<double> y3(m_daqSet.mem);
     QVector<double> y4(m_daqSet.mem);
 
-    for (int k = 0, i = m_firstPos; k < m_daqSet.mem; k++, i++)
-    {
-        if (i >= data_sz)
-            i = 0;
-
-        bool ch1 = (data[i] & (1 << info->la_ch1_pin)) != 0;
-        bool ch2 = (data[i] & (1 << info->la_ch2_pin)) != 0;
-        bool ch3 = false;
-        bool ch4 = false;
-
-        if (info->daq_ch == 4)
-        {
-            ch3 = (data[i] & (1 << info->la_ch3_pin)) != 0;
-            ch4 = (data[i] & (1 << info->la_ch4_pin)) != 0;
-        }
-
-        y1[k] = ch1 ? 1.0 : 0.0;
-        y2[k] = ch2 ? 1.0 : 0.0;
-        if (info->daq_ch == 4)
-        {
-            y3[k] = ch3 ? 1.0 : 0.0;
-            y4[k] = ch4 ? 1.0 : 0.0;
-        }
-    }
+    QVector<double>* y[DAQ_CH_NUM] = { &y1, &y2, &y3, &y4 };
+    la_frame_to_vals(data, m_firstPos, m_daqSet.mem, *info, y);
 
     assert(!m_t.isEmpty());
 
@@ -450,7 +428,7 @@ void WindowLa::on_msg_daqReady(Ready ready, int firstPos)
         m_ui->radioButton_trigLed->setChecked(false);
 
     if (m_instrEnabled)
-        Core::getInstance()->msgAdd(m_msg_read, true);
+        m_core->msgAdd(m_msg_read, true);
 }
 
 void WindowLa::on_msg_ok_forceTrig(const QString, const QString)
@@ -500,7 +478,7 @@ void WindowLa::on_actionViewLines_triggered(bool checked)
 
 void WindowLa::on_actionExportSave_triggered()
 {
-    auto info = Core::getInstance()->getDevInfo();
+    auto info = m_core->getDevInfo();
     auto sys = QSysInfo();
 
     QMap<QString, QString> header {
@@ -786,7 +764,7 @@ void WindowLa::on_pushButton_reset_clicked()
 
     on_pushButton_resetZoom_clicked();
 
-    Core::getInstance()->sendRst(LA);
+    m_core->sendRst(LA);
 
     showEvent(NULL);
 }
@@ -1085,7 +1063,7 @@ void WindowLa::on_pushButton_trigForc_clicked()
     m_ui->radioButton_trigLed->setChecked(false);
     enablePanel(false);
 
-    Core::getInstance()->msgAdd(m_msg_forceTrig, false, "");
+    m_core->msgAdd(m_msg_forceTrig, false, "");
 }
 
 void WindowLa::on_dial_trigPre_sliderPressed()
@@ -1311,7 +1289,7 @@ void WindowLa::on_pushButton_disable2_clicked()
 
 void WindowLa::on_pushButton_disable3_clicked()
 {
-    auto info = Core::getInstance()->getDevInfo();
+    auto info = m_core->getDevInfo();
     if (info->daq_ch == 4)
     {
         if ((m_daqSet.ch1_en + m_daqSet.ch2_en + m_daqSet.ch3_en + m_daqSet.ch4_en) == 1)
@@ -1334,7 +1312,7 @@ void WindowLa::on_pushButton_disable3_clicked()
 
 void WindowLa::on_pushButton_disable4_clicked()
 {
-    auto info = Core::getInstance()->getDevInfo();
+    auto info = m_core->getDevInfo();
     if (info->daq_ch == 4)
     {
         if ((m_daqSet.ch1_en + m_daqSet.ch2_en + m_daqSet.ch3_en + m_daqSet.ch4_en) == 1)
@@ -1383,7 +1361,7 @@ void WindowLa::on_pushButton_enable2_clicked()
 
 void WindowLa::on_pushButton_enable3_clicked()
 {
-    auto info = Core::getInstance()->getDevInfo();
+    auto info = m_core->getDevInfo();
     if (info->daq_ch == 4)
     {
         m_ui->pushButton_enable3->hide();
@@ -1400,7 +1378,7 @@ void WindowLa::on_pushButton_enable3_clicked()
 
 void WindowLa::on_pushButton_enable4_clicked()
 {
-    auto info = Core::getInstance()->getDevInfo();
+    auto info = m_core->getDevInfo();
     if (info->daq_ch == 4)
     {
         m_ui->pushButton_enable4->hide();
@@ -1426,7 +1404,7 @@ void WindowLa::closeEvent(QCloseEvent*)
     m_activeMsgs.clear();
     m_instrEnabled = false;
 
-    Core::getInstance()->setMode(NO_MODE);
+    m_core->setMode(NO_MODE);
     emit closing(WindowLa::staticMetaObject.className());
 
      m_timer_plot->stop();
@@ -1440,11 +1418,11 @@ void WindowLa::showEvent(QShowEvent*)
 
     enablePanel(false);
 
-    Core::getInstance()->setMode(LA);
+    m_core->setMode(LA);
     if (m_ui->pushButton_run->isVisible())
         m_instrEnabled = true;
 
-    auto info = Core::getInstance()->getDevInfo();
+    auto info = m_core->getDevInfo();
 
     m_err_cntr = 0;
     m_ref_v = info->ref_mv / 1000.0;
@@ -1462,7 +1440,7 @@ void WindowLa::showEvent(QShowEvent*)
         //m_ui->label_pins->setText("Vertical (" + m_pin1 + ", " + m_pin2 + ", " + m_pin3 + ", " + m_pin4 + ")");
     }
 
-    Core::getInstance()->msgAdd(m_msg_set, true, "");
+    m_core->msgAdd(m_msg_set, true, "");
 
     if (m_instrEnabled)
     {
@@ -1631,7 +1609,7 @@ void WindowLa::createX()
 
 void WindowLa::updatePanel()
 {
-    auto info = Core::getInstance()->getDevInfo();
+    auto info = m_core->getDevInfo();
 
     m_ignoreValuesChanged = true;
 
@@ -1917,7 +1895,7 @@ void WindowLa::enablePanel(bool en)
 
 void WindowLa::sendSet()
 {
-    auto info = Core::getInstance()->getDevInfo();
+    auto info = m_core->getDevInfo();
 
     m_msgPending = true;
     enablePanel(false);
@@ -1999,7 +1977,7 @@ void WindowLa::sendSet()
         else break;
     }
 
-    Core::getInstance()->msgAdd(m_msg_set, false, QString::number(m_daqSet.mem) + "," +       // mem
+    m_core->msgAdd(m_msg_set, false, QString::number(m_daqSet.mem) + "," +       // mem
                                                   QString::number(m_daqSet.fs) + "," +        // fs
                                                   QString::number(m_daqSet.trig_ch) + "," +   // trig ch
                                                   trigEdge + "," +                            // trig edge
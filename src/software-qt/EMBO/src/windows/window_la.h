@@ -39,7 +39,7 @@ class WindowLa : public QMainWindow, public IEmboInstrument
     Q_OBJECT
 
 public:
-    explicit WindowLa(QWidget *parent = nullptr);
+    explicit WindowLa(Core* core, QWidget *parent = nullptr);
     ~WindowLa();
 
     bool getInstrEnabled() override { return m_instrEnabled; };
@@ -50,12 +50,12 @@ signals:
 
 private slots:
     /* data msg */
-    void on_msg_set(int mem, int fs, int trig_ch, DaqTrigEdge trig_edge, DaqTrigMode trig_mode, int trig_pre, double fs_real_n, const QString fs_real);
+    void on_msg_set(const DaqSettings set);
     void on_msg_read(const QByteArray data);
 
     /* ok-err msg */
     void on_msg_err(const QString text, MsgBoxType type, bool needClose);
-    void on_msg_ok_set(double fs_real_n, const QString fs_real);
+    void on_msg_ok_set(const DaqSettings set);
     void on_msg_ok_forceTrig(const QString, const QString);
 
      /* async ready msg */
@@ -17,9 +17,10 @@
 
 QString WindowPwm::s_freq_real = "1000.0";
 
-WindowPwm::WindowPwm(QWidget *parent) : QMainWindow(parent), m_ui(new Ui::WindowPwm)
+WindowPwm::WindowPwm(Core* core, QWidget *parent) : QMainWindow(parent), m_ui(new Ui::WindowPwm)
 {
     m_ui->setupUi(this);
+    m_core = core;
 
     m_msg_set = new Msg_PWM_Set(this);
 
@@ -27,7 +28,7 @@ WindowPwm::WindowPwm(QWidget *parent) : QMainWindow(parent), m_ui(new Ui::Window
     connect(m_msg_set, &Msg_PWM_Set::err, this, &WindowPwm::on_msg_err, Qt::QueuedConnection);
     connect(m_msg_set, &Msg_PWM_Set::result, this, &WindowPwm::on_msg_set, Qt::QueuedConnection);
 
-    connect(m_ui->actionEMBO_Help, SIGNAL(triggered()), Core::getInstance(), SLOT(on_actionEMBO_Help()));
+    connect(m_ui->actionEMBO_Help, &QAction::triggered, this, open_help);
 
     m_ui->textBrowser_realFreq->setHtml("<p align=\"right\">? Hz&nbsp;&nbsp;&nbsp;</p>");
 
@@ -135,7 +136,7 @@ void WindowPwm::on_msg_set(int freq, int duty1, int duty2, int offset, bool en1,
     m_ui->dial_duty2->setValue(duty2);
     m_ui->dial_offset->setValue(offset);
 
-    auto info = Core::getInstance()->getDevInfo();
+    auto info = m_core->getDevInfo();
 
     m_ui->spinBox_freq->setRange(1, info->pwm_fs);
     m_ui->dial_freq->setRange(1, info->pwm_fs);
@@ -318,7 +319,7 @@ void WindowPwm::showEvent(QShowEvent*)
     m_ui->pushButton_ch2enable->show();
     m_ui->pushButton_ch2disable->hide();
 
-    auto info = Core::getInstance()->getDevInfo();
+    auto info = m_core->getDevInfo();
 
     if (!info->pwm2)
     {
@@ -342,7 +343,7 @@ void WindowPwm::showEvent(QShowEvent*)
 
     m_ignoreValuesChanged = false;
 
-    Core::getInstance()->msgAdd(m_msg_set, true, "");
+    m_core->msgAdd(m_msg_set, true, "");
 }
 
 void WindowPwm::enableAll(bool enable)
@@ -365,7 +366,7 @@ void WindowPwm::enableAll(bool enable)
 
     m_ui->textBrowser_realFreq->setEnabled(enable);
 
-    auto info = Core::getInstance()->getDevInfo();
+    auto info = m_core->getDevInfo();
 
     if (enable)
     {
@@ -423,7 +424,7 @@ void WindowPwm::sendSet(bool en1, bool en2)
 {
     enableAll(false);
 
-    Core::getInstance()->msgAdd(m_msg_set, false, QString::number(m_ui->spinBox_freq->value()) + EMBO_DELIM2 +
+    m_core->msgAdd(m_msg_set, false, QString::number(m_ui->spinBox_freq->value()) + EMBO_DELIM2 +
                                                   QString::number(m_ui->spinBox_duty1->value()) + EMBO_DELIM2 +
                                                   QString::number(m_ui->spinBox_duty2->value()) + EMBO_DELIM2 +
                                                   QString::number(m_ui->spinBox_offset->value()) + EMBO_DELIM2 +
@@ -24,7 +24,7 @@ class WindowPwm : public QMainWindow, public IEmboInstrument
     Q_OBJECT
 
 public:
-    explicit WindowPwm(QWidget *parent = nullptr);
+    explicit WindowPwm(Core* core, QWidget *parent = nullptr);
     ~WindowPwm();
 
     bool getInstrEnabled() override { return m_instrEnabled; };
@@ -8,6 +8,7 @@
 #include "window_pwm.h"
 #include "core.h"
 #include "utils.h"
+#include "daqconv.h"
 #include "settings.h"
 #include "css.h"
 
@@ -16,6 +17,8 @@
 #include <QMap>
 #include <QDateTime>
 #include <QMessageBox>
+#include <QFileDialog>
+#include <QInputDialog>
 
 
 #define Y_LIM1                  0.50    // spline on
@@ -26,10 +29,13 @@
 #define FFT_DB_MIN              -100
 #define FFT_DB_MAX              0
 
+#define PERSISTENCE_Z_MAX       12      // log2 of saturated bin
 
-WindowScope::WindowScope(QWidget *parent) : QMainWindow(parent), m_ui(new Ui::WindowScope), m_rec(4)
+
+WindowScope::WindowScope(Core* core, QWidget *parent) : QMainWindow(parent), m_ui(new Ui::WindowScope), m_rec(4)
 {
     m_ui->setupUi(this);
+    m_core = core;
 
     m_timer_plot = new QTimer(this);
     m_timer_plot->setTimerType(Qt::PreciseTimer);
@@ -51,12 +57,12 @@ WindowScope::WindowScope(QWidget *parent) : QMainWindow(parent), m_ui(new Ui::Wi
     connect(m_msg_forceTrig, &Msg_SCOP_ForceTrig::ok, this, &WindowScope::on_msg_ok_forceTrig, Qt::QueuedConnection);
     //connect(m_msg_forceTrig, &Msg_SCOP_ForceTrig::err, this, &WindowScope::on_msg_err, Qt::QueuedConnection);
 
-    connect(Core::getInstance(), &Core::daqReady, this, &WindowScope::on_msg_daqReady, Qt::QueuedConnection);
+    connect(m_core, &Core::daqReady, this, &WindowScope::on_msg_daqReady, Qt::QueuedConnection);
 
     connect(m_timer_plot, &QTimer::timeout, this, &WindowScope::on_timer_plot);
     connect(m_timer_trigSliders, &QTimer::timeout, this, &WindowScope::on_hideTrigSliders);
 
-    connect(m_ui->actionEMBO_Help, SIGNAL(triggered()), Core::getInstance(), SLOT(on_actionEMBO_Help()));
+    connect(m_ui->actionEMBO_Help, &QAction::triggered, this, open_help);
 
     /* QCP */
 
@@ -120,6 +126,7 @@ void WindowScope::statusBarLoad()
     m_status_seq = new QLabel("Sequence Number: 0", this);
     m_status_smpl = new QLabel("Sampling Time: 1.5", this);
     m_status_ets = new QLabel("", this);
+    m_status_mask = new QLabel("", this);
 
     QWidget* widget = new QWidget(this);
     QLabel* status_zoom = new QLabel("<span>Zoom with Scroll Wheel, Move with Mouse Drag&nbsp;&nbsp;<span>", this);
@@ -129,6 +136,7 @@ void WindowScope::statusBarLoad()
     m_status_seq->setFont(font1);
     m_status_smpl->setFont(font1);
     m_status_ets->setFont(font1);
+    m_status_mask->setFont(font1);
     status_zoom->setFont(font1);
 
     QLabel* status_img = new QLabel(this);
@@ -158,12 +166,20 @@ void WindowScope::statusBarLoad()
     m_status_line3->setFixedHeight(18);
     m_status_line3->setVisible(false);
 
+    m_status_line4 = new QFrame(this);
+    m_status_line4->setFrameShape(QFrame::VLine);
+    m_status_line4->setFrameShadow(QFrame::Plain);
+    m_status_line4->setStyleSheet("color:gray;");
+    m_status_line4->setFixedHeight(18);
+    m_status_line4->setVisible(false);
+
     QLabel* status_spacer2 = new QLabel("<span>&nbsp;&nbsp;&nbsp;</span>", this);
     QLabel* status_spacer3 = new QLabel("<span>&nbsp;&nbsp;&nbsp;</span>", this);
     QLabel* status_spacer4 = new QLabel("<span>&nbsp;&nbsp;&nbsp;</span>", this);
     QLabel* status_spacer5 = new QLabel("<span>&nbsp;&nbsp;&nbsp;</span>", this);
     QLabel* status_spacer6 = new QLabel("<span>&nbsp;&nbsp;&nbsp;</span>", this);
     QLabel* status_spacer7 = new QLabel("<span>&nbsp;&nbsp;&nbsp;</span>", this);
+    QLabel* status_spacer8 = new QLabel("<span>&nbsp;&nbsp;&nbsp;</span>", this);
 
     QSpacerItem* status_spacer0 = new QSpacerItem(1, 1, QSizePolicy::Expanding, QSizePolicy::Preferred);
 
@@ -182,8 +198,11 @@ void WindowScope::statusBarLoad()
     layout->addWidget(m_status_line3, 0,11,1,1,Qt::AlignVCenter);
     layout->addWidget(status_spacer7, 0,12,1,1,Qt::AlignVCenter);
     layout->addWidget(m_status_ets,   0,13,1,1,Qt::AlignVCenter | Qt::AlignLeft);
-    layout->addItem(status_spacer0,   0,14,1,1,Qt::AlignVCenter);
-    layout->addWidget(status_zoom,    0,15,1,1,Qt::AlignVCenter);
+    layout->addWidget(m_status_line4, 0,14,1,1,Qt::AlignVCenter);
+    layout->addWidget(status_spacer8, 0,15,1,1,Qt::AlignVCenter);
+    layout->addWidget(m_status_mask,  0,16,1,1,Qt::AlignVCenter | Qt::AlignLeft);
+    layout->addItem(status_spacer0,   0,17,1,1,Qt::AlignVCenter);
+    layout->addWidget(status_zoom,    0,18,1,1,Qt::AlignVCenter);
     layout->setMargin(0);
     layout->setSpacing(0);
 
@@ -311,6 +330,35 @@ void WindowScope::initQcp()
     m_cursors = new QCPCursors(this, m_ui->customPlot, m_axis_scope, false, QColor(COLOR3), QColor(COLOR3), QColor(COLOR7), QColor(Qt::black));
     m_cursorTrigVal = new QCPCursor(this, m_ui->customPlot, NULL, true, false, QColor(COLOR9));
     m_cursorTrigPre = new QCPCursor(this, m_ui->customPlot, NULL, false, false, QColor(COLOR9));
+
+    /* persistence - color map under live traces */
+
+    m_ui->customPlot->addLayer("persistence", m_ui->customPlot->layer("main"), QCustomPlot::limBelow);
+
+    QCPColorGradient gradient;
+    gradient.setColorStopAt(0.0, QColor(0, 0, 0, 0));
+    gradient.setColorStopAt(0.01, QColor(0, 60, 255, 90));
+    gradient.setColorStopAt(0.4, QColor(0, 220, 255, 160));
+    gradient.setColorStopAt(0.7, QColor(255, 220, 0, 200));
+    gradient.setColorStopAt(1.0, QColor(255, 40, 0, 230));
+
+    m_persist_map = new QCPColorMap(m_axis_scope->axis(QCPAxis::atBottom), m_axis_scope->axis(QCPAxis::atLeft));
+    m_persist_map->setLayer("persistence");
+    m_persist_map->setGradient(gradient);
+    m_persist_map->setDataRange(QCPRange(0, PERSISTENCE_Z_MAX));
+    m_persist_map->setInterpolate(false);
+    m_persist_map->setTightBoundary(true);
+    m_persist_map->setVisible(false);
+
+    /* XY */
+
+    m_ui->customPlot->addLayer("xy_hidden", m_ui->customPlot->layer("persistence"), QCustomPlot::limBelow);
+    m_ui->customPlot->layer("xy_hidden")->setVisible(false);
+
+    m_xy_curve = new QCPCurve(m_axis_scope->axis(QCPAxis::atBottom), m_axis_scope->axis(QCPAxis::atLeft));
+    m_xy_curve->setPen(QPen(QColor(COLOR1)));
+    m_xy_curve->setVisible(false);
+    xyCurveStyle();
 }
 
 WindowScope::~WindowScope()
@@ -342,6 +390,20 @@ void WindowScope::on_timer_plot() // 60 FPS
         m_cursors->refresh(rngV.lower, rngV.upper, rngH.lower, rngH.upper, false); // true
     }
 
+    if (m_persistence)
+        m_persist.render(m_persist_map->data());
+
+    if (m_mask_en)
+    {
+        m_status_mask->setText("Mask: " + QString::number(m_mask.getPass()) + " pass / " +
+                               QString::number(m_mask.getFail()) + " fail");
+
+        if (m_mask.getFirstFailFrame() >= 0)
+            m_ui->actionMaskFirstFail->setText("first fail: CH" + QString::number(m_mask.getFirstFailCh() + 1) +
+                                               " @ " + QString::number(m_mask.getFirstFailIdx()) +
+                                               " (frame " + QString::number(m_mask.getFirstFailFrame()) + ")");
+    }
+
     m_ui->customPlot->replot();
 }
 
@@ -357,37 +419,20 @@ void WindowScope::on_msg_err(const QString text, MsgBoxType type, bool needClose
     msgBox(this, text, type);
 }
 
-void WindowScope::on_msg_ok_set(double maxZ, double smpl_time, double fs_real_n, const QString fs_real)
+void WindowScope::on_msg_ok_set(const DaqSettings set)
 {
-    m_daqSet.maxZ_ohm = maxZ;
-    m_daqSet.smpl_time = smpl_time;
-    m_daqSet.fs_real = fs_real;
-    m_daqSet.fs_real_n = fs_real_n;
+    m_daqSet.maxZ_ohm = set.maxZ_ohm;
+    m_daqSet.smpl_time = set.smpl_time;
+    m_daqSet.fs_real = set.fs_real;
+    m_daqSet.fs_real_n = set.fs_real_n;
 
     updatePanel();
     m_msgPending = false;
 }
 
-void WindowScope::on_msg_set(DaqBits bits, int mem, int fs, bool ch1, bool ch2, bool ch3, bool ch4, int trig_ch, int trig_val,
-                             DaqTrigEdge trig_edge, DaqTrigMode trig_mode, int trig_pre, double maxZ,
-                             double smpl_time, double fs_real_n, const QString fs_real)
-{
-    m_daqSet.bits = bits;
-    m_daqSet.mem = mem;
-    m_daqSet.fs = fs;
-    m_daqSet.ch1_en = ch1;
-    m_daqSet.ch2_en = ch2;
-    m_daqSet.ch3_en = ch3;
-    m_daqSet.ch4_en = ch4;
-    m_daqSet.trig_ch = trig_ch;
-    m_daqSet.trig_val = trig_val;
-    m_daqSet.trig_edge = trig_edge;
-    m_daqSet.trig_mode = trig_mode;
-    m_daqSet.trig_pre = trig_pre;
-    m_daqSet.maxZ_ohm = maxZ;
-    m_daqSet.smpl_time = smpl_time;
-    m_daqSet.fs_real = fs_real;
-    m_daqSet.fs_real_n = fs_real_n;
+void WindowScope::on_msg_set(const DaqSettings set)
+{
+    m_daqSet = set;
 
     updatePanel();
     m_msgPending = false;
@@ -400,11 +445,9 @@ void WindowScope::on_msg_read(const QByteArray data)
 
     /************* parse circular buffer(s) *************/
 
-    auto info = Core::getInstance()->getDevInfo();
+    auto info = m_core->getDevInfo();
     int ch_num = m_daqSet.ch1_en + m_daqSet.ch2_en + m_daqSet.ch3_en + m_daqSet.ch4_en;
 
-    const uint8_t* dataU8 = reinterpret_cast<const uint8_t*>(data.constData());
-
     QVector<double> y1(m_daqSet.mem);
     QVector<double> y2(m_daqSet.mem);
     QVector<double> y3(m_daqSet.mem);
@@ -415,145 +458,11 @@ void WindowScope::on_msg_read(const QByteArray data)
     QVector<double>* _y3 = (m_daqSet.ch3_en ? &y3 : NULL);
     QVector<double>* _y4 = (m_daqSet.ch4_en ? &y4 : NULL);
 
-    double vcc = info->ref_mv / 1000.0;
-    int found = 0;
-
-    if (info->adc_num == 1)
-    {
-        uint8_t* buff1 = (uint8_t*)dataU8;
-        int buff1_len = data.size();
-
-        if (m_daqSet.bits == B12)
-            buff1_len /= 2;
-
-        int buff1_mem = buff1_len - (info->daq_reserve * ch_num);
-
-        found += get_vals_from_circ(m_firstPos, buff1_mem, buff1_len, m_daqSet.bits, vcc, buff1, _y1, _y2, _y3, _y4,
-                                    m_gain1, m_gain2, m_gain3, m_gain4, m_offset1, m_offset2, m_offset3, m_offset4);
-
-    }
-    else if (info->adc_num == 2)
-    {
-        int buff_part = data.size();
-        int buff_part_raw = buff_part;
-
-        if (m_daqSet.bits == B12)
-            buff_part /= 2;
-        buff_part /= ch_num;
-        buff_part_raw /= ch_num;
-
-        uint8_t* buff_it = (uint8_t*)dataU8;
-
-        uint8_t* buff1 = NULL;
-        int buff1_len = 0;
-        int buff1_mem;
-
-        uint8_t* buff2 = NULL;
-        int buff2_len = 0;
-        int buff2_mem;
-
-        if (m_daqSet.ch1_en)
-        {
-            buff1 = buff_it;
-            buff_it += buff_part_raw;
-            buff1_len += buff_part;
-        }
-        if (m_daqSet.ch2_en)
-        {
-            if (!m_daqSet.ch1_en)
-                buff1 = buff_it;
-            buff_it += buff_part_raw;
-            buff1_len += buff_part;
-        }
-        if (m_daqSet.ch3_en)
-        {
-            buff2 = buff_it;
-            buff_it += buff_part_raw;
-            buff2_len += buff_part;
-        }
-        if (m_daqSet.ch4_en)
-        {
-            if (!m_daqSet.ch3_en)
-                buff2 = buff_it;
-            //buff_it += buff_part_raw;
-            buff2_len += buff_part;
-        }
-
-        buff1_mem = buff1_len - (info->daq_reserve * (m_daqSet.ch1_en + m_daqSet.ch2_en));
-        buff2_mem = buff2_len - (info->daq_reserve * (m_daqSet.ch3_en + m_daqSet.ch4_en));
-
-        if (m_daqSet.ch1_en || m_daqSet.ch2_en)
-            found += get_vals_from_circ(m_firstPos, buff1_mem, buff1_len, m_daqSet.bits, vcc, buff1, _y1, _y2, NULL, NULL,
-                                        m_gain1, m_gain2, 0, 0, m_offset1, m_offset2, 0, 0);
-        if (m_daqSet.ch3_en || m_daqSet.ch4_en)
-            found += get_vals_from_circ(m_firstPos, buff2_mem, buff2_len, m_daqSet.bits, vcc, buff2, _y3, _y4, NULL, NULL,
-                                        m_gain3, m_gain4, 0, 0, m_offset3, m_offset4, 0, 0);
-
-    }
-    else if (info->adc_num == 4)
-    {
-        int buff_part = data.size();
-        int buff_part_raw = buff_part;
-
-        if (m_daqSet.bits == B12)
-            buff_part /= 2;
-        buff_part /= ch_num;
-        buff_part_raw /= ch_num;
-
-        uint8_t* buff_it = (uint8_t*)dataU8;
-
-        uint8_t* buff1 = NULL;
-        int buff1_len = buff_part;
-        int buff1_mem = buff1_len - (info->daq_reserve);
-
-        uint8_t* buff2 = NULL;
-        int buff2_len = buff_part;
-        int buff2_mem = buff2_len - (info->daq_reserve);
-
-        uint8_t* buff3 = NULL;
-        int buff3_len = buff_part;
-        int buff3_mem = buff3_len - (info->daq_reserve);
-
-        uint8_t* buff4 = NULL;
-        int buff4_len = buff_part;
-        int buff4_mem = buff4_len - (info->daq_reserve);
-
-        if (m_daqSet.ch1_en)
-        {
-            buff1 = buff_it;
-            buff_it += buff_part_raw;
-        }
-        if (m_daqSet.ch2_en)
-        {
-            buff2 = buff_it;
-            buff_it += buff_part_raw;
-        }
-        if (m_daqSet.ch3_en)
-        {
-            buff3 = buff_it;
-            buff_it += buff_part_raw;
-        }
-        if (m_daqSet.ch4_en)
-        {
-            buff4 = buff_it;
-            buff_it += buff_part_raw;
-        }
+    QVector<double>* y[DAQ_CH_NUM] = { _y1, _y2, _y3, _y4 };
+    const double gain[DAQ_CH_NUM] = { m_gain1, m_gain2, m_gain3, m_gain4 };
+    const double offset[DAQ_CH_NUM] = { m_offset1, m_offset2, m_offset3, m_offset4 };
 
-        if (m_daqSet.ch1_en)
-            found += get_vals_from_circ(m_firstPos, buff1_mem, buff1_len, m_daqSet.bits, vcc, buff1, _y1, NULL, NULL, NULL,
-                                        m_gain1, 0, 0, 0, m_offset1, 0, 0, 0);
-        if (m_daqSet.ch2_en)
-            found += get_vals_from_circ(m_firstPos, buff2_mem, buff2_len, m_daqSet.bits, vcc, buff2, _y2, NULL, NULL, NULL,
-                                        m_gain2, 0, 0, 0, m_offset2, 0, 0, 0);
-        if (m_daqSet.ch3_en)
-            found += get_vals_from_circ(m_firstPos, buff3_mem, buff3_len, m_daqSet.bits, vcc, buff3, _y3, NULL, NULL, NULL,
-                                        m_gain3, 0, 0, 0, m_offset3, 0, 0, 0);
-        if (m_daqSet.ch4_en)
-            found += get_vals_from_circ(m_firstPos, buff4_mem, buff4_len, m_daqSet.bits, vcc, buff4, _y4, NULL, NULL, NULL,
-                                        m_gain4, 0, 0, 0, m_offset4, 0, 0, 0);
-
-    }
-    else assert(0);
+    int found = scope_frame_to_vals(data, m_firstPos, m_daqSet, *info, gain, offset, y);
 
     if (found / ch_num != m_daqSet.mem) // wrong data size
     {
@@ -582,6 +491,22 @@ void WindowScope::on_msg_read(const QByteArray data)
         }
     }
 
+    /************* soft trigger *************/
+
+    double t_shift = 0;
+
+    if (m_softTrig_en)
+    {
+        QVector<double>* y_trig[SOFTTRIG_CH_NUM] = { _y1, _y2, _y3, _y4 };
+        int idx = m_softTrig.find(m_t, y_trig);
+
+        if (idx < 0) // condition not met, keep last frame on screen
+            return;
+
+        if (!m_math_xy_12 && !m_math_xy_34) // move trigger to pretrigger position
+            t_shift = m_t[((m_t.size() - 1) * m_daqSet.trig_pre) / 100] - m_t[idx];
+    }
+
     /************* average *************/
 
     if (m_average)
@@ -621,37 +546,112 @@ void WindowScope::on_msg_read(const QByteArray data)
             m_average_it = 0;
     }
 
-    /************* plot data *************/
-
     assert(!m_t.isEmpty());
 
-    if (m_math_xy_12 || m_math_xy_34)
+    QVector<double> t = m_t; // implicitly shared, detached only when shifted
+
+    if (t_shift != 0)
+    {
+        for (auto& x : t)
+            x += t_shift;
+    }
+
+    /************* mask test *************/
+
+    bool mask_failed = false;
+
+    if (m_mask_capture)
+    {
+        if (m_daqSet.ch1_en) m_mask.setGolden(0, t, y1, m_mask_tol);
+        if (m_daqSet.ch2_en) m_mask.setGolden(1, t, y2, m_mask_tol);
+        if (m_daqSet.ch3_en) m_mask.setGolden(2, t, y3, m_mask_tol);
+        if (m_daqSet.ch4_en) m_mask.setGolden(3, t, y4, m_mask_tol);
+
+        m_mask.reset();
+        m_mask_capture = false;
+    }
+
+    if (m_mask_en && !m_math_xy_12 && !m_math_xy_34)
+    {
+        QVector<double>* y_mask[MASK_CH_NUM] = { _y1, (m_math_2minus1 ? NULL : _y2), _y3, (m_math_4minus3 ? NULL : _y4) };
+
+        m_mask.compile(t);
+        mask_failed = !m_mask.test(y_mask);
+    }
+
+    /************* persistence *************/
+
+    if (m_persistence)
     {
+        QRect rect = m_axis_scope->rect();
+
+        bool resized = m_persist.setSize(rect.width(), rect.height());
+        bool moved = m_persist.setRange(m_axis_scope->axis(QCPAxis::atBottom)->range(), m_axis_scope->axis(QCPAxis::atLeft)->range());
+
+        if (resized || moved) // zoom or resize, start over
+            m_persist_map->data()->fill(0);
+
         if (m_math_xy_12)
         {
-            if (m_daqSet.ch1_en && m_daqSet.ch2_en)
-                m_ui->customPlot->graph(GRAPH_CH1)->setData(y1, y2);
+            if (m_daqSet.ch1_en && m_daqSet.ch2_en) m_persist.addFrameXY(y1, y2);
         }
-
-        if (m_math_xy_34)
+        else if (m_math_xy_34)
         {
-            if (m_daqSet.ch3_en && m_daqSet.ch4_en)
-                m_ui->customPlot->graph(GRAPH_CH3)->setData(y3, y4);
+            if (m_daqSet.ch3_en && m_daqSet.ch4_en) m_persist.addFrameXY(y3, y4);
+        }
+        else
+        {
+            if (m_daqSet.ch1_en) m_persist.addFrame(t, y1);
+            if (m_daqSet.ch2_en && !m_math_2minus1) m_persist.addFrame(t, y2);
+            if (m_daqSet.ch3_en) m_persist.addFrame(t, y3);
+            if (m_daqSet.ch4_en && !m_math_4minus3) m_persist.addFrame(t, y4);
         }
     }
-    else
+
+    /************* plot data *************/
+
+    if (m_math_xy_12 && m_daqSet.ch1_en && m_daqSet.ch2_en)
+        m_xy.setData(m_xy_curve, y1, y2);
+
+    if (m_math_xy_34 && m_daqSet.ch3_en && m_daqSet.ch4_en)
+        m_xy.setData(m_xy_curve, y3, y4);
+
+    /* in XY mode graphs of the pair are on hidden layer, their data serve meas and export */
+
+    if (m_daqSet.ch1_en)
+        m_ui->customPlot->graph(GRAPH_CH1)->setData(t, y1, true);
+
+    if (!m_math_2minus1 && m_daqSet.ch2_en)
+        m_ui->customPlot->graph(GRAPH_CH2)->setData(t, y2, true);
+
+    if (m_daqSet.ch3_en)
+        m_ui->customPlot->graph(GRAPH_CH3)->setData(t, y3, true);
+
+    if (!m_math_4minus3 && m_daqSet.ch4_en)
+        m_ui->customPlot->graph(GRAPH_CH4)->setData(t, y4, true);
+
+    if (mask_failed && m_mask_stop && m_ui->pushButton_run->isVisible()) // keep failed frame on screen
+        on_pushButton_run_clicked();
+
+    /************* history *************/
+
+    if (!m_math_xy_12 && !m_math_xy_34)
     {
-        if (m_daqSet.ch1_en)
-            m_ui->customPlot->graph(GRAPH_CH1)->setData(m_t, y1);
+        HistoryFrame frame;
+        frame.t = t;
 
-        if (!m_math_2minus1 && m_daqSet.ch2_en)
-            m_ui->customPlot->graph(GRAPH_CH2)->setData(m_t, y2);
+        if (m_daqSet.ch1_en) frame.y[0] = y1;
+        if (m_daqSet.ch2_en && !m_math_2minus1) frame.y[1] = y2;
+        if (m_daqSet.ch3_en) frame.y[2] = y3;
+        if (m_daqSet.ch4_en && !m_math_4minus3) frame.y[3] = y4;
 
-        if (m_daqSet.ch3_en)
-            m_ui->customPlot->graph(GRAPH_CH3)->setData(m_t, y3);
+        m_history.push(frame);
+    }
 
-        if (!m_math_4minus3 && m_daqSet.ch4_en)
-            m_ui->customPlot->graph(GRAPH_CH4)->setData(m_t, y4);
+    if (m_history_pos >= 0) // live data again, playback ended
+    {
+        m_history_pos = -1;
+        m_ui->actionHistoryPos->setText("frame: live");
     }
 
     /************* meas *************/
@@ -791,7 +791,7 @@ void WindowScope::on_msg_daqReady(Ready ready, int firstPos)
         m_ui->radioButton_trigLed->setChecked(false);
 
     if (m_instrEnabled)
-        Core::getInstance()->msgAdd(m_msg_read, true);
+        m_core->msgAdd(m_msg_read, true);
 }
 
 void WindowScope::on_msg_ok_forceTrig(const QString, const QString)
@@ -799,6 +799,13 @@ void WindowScope::on_msg_ok_forceTrig(const QString, const QString)
     updatePanel();
 }
 
+void WindowScope::xyCurveStyle()
+{
+    m_xy_curve->setLineStyle(m_ui->actionViewLines->isChecked() ? QCPCurve::lsLine : QCPCurve::lsNone);
+    m_xy_curve->setScatterStyle(m_ui->actionViewPoints->isChecked() ? QCPScatterStyle(QCPScatterStyle::ssDisc, 5) :
+                                                                      QCPScatterStyle(QCPScatterStyle::ssNone));
+}
+
 /******************************** GUI slots ********************************/
 
 /********** Plot **********/
@@ -816,6 +823,7 @@ void WindowScope::on_actionViewPoints_triggered(bool checked)
     m_ui->customPlot->graph(GRAPH_CH2)->setScatterStyle(style);
     m_ui->customPlot->graph(GRAPH_CH3)->setScatterStyle(style);
     m_ui->customPlot->graph(GRAPH_CH4)->setScatterStyle(style);
+    m_xy_curve->setScatterStyle(style);
 
     m_ui->customPlot->replot();
 }
@@ -833,6 +841,7 @@ void WindowScope::on_actionViewLines_triggered(bool checked)
     m_ui->customPlot->graph(GRAPH_CH2)->setLineStyle(style);
     m_ui->customPlot->graph(GRAPH_CH3)->setLineStyle(style);
     m_ui->customPlot->graph(GRAPH_CH4)->setLineStyle(style);
+    m_xy_curve->setLineStyle(checked ? QCPCurve::lsLine : QCPCurve::lsNone);
 
     m_ui->customPlot->replot();
 }
@@ -861,11 +870,32 @@ void WindowScope::on_actionInterpSinc_triggered(bool checked) // exclusive with
     m_ui->customPlot->replot();
 }
 
+void WindowScope::on_actionPersistence_triggered(bool checked)
+{
+    m_persistence = checked;
+
+    m_persist.clear();
+    m_persist_map->data()->fill(0);
+    m_persist_map->setVisible(checked);
+
+    m_ui->actionPersistenceClear->setEnabled(checked);
+
+    m_ui->customPlot->replot();
+}
+
+void WindowScope::on_actionPersistenceClear_triggered()
+{
+    m_persist.clear();
+    m_persist_map->data()->fill(0);
+
+    m_ui->customPlot->replot();
+}
+
 /********** Export **********/
 
 void WindowScope::on_actionExportSave_triggered()
 {
-    auto info = Core::getInstance()->getDevInfo();
+    auto info = m_core->getDevInfo();
     auto sys = QSysInfo();
 
     QMap<QString, QString> header {
@@ -1188,11 +1218,12 @@ void WindowScope::on_actionMath_XY_X_1_Y_2_triggered(bool checked)
         m_ui->actionMath_3_4->setChecked(false);
         m_ui->actionMath_XY_X_3_Y_4->setChecked(false);
 
-        m_ui->actionViewLines->setChecked(false);
-        m_ui->actionViewPoints->setChecked(true);
+        m_ui->customPlot->graph(GRAPH_CH1)->setLayer("xy_hidden");
+        m_ui->customPlot->graph(GRAPH_CH2)->setLayer("xy_hidden");
 
-        on_actionViewLines_triggered(false);
-        on_actionViewPoints_triggered(true);
+        m_xy_curve->setPen(QPen(QColor(COLOR1)));
+        xyCurveStyle();
+        m_xy_curve->setVisible(true);
 
         m_axis_scope->axis(QCPAxis::atBottom)->setTicker(m_timeTicker2);
         rescaleXAxis();
@@ -1205,11 +1236,10 @@ void WindowScope::on_actionMath_XY_X_1_Y_2_triggered(bool checked)
         m_ui->pushButton_enable2->setText(" CH2  ");
         m_ui->pushButton_disable2->setText(" CH2  ");
 
-        m_ui->actionViewLines->setChecked(true);
-        m_ui->actionViewPoints->setChecked(false);
+        m_ui->customPlot->graph(GRAPH_CH1)->setLayer("main");
+        m_ui->customPlot->graph(GRAPH_CH2)->setLayer("main");
 
-        on_actionViewLines_triggered(true);
-        on_actionViewPoints_triggered(false);
+        m_xy_curve->setVisible(false);
 
         m_axis_scope->axis(QCPAxis::atBottom)->setTicker(m_timeTicker);
         rescaleXAxis();
@@ -1218,6 +1248,8 @@ void WindowScope::on_actionMath_XY_X_1_Y_2_triggered(bool checked)
     m_ui->customPlot->graph(GRAPH_CH1)->data()->clear();
     m_ui->customPlot->graph(GRAPH_CH2)->data()->clear();
     m_ui->customPlot->graph(GRAPH_FFT)->data()->clear();
+    m_xy_curve->data()->clear();
+    m_persist.clear();
 }
 
 void WindowScope::on_actionMath_XY_X_3_Y_4_triggered(bool checked)
@@ -1240,11 +1272,12 @@ void WindowScope::on_actionMath_XY_X_3_Y_4_triggered(bool checked)
         m_ui->actionMath_3_4->setChecked(false);
         m_ui->actionMath_XY_X_1_Y_2->setChecked(false);
 
-        m_ui->actionViewLines->setChecked(false);
-        m_ui->actionViewPoints->setChecked(true);
+        m_ui->customPlot->graph(GRAPH_CH3)->setLayer("xy_hidden");
+        m_ui->customPlot->graph(GRAPH_CH4)->setLayer("xy_hidden");
 
-        on_actionViewLines_triggered(false);
-        on_actionViewPoints_triggered(true);
+        m_xy_curve->setPen(QPen(QColor(COLOR5)));
+        xyCurveStyle();
+        m_xy_curve->setVisible(true);
 
         m_axis_scope->axis(QCPAxis::atBottom)->setTicker(m_timeTicker2);
         rescaleXAxis();
@@ -1257,11 +1290,10 @@ void WindowScope::on_actionMath_XY_X_3_Y_4_triggered(bool checked)
         m_ui->pushButton_enable2->setText(" CH4  ");
         m_ui->pushButton_disable2->setText(" CH4  ");
 
-        m_ui->actionViewLines->setChecked(true);
-        m_ui->actionViewPoints->setChecked(false);
+        m_ui->customPlot->graph(GRAPH_CH3)->setLayer("main");
+        m_ui->customPlot->graph(GRAPH_CH4)->setLayer("main");
 
-        on_actionViewLines_triggered(true);
-        on_actionViewPoints_triggered(false);
+        m_xy_curve->setVisible(false);
 
         m_axis_scope->axis(QCPAxis::atBottom)->setTicker(m_timeTicker);
         rescaleXAxis();
@@ -1270,6 +1302,243 @@ void WindowScope::on_actionMath_XY_X_3_Y_4_triggered(bool checked)
     m_ui->customPlot->graph(GRAPH_CH3)->data()->clear();
     m_ui->customPlot->graph(GRAPH_CH4)->data()->clear();
     m_ui->customPlot->graph(GRAPH_FFT)->data()->clear();
+    m_xy_curve->data()->clear();
+    m_persist.clear();
+}
+
+/********** Mask **********/
+
+void WindowScope::on_actionMaskEnabled_triggered(bool checked)
+{
+    m_mask_en = checked;
+
+    if (checked && m_mask.isEmpty())
+        msgBox(this, "Mask is empty. Create it from frame or load it from file.", INFO);
+
+    m_mask.reset();
+
+    m_status_mask->setText(checked ? "Mask: 0 pass / 0 fail" : "");
+    m_status_line4->setVisible(checked);
+    m_ui->actionMaskFirstFail->setText("first fail: ?");
+}
+
+void WindowScope::on_actionMaskStopOnFail_triggered(bool checked)
+{
+    m_mask_stop = checked;
+}
+
+void WindowScope::on_actionMaskFromFrame_triggered()
+{
+    bool ok;
+    double value = QInputDialog::getDouble(this, "EMBO - Mask", "Envelope tolerance [V]:", m_mask_tol, 0.001, 100, 3, &ok);
+
+    if (ok)
+    {
+        m_mask_tol = value;
+        m_mask_capture = true;
+    }
+}
+
+void WindowScope::on_actionMaskLoad_triggered()
+{
+    QString path = QFileDialog::getOpenFileName(this, "EMBO - Load Mask", m_rec.getDir(), "Mask (*.txt *.csv);;All files (*)");
+
+    if (path.isEmpty())
+        return;
+
+    QString err;
+
+    if (!m_mask.loadFile(path, err))
+        msgBox(this, err, WARNING);
+}
+
+void WindowScope::on_actionMaskReset_triggered()
+{
+    m_mask.reset();
+
+    if (m_mask_en)
+        m_status_mask->setText("Mask: 0 pass / 0 fail");
+    m_ui->actionMaskFirstFail->setText("first fail: ?");
+}
+
+/********** Soft Trigger **********/
+
+void WindowScope::on_actionSoftTrigEnabled_triggered(bool checked)
+{
+    m_softTrig_en = checked;
+    m_softTrig.setSettings(m_softTrigSet);
+}
+
+void WindowScope::on_actionSoftTrigPulse_triggered(bool checked)
+{
+    if (checked)
+        softTrigSetType(ST_PULSE_WIDTH);
+}
+
+void WindowScope::on_actionSoftTrigRunt_triggered(bool checked)
+{
+    if (checked)
+        softTrigSetType(ST_RUNT);
+}
+
+void WindowScope::on_actionSoftTrigWindow_triggered(bool checked)
+{
+    if (checked)
+        softTrigSetType(ST_WINDOW);
+}
+
+void WindowScope::on_actionSoftTrigSlope_triggered(bool checked)
+{
+    if (checked)
+        softTrigSetType(ST_SLOPE_TIME);
+}
+
+void WindowScope::on_actionSoftTrigPattern_triggered(bool checked)
+{
+    if (checked)
+        softTrigSetType(ST_PATTERN);
+}
+
+void WindowScope::on_actionSoftTrigChannel_1_triggered(bool checked)
+{
+    if (checked)
+        softTrigSetCh(0);
+}
+
+void WindowScope::on_actionSoftTrigChannel_2_triggered(bool checked)
+{
+    if (checked)
+        softTrigSetCh(1);
+}
+
+void WindowScope::on_actionSoftTrigChannel_3_triggered(bool checked)
+{
+    if (checked)
+        softTrigSetCh(2);
+}
+
+void WindowScope::on_actionSoftTrigChannel_4_triggered(bool checked)
+{
+    if (checked)
+        softTrigSetCh(3);
+}
+
+void WindowScope::on_actionSoftTrigNegative_triggered(bool checked)
+{
+    m_softTrigSet.negative = checked;
+    m_softTrig.setSettings(m_softTrigSet);
+}
+
+void WindowScope::on_actionSoftTrigLevels_triggered()
+{
+    bool ok1, ok2;
+    double lo = QInputDialog::getDouble(this, "EMBO - Soft Trigger", "Low level [V]:", m_softTrigSet.level_lo, -100, 100, 3, &ok1);
+    if (!ok1)
+        return;
+
+    double hi = QInputDialog::getDouble(this, "EMBO - Soft Trigger", "High level [V] (runt, window, slope):", m_softTrigSet.level_hi, -100, 100, 3, &ok2);
+    if (!ok2)
+        return;
+
+    if (hi <= lo)
+    {
+        msgBox(this, "High level must be above low level!", WARNING);
+        return;
+    }
+
+    m_softTrigSet.level_lo = lo;
+    m_softTrigSet.level_hi = hi;
+    m_softTrig.setSettings(m_softTrigSet);
+}
+
+void WindowScope::on_actionSoftTrigTime_triggered()
+{
+    bool ok1, ok2;
+    double min = QInputDialog::getDouble(this, "EMBO - Soft Trigger", "Minimum time [us]:", m_softTrigSet.time_min * 1e6, 0, 1e9, 3, &ok1);
+    if (!ok1)
+        return;
+
+    double max = QInputDialog::getDouble(this, "EMBO - Soft Trigger", "Maximum time [us] (0 = no limit):", m_softTrigSet.time_max * 1e6, 0, 1e9, 3, &ok2);
+    if (!ok2)
+        return;
+
+    if (max > 0 && max < min)
+    {
+        msgBox(this, "Maximum time must not be below minimum time!", WARNING);
+        return;
+    }
+
+    m_softTrigSet.time_min = min / 1e6;
+    m_softTrigSet.time_max = max / 1e6;
+    m_softTrig.setSettings(m_softTrigSet);
+}
+
+void WindowScope::on_actionSoftTrigPatternSet_triggered()
+{
+    const char states[] = { 'X', 'L', 'H' };
+    QString pattern;
+
+    for (int ch = 0; ch < SOFTTRIG_CH_NUM; ch++)
+        pattern += states[m_softTrigSet.pattern[ch]];
+
+    bool ok;
+    QString text = QInputDialog::getText(this, "EMBO - Soft Trigger", "Pattern CH1-CH4 (H = high, L = low, X = any):",
+                                         QLineEdit::Normal, pattern, &ok).toUpper();
+    if (!ok)
+        return;
+
+    if (!QRegExp("[HLX]{4}").exactMatch(text))
+    {
+        msgBox(this, "Pattern must be 4 characters of H, L or X!", WARNING);
+        return;
+    }
+
+    for (int ch = 0; ch < SOFTTRIG_CH_NUM; ch++)
+        m_softTrigSet.pattern[ch] = (text[ch] == 'H' ? SP_H : (text[ch] == 'L' ? SP_L : SP_X));
+
+    m_softTrig.setSettings(m_softTrigSet);
+}
+
+void WindowScope::on_actionHistoryPrev_triggered()
+{
+    if (m_history.getCount() == 0)
+        return;
+
+    if (m_ui->pushButton_run->isVisible()) // playback only when stopped
+        on_pushButton_run_clicked();
+
+    historyShow(std::min(m_history_pos + 1, m_history.getCount() - 1));
+}
+
+void WindowScope::on_actionHistoryNext_triggered()
+{
+    if (m_history_pos < 0)
+        return;
+
+    historyShow(std::max(m_history_pos - 1, 0));
+}
+
+void WindowScope::on_actionHistoryLive_triggered()
+{
+    if (m_ui->pushButton_stop->isVisible())
+        on_pushButton_stop_clicked();
+}
+
+void WindowScope::on_actionHistoryDepth_triggered()
+{
+    bool ok;
+    int depth = QInputDialog::getInt(this, "EMBO - History", "Frames kept:", m_history.getDepth(), 1, 1000, 1, &ok);
+
+    if (!ok)
+        return;
+
+    m_history.setDepth(depth);
+
+    if (m_history_pos >= 0) // shown frame is gone
+    {
+        m_history_pos = -1;
+        m_ui->actionHistoryPos->setText("frame: live");
+    }
 }
 
 /********** FFT **********/
@@ -1830,7 +2099,7 @@ void WindowScope::on_pushButton_reset_clicked()
     on_pushButton_resetZoom_clicked();
     on_pushButton_average_on_clicked();
 
-    Core::getInstance()->sendRst(SCOPE);
+    m_core->sendRst(SCOPE);
 
     showEvent(NULL);
 }
@@ -2160,7 +2429,7 @@ void WindowScope::on_pushButton_trigForc_clicked()
     m_ui->radioButton_trigLed->setChecked(false);
     enablePanel(false);
 
-    Core::getInstance()->msgAdd(m_msg_forceTrig, false, "");
+    m_core->msgAdd(m_msg_forceTrig, false, "");
 }
 
 void WindowScope::on_hideTrigSliders()
@@ -2397,7 +2666,7 @@ void WindowScope::on_pushButton_disable2_clicked()
 
 void WindowScope::on_pushButton_disable3_clicked()
 {
-    auto info = Core::getInstance()->getDevInfo();
+    auto info = m_core->getDevInfo();
     if (info->daq_ch == 4)
     {
         if ((m_daqSet.ch1_en + m_daqSet.ch2_en + m_daqSet.ch3_en + m_daqSet.ch4_en) == 1)
@@ -2419,7 +2688,7 @@ void WindowScope::on_pushButton_disable3_clicked()
 
 void WindowScope::on_pushButton_disable4_clicked()
 {
-    auto info = Core::getInstance()->getDevInfo();
+    auto info = m_core->getDevInfo();
     if (info->daq_ch == 4)
     {
         if ((m_daqSet.ch1_en + m_daqSet.ch2_en + m_daqSet.ch3_en + m_daqSet.ch4_en) == 1)
@@ -2465,7 +2734,7 @@ void WindowScope::on_pushButton_enable2_clicked()
 
 void WindowScope::on_pushButton_enable3_clicked()
 {
-    auto info = Core::getInstance()->getDevInfo();
+    auto info = m_core->getDevInfo();
     if (info->daq_ch == 4)
     {
         m_ui->pushButton_enable3->hide();
@@ -2481,7 +2750,7 @@ void WindowScope::on_pushButton_enable3_clicked()
 
 void WindowScope::on_pushButton_enable4_clicked()
 {
-    auto info = Core::getInstance()->getDevInfo();
+    auto info = m_core->getDevInfo();
     if (info->daq_ch == 4)
     {
         m_ui->pushButton_enable4->hide();
@@ -2801,7 +3070,7 @@ void WindowScope::closeEvent(QCloseEvent*)
 
     on_pushButton_average_on_clicked();
 
-    Core::getInstance()->setMode(NO_MODE);
+    m_core->setMode(NO_MODE);
     emit closing(WindowScope::staticMetaObject.className());
 
      m_timer_plot->stop();
@@ -2815,11 +3084,11 @@ void WindowScope::showEvent(QShowEvent*)
 
     enablePanel(false);
 
-    Core::getInstance()->setMode(SCOPE);
+    m_core->setMode(SCOPE);
     if (m_ui->pushButton_run->isVisible())
         m_instrEnabled = true;
 
-    auto info = Core::getInstance()->getDevInfo();
+    auto info = m_core->getDevInfo();
 
     m_err_cntr = 0;
     m_ref_v = info->ref_mv / 1000.0;
@@ -2837,7 +3106,7 @@ void WindowScope::showEvent(QShowEvent*)
         //m_ui->label_pins->setText("Vertical (" + m_pin1 + ", " + m_pin2 + ", " + m_pin3 + ", " + m_pin4 + ")");
     }
 
-    Core::getInstance()->msgAdd(m_msg_set, true, "");
+    m_core->msgAdd(m_msg_set, true, "");
 
     if (m_instrEnabled)
     {
@@ -2846,6 +3115,8 @@ void WindowScope::showEvent(QShowEvent*)
         m_ui->customPlot->graph(GRAPH_CH3)->data()->clear();
         m_ui->customPlot->graph(GRAPH_CH4)->data()->clear();
         m_ui->customPlot->graph(GRAPH_FFT)->data()->clear();
+
+        m_persist.clear();
     }
 
     on_actionMeasReset_triggered();
@@ -3150,7 +3421,7 @@ void WindowScope::createX()
 
 void WindowScope::updatePanel()
 {
-    auto info = Core::getInstance()->getDevInfo();
+    auto info = m_core->getDevInfo();
 
     m_ignoreValuesChanged = true;
 
@@ -3383,7 +3654,7 @@ void WindowScope::enablePanel(bool en)
 
 void WindowScope::fix2ADCproblem(bool add)
 {
-    if (Core::getInstance()->getDevInfo()->adc_num == 2)
+    if (m_core->getDevInfo()->adc_num == 2)
     {
         int count = 0;
 
@@ -3433,7 +3704,7 @@ void WindowScope::fix2ADCproblem(bool add)
 
 void WindowScope::sendSet()
 {
-    auto info = Core::getInstance()->getDevInfo();
+    auto info = m_core->getDevInfo();
 
     m_msgPending = true;
     enablePanel(false);
@@ -3542,7 +3813,7 @@ void WindowScope::sendSet()
         else break;
     }
 
-    Core::getInstance()->msgAdd(m_msg_set, false, (m_daqSet.bits == B12 ? "12," : "8," ) +     // bits
+    m_core->msgAdd(m_msg_set, false, (m_daqSet.bits == B12 ? "12," : "8," ) +     // bits
                                                    QString::number(m_daqSet.mem) + "," +       // mem
                                                    QString::number(m_daqSet.fs) + "," +        // fs
                                                    channs + "," +                              // channs
@@ -3552,3 +3823,42 @@ void WindowScope::sendSet()
                                                    trigMode + "," +                            // trig mode
                                                    QString::number(m_daqSet.trig_pre));        // trig pre
 }
+
+void WindowScope::softTrigSetType(SoftTrigType type)
+{
+    m_ui->actionSoftTrigPulse->setChecked(type == ST_PULSE_WIDTH);
+    m_ui->actionSoftTrigRunt->setChecked(type == ST_RUNT);
+    m_ui->actionSoftTrigWindow->setChecked(type == ST_WINDOW);
+    m_ui->actionSoftTrigSlope->setChecked(type == ST_SLOPE_TIME);
+    m_ui->actionSoftTrigPattern->setChecked(type == ST_PATTERN);
+
+    m_softTrigSet.type = type;
+    m_softTrig.setSettings(m_softTrigSet);
+}
+
+void WindowScope::softTrigSetCh(int ch)
+{
+    m_ui->actionSoftTrigChannel_1->setChecked(ch == 0);
+    m_ui->actionSoftTrigChannel_2->setChecked(ch == 1);
+    m_ui->actionSoftTrigChannel_3->setChecked(ch == 2);
+    m_ui->actionSoftTrigChannel_4->setChecked(ch == 3);
+
+    m_softTrigSet.ch = ch;
+    m_softTrig.setSettings(m_softTrigSet);
+}
+
+void WindowScope::historyShow(int pos)
+{
+    const HistoryFrame& frame = m_history.at(pos);
+
+    for (int ch = 0; ch < SOFTTRIG_CH_NUM; ch++)
+    {
+        if (frame.y[ch].isEmpty())
+            m_ui->customPlot->graph(GRAPH_CH1 + ch)->data()->clear();
+        else
+            m_ui->customPlot->graph(GRAPH_CH1 + ch)->setData(frame.t, frame.y[ch]);
+    }
+
+    m_history_pos = pos;
+    m_ui->actionHistoryPos->setText("frame: -" + QString::number(pos) + " / " + QString::number(m_history.getCount()));
+}
@@ -11,6 +11,10 @@
 #include "qcpcursors.h"
 #include "containers.h"
 #include "recorder.h"
+#include "persistence.h"
+#include "xycurve.h"
+#include "masktest.h"
+#include "softtrig.h"
 
 #include "lib/fftw3.h"
 
@@ -47,7 +51,7 @@ class WindowScope : public QMainWindow, public IEmboInstrument
     Q_OBJECT
 
 public:
-    explicit WindowScope(QWidget *parent = nullptr);
+    explicit WindowScope(Core* core, QWidget *parent = nullptr);
     ~WindowScope();
 
     bool getInstrEnabled() override { return m_instrEnabled; };
@@ -59,14 +63,12 @@ signals:
 
 private slots:
     /* data msg */
-    void on_msg_set(DaqBits bits, int mem, int fs, bool ch1, bool ch2, bool ch3, bool ch4, int trig_ch, int trig_val,
-                    DaqTrigEdge trig_edge, DaqTrigMode trig_mode, int trig_pre,
-                    double maxZ, double smpl_time, double fs_real_n, const QString fs_real);
+    void on_msg_set(const DaqSettings set);
     void on_msg_read(const QByteArray data);
 
     /* ok-err msg */
     void on_msg_err(const QString text, MsgBoxType type, bool needClose);
-    void on_msg_ok_set(double maxZ, double smpl_time, double fs_real_n, const QString fs_real);
+    void on_msg_ok_set(const DaqSettings set);
     void on_msg_ok_forceTrig(const QString, const QString);
 
      /* async ready msg */
@@ -83,6 +85,8 @@ private slots:
     void on_actionViewLines_triggered(bool checked);
     void on_actionInterpLinear_triggered(bool checked);
     void on_actionInterpSinc_triggered(bool checked);
+    void on_actionPersistence_triggered(bool checked);
+    void on_actionPersistenceClear_triggered();
 
     /* GUI slots - Menu - Export */
     void on_actionExportSave_triggered();
@@ -108,6 +112,33 @@ private slots:
     void on_actionMath_XY_X_1_Y_2_triggered(bool checked);
     void on_actionMath_XY_X_3_Y_4_triggered(bool checked);
 
+    /* GUI slots - Menu - Mask */
+    void on_actionMaskEnabled_triggered(bool checked);
+    void on_actionMaskStopOnFail_triggered(bool checked);
+    void on_actionMaskFromFrame_triggered();
+    void on_actionMaskLoad_triggered();
+    void on_actionMaskReset_triggered();
+
+    /* GUI slots - Menu - Soft Trigger */
+    void on_actionSoftTrigEnabled_triggered(bool checked);
+    void on_actionSoftTrigPulse_triggered(bool checked);
+    void on_actionSoftTrigRunt_triggered(bool checked);
+    void on_actionSoftTrigWindow_triggered(bool checked);
+    void on_actionSoftTrigSlope_triggered(bool checked);
+    void on_actionSoftTrigPattern_triggered(bool checked);
+    void on_actionSoftTrigChannel_1_triggered(bool checked);
+    void on_actionSoftTrigChannel_2_triggered(bool checked);
+    void on_actionSoftTrigChannel_3_triggered(bool checked);
+    void on_actionSoftTrigChannel_4_triggered(bool checked);
+    void on_actionSoftTrigNegative_triggered(bool checked);
+    void on_actionSoftTrigLevels_triggered();
+    void on_actionSoftTrigTime_triggered();
+    void on_actionSoftTrigPatternSet_triggered();
+    void on_actionHistoryPrev_triggered();
+    void on_actionHistoryNext_triggered();
+    void on_actionHistoryLive_triggered();
+    void on_actionHistoryDepth_triggered();
+
     /* GUI slots - Menu - FFT */
     void on_actionFFTChannel_1_triggered(bool checked);
     void on_actionFFTChannel_2_triggered(bool checked);
@@ -224,6 +255,7 @@ private:
     void rescaleXAxis();
     void rescaleYAxis();
     void createX();
+    void xyCurveStyle();
 
     void updatePanel();
     void enablePanel(bool en);
@@ -232,6 +264,10 @@ private:
 
     void sendSet();
 
+    void softTrigSetType(SoftTrigType type);
+    void softTrigSetCh(int ch);
+    void historyShow(int pos);
+
     /* main window */
     Ui::WindowScope* m_ui;
 
@@ -260,6 +296,8 @@ private:
     QFrame* m_status_line2;
     QLabel* m_status_ets;
     QFrame* m_status_line3;
+    QLabel* m_status_mask;
+    QFrame* m_status_line4;
 
     /* FFT */
     int m_fft_size = 131072;
@@ -306,6 +344,7 @@ private:
     bool m_math_xy_34 = false;
     bool m_fft = false;
     bool m_single = false;
+    bool m_persistence = false;
 
     /* helpers */
     int m_seq_num = 0;
@@ -358,6 +397,28 @@ private:
     //double m_meas_max = -1000;
     //double m_meas_min = 1000;
 
+    /* mask test */
+    MaskTest m_mask;
+    bool m_mask_en = false;
+    bool m_mask_stop = false;
+    bool m_mask_capture = false;
+    double m_mask_tol = MASK_TOL_DEFAULT;
+
+    /* soft trigger */
+    SoftTrigger m_softTrig;
+    SoftTrigSettings m_softTrigSet;
+    bool m_softTrig_en = false;
+    FrameHistory m_history;
+    int m_history_pos = -1; // -1 = live
+
+    /* persistence */
+    Persistence m_persist;
+    QCPColorMap* m_persist_map;
+
+    /* XY - parametric curve, YT graphs of the pair keep data on hidden layer */
+    XyCurve m_xy;
+    QCPCurve* m_xy_curve;
+
     /* recorder */
     Recorder m_rec;
 
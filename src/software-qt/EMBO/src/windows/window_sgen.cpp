@@ -14,11 +14,16 @@
 #include <QLabel>
 #include <QMessageBox>
 #include <QGridLayout>
+#include <QFileDialog>
 
 
-WindowSgen::WindowSgen(QWidget *parent) : QMainWindow(parent), m_ui(new Ui::WindowSgen)
+#define ARB_MAX_VAL     4095    // 12-bit DAC
+
+
+WindowSgen::WindowSgen(Core* core, QWidget *parent) : QMainWindow(parent), m_ui(new Ui::WindowSgen)
 {
     m_ui->setupUi(this);
+    m_core = core;
 
     m_msg_set = new Msg_SGEN_Set(this);
 
@@ -26,7 +31,13 @@ WindowSgen::WindowSgen(QWidget *parent) : QMainWindow(parent), m_ui(new Ui::Wind
     connect(m_msg_set, &Msg_SGEN_Set::err, this, &WindowSgen::on_msg_err, Qt::QueuedConnection);
     connect(m_msg_set, &Msg_SGEN_Set::result, this, &WindowSgen::on_msg_set, Qt::QueuedConnection);
 
-    connect(m_ui->actionEMBO_Help, SIGNAL(triggered()), Core::getInstance(), SLOT(on_actionEMBO_Help()));
+    m_msg_arb = new Msg_SGEN_Arb(this);
+
+    connect(m_msg_arb, &Msg_SGEN_Arb::ok, this, &WindowSgen::on_msg_arb_ok, Qt::QueuedConnection);
+    connect(m_msg_arb, &Msg_SGEN_Arb::err, this, &WindowSgen::on_msg_err, Qt::QueuedConnection);
+    connect(m_msg_arb, &Msg_SGEN_Arb::result, this, &WindowSgen::on_msg_arb, Qt::QueuedConnection);
+
+    connect(m_ui->actionEMBO_Help, &QAction::triggered, this, open_help);
 
     m_status_enabled = new QLabel(" Disabled", this);
     QWidget* widget = new QWidget(this);
@@ -44,6 +55,13 @@ WindowSgen::WindowSgen(QWidget *parent) : QMainWindow(parent), m_ui(new Ui::Wind
     QGridLayout * layout = new QGridLayout(widget);
     layout->addWidget(status_img,0,0,1,1,Qt::AlignVCenter);
     layout->addWidget(m_status_enabled,0,1,1,1,Qt::AlignVCenter | Qt::AlignLeft);
+
+    m_status_upload = new QProgressBar(this);
+    m_status_upload->setFixedWidth(150);
+    m_status_upload->setFixedHeight(15);
+    m_status_upload->setFont(font1);
+    m_status_upload->hide();
+    layout->addWidget(m_status_upload,0,2,1,1,Qt::AlignVCenter | Qt::AlignRight);
     layout->setMargin(0);
     layout->setSpacing(0);
     m_ui->statusbar->addWidget(widget,1);
@@ -99,6 +117,7 @@ void WindowSgen::on_msg_ok(const QString real_freq, const QString N)
 void WindowSgen::on_msg_err(const QString text, MsgBoxType type, bool needClose)
 {
     m_activeMsgs.clear();
+    m_status_upload->hide();
 
     if (needClose)
         this->close();
@@ -116,8 +135,11 @@ void WindowSgen::on_msg_set(double freq, int ampl, int offset, SgenMode mode, bo
     m_ui->doubleSpinBox_ampl->setValue(ampl / 10.0);
     m_ui->spinBox_offset->setValue(offset);
 
+    setArbMode(mode == SgenMode::ARB);
+
     switch (mode)
     {
+        case SgenMode::ARB: break;
         default:
         case SgenMode::CONSTANT: m_ui->radioButton_const->setChecked(true); break;
         case SgenMode::SINE: m_ui->radioButton_sine->setChecked(true); break;
@@ -131,15 +153,17 @@ void WindowSgen::on_msg_set(double freq, int ampl, int offset, SgenMode mode, bo
     m_ui->dial_ampl->setValue(ampl / 10.0);
     m_ui->dial_offset->setValue(offset);
 
-    auto info = Core::getInstance()->getDevInfo();
-
-    m_ui->spinBox_freq->setRange(1, info->sgen_maxf);
-    m_ui->dial_freq->setRange(1, info->sgen_maxf);
-    m_ui->dial_freq->setNotchTarget(info->sgen_maxf / 100000);
+    auto info = m_core->getDevInfo();
 
     m_real_freq = real_freq;
     m_N = N;
 
+    int maxf = (m_arbMode && m_N.toInt() > 0 ? info->sgen_maxf / m_N.toInt() : info->sgen_maxf);
+
+    m_ui->spinBox_freq->setRange(1, maxf);
+    m_ui->dial_freq->setRange(1, maxf);
+    m_ui->dial_freq->setNotchTarget(maxf / 100000);
+
     m_ignoreValuesChanged = false;
 
     m_instrEnabled = enable;
@@ -147,6 +171,72 @@ void WindowSgen::on_msg_set(double freq, int ampl, int offset, SgenMode mode, bo
     enableAll(true);
 }
 
+void WindowSgen::on_msg_arb(int, int maxLen, int chunk)
+{
+    if (maxLen < 2 || chunk < 1)
+    {
+        enableAll(true);
+        msgBox(this, "Arbitrary waveform is not supported by device!", WARNING);
+        return;
+    }
+
+    m_arb.compile(maxLen, ARB_MAX_VAL, m_ui->doubleSpinBox_ampl->value(), m_ui->spinBox_offset->value());
+
+    m_arbChunk = chunk;
+    m_arbChunkIdx = 0;
+
+    m_status_upload->setRange(0, m_arb.getChunks(m_arbChunk));
+    m_status_upload->setValue(0);
+    m_status_upload->show();
+
+    sendArbChunk();
+}
+
+void WindowSgen::on_msg_arb_ok(const QString)
+{
+    m_status_upload->setValue(++m_arbChunkIdx);
+
+    if (m_arbChunkIdx < m_arb.getChunks(m_arbChunk))
+    {
+        sendArbChunk();
+        return;
+    }
+
+    m_status_upload->hide();
+
+    int N = m_arb.getSamples().size();
+    int maxf = m_core->getDevInfo()->sgen_maxf / N;
+
+    setArbMode(true);
+
+    m_ignoreValuesChanged = true;
+    m_ui->spinBox_freq->setRange(1, maxf);
+    m_ui->dial_freq->setRange(1, maxf);
+    m_ui->dial_freq->setNotchTarget(maxf / 100000);
+    m_ignoreValuesChanged = false;
+
+    sendSet(m_instrEnabled); // play it
+}
+
+void WindowSgen::on_actionArbLoad_triggered()
+{
+    QString path = QFileDialog::getOpenFileName(this, "EMBO - Load Waveform", "",
+                                                "Waveform (*.csv *.txt *.bin *.raw);;All files (*)");
+    if (path.isEmpty())
+        return;
+
+    QString err;
+
+    if (!m_arb.loadFile(path, err))
+    {
+        msgBox(this, err, WARNING);
+        return;
+    }
+
+    enableAll(false);
+    m_core->msgAdd(m_msg_arb, true, ""); // memory and block size of device first
+}
+
 void WindowSgen::on_actionAbout_triggered()
 {
     QMessageBox::about(this, EMBO_TITLE, EMBO_ABOUT_TXT);
@@ -247,6 +337,7 @@ void WindowSgen::on_radioButton_const_clicked()
     if (m_ignoreValuesChanged)
         return;
 
+    setArbMode(false);
     sendSet(m_instrEnabled);
 }
 
@@ -255,6 +346,7 @@ void WindowSgen::on_radioButton_sine_clicked()
     if (m_ignoreValuesChanged)
         return;
 
+    setArbMode(false);
     sendSet(m_instrEnabled);
 }
 
@@ -263,6 +355,7 @@ void WindowSgen::on_radioButton_triangle_clicked()
     if (m_ignoreValuesChanged)
         return;
 
+    setArbMode(false);
     sendSet(m_instrEnabled);
 }
 
@@ -271,6 +364,7 @@ void WindowSgen::on_radioButton_saw_clicked()
     if (m_ignoreValuesChanged)
         return;
 
+    setArbMode(false);
     sendSet(m_instrEnabled);
 }
 
@@ -279,6 +373,7 @@ void WindowSgen::on_radioButton_square_clicked()
     if (m_ignoreValuesChanged)
         return;
 
+    setArbMode(false);
     sendSet(m_instrEnabled);
 }
 
@@ -287,6 +382,7 @@ void WindowSgen::on_radioButton_noise_clicked()
     if (m_ignoreValuesChanged)
         return;
 
+    setArbMode(false);
     sendSet(m_instrEnabled);
 }
 
@@ -309,7 +405,7 @@ void WindowSgen::showEvent(QShowEvent*)
 
     m_ignoreValuesChanged = false;
 
-    Core::getInstance()->msgAdd(m_msg_set, true, "");
+    m_core->msgAdd(m_msg_set, true, "");
 }
 
 void WindowSgen::enableAll(bool enable)
@@ -332,7 +428,9 @@ void WindowSgen::enableAll(bool enable)
     m_ui->radioButton_square->setEnabled(enable);
     m_ui->radioButton_noise->setEnabled(enable);
 
-    auto info = Core::getInstance()->getDevInfo();
+    m_ui->actionArbLoad->setEnabled(enable);
+
+    auto info = m_core->getDevInfo();
 
     m_ui->textBrowser_realFs->setText(m_real_freq + " Hz");
     m_ui->textBrowser_N->setText(m_N);
@@ -388,16 +486,46 @@ void WindowSgen::sendSet(bool enable)
 
     int mode;
 
-    if      (m_ui->radioButton_const->isChecked())    mode = 0;
+    if      (m_arbMode)                               mode = 6;
+    else if (m_ui->radioButton_const->isChecked())    mode = 0;
     else if (m_ui->radioButton_sine->isChecked())     mode = 1;
     else if (m_ui->radioButton_triangle->isChecked()) mode = 2;
     else if (m_ui->radioButton_saw->isChecked())      mode = 3;
     else if (m_ui->radioButton_square->isChecked())   mode = 4;
     else                                              mode = 5;
 
-    Core::getInstance()->msgAdd(m_msg_set, false, QString::number(m_ui->spinBox_freq->value()) + EMBO_DELIM2 +
+    m_core->msgAdd(m_msg_set, false, QString::number(m_ui->spinBox_freq->value()) + EMBO_DELIM2 +
                                                   QString::number(m_ui->doubleSpinBox_ampl->value() * 10.0) + EMBO_DELIM2 +
                                                   QString::number(m_ui->spinBox_offset->value()) + EMBO_DELIM2 +
                                                   QString::number(mode) + EMBO_DELIM2 +
                                                   (enable ? "1" : "0"));
 }
+
+void WindowSgen::sendArbChunk()
+{
+    m_core->msgAdd(m_msg_arb, false, m_arb.chunkParams(m_arbChunkIdx, m_arbChunk), m_arb.chunkBlock(m_arbChunkIdx, m_arbChunk));
+}
+
+void WindowSgen::setArbMode(bool arb)
+{
+    if (arb == m_arbMode)
+        return;
+
+    m_arbMode = arb;
+
+    if (arb) // none of generated waves
+    {
+        m_mode.setExclusive(false);
+        for (auto button : m_mode.buttons())
+            button->setChecked(false);
+        m_mode.setExclusive(true);
+    }
+    else
+    {
+        auto info = m_core->getDevInfo();
+
+        m_ui->spinBox_freq->setRange(1, info->sgen_maxf);
+        m_ui->dial_freq->setRange(1, info->sgen_maxf);
+        m_ui->dial_freq->setNotchTarget(info->sgen_maxf / 100000);
+    }
+}
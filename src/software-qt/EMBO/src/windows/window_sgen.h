@@ -8,10 +8,12 @@
 
 #include "interfaces.h"
 #include "messages.h"
+#include "arbwave.h"
 
 #include <QMainWindow>
 #include <QLabel>
 #include <QButtonGroup>
+#include <QProgressBar>
 
 
 QT_BEGIN_NAMESPACE
@@ -24,7 +26,7 @@ class WindowSgen : public QMainWindow, public IEmboInstrument
     Q_OBJECT
 
 public:
-    explicit WindowSgen(QWidget *parent = nullptr);
+    explicit WindowSgen(Core* core, QWidget *parent = nullptr);
     ~WindowSgen();
 
     bool getInstrEnabled() override { return m_instrEnabled; };
@@ -37,6 +39,10 @@ private slots:
     void on_msg_ok(const QString real_freq, const QString N);
     void on_msg_err(const QString text, MsgBoxType type, bool needClose);
     void on_msg_set(double freq, int ampl, int offset, SgenMode mode, bool enable, const QString real_freq, const QString N);
+    void on_msg_arb(int len, int maxLen, int chunk);
+    void on_msg_arb_ok(const QString len);
+
+    void on_actionArbLoad_triggered();
 
     void on_actionAbout_triggered();
     void on_spinBox_freq_valueChanged(int arg1);
@@ -61,24 +67,32 @@ private:
 
     void enableAll(bool enable);
     void sendSet(bool enable);
+    void sendArbChunk();
+    void setArbMode(bool arb);
 
     /* main window */
     Ui::WindowSgen* m_ui;
 
     /* messages */
     Msg_SGEN_Set* m_msg_set;
+    Msg_SGEN_Arb* m_msg_arb;
 
     /* helpers */
     bool m_ignoreValuesChanged = false;
     bool m_ch_wantSwitch = false;
     QButtonGroup m_mode;
+    bool m_arbMode = false;     // uploaded waveform instead of radio buttons
+    int m_arbChunk = 0;         // samples per block
+    int m_arbChunkIdx = 0;      // block being uploaded
 
     /* data */
     QString m_real_freq;
     QString m_N;
+    ArbWave m_arb;
 
     /* status bar */
     QLabel* m_status_enabled;
+    QProgressBar* m_status_upload;
 };
 
 #endif // WINDOW_SGEN_H
@@ -16,6 +16,7 @@
 #include <QDebug>
 #include <QLabel>
 #include <QInputDialog>
+#include <QFileDialog>
 #include <QMessageBox>
 
 #include <algorithm>
@@ -27,9 +28,10 @@
 #define DEFAULT_AVG     1
 
 
-WindowVm::WindowVm(QWidget *parent) : QMainWindow(parent), m_ui(new Ui::WindowVm), m_rec(4)
+WindowVm::WindowVm(Core* core, QWidget *parent) : QMainWindow(parent), m_ui(new Ui::WindowVm), m_rec(4)
 {
     m_ui->setupUi(this);
+    m_core = core;
 
     m_timer_plot = new QTimer(this);
     m_timer_digits = new QTimer(this);
@@ -67,7 +69,7 @@ WindowVm::WindowVm(QWidget *parent) : QMainWindow(parent), m_ui(new Ui::WindowVm
     connect(m_timer_plot, &QTimer::timeout, this, &WindowVm::on_timer_plot);
     connect(m_timer_digits, &QTimer::timeout, this, &WindowVm::on_timer_digits);
 
-    connect(m_ui->actionEMBO_Help, SIGNAL(triggered()), Core::getInstance(), SLOT(on_actionEMBO_Help()));
+    connect(m_ui->actionEMBO_Help, &QAction::triggered, this, open_help);
 
     m_ui->dial_display->setValue(DISPLAY_VM_DEFAULT);
 
@@ -182,6 +184,40 @@ void WindowVm::initQcp()
     m_ui->customPlot->addGraph();  // ch3
     m_ui->customPlot->addGraph();  // ch4
 
+    m_strip1.reset(new StripChart(STRIP_VM_CAP));
+    m_strip2.reset(new StripChart(STRIP_VM_CAP));
+    m_strip3.reset(new StripChart(STRIP_VM_CAP));
+    m_strip4.reset(new StripChart(STRIP_VM_CAP));
+
+    m_ui->customPlot->graph(GRAPH_CH1)->setData(m_strip1);
+    m_ui->customPlot->graph(GRAPH_CH2)->setData(m_strip2);
+    m_ui->customPlot->graph(GRAPH_CH3)->setData(m_strip3);
+    m_ui->customPlot->graph(GRAPH_CH4)->setData(m_strip4);
+
+    /* trend band - min and max graph of every channel, max filled down to min */
+    QColor colors[4] = { QColor(COLOR1), QColor(COLOR2), QColor(COLOR5), QColor(COLOR4) };
+
+    for (int i = 0; i < 8; i++)
+        m_ui->customPlot->addGraph();
+
+    for (int i = 0; i < 4; i++)
+    {
+        QColor fill = colors[i];
+        fill.setAlpha(60);
+
+        QCPGraph* min = m_ui->customPlot->graph(GRAPH_MIN1 + i);
+        QCPGraph* max = m_ui->customPlot->graph(GRAPH_MAX1 + i);
+
+        min->setPen(Qt::NoPen);
+        max->setPen(Qt::NoPen);
+        max->setBrush(fill);
+        max->setChannelFillGraph(min);
+        min->setVisible(false);
+        max->setVisible(false);
+
+        m_trendMean[i].reset(new QCPGraphDataContainer);
+    }
+
     m_ui->customPlot->graph(GRAPH_CH1)->setPen(QPen(QColor(COLOR1)));
     m_ui->customPlot->graph(GRAPH_CH2)->setPen(QPen(QColor(COLOR2)));
     m_ui->customPlot->graph(GRAPH_CH3)->setPen(QPen(QColor(COLOR5)));
@@ -222,6 +258,7 @@ void WindowVm::initQcp()
     connect(m_ui->customPlot->yAxis, SIGNAL(rangeChanged(QCPRange)), m_ui->customPlot->yAxis2, SLOT(setRange(QCPRange)));
     connect(m_ui->customPlot, SIGNAL(mouseWheel(QWheelEvent*)), this, SLOT(on_qcpMouseWheel(QWheelEvent*)));
     connect(m_ui->customPlot, SIGNAL(mousePress(QMouseEvent*)), this, SLOT(on_qcpMousePress(QMouseEvent*)));
+    connect(m_ui->customPlot->xAxis, SIGNAL(rangeChanged(QCPRange)), this, SLOT(on_qcpXRangeChanged(QCPRange)));
 
     /* cursors */
 
@@ -256,7 +293,7 @@ void WindowVm::on_msg_err(const QString text, MsgBoxType type, bool needClose)
     msgBox(this, text, type);
 }
 
-void WindowVm::on_msg_read(const QString ch1, const QString ch2, const QString ch3, const QString ch4, const QString vcc) // 100 Hz idealy
+void WindowVm::on_msg_read(const VmData data) // 100 Hz idealy
 {
     if (m_instrEnabled && !m_activeMsgs.empty())
     {
@@ -264,16 +301,16 @@ void WindowVm::on_msg_read(const QString ch1, const QString ch2, const QString c
         m_timer_elapsed += 10;
         double t = t_ms / 1000.0;
 
-        double _ch1 = ch1.toDouble() * m_gain1;
-        double _ch2 = ch2.toDouble() * m_gain2;
-        double _ch3 = ch3.toDouble() * m_gain3;
-        double _ch4 = ch4.toDouble() * m_gain4;
+        double _ch1 = data.ch1 * m_gain1;
+        double _ch2 = data.ch2 * m_gain2;
+        double _ch3 = data.ch3 * m_gain3;
+        double _ch4 = data.ch4 * m_gain4;
 
         double data_ch1 = _ch1;
         double data_ch2 = _ch2;
         double data_ch3 = _ch3;
         double data_ch4 = _ch4;
-        double data_vcc = vcc.toDouble();
+        double data_vcc = data.vcc;
 
         if (m_math_2minus1)
             data_ch3 = _ch2 - _ch1;
@@ -370,6 +407,9 @@ void WindowVm::on_timer_plot() // 60 FPS
 
     if (m_plot)
     {
+        if (m_trend_view)
+            updateTrendData();
+
         if (m_cursorsV_en || m_cursorsH_en)
         {
             auto rngV = m_ui->customPlot->yAxis->range();
@@ -417,7 +457,7 @@ void WindowVm::on_timer_digits() // 4 FPS
             m_ui->textBrowser_ch4->setHtml("<p align=\"center\">" + ch4_s + " V</p>");
 
         m_ref_v = vcc;
-        Core::getInstance()->getDevInfo()->ref_mv = vcc_mv;
+        m_core->getDevInfo()->ref_mv = vcc_mv;
         m_status_vcc->setText(" Vcc: " + vcc_mv_s + " mV");
 
         if (m_meas_en) //&& m_meas_max > -1000 && m_meas_min < 1000)
@@ -457,24 +497,57 @@ bool WindowVm::updatePlotData()
     {
         m_key_last = smpl.t;
 
-        m_ui->customPlot->graph(GRAPH_CH1)->addData(m_key_last, smpl.ch1);
-        m_ui->customPlot->graph(GRAPH_CH2)->addData(m_key_last, smpl.ch2);
-        m_ui->customPlot->graph(GRAPH_CH3)->addData(m_key_last, smpl.ch3);
-        m_ui->customPlot->graph(GRAPH_CH4)->addData(m_key_last, smpl.ch4);
+        if (m_en1)
+            m_strip1->append(m_key_last, smpl.ch1);
+        if (m_en2)
+            m_strip2->append(m_key_last, smpl.ch2);
+        if (m_en3)
+            m_strip3->append(m_key_last, smpl.ch3);
+        if (m_en4)
+            m_strip4->append(m_key_last, smpl.ch4);
+
+        double vals[4] = { smpl.ch1, smpl.ch2, smpl.ch3, smpl.ch4 };
+        m_trend.addSample(m_key_last, vals);
     }
 
     m_smplBuff.clear();
 
-    rescaleXAxis();
+    if (!m_zoomed)
+        rescaleXAxis();
 
-    m_ui->customPlot->graph(GRAPH_CH1)->data()->removeBefore(m_key_last - m_display);
-    m_ui->customPlot->graph(GRAPH_CH2)->data()->removeBefore(m_key_last - m_display);
-    m_ui->customPlot->graph(GRAPH_CH3)->data()->removeBefore(m_key_last - m_display);
-    m_ui->customPlot->graph(GRAPH_CH4)->data()->removeBefore(m_key_last - m_display);
+    m_strip1->evictBefore(m_key_last - m_display);
+    m_strip2->evictBefore(m_key_last - m_display);
+    m_strip3->evictBefore(m_key_last - m_display);
+    m_strip4->evictBefore(m_key_last - m_display);
 
     return true;
 }
 
+/* level with about one bin per pixel in visible range - days of trend cost the same as seconds */
+void WindowVm::updateTrendData()
+{
+    auto rng = m_ui->customPlot->xAxis->range();
+    int level = m_trend.selectLevel(rng.lower, rng.upper, m_ui->customPlot->axisRect()->width());
+    bool en[4] = { m_en1, m_en2, m_en3, m_en4 };
+
+    QVector<double> keys, min, mean, max;
+
+    for (int i = 0; i < 4; i++)
+    {
+        m_ui->customPlot->graph(GRAPH_MIN1 + i)->setVisible(en[i]);
+        m_ui->customPlot->graph(GRAPH_MAX1 + i)->setVisible(en[i]);
+
+        if (!en[i])
+            continue;
+
+        m_trend.getRange(level, i, rng.lower, rng.upper, keys, min, mean, max);
+
+        m_ui->customPlot->graph(GRAPH_CH1 + i)->setData(keys, mean, true);
+        m_ui->customPlot->graph(GRAPH_MIN1 + i)->setData(keys, min, true);
+        m_ui->customPlot->graph(GRAPH_MAX1 + i)->setData(keys, max, true);
+    }
+}
+
 /********************************* GUI slots *********************************/
 
 /********** Plot **********/
@@ -563,11 +636,54 @@ void WindowVm::on_actionShowPlot_triggered(bool checked)
     m_ui->dial_display->setEnabled(checked);
 }
 
+void WindowVm::on_actionViewTrend_triggered(bool checked)
+{
+    m_trend_view = checked;
+
+    QSharedPointer<StripChart> strips[4] = { m_strip1, m_strip2, m_strip3, m_strip4 };
+
+    for (int i = 0; i < 4; i++)
+    {
+        if (checked)
+            m_ui->customPlot->graph(GRAPH_CH1 + i)->setData(m_trendMean[i]);
+        else
+            m_ui->customPlot->graph(GRAPH_CH1 + i)->setData(strips[i]);
+
+        m_ui->customPlot->graph(GRAPH_MIN1 + i)->setVisible(false); // shown by updateTrendData
+        m_ui->customPlot->graph(GRAPH_MAX1 + i)->setVisible(false);
+    }
+
+    m_zoomed = false;
+    rescaleXAxis();
+}
+
+void WindowVm::on_actionTrendOpen_triggered()
+{
+    QString path = QFileDialog::getOpenFileName(this, "EMBO - Open Trend", m_rec.getDir(), "Trend (*" TREND_FILE_EXT ")");
+
+    if (path.isEmpty())
+        return;
+
+    if (m_instrEnabled)
+        on_pushButton_disable_clicked();
+
+    if (!m_trend.load(path))
+    {
+        msgBox(this, "Read file at: " + path + " failed!", CRITICAL);
+        return;
+    }
+
+    m_trend_loaded = true;
+
+    m_ui->actionViewTrend->setChecked(true);
+    on_actionViewTrend_triggered(true);
+}
+
 /********** Export **********/
 
 void WindowVm::on_actionExportStart_triggered()
 {
-    auto info = Core::getInstance()->getDevInfo();
+    auto info = m_core->getDevInfo();
     auto sys = QSysInfo();
 
     QMap<QString, QString> header {
@@ -596,6 +712,9 @@ void WindowVm::on_actionExportStart_triggered()
         if (m_en4) m_rec << "CH4(V)";
         m_rec << ENDL;
 
+        m_trend.reset(); // .trend saved at stop holds the same span as the recording
+        m_trend_loaded = false;
+
         m_recording = true;
 
         m_ui->actionExportStart->setEnabled(false);
@@ -625,6 +744,10 @@ void WindowVm::on_actionExportStop_triggered()
     m_status_line1->setVisible(false);
 
     QString ret = m_rec.closeFile();
+    QString trend = ret.left(ret.lastIndexOf('.')) + TREND_FILE_EXT;
+
+    if (!m_trend.save(trend))
+        msgBox(this, "Write file at: " + trend + " failed!", CRITICAL);
 
     msgBox(this, "File saved at: " + ret, INFO);
 }
@@ -955,12 +1078,19 @@ void WindowVm::on_qcpMousePress(QMouseEvent*)
     m_ui->pushButton_resetZoom->show();
 }
 
+void WindowVm::on_qcpXRangeChanged(const QCPRange&)
+{
+    if (!m_rescalingX) // wheel or drag
+        m_zoomed = true;
+}
+
 /********** right pannel - on/off **********/
 
 void WindowVm::on_pushButton_disable1_clicked()
 {
     m_en1 = false;
     m_ui->customPlot->graph(GRAPH_CH1)->setVisible(false);
+    m_strip1->reset(); // not fed while disabled
     m_ui->textBrowser_ch1->setText("");
     m_ui->progressBar_ch1->setValue(0);
 
@@ -991,6 +1121,7 @@ void WindowVm::on_pushButton_disable2_clicked()
 {
     m_en2 = false;
     m_ui->customPlot->graph(GRAPH_CH2)->setVisible(false);
+    m_strip2->reset();
     m_ui->textBrowser_ch2->setText("");
     m_ui->progressBar_ch2->setValue(0);
 
@@ -1021,6 +1152,7 @@ void WindowVm::on_pushButton_disable3_clicked()
 {
     m_en3 = false;
     m_ui->customPlot->graph(GRAPH_CH3)->setVisible(false);
+    m_strip3->reset();
     m_ui->textBrowser_ch3->setText("");
     m_ui->progressBar_ch3->setValue(0);
 
@@ -1051,6 +1183,7 @@ void WindowVm::on_pushButton_disable4_clicked()
 {
     m_en4 = false;
     m_ui->customPlot->graph(GRAPH_CH4)->setVisible(false);
+    m_strip4->reset();
     m_ui->textBrowser_ch4->setText("");
     m_ui->progressBar_ch4->setValue(0);
 
@@ -1160,6 +1293,13 @@ void WindowVm::on_pushButton_enable_clicked()
 {
     m_smplBuff.clear();
 
+    if (m_trend_loaded) // opened file is not continued by live data
+    {
+        m_trend.reset();
+        m_trend_loaded = false;
+    }
+    m_zoomed = false; // live data followed again
+
     m_avg1_val = 0;
     m_avg2_val = 0;
     m_avg3_val = 0;
@@ -1286,10 +1426,12 @@ void WindowVm::on_pushButton_reset_clicked()
     m_ui->doubleSpinBox_gain4->setValue(1);
 
     /* graph data */
-    m_ui->customPlot->graph(GRAPH_CH1)->data()->clear();
-    m_ui->customPlot->graph(GRAPH_CH2)->data()->clear();
-    m_ui->customPlot->graph(GRAPH_CH3)->data()->clear();
-    m_ui->customPlot->graph(GRAPH_CH4)->data()->clear();
+    m_strip1->reset();
+    m_strip2->reset();
+    m_strip3->reset();
+    m_strip4->reset();
+    m_trend.reset();
+    m_trend_loaded = false;
 
     /* helper vars */
     m_smplBuff.clear();
@@ -1313,6 +1455,9 @@ void WindowVm::on_pushButton_resetZoom_clicked()
     //m_ui->customPlot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom | QCP::iSelectPlottables);
     rescaleYAxis();
 
+    m_zoomed = false;
+    rescaleXAxis();
+
     m_ui->pushButton_reset->show();
     m_ui->pushButton_resetZoom->hide();
 }
@@ -1373,7 +1518,7 @@ void WindowVm::closeEvent(QCloseEvent*)
 {
     m_activeMsgs.clear();
 
-    Core::getInstance()->setMode(NO_MODE);
+    m_core->setMode(NO_MODE);
     emit closing(WindowVm::staticMetaObject.className());
 
     m_timer_plot->stop();
@@ -1382,7 +1527,7 @@ void WindowVm::closeEvent(QCloseEvent*)
 
 void WindowVm::showEvent(QShowEvent*)
 {
-    auto info = Core::getInstance()->getDevInfo();
+    auto info = m_core->getDevInfo();
     QStringList pins = info->pins_scope_vm.split(EMBO_DELIM2, QString::SkipEmptyParts);
 
     if (pins.size() == 2)
@@ -1407,14 +1552,16 @@ void WindowVm::showEvent(QShowEvent*)
 
     m_ref_v = info->ref_mv / 1000;
 
-    m_ui->customPlot->graph(GRAPH_CH1)->data()->clear();
-    m_ui->customPlot->graph(GRAPH_CH2)->data()->clear();
-    m_ui->customPlot->graph(GRAPH_CH3)->data()->clear();
-    m_ui->customPlot->graph(GRAPH_CH4)->data()->clear();
+    m_strip1->reset();
+    m_strip2->reset();
+    m_strip3->reset();
+    m_strip4->reset();
+    m_trend.reset();
+    m_trend_loaded = false;
 
     //m_ui->customPlot->replot();
 
-    Core::getInstance()->setMode(VM);
+    m_core->setMode(VM);
 
     m_activeMsgs.push_back(m_msg_read1);
     m_activeMsgs.push_back(m_msg_read2);
@@ -1464,6 +1611,13 @@ void WindowVm::rescaleYAxis()
 
 void WindowVm::rescaleXAxis()
 {
-    m_ui->customPlot->xAxis->setRange(m_key_last, m_display, Qt::AlignRight);
+    m_rescalingX = true;
+
+    if (m_trend_view && m_trend.getLastKey() > m_trend.getFirstKey()) // whole trend
+        m_ui->customPlot->xAxis->setRange(m_trend.getFirstKey(), m_trend.getLastKey());
+    else
+        m_ui->customPlot->xAxis->setRange(m_key_last, m_display, Qt::AlignRight);
+
+    m_rescalingX = false;
 }
 
@@ -9,8 +9,10 @@
 #include "interfaces.h"
 #include "messages.h"
 #include "qcpcursors.h"
-#include "movemean.h"
+#include "streamstats.h"
 #include "recorder.h"
+#include "stripchart.h"
+#include "trend.h"
 
 #include "lib/qcustomplot.h"
 
@@ -28,6 +30,8 @@
 #define GRAPH_CH2               1
 #define GRAPH_CH3               2
 #define GRAPH_CH4               3
+#define GRAPH_MIN1              4       // trend band - min, max filled to min
+#define GRAPH_MAX1              8
 
 #define CURSOR_DEFAULT_H_MIN    400
 #define CURSOR_DEFAULT_H_MAX    600
@@ -35,6 +39,7 @@
 #define CURSOR_DEFAULT_V_MAX    600
 
 #define DISPLAY_VM_DEFAULT      1000.0
+#define STRIP_VM_CAP            8192    // > max display points (6000), rest evicted by time
 
 
 QT_BEGIN_NAMESPACE
@@ -59,7 +64,7 @@ class WindowVm : public QMainWindow, public IEmboInstrument
     Q_OBJECT
 
 public:
-    explicit WindowVm(QWidget *parent = nullptr);
+    explicit WindowVm(Core* core, QWidget *parent = nullptr);
     ~WindowVm();
 
     bool getInstrEnabled() override { return m_instrEnabled; };
@@ -71,7 +76,7 @@ signals:
 private slots:
     /* msg slots */
     void on_msg_err(const QString text, MsgBoxType type, bool needClose);
-    void on_msg_read(const QString ch1, const QString ch2, const QString ch3, const QString ch4, const QString vcc);
+    void on_msg_read(const VmData data);
 
     /* timer slots */
     void on_timer_plot();
@@ -86,6 +91,8 @@ private slots:
     void on_actionInterpLinear_triggered(bool checked);
     void on_actionInterpSinc_triggered(bool checked);
     void on_actionShowPlot_triggered(bool checked);
+    void on_actionViewTrend_triggered(bool checked);
+    void on_actionTrendOpen_triggered();
 
     /* GUI slots - Menu - Export */
     void on_actionExportStart_triggered();
@@ -121,6 +128,7 @@ private slots:
     /* GUI slots - QCP */
     void on_qcpMouseWheel(QWheelEvent*);
     void on_qcpMousePress(QMouseEvent*);
+    void on_qcpXRangeChanged(const QCPRange&);
 
     /* GUI slots - right panel - on/off */
     void on_pushButton_disable1_clicked();
@@ -158,6 +166,7 @@ private:
     void showEvent(QShowEvent* event) override;
 
     bool updatePlotData();
+    void updateTrendData();
     void rescaleYAxis();
     void rescaleXAxis();
 
@@ -191,6 +200,20 @@ private:
     bool m_data_fresh = false;
     double m_key_last = 0;
 
+    /* graph data - ring buffers */
+    QSharedPointer<StripChart> m_strip1;
+    QSharedPointer<StripChart> m_strip2;
+    QSharedPointer<StripChart> m_strip3;
+    QSharedPointer<StripChart> m_strip4;
+
+    /* long term trend - all channels since start */
+    Trend m_trend {4};
+    QSharedPointer<QCPGraphDataContainer> m_trendMean[4];
+    bool m_trend_view = false;
+    bool m_trend_loaded = false;
+    bool m_zoomed = false;          // x range zoomed or panned by user, not followed until zoom reset
+    bool m_rescalingX = false;
+
     /* average vars */
     double m_avg1_val = 0;
     double m_avg2_val = 0;
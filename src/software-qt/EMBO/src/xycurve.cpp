@@ -0,0 +1,55 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#include "xycurve.h"
+
+#include <algorithm>
+#include <math.h>
+
+
+void XyCurve::setData(QCPCurve* curve, const QVector<double>& x, const QVector<double>& y)
+{
+    int n = std::min(x.size(), y.size());
+
+    m_points.clear();
+
+    if (n < 1)
+    {
+        curve->data()->clear();
+        return;
+    }
+
+    QCPAxis* axis_x = curve->keyAxis();
+    QCPAxis* axis_y = curve->valueAxis();
+
+    const double kx = axis_x->axisRect()->width() / std::max(axis_x->range().size(), 1e-12) / XY_DECIM_PX;
+    const double ky = axis_y->axisRect()->height() / std::max(axis_y->range().size(), 1e-12) / XY_DECIM_PX;
+    const double* x_data = x.constData();
+    const double* y_data = y.constData();
+
+    m_points.reserve(n);
+    m_points.append(QCPCurveData(0, x_data[0], y_data[0]));
+
+    double last_x = x_data[0] * kx;
+    double last_y = y_data[0] * ky;
+
+    for (int i = 1; i < n - 1; i++)
+    {
+        double px = x_data[i] * kx;
+        double py = y_data[i] * ky;
+
+        if (fabs(px - last_x) >= 1 || fabs(py - last_y) >= 1)
+        {
+            m_points.append(QCPCurveData(i, x_data[i], y_data[i]));
+            last_x = px;
+            last_y = py;
+        }
+    }
+
+    if (n > 1) // end of figure always drawn
+        m_points.append(QCPCurveData(n - 1, x_data[n - 1], y_data[n - 1]));
+
+    curve->data()->set(m_points, true); // t is index - already sorted
+}
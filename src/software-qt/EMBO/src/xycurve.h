@@ -0,0 +1,33 @@
+/*
+ * CTU/EMBO - EMBedded Oscilloscope <github.com/parezj/EMBO>
+ * Author: Jakub Parez <parez.jakub@gmail.com>
+ */
+
+#ifndef XYCURVE_H
+#define XYCURVE_H
+
+#include "lib/qcustomplot.h"
+
+#include <QVector>
+
+
+#define XY_DECIM_PX     1.0     // min distance of drawn points [px], on either axis
+
+/* XY (Lissajous) display - QCPCurve is parametric, t = sample index, so samples are drawn in acquisition
+ * order without sorting. large memory depths are decimated to points at least XY_DECIM_PX apart,
+ * samples falling into the same pixel as the previous point add nothing to the figure. */
+
+class XyCurve
+{
+public:
+    XyCurve() {};
+
+    void setData(QCPCurve* curve, const QVector<double>& x, const QVector<double>& y);
+
+    int getPoints() const { return m_points.size(); }
+
+private:
+    QVector<QCPCurveData> m_points;
+};
+
+#endif // XYCURVE_H